@@ -0,0 +1,241 @@
+#include "CANFDMolinaroAcceptanceFilter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+//----------------------------------------------------------------------------------------
+
+static const U32 MAX_BASE_IDENTIFIER = 0x7FF ;
+static const U32 MAX_EXTENDED_IDENTIFIER = 0x1FFFFFFF ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroAcceptanceFilter::CANFDMolinaroAcceptanceFilter (void) :
+mBaseIdentifierBitmap (),
+mExtendedRanges (),
+mExtendedMasks (),
+mPayloadTerms (),
+mIsEmpty (true),
+mHasIdentifierTerms (false),
+mAcceptsCAN20B (true),
+mAcceptsCANFD (true),
+mAcceptsBase (true),
+mAcceptsExtended (true) {
+  clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAcceptanceFilter::clear (void) {
+  for (U32 i=0 ; i<(2048 / 32) ; i++) {
+    mBaseIdentifierBitmap [i] = 0 ;
+  }
+  mExtendedRanges.clear () ;
+  mExtendedMasks.clear () ;
+  mPayloadTerms.clear () ;
+  mIsEmpty = true ;
+  mHasIdentifierTerms = false ;
+  mAcceptsCAN20B = true ;
+  mAcceptsCANFD = true ;
+  mAcceptsBase = true ;
+  mAcceptsExtended = true ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool parseNumber (const std::string & inString, U32 & outValue) {
+  bool ok = inString.length () > 0 ;
+  if (ok) {
+    char * end = nullptr ;
+    const unsigned long value = strtoul (inString.c_str (), &end, 0) ;
+    ok = (*end == '\0') && (value <= 0xFFFFFFFFUL) ;
+    outValue = U32 (value) ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroAcceptanceFilter::compile (const std::string & inSource,
+                                             std::string & outErrorMessage) {
+  clear () ;
+  mAcceptsCAN20B = false ;
+  mAcceptsCANFD = false ;
+  mAcceptsBase = false ;
+  mAcceptsExtended = false ;
+//--- Split terms
+  bool ok = true ;
+  std::string term ;
+  for (size_t i=0 ; (i <= inSource.length ()) && ok ; i++) {
+    const char c = (i < inSource.length ()) ? inSource [i] : ' ' ;
+    if ((c == ',') || (c == ';') || isspace (c)) {
+      if (term.length () > 0) {
+        ok = compileTerm (term, outErrorMessage) ;
+        term.clear () ;
+      }
+    }else{
+      term += char (tolower (c)) ;
+    }
+  }
+//--- Frame kinds: no term in a group means no constraint
+  if (!mAcceptsCAN20B && !mAcceptsCANFD) {
+    mAcceptsCAN20B = true ;
+    mAcceptsCANFD = true ;
+  }
+  if (!mAcceptsBase && !mAcceptsExtended) {
+    mAcceptsBase = true ;
+    mAcceptsExtended = true ;
+  }
+//--- Sort and merge extended identifier ranges
+  std::sort (mExtendedRanges.begin (), mExtendedRanges.end (),
+             [] (const IdentifierRange & inLeft, const IdentifierRange & inRight) {
+               return inLeft.mFirst < inRight.mFirst ;
+             }) ;
+  std::vector <IdentifierRange> merged ;
+  for (const IdentifierRange & range : mExtendedRanges) {
+    if ((merged.size () > 0) && (range.mFirst <= (merged.back ().mLast + 1))) {
+      merged.back ().mLast = std::max (merged.back ().mLast, range.mLast) ;
+    }else{
+      merged.push_back (range) ;
+    }
+  }
+  mExtendedRanges.swap (merged) ;
+//---
+  if (ok) {
+    mIsEmpty = !mHasIdentifierTerms
+      && mAcceptsCAN20B && mAcceptsCANFD
+      && mAcceptsBase && mAcceptsExtended
+      && (mPayloadTerms.size () == 0) ;
+  }else{
+    clear () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroAcceptanceFilter::compileTerm (const std::string & inTerm,
+                                                 std::string & outErrorMessage) {
+  bool ok = true ;
+  if (inTerm == "fd") {
+    mAcceptsCANFD = true ;
+  }else if (inTerm == "classic") {
+    mAcceptsCAN20B = true ;
+  }else if (inTerm == "base") {
+    mAcceptsBase = true ;
+  }else if (inTerm == "ext") {
+    mAcceptsExtended = true ;
+  }else if ((inTerm [0] == 'd') && (inTerm.length () > 1) && isdigit (inTerm [1])) { // Payload term
+    const size_t equalPos = inTerm.find ('=') ;
+    const size_t slashPos = inTerm.find ('/') ;
+    U32 index = 0 ;
+    U32 value = 0 ;
+    U32 mask = 0xFF ;
+    ok = (equalPos != std::string::npos)
+      && parseNumber (inTerm.substr (1, equalPos - 1), index)
+      && parseNumber (inTerm.substr (equalPos + 1, slashPos - equalPos - 1), value)
+      && ((slashPos == std::string::npos) || parseNumber (inTerm.substr (slashPos + 1), mask))
+      && (index < 64) && (value <= 0xFF) && (mask <= 0xFF) ;
+    if (ok) {
+      const PayloadTerm payloadTerm = { U8 (index), U8 (value & mask), U8 (mask) } ;
+      mPayloadTerms.push_back (payloadTerm) ;
+    }
+  }else{ // Identifier term
+    std::string s = inTerm ;
+    bool forceExtended = false ;
+    bool forceBase = false ;
+    if (s.compare (0, 2, "x:") == 0) {
+      forceExtended = true ;
+      s = s.substr (2) ;
+    }else if (s.compare (0, 2, "s:") == 0) {
+      forceBase = true ;
+      s = s.substr (2) ;
+    }
+    const size_t dashPos = s.find ('-') ;
+    const size_t slashPos = s.find ('/') ;
+    U32 first = 0 ;
+    U32 last = 0 ;
+    U32 mask = 0xFFFFFFFF ;
+    if (dashPos != std::string::npos) {
+      ok = parseNumber (s.substr (0, dashPos), first) && parseNumber (s.substr (dashPos + 1), last) && (first <= last) ;
+    }else if (slashPos != std::string::npos) {
+      ok = parseNumber (s.substr (0, slashPos), first) && parseNumber (s.substr (slashPos + 1), mask) ;
+      last = first ;
+    }else{
+      ok = parseNumber (s, first) ;
+      last = first ;
+    }
+    const bool extended = forceExtended || (!forceBase && (last > MAX_BASE_IDENTIFIER)) ;
+    ok = ok && (last <= (extended ? MAX_EXTENDED_IDENTIFIER : MAX_BASE_IDENTIFIER)) ;
+    if (ok) {
+      mHasIdentifierTerms = true ;
+      if (extended && (slashPos != std::string::npos)) {
+        const IdentifierMask idfMask = { first & mask, mask & MAX_EXTENDED_IDENTIFIER } ;
+        mExtendedMasks.push_back (idfMask) ;
+      }else if (extended) {
+        const IdentifierRange range = { first, last } ;
+        mExtendedRanges.push_back (range) ;
+      }else if (slashPos != std::string::npos) {
+        for (U32 idf = 0 ; idf <= MAX_BASE_IDENTIFIER ; idf++) {
+          if ((idf & mask) == (first & mask)) {
+            setBaseIdentifier (idf) ;
+          }
+        }
+      }else{
+        for (U32 idf = first ; idf <= last ; idf++) {
+          setBaseIdentifier (idf) ;
+        }
+      }
+    }
+  }
+  if (!ok) {
+    outErrorMessage = "Invalid acceptance filter term: \"" + inTerm + "\"" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAcceptanceFilter::setBaseIdentifier (const U32 inIdentifier) {
+  mBaseIdentifierBitmap [inIdentifier / 32] |= 1U << (inIdentifier % 32) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroAcceptanceFilter::acceptsHeader (const U32 inIdentifier,
+                                                   const bool inExtended,
+                                                   const bool inCANFD) const {
+  bool accepted = (inCANFD ? mAcceptsCANFD : mAcceptsCAN20B)
+    && (inExtended ? mAcceptsExtended : mAcceptsBase) ;
+  if (accepted && mHasIdentifierTerms) {
+    if (!inExtended) {
+      const U32 idf = inIdentifier & MAX_BASE_IDENTIFIER ;
+      accepted = (mBaseIdentifierBitmap [idf / 32] & (1U << (idf % 32))) != 0 ;
+    }else{
+    //--- Find the last range beginning at or before the identifier
+      const auto it = std::upper_bound (mExtendedRanges.begin (), mExtendedRanges.end (), inIdentifier,
+                                        [] (const U32 inValue, const IdentifierRange & inRange) {
+                                          return inValue < inRange.mFirst ;
+                                        }) ;
+      accepted = (it != mExtendedRanges.begin ()) && (inIdentifier <= (it - 1)->mLast) ;
+      for (size_t i=0 ; (i < mExtendedMasks.size ()) && !accepted ; i++) {
+        accepted = (inIdentifier & mExtendedMasks [i].mMask) == mExtendedMasks [i].mValue ;
+      }
+    }
+  }
+  return accepted ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroAcceptanceFilter::acceptsPayload (const U8 * inData, const U32 inLength) const {
+  bool accepted = true ;
+  for (size_t i=0 ; (i < mPayloadTerms.size ()) && accepted ; i++) {
+    const PayloadTerm & term = mPayloadTerms [i] ;
+    accepted = (term.mIndex < inLength) && ((inData [term.mIndex] & term.mMask) == term.mValue) ;
+  }
+  return accepted ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,86 @@
+#ifndef CANFDMOLINARO_ACCEPTANCE_FILTER_H
+#define CANFDMOLINARO_ACCEPTANCE_FILTER_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Acceptance filter expression: a list of terms, separated by commas or spaces.
+//
+//  Identifier terms (a frame is accepted if it matches one of them, or if there is none):
+//    0x123          a base identifier (a value above 0x7FF denotes an extended identifier)
+//    0x100-0x1FF    an identifier range
+//    0x700/0x7F0    an identifier / mask pair (only bits set in mask are compared)
+//    x:0x123        "x:" prefix forces an extended identifier, "s:" a base identifier
+//
+//  Frame kind terms (if a group is given, the frame should match one term of the group):
+//    fd, classic    CANFD frame, CAN 2.0B frame
+//    base, ext      base (11-bit) identifier, extended (29-bit) identifier
+//
+//  Payload terms (all of them should match, a frame without the byte is rejected):
+//    d3=0x12        data byte 3 is 0x12
+//    d3=0x10/0xF0   data byte 3, masked with 0xF0, is 0x10
+//
+//  The expression is compiled once: a bitmap for base identifiers, sorted ranges and a
+//  mask table for extended identifiers.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroAcceptanceFilter {
+  public: CANFDMolinaroAcceptanceFilter (void) ;
+
+//--- Returns false and sets outErrorMessage on syntax error (the filter is then empty)
+  public: bool compile (const std::string & inSource, std::string & outErrorMessage) ;
+
+//--- An empty filter accepts every frame
+  public: inline bool isEmpty (void) const { return mIsEmpty ; }
+
+//--- True if the decision cannot be taken until the data field is received
+  public: inline bool needsPayload (void) const { return mPayloadTerms.size () > 0 ; }
+
+  public: bool acceptsHeader (const U32 inIdentifier,
+                              const bool inExtended,
+                              const bool inCANFD) const ;
+
+  public: bool acceptsPayload (const U8 * inData, const U32 inLength) const ;
+
+//--- Private types
+  private: typedef struct {
+    U32 mFirst ;
+    U32 mLast ;
+  } IdentifierRange ;
+
+  private: typedef struct {
+    U32 mValue ;
+    U32 mMask ;
+  } IdentifierMask ;
+
+  private: typedef struct {
+    U8 mIndex ;
+    U8 mValue ;
+    U8 mMask ;
+  } PayloadTerm ;
+
+//--- Private methods
+  private: void clear (void) ;
+  private: bool compileTerm (const std::string & inTerm, std::string & outErrorMessage) ;
+  private: void setBaseIdentifier (const U32 inIdentifier) ;
+
+//--- Private properties
+  private: U32 mBaseIdentifierBitmap [2048 / 32] ;
+  private: std::vector <IdentifierRange> mExtendedRanges ;
+  private: std::vector <IdentifierMask> mExtendedMasks ;
+  private: std::vector <PayloadTerm> mPayloadTerms ;
+  private: bool mIsEmpty ;
+  private: bool mHasIdentifierTerms ;
+  private: bool mAcceptsCAN20B ;
+  private: bool mAcceptsCANFD ;
+  private: bool mAcceptsBase ;
+  private: bool mAcceptsExtended ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_ACCEPTANCE_FILTER_H
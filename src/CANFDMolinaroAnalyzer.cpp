@@ -2,6 +2,7 @@
 #include "CANFDMolinaroAnalyzerSettings.h"
 #include <AnalyzerChannelData.h>
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
@@ -12,9 +13,33 @@
 CANFDMolinaroAnalyzer::CANFDMolinaroAnalyzer (void) :
 Analyzer2 (),
 mSettings (new CANFDMolinaroAnalyzerSettings ()),
-mSimulationInitialized (false) {
+mSimulationInitialized (false),
+mFrameStore (),
+mFrameStoreIndex (0),
+mDecodingMode (DecodingMode::FIELD_DECODING_MODE),
+mResultOutput (ResultOutput::LEGACY_AND_FRAMEV2_RESULTS),
+mFrameHasError (false),
+mBitArchive (),
+mLiveLatency (),
+mLiveLastReportTime (),
+mBusCount (1),
+mBusDecoders (),
+mBusEdges (),
+mWorkerPool (),
+mDecoder (mBusDecoders [0].frameDecoder ()),
+mGatewayMonitor (),
+mGatewayEvents (),
+mTxd (nullptr),
+mTxBit (true),
+mLoopDelayPending (false),
+mTransceiverMonitor (),
+mCounters (),
+mWorkerThreadStartTime (),
+mSummaryDone (false),
+mTrace () {
   SetAnalyzerSettings (mSettings.get()) ;
   UseFrameV2 () ;
+  mFrameStore.setPayloadDeduplication (true) ;
 }
 
 //----------------------------------------------------------------------------------------
@@ -28,691 +53,579 @@ CANFDMolinaroAnalyzer::~CANFDMolinaroAnalyzer (void) {
 void CANFDMolinaroAnalyzer::SetupResults (void) {
   mResults.reset (new CANFDMolinaroAnalyzerResults (this, mSettings.get())) ;
   SetAnalyzerResults (mResults.get()) ;
-  mResults->AddChannelBubblesWillAppearOn (mSettings->mInputChannel) ;
+  for (U32 bus = 0 ; bus < mSettings->busCount () ; bus++) {
+    Channel channel = mSettings->busChannel (bus) ;
+    mResults->AddChannelBubblesWillAppearOn (channel) ;
+  }
 }
 
 //----------------------------------------------------------------------------------------
 
 void CANFDMolinaroAnalyzer::WorkerThread (void) {
-  const bool inverted = mSettings->inverted () ;
+  mWorkerThreadStartTime = std::chrono::steady_clock::now () ;
+  mCounters.reset () ;
+  mSummaryDone = false ;
+  mTrace.open (mSettings->traceFile ()) ;
+  const BitState recessiveState = mSettings->inverted () ? BIT_LOW : BIT_HIGH ; // Polarity resolved once
   mSampleRateHz = GetSampleRate () ;
   AnalyzerChannelData * serial = GetAnalyzerChannelData (mSettings->mInputChannel) ;
 //--- Sample settings
-  mCurrentSamplesPerBit = mSampleRateHz / mSettings->arbitrationBitRate () ;
+  mDecodingMode = mSettings->decodingMode () ;
+  mResultOutput = mSettings->resultOutput () ;
+//--- Signal database (already checked by settings)
+  std::string errorMessage ;
+  mSignalDatabase = CANFDMolinaroSignalDatabase () ;
+  if (mSettings->signalDatabaseFile ().length () > 0) {
+    mSignalDatabase.load (mSettings->signalDatabaseFile (), errorMessage) ;
+  }
+//--- Multi-bus decoding
+  mBusCount = mSettings->busCount () ;
+  if (mBusCount > 1) {
+    multiBusWorkerThread () ;
+    return ;
+  }
+//--- Single bus decoder (acceptance filter already checked by settings)
+  mBusDecoders [0].configure (*mSettings, 0, mSampleRateHz) ;
+  mBusDecoders [0].setMarkerOutput (mDecodingMode == DecodingMode::FIELD_DECODING_MODE) ; // No marker in frame level modes
+  mBusDecoders [0].setForwardOutput (this) ;
+//--- Local node TXD
+  Channel txdChannel = mSettings->txdChannel () ;
+  mTxd = (txdChannel != UNDEFINED_CHANNEL) ? GetAnalyzerChannelData (txdChannel) : nullptr ;
+  mTxBit = true ;
+  mLoopDelayPending = false ;
 //--- Synchronize to recessive level
-  if (serial->GetBitState() == (inverted ? BIT_HIGH : BIT_LOW)) {
+  if (serial->GetBitState() != recessiveState) {
     serial->AdvanceToNextEdge () ;
   }
+  mBusDecoders [0].reset (serial->GetBitState () == recessiveState, serial->GetSampleNumber ()) ; // Also resets mDecoder
+  { std::lock_guard <std::mutex> lock (mFrameStore.mutex ()) ;
+    mFrameStore.clear () ;
+  }
+  { std::lock_guard <std::mutex> lock (mBitArchive.mutex ()) ;
+    mBitArchive.clear () ;
+  }
 //---
-  mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
-  mUnstuffingActive = false ;
-  mPreviousBit = (serial->GetBitState () == BIT_HIGH) ^ inverted ;
-//---
+  mLiveLatency.start (serial->GetSampleNumber (), mSampleRateHz) ;
+  mLiveLastReportTime = std::chrono::steady_clock::now () ;
+  U64 currentCenter = 0 ;
   while (1) {
-    const bool currentBitValue = (serial->GetBitState () == BIT_HIGH) ^ inverted ;
+    if (!serial->DoMoreTransitionsExistInCurrentData ()) { // Caught up with capture data
+      updateWallTime () ;
+      emitCountersSummary (serial->GetSampleNumber ()) ;
+      mTrace.flush () ;
+    }
+    const bool currentBitValue = serial->GetBitState () == recessiveState ;
     const U64 start = serial->GetSampleNumber () ;
     const U64 nextEdge = serial->GetSampleOfNextEdge () ;
 
-    U64 currentCenter = start + mCurrentSamplesPerBit / 2 ;
-    while (currentCenter < nextEdge) {
-      enterBit (currentBitValue, currentCenter) ;
-      currentCenter += mCurrentSamplesPerBit ;
+    currentCenter = mDecoder.resynchronize (start, currentCenter, !currentBitValue) ;
+    { CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::DECODE) ;
+      while (currentCenter < nextEdge) {
+        if ((mDecodingMode == DecodingMode::BIT_ARCHIVE_DECODING_MODE) && !(mDecoder.isIdle () && currentBitValue)) { // Record SOF and following bits
+          std::lock_guard <std::mutex> lock (mBitArchive.mutex ()) ;
+          if (mDecoder.isIdle ()) {
+            mBitArchive.beginFrame (currentCenter - mDecoder.currentSamplesPerBit () / 2) ;
+          }
+          mBitArchive.appendBit (currentBitValue) ;
+        }
+        if (mTxd != nullptr) {
+          checkTransmittedBit (currentBitValue, currentCenter) ;
+        }
+        mDecoder.enterBit (currentBitValue, currentCenter) ;
+        if (mLoopDelayPending) { // FDF bit of a transmitted frame: next RXD edge is at res
+          measureLoopDelay (nextEdge) ;
+        }
+        currentCenter += mDecoder.currentSamplesPerBit () ;
+      }
     }
   //---
-    mResults->CommitResults () ;
+    if (mDecodingMode != DecodingMode::LIVE_DECODING_MODE) {
+      commitResults () ;
+    }else if (mDecoder.isIdle ()) { // Bounded staleness of progress while bus is idle
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now () ;
+      if ((now - mLiveLastReportTime) > std::chrono::milliseconds (LIVE_STALENESS_MS)) {
+        reportProgress (nextEdge) ;
+        mLiveLastReportTime = now ;
+      }
+    }
     serial->AdvanceToNextEdge () ;
+    mCounters.increment (CANFDMolinaroDecoderCounters::EDGES) ;
   }
 }
 
+//----------------------------------------------------------------------------------------
+//  MULTI-BUS DECODING
+//  Every bus channel is read by windows of WINDOW_MS; as a channel read blocks until
+//  capture data is available, the results of the last window are output when the next
+//  window is complete. Each window costs a worker pool barrier, a commit and a progress
+//  report, so a window spans many frames; 50 ms is also the live progress interval.
+//  Multi-bus decoding always uses field decoding mode.
 //----------------------------------------------------------------------------------------
 
-bool CANFDMolinaroAnalyzer::NeedsRerun () {
-  return false;
-}
+static const U32 WINDOW_MS = 50 ;
 
 //----------------------------------------------------------------------------------------
 
-U32 CANFDMolinaroAnalyzer::GenerateSimulationData (U64 minimum_sample_index,
-                                                 U32 device_sample_rate,
-                                                 SimulationChannelDescriptor** simulation_channels ) {
-  if (mSimulationInitialized == false) {
-    mSimulationDataGenerator.Initialize( GetSimulationSampleRate(), mSettings.get() );
-    mSimulationInitialized = true;
+void CANFDMolinaroAnalyzer::multiBusWorkerThread (void) {
+  const bool inverted = mSettings->inverted () ;
+  mDecodingMode = DecodingMode::FIELD_DECODING_MODE ;
+  { std::lock_guard <std::mutex> lock (mFrameStore.mutex ()) ;
+    mFrameStore.clear () ;
+  }
+  { std::lock_guard <std::mutex> lock (mBitArchive.mutex ()) ;
+    mBitArchive.clear () ;
+  }
+//--- Synchronize every bus to recessive level
+  AnalyzerChannelData * channels [CANFD_MAX_BUS_COUNT] ;
+  U64 windowEnd = 0 ;
+  for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+    Channel busChannel = mSettings->busChannel (bus) ;
+    AnalyzerChannelData * channel = GetAnalyzerChannelData (busChannel) ;
+    channels [bus] = channel ;
+    if (channel->GetBitState() == (inverted ? BIT_HIGH : BIT_LOW)) {
+      channel->AdvanceToNextEdge () ;
+    }
+    mBusDecoders [bus].configure (*mSettings, bus, mSampleRateHz) ;
+    mBusDecoders [bus].setMarkerOutput (mDecodingMode == DecodingMode::FIELD_DECODING_MODE) ;
+    mBusDecoders [bus].setForwardOutput (nullptr) ; // Bus 0 forwards in single bus decoding
+    mBusDecoders [bus].reset ((channel->GetBitState () == BIT_HIGH) ^ inverted, channel->GetSampleNumber ()) ;
+    windowEnd = std::max (windowEnd, channel->GetSampleNumber ()) ;
+  }
+  { std::lock_guard <std::mutex> lock (mGatewayMonitor.mutex ()) ;
+    std::string errorMessage ; // Already checked by settings
+    mGatewayMonitor.compile (mSettings->gatewayRoutes (), errorMessage) ;
+    mGatewayMonitor.reset (mSampleRateHz) ;
+  }
+//--- Decode by windows
+  const U64 windowLength = std::max (U64 (1), U64 (mSampleRateHz) * WINDOW_MS / 1000) ;
+  const std::function <void (const U32)> decodeTask = [this, &windowEnd] (const U32 inBus) {
+    mBusDecoders [inBus].decodeBlock (mBusEdges [inBus], windowEnd) ;
+  } ;
+  while (1) {
+    windowEnd += windowLength ;
+    bool caughtUp = true ;
+    for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+      AnalyzerChannelData * channel = channels [bus] ;
+      mBusEdges [bus].clear () ;
+      while (channel->WouldAdvancingToAbsPositionCauseTransition (windowEnd)) {
+        channel->AdvanceToNextEdge () ;
+        mBusEdges [bus].push_back (channel->GetSampleNumber ()) ;
+      }
+      channel->AdvanceToAbsPosition (windowEnd) ;
+      mCounters.add (CANFDMolinaroDecoderCounters::EDGES, mBusEdges [bus].size ()) ;
+      caughtUp &= !channel->DoMoreTransitionsExistInCurrentData () ;
+    }
+    { CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::DECODE) ;
+      mWorkerPool.run (mBusCount, decodeTask) ;
+    }
+    mergeBusResults () ;
+    updateWallTime () ;
+    if (caughtUp) {
+      emitCountersSummary (windowEnd) ;
+      mTrace.flush () ;
+    }
+    commitResults () ;
+    reportProgress (windowEnd) ;
   }
-  return mSimulationDataGenerator.GenerateSimulationData (minimum_sample_index,
-                                                          device_sample_rate,
-                                                          simulation_channels) ;
 }
 
 //----------------------------------------------------------------------------------------
-
-U32 CANFDMolinaroAnalyzer::GetMinimumSampleRateHz () {
-  const U32 arbitrationBitRate = mSettings->arbitrationBitRate () ;
-  const U32 dataBitRate = mSettings->dataBitRate () ;
-  const U32 max = (dataBitRate > arbitrationBitRate) ? dataBitRate : arbitrationBitRate ;
-  return max * 12 ;
-}
-
+//  Markers are output per channel; bubbles and frames of all buses are output in a
+//  single stream sorted by start sample, up to the smallest bus watermark (a bubble goes
+//  before a frame that starts at the same sample, as its SOF bubble). Buses are
+//  concurrent, so bubbles of different buses may overlap in time.
 //----------------------------------------------------------------------------------------
 
-const char* CANFDMolinaroAnalyzer::GetAnalyzerName () const {
-  return "CANFD (Molinaro)";
+void CANFDMolinaroAnalyzer::mergeBusResults (void) {
+  U64 watermark = mBusDecoders [0].watermark () ;
+  for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+    watermark = std::min (watermark, mBusDecoders [bus].watermark ()) ;
+    Channel channel = mSettings->busChannel (bus) ;
+    for (const CANFDMolinaroBusDecoder::Marker & marker : mBusDecoders [bus].markers ()) {
+      addMarker (marker.mSampleNumber, marker.mType, channel) ;
+    }
+    mBusDecoders [bus].markers ().clear () ;
+  }
+//--- Bubbles and frames
+  bool found = true ;
+  while (found) {
+    found = false ;
+    bool selectedIsBubble = false ;
+    U32 selectedBus = 0 ;
+    U64 start = watermark ;
+    for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+      const std::deque <CANFDMolinaroBusDecoder::Bubble> & bubbles = mBusDecoders [bus].bubbles () ;
+      if ((bubbles.size () > 0) && (bubbles.front ().mStartSampleNumber < start)) {
+        start = bubbles.front ().mStartSampleNumber ;
+        selectedIsBubble = true ;
+        selectedBus = bus ;
+        found = true ;
+      }
+    }
+    for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+      const std::deque <CANFDMolinaroBusDecoder::FrameRecord> & records = mBusDecoders [bus].frameRecords () ;
+      if ((records.size () > 0) && (records.front ().mStartSampleNumber < start)) {
+        start = records.front ().mStartSampleNumber ;
+        selectedIsBubble = false ;
+        selectedBus = bus ;
+        found = true ;
+      }
+    }
+    if (!found) {
+    }else if (selectedIsBubble) {
+      const CANFDMolinaroBusDecoder::Bubble bubble = mBusDecoders [selectedBus].bubbles ().front () ;
+      mBusDecoders [selectedBus].bubbles ().pop_front () ;
+      emitBubble (bubble.mType, bubble.mData1, bubble.mData2,
+                  bubble.mStartSampleNumber, bubble.mEndSampleNumber, selectedBus) ;
+    }else{
+      storeBusFrame (mBusDecoders [selectedBus].frameRecords ().front (), selectedBus) ;
+      mBusDecoders [selectedBus].frameRecords ().pop_front () ;
+    }
+  }
 }
 
 //----------------------------------------------------------------------------------------
 
-const char* GetAnalyzerName () {
-  return "CANFD (Molinaro)";
+void CANFDMolinaroAnalyzer::storeBusFrame (const CANFDMolinaroBusDecoder::FrameRecord & inRecord,
+                                           const U32 inBus) {
+  mTrace.frameDone () ;
+  U32 storeIndex = 0 ;
+  { std::lock_guard <std::mutex> lock (mFrameStore.mutex ()) ;
+    mFrameStore.append (inRecord.mStartSampleNumber, inRecord.mEndSampleNumber, inRecord.mIdentifier,
+                        inRecord.mFlags, inRecord.mDataCodeLength, inRecord.mData.data (), U8 (inBus)) ;
+    storeIndex = mFrameStore.size () ;
+  }
+  if (mResultOutput == ResultOutput::FRAMEV2_RESULTS_ONLY) { // Erroneous frames only have field rows
+    const bool crcError = (inRecord.mFlags & CANFDMolinaroFrameStore::CRC_ERROR_FLAG) != 0 ;
+    emitFrameResult (inRecord.mIdentifier, storeIndex, U8 ((inBus & FRAME_BUS_MASK) | (crcError ? DISPLAY_AS_ERROR_FLAG : 0)),
+                     inRecord.mStartSampleNumber, inRecord.mEndSampleNumber) ;
+  }
+  const bool decodeSignals =
+    ((inRecord.mFlags & (CANFDMolinaroFrameStore::REMOTE_FLAG | CANFDMolinaroFrameStore::CRC_ERROR_FLAG)) == 0)
+    && !mSignalDatabase.isEmpty () ;
+  if (decodeSignals) {
+    emitSignals (inRecord.mIdentifier,
+                 (inRecord.mFlags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0,
+                 inRecord.mData.data (),
+                 U32 (inRecord.mData.size ()),
+                 inRecord.mStartSampleNumber,
+                 inRecord.mEndSampleNumber,
+                 inBus) ;
+  }
+  if (!mGatewayMonitor.isEmpty () && ((inRecord.mFlags & CANFDMolinaroFrameStore::CRC_ERROR_FLAG) == 0)) {
+    mGatewayEvents.clear () ;
+    { std::lock_guard <std::mutex> lock (mGatewayMonitor.mutex ()) ;
+      mGatewayMonitor.enterFrame (inBus,
+                                  inRecord.mStartSampleNumber,
+                                  inRecord.mEndSampleNumber,
+                                  inRecord.mIdentifier,
+                                  inRecord.mFlags,
+                                  inRecord.mData.data (),
+                                  U32 (inRecord.mData.size ()),
+                                  mGatewayEvents) ;
+    }
+    emitGatewayEvents (inRecord.mStartSampleNumber, inRecord.mEndSampleNumber) ;
+  }
 }
 
+//----------------------------------------------------------------------------------------
+//  A forwarded frame is reported on the destination frame; an unmatched source frame is
+//  reported when it leaves the matching window, that is at the SOF of the entered frame,
+//  so that results stay in time order.
 //----------------------------------------------------------------------------------------
 
-Analyzer* CreateAnalyzer () {
-  return new CANFDMolinaroAnalyzer();
+void CANFDMolinaroAnalyzer::emitGatewayEvents (const U64 inStartSampleNumber,
+                                               const U64 inEndSampleNumber) {
+  for (const CANFDMolinaroGatewayMonitor::Event & event : mGatewayEvents) {
+    FrameV2 frameV2 ;
+    frameV2.AddString ("Route", mGatewayMonitor.routeName (event.mRoute).c_str ()) ;
+    frameV2.AddInteger ("Identifier", event.mIdentifier) ;
+    if (event.mKind == CANFDMolinaroGatewayMonitor::EventKind::UNMATCHED_FRAME) {
+      frameV2.AddDouble ("Source End (s)", double (event.mSourceEndSampleNumber) / double (mSampleRateHz)) ;
+      addFrameV2 (frameV2, "Unmatched", inStartSampleNumber, inStartSampleNumber) ;
+    }else{
+      frameV2.AddDouble ("Latency (us)", double (event.mLatency) * 1.0e6 / double (mSampleRateHz)) ;
+      frameV2.AddBoolean ("Late", event.mKind == CANFDMolinaroGatewayMonitor::EventKind::LATE_FRAME) ;
+      addFrameV2 (frameV2, "Gateway", inStartSampleNumber, inEndSampleNumber) ;
+    }
+  }
 }
 
 //----------------------------------------------------------------------------------------
 
-void DestroyAnalyzer (Analyzer* analyzer) {
-  delete analyzer;
+bool CANFDMolinaroAnalyzer::NeedsRerun () {
+  return false;
 }
 
 //----------------------------------------------------------------------------------------
-//  CAN FRAME DECODER
+//  LOCAL NODE TXD
+//  TXD is read at every RXD bit center, minus the loop delay once it is measured (as
+//  transmitter delay compensation does, TXD bits are compared with the RXD bits they
+//  produced). Arbitration losses and bit errors are marked on TXD channel, loop delay by
+//  a start marker at the TXD edge and a stop marker at the RXD edge.
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::enterBit (const bool inBit, U64 & ioBitCenterSampleNumber) {
-  if (!mUnstuffingActive) {
-    decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
-    mPreviousBit = inBit ;
-  }else if ((mConsecutiveBitCountOfSamePolarity == 5) && (inBit != mPreviousBit)) {
-   // Stuff bit - discarded
-    addMark (ioBitCenterSampleNumber, AnalyzerResults::X);
-    mConsecutiveBitCountOfSamePolarity = 1 ;
-    mPreviousBit = inBit ;
-    mStuffBitCount += 1 ;
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
-  }else if ((mConsecutiveBitCountOfSamePolarity == 5) && (mPreviousBit == inBit)) { // Stuff Error
-    addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorX);
-    enterInErrorMode (ioBitCenterSampleNumber + mCurrentSamplesPerBit / 2) ;
-    mConsecutiveBitCountOfSamePolarity += 1 ;
-  }else if (mPreviousBit == inBit) {
-    mConsecutiveBitCountOfSamePolarity += 1 ;
-    decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
-  }else{
-    mConsecutiveBitCountOfSamePolarity = 1 ;
-    mPreviousBit = inBit ;
-    decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
+void CANFDMolinaroAnalyzer::checkTransmittedBit (const bool inRxBit, const U64 inBitCenterSampleNumber) {
+  const U64 loopDelay = mTransceiverMonitor.hasLoopDelay () ? mTransceiverMonitor.loopDelay () : 0 ;
+  mTxd->AdvanceToAbsPosition (inBitCenterSampleNumber - loopDelay) ;
+  mTxBit = (mTxd->GetBitState () == BIT_HIGH) ^ mSettings->inverted () ;
+  if (!mDecoder.isIdle ()) {
+    Channel txdChannel = mSettings->txdChannel () ;
+    switch (mTransceiverMonitor.checkBit (inRxBit, mTxBit, mDecoder.isInAckField ())) {
+    case CANFDMolinaroTransceiverMonitor::BitCheck::BIT_OK :
+      break ;
+    case CANFDMolinaroTransceiverMonitor::BitCheck::ARBITRATION_LOST :
+      addMarker (inBitCenterSampleNumber, AnalyzerResults::X, txdChannel) ;
+      break ;
+    case CANFDMolinaroTransceiverMonitor::BitCheck::BIT_ERROR :
+      addMarker (inBitCenterSampleNumber, AnalyzerResults::ErrorX, txdChannel) ;
+      break ;
+    }
   }
 }
 
 //----------------------------------------------------------------------------------------
 
-static const uint8_t CANFD_LENGTH [16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64} ;
+void CANFDMolinaroAnalyzer::measureLoopDelay (const U64 inRxEdgeSampleNumber) {
+  mLoopDelayPending = false ;
+  const U64 txEdgeSampleNumber = mTxd->GetSampleOfNextEdge () ; // TXD is at FDF bit center
+  const bool valid = (txEdgeSampleNumber <= inRxEdgeSampleNumber)
+    && ((inRxEdgeSampleNumber - txEdgeSampleNumber) < mDecoder.samplesPerArbitrationBit ()) ;
+  if (valid) {
+    mTransceiverMonitor.setLoopDelay (inRxEdgeSampleNumber - txEdgeSampleNumber) ;
+    Channel txdChannel = mSettings->txdChannel () ;
+    addMarker (txEdgeSampleNumber, AnalyzerResults::Start, txdChannel) ;
+    addMarker (inRxEdgeSampleNumber, AnalyzerResults::Stop, txdChannel) ;
+  }
+}
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::decodeFrameBit (const bool inBit, U64 & ioBitCenterSampleNumber) {
-  switch (mFrameFieldEngineState) {
-  case FrameFieldEngineState::IDLE :
-    handle_IDLE_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::IDENTIFIER :
-    handle_IDENTIFIER_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CONTROL_EXTENDED :
-    handle_CONTROL_EXTENDED_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CONTROL_BASE :
-    handle_CONTROL_BASE_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CONTROL_AFTER_R0 :
-    handle_CONTROL_AFTER_R0_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::DATA :
-    handle_DATA_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::SBC :
-    handle_SBC_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CRC15 :
-    handle_CRC15_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CRC17 :
-    handle_CRC17_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CRC21 :
-    handle_CRC21_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::CRCDEL :
-    handle_CRCDEL_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::ACK :
-    handle_ACK_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::ENDOFFRAME :
-    handle_ENDOFFRAME_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::INTERMISSION :
-    handle_INTERMISSION_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
-  case FrameFieldEngineState::DECODER_ERROR :
-    handle_DECODER_ERROR_state (inBit, ioBitCenterSampleNumber) ;
-    break ;
+void CANFDMolinaroAnalyzer::emitTransmission (const U64 inEndSampleNumber) {
+  FrameV2 frameV2 ;
+  if (mTransceiverMonitor.hasLoopDelay ()) {
+    frameV2.AddDouble ("Loop Delay (ns)", double (mTransceiverMonitor.loopDelay ()) * 1.0e9 / double (mSampleRateHz)) ;
   }
+  frameV2.AddBoolean ("Arbitration Lost", mTransceiverMonitor.arbitrationLost ()) ;
+  frameV2.AddBoolean ("Bit Error", mTransceiverMonitor.bitError ()) ;
+  addFrameV2 (frameV2, "Transmission", inEndSampleNumber, inEndSampleNumber) ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_IDLE_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  if (inBit) {
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Stop) ;
-  }else{ // SOF
-    mUnstuffingActive = true ;
-    mCRC15Accumulator = 0 ;
-    switch (mSettings->protocol ()) {
-    case CANFD_NON_ISO_PROTOCOL :
-      mCRC17Accumulator = 0 ;
-      mCRC21Accumulator = 0 ;
-      break ;
-    case CANFD_ISO_PROTOCOL :
-      mCRC17Accumulator = 1 << 16 ;
-      mCRC21Accumulator = 1 << 20 ;
-      break ;
-    }
-    mConsecutiveBitCountOfSamePolarity = 1 ;
-    mPreviousBit = false ;
-    enterBitInCRC15 (inBit) ;
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Start);
-    mFieldBitIndex = 0 ;
-    mIdentifier = 0 ;
-    mStuffBitCount = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::IDENTIFIER ;
-    mCurrentSamplesPerBit = mSampleRateHz / mSettings->arbitrationBitRate () ;
-    mStartOfFieldSampleNumber = inBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
-    mStartOfFrameSampleNumber = inBitCenterSampleNumber ;
-    mMarkerTypeForDataAndCRC = AnalyzerResults::Dot ;
-  }
-}
-
-//----------------------------------------------------------------------------------------
-
-void CANFDMolinaroAnalyzer::handle_IDENTIFIER_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex <= 11) { // Standard identifier
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Dot);
-    mIdentifier <<= 1 ;
-    mIdentifier |= inBit ;
-  }else if (mFieldBitIndex == 12) { // RTR or SRR bit
-    mFrameType = inBit ? FrameType::remote : FrameType::canData  ;
-  }else if (mFieldBitIndex == 13) { // IDE bit
-    mFrameFormat = inBit ? FrameFormat::extended : FrameFormat::base ;
-    if (!inBit) { // IDE dominant -> base frame
-    //--- RTR mark
-      addMark (inBitCenterSampleNumber - mCurrentSamplesPerBit,
-               inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
-    //--- IDE Mark
-      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
-    //--- Bubble
-      addBubble (STANDARD_IDENTIFIER_FIELD_RESULT,
-                 mIdentifier,
-                 mFrameType == FrameType::canData, // 0 -> remote, 1 -> data
-                 inBitCenterSampleNumber - mCurrentSamplesPerBit) ;
-      mFieldBitIndex = 0 ;
-      mFrameFieldEngineState = FrameFieldEngineState::CONTROL_BASE ;
-    }else{ // IDE recessive -> extended frame
-    //--- SRR mark
-      addMark (inBitCenterSampleNumber - mCurrentSamplesPerBit, inBit ? AnalyzerResults::One : AnalyzerResults::ErrorSquare) ;
-    //--- IDE Mark
-      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
-    }
-  }else if (mFieldBitIndex < 32) { // ID17 ... ID0
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Dot);
-    mIdentifier <<= 1 ;
-    mIdentifier |= inBit ;
-  }else{ // RTR
-    mFrameType = inBit ? FrameType::remote : FrameType::canData ;
-    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
-  //--- Bubble
-    addBubble (EXTENDED_IDENTIFIER_FIELD_RESULT,
-               mIdentifier,
-               mFrameType == FrameType::canData, // 0 -> remote, 1 -> data
-               inBitCenterSampleNumber) ;
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_EXTENDED ;
-  }
-}
-
-//----------------------------------------------------------------------------------------
-
-
-void CANFDMolinaroAnalyzer::handle_CONTROL_BASE_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 1) { // FDF bit
-    if (inBit) { // FDF recessive -> CANFD frame
-      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
-      mFrameType = FrameType::canfdData ;
-    }else{
-      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
-      mFieldBitIndex = 0 ;
-      mDataCodeLength = 0 ;
-      mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
-    }
-  }else if (inBit) { // R0 bit recessive -> error
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }else{ // R0 dominant: ok
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Zero) ;
-    mDataCodeLength = 0 ;
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
+U64 CANFDMolinaroAnalyzer::counterValue (const CANFDMolinaroDecoderCounters::Counter inCounter) const {
+  U64 result = mCounters.value (inCounter) ;
+  for (U32 bus = 0 ; bus < mBusCount ; bus++) {
+    result += mBusDecoders [bus].counters ().value (inCounter) ;
   }
+  return result ;
 }
 
+//----------------------------------------------------------------------------------------
+//  The analyzer never returns from WorkerThread: wall time is updated each time decoding
+//  has caught up with the capture data.
 //----------------------------------------------------------------------------------------
 
-
-void CANFDMolinaroAnalyzer::handle_CONTROL_EXTENDED_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 1) { // FDF bit
-    if (inBit) { // FDF recessive -> CANFD frame
-      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
-      mFrameType = FrameType::canfdData ;
-    }else{
-      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
-    }
-  }else if (inBit) { // R0 bit recessive -> error
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }else{ // R0 dominant: ok
-    addMark (inBitCenterSampleNumber, AnalyzerResults::Zero) ;
-    mDataCodeLength = 0 ;
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
-  }
-}
-
-//----------------------------------------------------------------------------------------
-
-void CANFDMolinaroAnalyzer::handle_CONTROL_AFTER_R0_state (const bool inBit,
-                                                           U64 & ioBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  mFieldBitIndex ++ ;
-  if (mFrameType == FrameType::canfdData) {
-    if (mFieldBitIndex == 1) { // BRS
-      mBRS = inBit ;
-      if (inBit) { // Switch to data bit rate
-        const U64 samplesForDataBitRate = mSampleRateHz / mSettings->dataBitRate () ;
-        const U64 BSRsamplesX100 =
-          mSettings->arbitrationSamplePoint () * mCurrentSamplesPerBit
-        +
-          (100 - mSettings->dataSamplePoint ()) * samplesForDataBitRate
-        ;
-        const U64 centerBSR = ioBitCenterSampleNumber - mCurrentSamplesPerBit / 2 + BSRsamplesX100 / 200 ;
-        addMark (centerBSR, AnalyzerResults::UpArrow) ;
-      //--- Adjust for center of next bit
-        ioBitCenterSampleNumber -= mCurrentSamplesPerBit / 2 ; // Returns at the beginning of BRS bit
-        ioBitCenterSampleNumber += BSRsamplesX100 / 100 ; // Advance at the beginning of next bit
-        ioBitCenterSampleNumber -= samplesForDataBitRate / 2 ; // Back half of a data bit rate bit
-      //--- Switch to Data Bit Rate
-        mCurrentSamplesPerBit = samplesForDataBitRate ;
-        mMarkerTypeForDataAndCRC = AnalyzerResults::Square ;
-      }else{
-        addMark (ioBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
-      }
-    }else if (mFieldBitIndex == 2) { // ESI
-      addMark (ioBitCenterSampleNumber, inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
-      mESI = inBit ;
-    }else{
-      addMark (ioBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
-      mDataCodeLength <<= 1 ;
-      mDataCodeLength |= inBit ;
-      if (mFieldBitIndex == 6) {
-        const U32 data2 = U32 (mBRS) | (U32 (mESI) << 1) ;
-        addBubble (CANFD_CONTROL_FIELD_RESULT, mDataCodeLength, data2, ioBitCenterSampleNumber) ;
-        mFieldBitIndex = 0 ;
-        if (mDataCodeLength != 0) {
-          mFrameFieldEngineState = FrameFieldEngineState::DATA ;
-        }else if (mSettings->protocol () == CANFD_NON_ISO_PROTOCOL) { // No Data, CANFD non ISO
-          mCRC17 = mCRC17Accumulator ;
-          mUnstuffingActive = false ;
-          mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
-        }else{  // No Data, CANFD ISO
-          mUnstuffingActive = false ;
-          mFrameFieldEngineState = FrameFieldEngineState::SBC ;
-        }
-      }
-    }
-  }else{ // Base frame
-    addMark (ioBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-    mDataCodeLength <<= 1 ;
-    mDataCodeLength |= inBit ;
-    if (mFieldBitIndex == 4) {
-      addBubble (CAN20B_CONTROL_FIELD_RESULT, mDataCodeLength, 0, ioBitCenterSampleNumber) ;
-      mFieldBitIndex = 0 ;
-      if ((mDataCodeLength > 8) && (mFrameType != FrameType::canfdData)) {
-        mDataCodeLength = 8 ;
-      }
-      mCRC15 = mCRC15Accumulator ;
-      if (mFrameType == FrameType::remote) {
-        mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
-      }else if (mDataCodeLength > 0) {
-        mFrameFieldEngineState = FrameFieldEngineState::DATA ;
-      }else if (mFrameType == FrameType::canData) {
-        mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
-      }
-    }
-  }
+void CANFDMolinaroAnalyzer::updateWallTime (void) {
+  const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - mWorkerThreadStartTime ;
+  mCounters.set (CANFDMolinaroDecoderCounters::WALL_TIME_US,
+                 U64 (std::chrono::duration_cast <std::chrono::microseconds> (elapsed).count ())) ;
 }
 
+//----------------------------------------------------------------------------------------
+//  A single summary row is added per run, the first time decoding catches up with the
+//  capture data after edges were read: for a recorded capture, when decoding ends. A live
+//  capture catches up again between frames; later counter values are read by the
+//  decoder counters export.
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-  mData [mFieldBitIndex / 8] <<= 1 ;
-  mData [mFieldBitIndex / 8] |= inBit ;
-  mFieldBitIndex += 1 ;
-  if ((mFieldBitIndex % 8) == 0) {
-    const U32 dataIndex = (mFieldBitIndex - 1) / 8 ;
-    addBubble (DATA_FIELD_RESULT, mData [dataIndex], dataIndex, inBitCenterSampleNumber) ;
-  }
-  if (mFieldBitIndex == (8 * CANFD_LENGTH [mDataCodeLength])) {
-    mFieldBitIndex = 0 ;
-    if (mFrameType != FrameType::canfdData) {
-      mCRC15 = mCRC15Accumulator ;
-      mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
-    }else if (mSettings->protocol () == CANFD_ISO_PROTOCOL) {
-      mFrameFieldEngineState = FrameFieldEngineState::SBC ;
-      mUnstuffingActive = false ;
-    }else if (mDataCodeLength <= 10) {
-      mCRC17 = mCRC17Accumulator ;
-      mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
-      mUnstuffingActive = false ;
-    }else{
-      mCRC21 = mCRC21Accumulator ;
-      mFrameFieldEngineState = FrameFieldEngineState::CRC21 ;
-      mUnstuffingActive = false ;
+void CANFDMolinaroAnalyzer::emitCountersSummary (const U64 inSampleNumber) {
+  if (!mSummaryDone && (mCounters.value (CANFDMolinaroDecoderCounters::EDGES) > 0)) {
+    mSummaryDone = true ;
+    FrameV2 frameV2 ;
+    for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+      const CANFDMolinaroDecoderCounters::Counter counter = CANFDMolinaroDecoderCounters::Counter (i) ;
+      frameV2.AddInteger (CANFDMolinaroDecoderCounters::name (counter), S64 (counterValue (counter))) ;
     }
+    addFrameV2 (frameV2, "Counters", inSampleNumber, inSampleNumber) ;
+    commitResults () ;
   }
 }
 
+
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_CRC15_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  enterBitInCRC15 (inBit) ;
-  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-  mFieldBitIndex += 1 ;
-  if (mFieldBitIndex == 15) {
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
-    addBubble (CRC15_FIELD_RESULT, mCRC15, mCRC15Accumulator, inBitCenterSampleNumber) ;
-    if (mCRC15Accumulator != 0) {
-      mFrameFieldEngineState = DECODER_ERROR ;
+U32 CANFDMolinaroAnalyzer::GenerateSimulationData (U64 minimum_sample_index,
+                                                 U32 device_sample_rate,
+                                                 SimulationChannelDescriptor** simulation_channels ) {
+  const U32 busCount = mSettings->busCount () ;
+  if (mSimulationInitialized == false) {
+    const U32 simulationSampleRate = GetSimulationSampleRate () ;
+    for (U32 bus = 0 ; bus < busCount ; bus++) {
+      Channel busChannel = mSettings->busChannel (bus) ;
+      SimulationChannelDescriptor * channel = mSimulationChannels.Add (busChannel, simulationSampleRate, BIT_HIGH) ;
+      SimulationChannelDescriptor * txdChannel = nullptr ;
+      Channel txd = mSettings->txdChannel () ;
+      if ((bus == 0) && (txd != UNDEFINED_CHANNEL)) {
+        txdChannel = mSimulationChannels.Add (txd, simulationSampleRate, BIT_HIGH) ;
+      }
+      mSimulationDataGenerators [bus].Initialize (simulationSampleRate, mSettings.get(), bus, channel, txdChannel) ;
     }
+    mSimulationInitialized = true;
   }
+  for (U32 bus = 0 ; bus < busCount ; bus++) {
+    mSimulationDataGenerators [bus].GenerateSimulationData (minimum_sample_index, device_sample_rate) ;
+  }
+  *simulation_channels = mSimulationChannels.GetArray () ;
+  return mSimulationChannels.GetCount () ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_SBC_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  mFieldBitIndex += 1 ;
-  if (mFieldBitIndex == 1) { // Forced Stuff Bit
-    mSBCField = 0 ;
-    if (inBit == mPreviousBit) {
-      addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-      enterInErrorMode (inBitCenterSampleNumber) ;
-    }else{
-      addMark (inBitCenterSampleNumber, AnalyzerResults::X);
-    }
-  }else if (mFieldBitIndex <= 4) {
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
-    mSBCField <<= 1 ;
-    mSBCField |= inBit ;
-    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-  }else{ // Parity bit
-    enterBitInCRC17 (inBit) ;
-    enterBitInCRC21 (inBit) ;
-    const U8 GRAY_CODE_DECODER [8] = {0, 1, 3, 2, 7, 6, 4, 5} ;
-    const U8 suffBitCountMod8 = GRAY_CODE_DECODER [mSBCField] ;
-    mSBCField <<= 1 ;
-    mSBCField |= inBit ;
-  //--- Check parity
-    bool oneBitCountIsEven = true ;
-    U32 v = mSBCField ;
-    while (v > 0) {
-      oneBitCountIsEven ^= (v & 1) != 0 ;
-      v >>= 1 ;
-    }
-    addMark (inBitCenterSampleNumber, oneBitCountIsEven ? AnalyzerResults::Dot : AnalyzerResults::ErrorX) ;
-    const U32 data2 = ((mStuffBitCount % 8) << 1) | !oneBitCountIsEven ;
-    addBubble (SBC_FIELD_RESULT, suffBitCountMod8, data2, inBitCenterSampleNumber) ;
-    mUnstuffingActive = false ;
-    mFieldBitIndex = 0 ;
-    if (mDataCodeLength <= 10) {
-      mCRC17 = mCRC17Accumulator ;
-      mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
-    }else{
-      mCRC21 = mCRC21Accumulator ;
-      mFrameFieldEngineState = FrameFieldEngineState::CRC21 ;
-    }
+U32 CANFDMolinaroAnalyzer::GetMinimumSampleRateHz () {
+  U32 max = 0 ;
+  for (U32 bus = 0 ; bus < mSettings->busCount () ; bus++) {
+    const BusBitTiming timing = mSettings->busBitTiming (bus) ;
+    max = std::max (max, std::max (timing.mArbitrationBitRate, timing.mDataBitRate)) ;
   }
+  return max * 12 ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_CRC17_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  if ((mFieldBitIndex % 5) != 0) {
-    enterBitInCRC17 (inBit) ;
-    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-  }else if (inBit == mPreviousBit) {
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }else{
-    addMark (inBitCenterSampleNumber, AnalyzerResults::X);
-  }
-  mFieldBitIndex += 1 ;
-  if (mFieldBitIndex == 22) {
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
-    addBubble (CRC17_FIELD_RESULT, mCRC17, mCRC17Accumulator, inBitCenterSampleNumber) ;
-  }
+const char* CANFDMolinaroAnalyzer::GetAnalyzerName () const {
+  return "CANFD (Molinaro)";
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_CRC21_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  if ((mFieldBitIndex % 5) != 0) {
-    enterBitInCRC21 (inBit) ;
-    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
-  }else if (inBit == mPreviousBit) {
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }else{
-    addMark (inBitCenterSampleNumber, AnalyzerResults::X);
-  }
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 27) {
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
-    addBubble (CRC21_FIELD_RESULT, mCRC21, mCRC21Accumulator, inBitCenterSampleNumber) ;
-  }
+const char* GetAnalyzerName () {
+  return "CANFD (Molinaro)";
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_CRCDEL_state (const bool inBit, U64 & ioBitCenterSampleNumber) {
-  mUnstuffingActive = false ;
-  if (inBit) { // Handle Bit Rate Switch: data bit rate -> arbitration bit rate
-    const U32 samplesPerArbitrationBit = mSampleRateHz / mSettings->arbitrationBitRate () ;
-    const U64 CRCDELsamplesX100 =
-      mSettings->dataSamplePoint () * mCurrentSamplesPerBit
-    +
-      (100 - mSettings->arbitrationSamplePoint ()) * samplesPerArbitrationBit
-    ;
-    const U64 centerCRCDEL = ioBitCenterSampleNumber - mCurrentSamplesPerBit / 2 + CRCDELsamplesX100 / 200 ;
-    addMark (centerCRCDEL, AnalyzerResults::One) ;
-  //--- Adjust for center of next bit
-    ioBitCenterSampleNumber -= mCurrentSamplesPerBit / 2 ; // Returns at the beginning of CRCDEL bit
-    ioBitCenterSampleNumber += CRCDELsamplesX100 / 100 ; // Advance at the beginning of next bit
-    ioBitCenterSampleNumber -= samplesPerArbitrationBit / 2 ; // Back half of a arbitration bit rate bit
-  //--- Switch to Data Bit Rate
-    mCurrentSamplesPerBit = samplesPerArbitrationBit ;
-  }else{
-    addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-    enterInErrorMode (ioBitCenterSampleNumber) ;
-  }
-  mStartOfFieldSampleNumber = ioBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
-  mFrameFieldEngineState = FrameFieldEngineState::ACK ;
+Analyzer* CreateAnalyzer () {
+  return new CANFDMolinaroAnalyzer();
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_ACK_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 1) { // ACK SLOT
-    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::ErrorSquare : AnalyzerResults::DownArrow);
-    mAcked = inBit ;
-  }else{ // ACK DELIMITER
-    addBubble (ACK_FIELD_RESULT, mAcked, 0, inBitCenterSampleNumber) ;
-    mFrameFieldEngineState = FrameFieldEngineState::ENDOFFRAME ;
-    if (inBit) {
-      addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
-    }else{
-      addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
-      enterInErrorMode (inBitCenterSampleNumber) ;
-    }
-    mFieldBitIndex = 0 ;
-  }
+void DestroyAnalyzer (Analyzer* analyzer) {
+  delete analyzer;
 }
 
+//----------------------------------------------------------------------------------------
+//  DECODER OUTPUT: in single bus decoding, bus decoder 0 forwards markers and bubbles
+//  of accepted frames, and all frame events.
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_ENDOFFRAME_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  if (inBit) {
-    addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
-  }else{
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 7) {
-    addBubble (EOF_FIELD_RESULT, 0, 0, inBitCenterSampleNumber) ;
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::INTERMISSION ;
-  }
+void CANFDMolinaroAnalyzer::decoderMark (const U64 inBitCenterSampleNumber,
+                                         const AnalyzerResults::MarkerType inMarker) {
+  addMarker (inBitCenterSampleNumber, inMarker, mSettings->mInputChannel);
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_INTERMISSION_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  if (inBit) {
-    addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
-  }else{
-    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
-    enterInErrorMode (inBitCenterSampleNumber) ;
-  }
-  mFieldBitIndex ++ ;
-  if (mFieldBitIndex == 3) {
-    addBubble (INTERMISSION_FIELD_RESULT, 0, 0, inBitCenterSampleNumber) ;
-    mFieldBitIndex = 0 ;
-    mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
-  }
+void CANFDMolinaroAnalyzer::addMarker (const U64 inSampleNumber,
+                                       const AnalyzerResults::MarkerType inMarker,
+                                       Channel & inChannel) {
+  CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::ADD_MARKER) ;
+  mResults->AddMarker (inSampleNumber, inMarker, inChannel) ;
+  mCounters.increment (CANFDMolinaroDecoderCounters::MARKERS) ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::handle_DECODER_ERROR_state (const bool inBit, const U64 inBitCenterSampleNumber) {
-  mUnstuffingActive = false ;
-  addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot);
-  if (mPreviousBit != inBit) {
-    mConsecutiveBitCountOfSamePolarity = 1 ;
-    mPreviousBit = inBit ;
-  }else if (inBit) {
-    mConsecutiveBitCountOfSamePolarity += 1 ;
-    if (mConsecutiveBitCountOfSamePolarity == 11) {
-      addBubble (CAN_ERROR_RESULT, 0, 0, inBitCenterSampleNumber) ;
-      mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
-    }
-  }
+void CANFDMolinaroAnalyzer::addFrameV2 (const FrameV2 & inFrameV2,
+                                        const char * inType,
+                                        const U64 inStartSampleNumber,
+                                        const U64 inEndSampleNumber) {
+  CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::ADD_FRAMEV2) ;
+  mResults->AddFrameV2 (inFrameV2, inType, inStartSampleNumber, inEndSampleNumber) ;
+  mCounters.increment (CANFDMolinaroDecoderCounters::FRAMEV2_RESULTS) ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::enterBitInCRC15 (const bool inBit) {
-  const bool bit14 = (mCRC15Accumulator & (1 << 14)) != 0 ;
-  const bool crc_nxt = inBit ^ bit14 ;
-  mCRC15Accumulator <<= 1 ;
-  mCRC15Accumulator &= 0x7FFF ;
-  if (crc_nxt) {
-    mCRC15Accumulator ^= 0x4599 ;
-  }
+void CANFDMolinaroAnalyzer::addFrame (const Frame & inFrame) {
+  CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::ADD_FRAME) ;
+  mResults->AddFrame (inFrame) ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::enterBitInCRC17 (const bool inBit) {
-  const bool bit16 = (mCRC17Accumulator & (1 << 16)) != 0 ;
-  const bool crc_nxt = inBit ^ bit16 ;
-  mCRC17Accumulator <<= 1 ;
-  mCRC17Accumulator &= 0x1FFFF ;
-  if (crc_nxt) {
-    mCRC17Accumulator ^= 0x1685B ;
-  }
+void CANFDMolinaroAnalyzer::commitResults (void) {
+  CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::COMMIT_RESULTS) ;
+  mResults->CommitResults () ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::enterBitInCRC21 (const bool inBit) {
-  const bool bit20 = (mCRC21Accumulator & (1 << 20)) != 0 ;
-  const bool crc_nxt = inBit ^ bit20 ;
-  mCRC21Accumulator <<= 1 ;
-  mCRC21Accumulator &= 0x1FFFFF ;
-  if (crc_nxt) {
-    mCRC21Accumulator ^= 0x102899 ;
-  }
+void CANFDMolinaroAnalyzer::reportProgress (const U64 inSampleNumber) {
+  CANFDMolinaroPhaseTrace::Span span (mTrace, CANFDMolinaroPhaseTrace::REPORT_PROGRESS) ;
+  ReportProgress (inSampleNumber) ;
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::addMark (const U64 inBitCenterSampleNumber,
-                                     const AnalyzerResults::MarkerType inMarker) {
-  mResults->AddMarker (inBitCenterSampleNumber, inMarker, mSettings->mInputChannel);
+void CANFDMolinaroAnalyzer::decoderBubble (const U8 inBubbleType,
+                                           const U64 inData1,
+                                           const U64 inData2,
+                                           const U64 inStartSampleNumber,
+                                           const U64 inEndSampleNumber) {
+  if (mDecodingMode == DecodingMode::BIT_ARCHIVE_DECODING_MODE) { // Field bubbles are rebuilt from bit archive
+    reportProgress (inEndSampleNumber) ;
+    return ;
+  }else if (mDecodingMode == DecodingMode::LIVE_DECODING_MODE) { // Progress is reported by emitLiveFrame
+    return ;
+  }
+  emitBubble (inBubbleType, inData1, inData2, inStartSampleNumber, inEndSampleNumber, 0) ;
+}
+
+//----------------------------------------------------------------------------------------
+void CANFDMolinaroAnalyzer::emitBubble (const U8 inBubbleType,
+                                        const U64 inData1,
+                                        const U64 inData2,
+                                        const U64 inStartSampleNumber,
+                                        const U64 inEndSampleNumber,
+                                        const U32 inBus) {
+  if (mResultOutput != ResultOutput::FRAMEV2_RESULTS_ONLY) {
+    Frame frame ;
+    frame.mType = inBubbleType ;
+    frame.mFlags = U8 (inBus) & FRAME_BUS_MASK ;
+    frame.mData1 = inData1 ;
+    frame.mData2 = inData2 ;
+    frame.mStartingSampleInclusive = inStartSampleNumber ;
+    frame.mEndingSampleInclusive = inEndSampleNumber ;
+    addFrame (frame) ;
+  }
+  if (mResultOutput != ResultOutput::LEGACY_RESULTS_ONLY) {
+    emitFieldFrameV2 (inBubbleType, inData1, inData2, inStartSampleNumber, inEndSampleNumber, inBus) ;
+  }
+  commitResults () ;
+  if (mBusCount == 1) { // Multi-bus decoding reports progress by window
+    reportProgress (inEndSampleNumber) ;
+  }
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::addBubble (const U8 inBubbleType,
-                                       const U64 inData1,
-                                       const U64 inData2,
-                                       const U64 inBitCenterSampleNumber) {
-  Frame frame ;
-  frame.mType = inBubbleType ;
-  frame.mFlags = 0 ;
-  frame.mData1 = inData1 ;
-  frame.mData2 = inData2 ;
-  frame.mStartingSampleInclusive = mStartOfFieldSampleNumber ;
-  const U64 endSampleNumber = inBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
-  frame.mEndingSampleInclusive = endSampleNumber ;
-  mResults->AddFrame (frame) ;
-
+void CANFDMolinaroAnalyzer::emitFieldFrameV2 (const U8 inBubbleType,
+                                              const U64 inData1,
+                                              const U64 inData2,
+                                              const U64 inStartSampleNumber,
+                                              const U64 inEndSampleNumber,
+                                              const U32 inBus) {
   FrameV2 frameV2 ;
+  if (mBusCount > 1) {
+    frameV2.AddInteger ("Bus", inBus + 1) ;
+  }
   switch (inBubbleType) {
   case STANDARD_IDENTIFIER_FIELD_RESULT :
     { const U8 idf [2] = { U8 (inData1 >> 8), U8 (inData1) } ;
       frameV2.AddByteArray ("Value", idf, 2) ;
-      mResults->AddFrameV2 (frameV2, "Std Idf", mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, "Std Idf", inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case EXTENDED_IDENTIFIER_FIELD_RESULT :
@@ -720,12 +633,12 @@ void CANFDMolinaroAnalyzer::addBubble (const U8 inBubbleType,
         U8 (inData1 >> 24), U8 (inData1 >> 16), U8 (inData1 >> 8), U8 (inData1)
       } ;
       frameV2.AddByteArray ("Value", idf, 4) ;
-      mResults->AddFrameV2 (frameV2, "Ext Idf", mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, "Ext Idf", inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case CAN20B_CONTROL_FIELD_RESULT :
     frameV2.AddByte ("Value", inData1) ;
-    mResults->AddFrameV2 (frameV2, "Ctrl", mStartOfFieldSampleNumber, endSampleNumber) ;
+    addFrameV2 (frameV2, "Ctrl", inStartSampleNumber, inEndSampleNumber) ;
     break ;
   case CANFD_CONTROL_FIELD_RESULT :
     { frameV2.AddByte ("Value", inData1) ;
@@ -738,61 +651,294 @@ void CANFDMolinaroAnalyzer::addBubble (const U8 inBubbleType,
         str << ", ESI" ;
       }
       str << ")" ;
-      mResults->AddFrameV2 (frameV2, str.str ().c_str (), mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, str.str ().c_str (), inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case DATA_FIELD_RESULT :
     { frameV2.AddByte ("Value", inData1) ;
       std::stringstream str ;
       str << "D" << inData2 ;
-      mResults->AddFrameV2 (frameV2, str.str ().c_str (), mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, str.str ().c_str (), inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case CRC15_FIELD_RESULT :
     { const U8 crc [2] = { U8 (inData1 >> 8), U8 (inData1) } ;
       frameV2.AddByteArray ("Value", crc, 2) ;
-      mResults->AddFrameV2 (frameV2, "CRC15", mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, "CRC15", inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case CRC17_FIELD_RESULT :
     { const U8 crc [3] = { U8 (inData1 >> 16), U8 (inData1 >> 8), U8 (inData1) } ;
       frameV2.AddByteArray ("Value", crc, 3) ;
-      mResults->AddFrameV2 (frameV2, "CRC17", mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, "CRC17", inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case CRC21_FIELD_RESULT :
     { const U8 crc [3] = { U8 (inData1 >> 16), U8 (inData1 >> 8), U8 (inData1) } ;
       frameV2.AddByteArray ("Value", crc, 3) ;
-      mResults->AddFrameV2 (frameV2, "CRC21", mStartOfFieldSampleNumber, endSampleNumber) ;
+      addFrameV2 (frameV2, "CRC21", inStartSampleNumber, inEndSampleNumber) ;
+    }
+    break ;
+  case CANXL_CONTROL_FIELD_RESULT :
+    frameV2.AddInteger ("DLC", inData1) ;
+    frameV2.AddByte ("SDT", U8 (inData2)) ;
+    frameV2.AddBoolean ("SEC", (inData2 & 0x100) != 0) ;
+    addFrameV2 (frameV2, "XL Ctrl", inStartSampleNumber, inEndSampleNumber) ;
+    break ;
+  case PCRC_FIELD_RESULT :
+    { const U8 crc [2] = { U8 (inData1 >> 8), U8 (inData1) } ;
+      frameV2.AddByteArray ("Value", crc, 2) ;
+      addFrameV2 (frameV2, "PCRC", inStartSampleNumber, inEndSampleNumber) ;
+    }
+    break ;
+  case CANXL_ACCEPTANCE_FIELD_RESULT :
+    { const U8 af [4] = {
+        U8 (inData1 >> 24), U8 (inData1 >> 16), U8 (inData1 >> 8), U8 (inData1)
+      } ;
+      frameV2.AddByte ("VCID", U8 (inData2)) ;
+      frameV2.AddByteArray ("AF", af, 4) ;
+      addFrameV2 (frameV2, "AF", inStartSampleNumber, inEndSampleNumber) ;
+    }
+    break ;
+  case CANXL_DATA_FIELD_RESULT : // Whole payload is in the frame row
+    { U8 head [8] ;
+      const U32 headLength = std::min (U32 (inData1), U32 (8)) ;
+      for (U32 i=0 ; i<headLength ; i++) {
+        head [i] = U8 (inData2 >> (56 - 8 * i)) ;
+      }
+      frameV2.AddInteger ("Length", inData1) ;
+      frameV2.AddByteArray ("Head", head, headLength) ;
+      addFrameV2 (frameV2, "XL Data", inStartSampleNumber, inEndSampleNumber) ;
+    }
+    break ;
+  case FCRC_FIELD_RESULT :
+    { const U8 crc [4] = {
+        U8 (inData1 >> 24), U8 (inData1 >> 16), U8 (inData1 >> 8), U8 (inData1)
+      } ;
+      frameV2.AddByteArray ("Value", crc, 4) ;
+      addFrameV2 (frameV2, "FCRC", inStartSampleNumber, inEndSampleNumber) ;
     }
     break ;
   case ACK_FIELD_RESULT :
-    mResults->AddFrameV2 (frameV2, "ACK", mStartOfFieldSampleNumber, endSampleNumber) ;
+    addFrameV2 (frameV2, "ACK", inStartSampleNumber, inEndSampleNumber) ;
     break ;
   case EOF_FIELD_RESULT :
-    mResults->AddFrameV2 (frameV2, "EOF", mStartOfFieldSampleNumber, endSampleNumber) ;
+    addFrameV2 (frameV2, "EOF", inStartSampleNumber, inEndSampleNumber) ;
     break ;
   case INTERMISSION_FIELD_RESULT :
-    mResults->AddFrameV2 (frameV2, "IFS", mStartOfFieldSampleNumber, endSampleNumber) ;
+    addFrameV2 (frameV2, "IFS", inStartSampleNumber, inEndSampleNumber) ;
     break ;
   case CAN_ERROR_RESULT :
-    mResults->AddFrameV2 (frameV2, "Error", mStartOfFieldSampleNumber, endSampleNumber) ;
+    addFrameV2 (frameV2, "Error", inStartSampleNumber, inEndSampleNumber) ;
     break ;
   }
+}
 
-  mResults->CommitResults () ;
-  ReportProgress (frame.mEndingSampleInclusive) ;
-//--- Prepare for next bubble
-  mStartOfFieldSampleNumber = endSampleNumber ;
+//----------------------------------------------------------------------------------------
+//  Legacy result of a whole frame (live mode, and field mode with FrameV2 field results
+//  only): its text is built from the frame store.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::emitFrameResult (const U32 inIdentifier,
+                                             const U32 inStoreIndex,
+                                             const U8 inFlags,
+                                             const U64 inStartSampleNumber,
+                                             const U64 inEndSampleNumber) {
+  Frame frame ;
+  frame.mType = LIVE_FRAME_RESULT ;
+  frame.mFlags = inFlags ;
+  frame.mData1 = inIdentifier ;
+  frame.mData2 = inStoreIndex ;
+  frame.mStartingSampleInclusive = inStartSampleNumber ;
+  frame.mEndingSampleInclusive = inEndSampleNumber ;
+  addFrame (frame) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::frameError (void) {
+  mFrameHasError = true ;
+  mTransceiverMonitor.frameError () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::startOfFrame (const CANFDMolinaroFrameDecoder & /* inDecoder */,
+                                          const U64 /* inSampleNumber */) {
+  mFrameHasError = false ;
+  mFrameStoreIndex = 0 ;
+  mTransceiverMonitor.startOfFrame ((mTxd == nullptr) || mTxBit) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::frameHeaderDecoded (const CANFDMolinaroFrameDecoder & /* inDecoder */,
+                                                const bool inFDF) {
+  mTransceiverMonitor.endOfArbitration () ;
+  mLoopDelayPending = inFDF && mTransceiverMonitor.isMeasuringLoopDelay () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::frameReceived (const CANFDMolinaroFrameDecoder & inDecoder,
+                                           const U64 inEndSampleNumber) {
+  const bool accepted = !mBusDecoders [0].frameIsRejected () ;
+//--- Frame store
+  if (accepted) {
+    const U8 flags = CANFDMolinaroBusDecoder::frameFlags (inDecoder) ;
+    std::lock_guard <std::mutex> lock (mFrameStore.mutex ()) ;
+    mFrameStore.append (inDecoder.startOfFrameSampleNumber (), inEndSampleNumber,
+                        inDecoder.identifier (), flags, U16 (inDecoder.dataCodeLength ()), inDecoder.data (), 0) ;
+    mFrameStoreIndex = mFrameStore.size () ;
+  }
+  if (!inDecoder.crcIsValid ()) {
+    mFrameHasError = true ;
+  }
+//--- DBC signals
+  const bool decodeSignals = inDecoder.crcIsValid ()
+    && accepted
+    && !inDecoder.isRemote ()
+    && !mSignalDatabase.isEmpty () ;
+  if (decodeSignals) {
+    emitSignals (inDecoder.identifier (),
+                 inDecoder.isExtended (),
+                 inDecoder.data (),
+                 inDecoder.dataLength (),
+                 inDecoder.startOfFrameSampleNumber (),
+                 inEndSampleNumber,
+                 0) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::emitSignals (const U32 inIdentifier,
+                                         const bool inExtended,
+                                         const U8 * inData,
+                                         const U32 inDataLength,
+                                         const U64 inStartSampleNumber,
+                                         const U64 inEndSampleNumber,
+                                         const U32 inBus) {
+  std::string messageName ;
+  const bool found = mSignalDatabase.decode (inIdentifier,
+                                             inExtended,
+                                             inData,
+                                             inDataLength,
+                                             mSignalValues,
+                                             messageName) ;
+  if (found) {
+    FrameV2 frameV2 ;
+    if (mBusCount > 1) {
+      frameV2.AddInteger ("Bus", inBus + 1) ;
+    }
+    frameV2.AddString ("Message", messageName.c_str ()) ;
+    for (const CANFDMolinaroSignalDatabase::SignalValue & signal : mSignalValues) {
+      frameV2.AddDouble (mSignalDatabase.signalName (signal.mSignalIndex).c_str (), signal.mValue) ;
+    }
+    addFrameV2 (frameV2, "Signals", inStartSampleNumber, inEndSampleNumber) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) {
+  if (mDecodingMode == DecodingMode::BIT_ARCHIVE_DECODING_MODE) {
+    std::lock_guard <std::mutex> lock (mBitArchive.mutex ()) ;
+    mBitArchive.bitRateSwitch (inSampleNumber, inDataBitRate) ;
+  }
 }
 
 //----------------------------------------------------------------------------------------
 
-void CANFDMolinaroAnalyzer::enterInErrorMode (const U64 inBitCenterSampleNumber) {
-  mStartOfFieldSampleNumber = inBitCenterSampleNumber ;
-  mCurrentSamplesPerBit = mSampleRateHz / mSettings->arbitrationBitRate () ;
-  mFrameFieldEngineState = DECODER_ERROR ;
-  mUnstuffingActive = false ;
+void CANFDMolinaroAnalyzer::endOfFrame (const U64 inEndSampleNumber) {
+  mTrace.frameDone () ;
+  const bool rejected = mBusDecoders [0].frameIsRejected () ;
+  if (mTransceiverMonitor.transmitted () && !rejected) {
+    emitTransmission (inEndSampleNumber) ;
+  }
+  switch (mDecodingMode) {
+  case DecodingMode::FIELD_DECODING_MODE :
+    if (rejected) { // No bubble of rejected frame reports progress
+      reportProgress (inEndSampleNumber) ;
+    }else if (mResultOutput == ResultOutput::FRAMEV2_RESULTS_ONLY) {
+      emitFrameResult (mDecoder.identifier (), mFrameStoreIndex, mFrameHasError ? DISPLAY_AS_ERROR_FLAG : 0,
+                       mDecoder.startOfFrameSampleNumber (), inEndSampleNumber) ;
+      commitResults () ;
+    }
+    break ;
+  case DecodingMode::BIT_ARCHIVE_DECODING_MODE :
+    emitArchivedFrame (inEndSampleNumber) ;
+    break ;
+  case DecodingMode::LIVE_DECODING_MODE :
+    emitLiveFrame (inEndSampleNumber) ;
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  In bit archive mode, a frame is reported by a single result, whose fields are
+//  rebuilt from its bits when text is generated.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::emitArchivedFrame (const U64 inEndSampleNumber) {
+  std::unique_lock <std::mutex> lock (mBitArchive.mutex ()) ;
+  if (mBitArchive.frameCount () > 0) {
+    const U32 archiveIndex = mBitArchive.frameCount () - 1 ;
+    const U64 startSampleNumber = mBitArchive.frame (archiveIndex).mStartSampleNumber ;
+    if (mBusDecoders [0].frameIsRejected ()) {
+      mBitArchive.truncate (startSampleNumber) ;
+      lock.unlock () ;
+      reportProgress (inEndSampleNumber) ;
+    }else{
+      lock.unlock () ;
+      Frame frame ;
+      frame.mType = ARCHIVED_FRAME_RESULT ;
+      frame.mFlags = mFrameHasError ? DISPLAY_AS_ERROR_FLAG : 0 ;
+      frame.mData1 = archiveIndex ;
+      frame.mData2 = mDecoder.identifier () ;
+      frame.mStartingSampleInclusive = startSampleNumber ;
+      frame.mEndingSampleInclusive = inEndSampleNumber ;
+      addFrame (frame) ;
+
+      FrameV2 frameV2 ;
+      frameV2.AddInteger ("Identifier", mDecoder.identifier ()) ;
+      frameV2.AddBoolean ("Extended", mDecoder.isExtended ()) ;
+      frameV2.AddBoolean ("Error", mFrameHasError) ;
+      addFrameV2 (frameV2, "Frame", startSampleNumber, inEndSampleNumber) ;
+
+      commitResults () ;
+      reportProgress (inEndSampleNumber) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  In live mode, a frame is reported by a single result, and results are committed
+//  once, when the frame ends.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzer::emitLiveFrame (const U64 inEndSampleNumber) {
+  if (!mBusDecoders [0].frameIsRejected ()) {
+    const U64 startSampleNumber = mDecoder.startOfFrameSampleNumber () ;
+    emitFrameResult (mDecoder.identifier (), mFrameStoreIndex, mFrameHasError ? DISPLAY_AS_ERROR_FLAG : 0,
+                     startSampleNumber, inEndSampleNumber) ;
+
+    FrameV2 frameV2 ;
+    frameV2.AddInteger ("Identifier", mDecoder.identifier ()) ;
+    frameV2.AddBoolean ("Extended", mDecoder.isExtended ()) ;
+    if (mFrameStoreIndex > 0) {
+      frameV2.AddByteArray ("Data", mDecoder.data (), mDecoder.dataLength ()) ;
+    }
+    frameV2.AddBoolean ("Error", mFrameHasError) ;
+//--- The decode lag is measured just before the commit that displays the frame
+    const double lag = mLiveLatency.record (inEndSampleNumber) ;
+    frameV2.AddDouble ("Lag (ms)", lag * 1.0e3) ;
+    addFrameV2 (frameV2, "Frame", startSampleNumber, inEndSampleNumber) ;
+
+    commitResults () ;
+  }
+  reportProgress (inEndSampleNumber) ;
+  mLiveLastReportTime = std::chrono::steady_clock::now () ;
 }
 
 //----------------------------------------------------------------------------------------
@@ -7,6 +7,18 @@
 #include <AnalyzerResults.h>
 #include "CANFDMolinaroAnalyzerResults.h"
 #include "CANFDMolinaroSimulationDataGenerator.h"
+#include "CANFDMolinaroSignalDatabase.h"
+#include "CANFDMolinaroFrameDecoder.h"
+#include "CANFDMolinaroFrameStore.h"
+#include "CANFDMolinaroBitArchive.h"
+#include "CANFDMolinaroLatencyMonitor.h"
+#include "CANFDMolinaroBusDecoder.h"
+#include "CANFDMolinaroWorkerPool.h"
+#include "CANFDMolinaroGatewayMonitor.h"
+#include "CANFDMolinaroTransceiverMonitor.h"
+#include "CANFDMolinaroPhaseTrace.h"
+#include <chrono>
+#include <vector>
 
 //----------------------------------------------------------------------------------------
 
@@ -15,7 +27,7 @@ class CANFDMolinaroAnalyzerSettings;
 //----------------------------------------------------------------------------------------
 
 
-class ANALYZER_EXPORT CANFDMolinaroAnalyzer : public Analyzer2 {
+class ANALYZER_EXPORT CANFDMolinaroAnalyzer : public Analyzer2, public CANFDMolinaroDecoderOutput {
 
   public: CANFDMolinaroAnalyzer();
 
@@ -34,83 +46,149 @@ class ANALYZER_EXPORT CANFDMolinaroAnalyzer : public Analyzer2 {
 
   public: virtual bool NeedsRerun () ;
 
+//--- Decoded frames (lock frameStore ().mutex () while reading)
+  public: CANFDMolinaroFrameStore & frameStore (void) { return mFrameStore ; }
+
+//--- Raw bit archive, filled in bit archive decoding mode (lock bitArchive ().mutex () while reading)
+  public: CANFDMolinaroBitArchive & bitArchive (void) { return mBitArchive ; }
+
+//--- Decode lag of live decoding mode commits
+  public: CANFDMolinaroLatencyMonitor & liveLatency (void) { return mLiveLatency ; }
+
+//--- Gateway latency statistics of multi-bus decoding (lock gatewayMonitor ().mutex () while reading)
+  public: CANFDMolinaroGatewayMonitor & gatewayMonitor (void) { return mGatewayMonitor ; }
+
+//--- Performance counters of the current run: analyzer counters, plus counters of the
+//    decoder (or of every bus decoder); may be called from any thread
+  public: U64 counterValue (const CANFDMolinaroDecoderCounters::Counter inCounter) const ;
+
 //--- Protected properties
   protected: std::shared_ptr < CANFDMolinaroAnalyzerSettings > mSettings;
   protected: std::shared_ptr < CANFDMolinaroAnalyzerResults > mResults;
   protected: // AnalyzerChannelData* mSerial;
 
-  protected: CANMolinaroSimulationDataGenerator mSimulationDataGenerator;
+  protected: CANMolinaroSimulationDataGenerator mSimulationDataGenerators [CANFD_MAX_BUS_COUNT] ;
+  protected: SimulationChannelDescriptorGroup mSimulationChannels ;
    protected: bool mSimulationInitialized ;
 
   protected: U32 mSampleRateHz;
 
 
-//---------------- CAN decoder
-  private: U64 mStartOfFieldSampleNumber ;
-  private: U64 mStartOfFrameSampleNumber ;
-  private: U32 mCurrentSamplesPerBit ;
-
-//--- CAN protocol
-  private: typedef enum  {
-    IDLE, IDENTIFIER, CONTROL_BASE, CONTROL_EXTENDED, CONTROL_AFTER_R0, DATA, SBC,
-    CRC15, CRC17, CRC21, CRCDEL, ACK, ENDOFFRAME, INTERMISSION, DECODER_ERROR
-  } FrameFieldEngineState ;
-
-  private: FrameFieldEngineState mFrameFieldEngineState ;
-  private: int mFieldBitIndex ;
-  private: int mConsecutiveBitCountOfSamePolarity ;
-  private: bool mPreviousBit ;
-  private: bool mUnstuffingActive ;
-
-//--- Received frame
-  private: uint32_t mIdentifier ;
-  private: U32 mSBCField ;
-  private: U32 mStuffBitCount ;
-  private: U32 mDataCodeLength ;
-  private: U8 mData [64] ;
-  private: U16 mCRC15Accumulator ;
-  private: U16 mCRC15 ;
-  private: U32 mCRC17Accumulator ;
-  private: U32 mCRC17 ;
-  private: U32 mCRC21Accumulator ;
-  private: U32 mCRC21 ;
-  private: typedef enum {base, extended} FrameFormat ;
-  private: FrameFormat mFrameFormat ;
-  private: typedef enum {canData, remote, canfdData} FrameType ;
-  private: FrameType mFrameType ;
-  private: bool mBRS ;
-  private: bool mESI ;
-  private: bool mAcked ;
-  private: AnalyzerResults::MarkerType mMarkerTypeForDataAndCRC ;
-
-//---------------- CAN decoder methods
-  private: void enterBit (const bool inBit, U64 & ioBitCenterSampleNumber) ;
-  private: void decodeFrameBit (const bool inBit, U64 & ioBitCenterSampleNumber) ;
-  private: void enterBitInCRC15 (const bool inBit) ;
-  private: void enterBitInCRC17 (const bool inBit) ;
-  private: void enterBitInCRC21 (const bool inBit) ;
-  private: void addMark (const U64 inBitCenterSampleNumber, const AnalyzerResults::MarkerType inMarker) ;
-  private: void addBubble (const U8 inBubbleType,
-                           const U64 inData1,
-                           const U64 inData2,
-                           const U64 inEndSampleNumber) ;
-  private: void enterInErrorMode (const U64 inBitCenterSampleNumber) ;
-
-  private: void handle_IDLE_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_IDENTIFIER_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CONTROL_BASE_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CONTROL_EXTENDED_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CONTROL_AFTER_R0_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
-  private: void handle_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_SBC_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CRC15_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CRC17_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CRC21_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_CRCDEL_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
-  private: void handle_ACK_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_ENDOFFRAME_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_INTERMISSION_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
-  private: void handle_DECODER_ERROR_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+//--- DBC signal decoding
+  private: CANFDMolinaroSignalDatabase mSignalDatabase ;
+  private: std::vector <CANFDMolinaroSignalDatabase::SignalValue> mSignalValues ;
+
+//--- Decoded frames; mFrameStoreIndex is the frame store index + 1 of the current
+//    frame (0 if not stored)
+  private: CANFDMolinaroFrameStore mFrameStore ;
+  private: U32 mFrameStoreIndex ;
+
+  private: DecodingMode mDecodingMode ;
+  private: ResultOutput mResultOutput ;
+  private: bool mFrameHasError ;
+
+//--- Bit archive decoding mode
+  private: CANFDMolinaroBitArchive mBitArchive ;
+
+//--- Live decoding mode: results are committed once per frame; while the bus is idle,
+//    progress is reported at most every LIVE_STALENESS_MS
+  private: CANFDMolinaroLatencyMonitor mLiveLatency ;
+  private: std::chrono::steady_clock::time_point mLiveLastReportTime ;
+  private: static const U32 LIVE_STALENESS_MS = 50 ;
+
+//--- Multi-bus decoding: the analyzer thread reads edge blocks of every bus channel (it
+//    is the only thread calling the SDK), the worker pool decodes them concurrently, and
+//    the analyzer thread merges the released results in time order
+  private: U32 mBusCount ;
+  private: CANFDMolinaroBusDecoder mBusDecoders [CANFD_MAX_BUS_COUNT] ;
+  private: std::vector <U64> mBusEdges [CANFD_MAX_BUS_COUNT] ;
+  private: CANFDMolinaroWorkerPool mWorkerPool ;
+  private: void multiBusWorkerThread (void) ;
+  private: void mergeBusResults (void) ;
+  private: void storeBusFrame (const CANFDMolinaroBusDecoder::FrameRecord & inRecord, const U32 inBus) ;
+
+//---------------- CAN decoder of single bus decoding: bus decoder 0 applies the
+//    acceptance filter, and forwards results and frame events to the analyzer
+  private: CANFDMolinaroFrameDecoder & mDecoder ;
+
+//--- Gateway latency measurement, fed with the merged frames of multi-bus decoding
+  private: CANFDMolinaroGatewayMonitor mGatewayMonitor ;
+  private: std::vector <CANFDMolinaroGatewayMonitor::Event> mGatewayEvents ;
+  private: void emitGatewayEvents (const U64 inStartSampleNumber, const U64 inEndSampleNumber) ;
+
+//--- Local node TXD (single bus decoding): mTxBit is the TXD level at current bit center
+  private: AnalyzerChannelData * mTxd ;
+  private: bool mTxBit ;
+  private: bool mLoopDelayPending ;
+  private: CANFDMolinaroTransceiverMonitor mTransceiverMonitor ;
+  private: void checkTransmittedBit (const bool inRxBit, const U64 inBitCenterSampleNumber) ;
+  private: void measureLoopDelay (const U64 inRxEdgeSampleNumber) ;
+  private: void emitTransmission (const U64 inEndSampleNumber) ;
+
+//--- Performance counters: edges, markers, FrameV2 results and wall time are counted by
+//    the analyzer. They are read by the decoder counters export, and a summary row is
+//    added once per run
+  private: CANFDMolinaroDecoderCounters mCounters ;
+  private: std::chrono::steady_clock::time_point mWorkerThreadStartTime ;
+  private: bool mSummaryDone ;
+  private: void updateWallTime (void) ;
+  private: void emitCountersSummary (const U64 inSampleNumber) ;
+
+//--- Phase trace (CANFD_TRACE builds): SDK result calls go through the helpers below
+  private: CANFDMolinaroPhaseTrace mTrace ;
+
+//---------------- Decoder output
+  public: virtual void decoderMark (const U64 inSampleNumber,
+                                    const AnalyzerResults::MarkerType inMarker) ;
+  public: virtual void decoderBubble (const U8 inBubbleType,
+                                      const U64 inData1,
+                                      const U64 inData2,
+                                      const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber) ;
+  public: virtual void startOfFrame (const CANFDMolinaroFrameDecoder & inDecoder,
+                                     const U64 inSampleNumber) ;
+  public: virtual void frameHeaderDecoded (const CANFDMolinaroFrameDecoder & inDecoder,
+                                           const bool inFDF) ;
+  public: virtual void frameReceived (const CANFDMolinaroFrameDecoder & inDecoder,
+                                      const U64 inEndSampleNumber) ;
+  public: virtual void frameError (void) ;
+  public: virtual void bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) ;
+  public: virtual void endOfFrame (const U64 inEndSampleNumber) ;
+
+  private: void addMarker (const U64 inSampleNumber, const AnalyzerResults::MarkerType inMarker, Channel & inChannel) ;
+  private: void addFrame (const Frame & inFrame) ;
+  private: void addFrameV2 (const FrameV2 & inFrameV2,
+                            const char * inType,
+                            const U64 inStartSampleNumber,
+                            const U64 inEndSampleNumber) ;
+  private: void commitResults (void) ;
+  private: void reportProgress (const U64 inSampleNumber) ;
+  private: void emitBubble (const U8 inBubbleType,
+                            const U64 inData1,
+                            const U64 inData2,
+                            const U64 inStartSampleNumber,
+                            const U64 inEndSampleNumber,
+                            const U32 inBus) ;
+  private: void emitFieldFrameV2 (const U8 inBubbleType,
+                                  const U64 inData1,
+                                  const U64 inData2,
+                                  const U64 inStartSampleNumber,
+                                  const U64 inEndSampleNumber,
+                                  const U32 inBus) ;
+  private: void emitFrameResult (const U32 inIdentifier,
+                                 const U32 inStoreIndex,
+                                 const U8 inFlags,
+                                 const U64 inStartSampleNumber,
+                                 const U64 inEndSampleNumber) ;
+  private: void emitSignals (const U32 inIdentifier,
+                             const bool inExtended,
+                             const U8 * inData,
+                             const U32 inDataLength,
+                             const U64 inStartSampleNumber,
+                             const U64 inEndSampleNumber,
+                             const U32 inBus) ;
+  private: void emitArchivedFrame (const U64 inEndSampleNumber) ;
+  private: void emitLiveFrame (const U64 inEndSampleNumber) ;
 } ;
 
 //----------------------------------------------------------------------------------------
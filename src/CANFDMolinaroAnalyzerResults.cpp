@@ -2,17 +2,23 @@
 #include <AnalyzerHelpers.h>
 #include "CANFDMolinaroAnalyzer.h"
 #include "CANFDMolinaroAnalyzerSettings.h"
+#include "CANFDMolinaroSignalDatabase.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
+//--- Payload bytes in frame text (CAN XL payload is up to 2048 bytes)
+static const U32 LIVE_FRAME_TEXT_MAX_LENGTH = 64 ;
+
 //----------------------------------------------------------------------------------------
 
 CANFDMolinaroAnalyzerResults::CANFDMolinaroAnalyzerResults (CANFDMolinaroAnalyzer* analyzer,
                                                             CANFDMolinaroAnalyzerSettings* settings ) :
 AnalyzerResults(),
 mSettings (settings),
-mAnalyzer (analyzer) {
+mAnalyzer (analyzer),
+mReplayDecoder () {
 }
 
 //----------------------------------------------------------------------------------------
@@ -130,6 +136,57 @@ void CANFDMolinaroAnalyzerResults::GenerateText (const Frame & inFrame,
       }
       ioText << "\n" ;
     } break ;
+  case CANXL_CONTROL_FIELD_RESULT :
+    if (!inBubbleText) {
+      ioText << "  " ;
+    }
+    snprintf (numberString, 128, "0x%02llX", inFrame.mData2 & 0xFF) ;
+    ioText << "Ctrl: " << inFrame.mData1 << " (XLF, SDT " << numberString ;
+    if ((inFrame.mData2 & 0x100) != 0) {
+      ioText << ", SEC" ;
+    }
+    ioText << ")\n" ;
+    break ;
+  case PCRC_FIELD_RESULT : // Data1: CRC, Data2: is 0 if CRC ok
+    if (!inBubbleText) {
+      ioText << "  " ;
+    }
+    snprintf (numberString, 128, "0x%04llX", inFrame.mData1) ;
+    ioText << "PCRC: " << numberString ;
+    if (inFrame.mData2 != 0) {
+      ioText << " (error)" ;
+    }
+    ioText << "\n" ;
+    break ;
+  case CANXL_ACCEPTANCE_FIELD_RESULT :
+    if (!inBubbleText) {
+      ioText << "  " ;
+    }
+    snprintf (numberString, 128, "VCID: 0x%02llX, AF: 0x%08llX", inFrame.mData2, inFrame.mData1) ;
+    ioText << numberString << "\n" ;
+    break ;
+  case CANXL_DATA_FIELD_RESULT :
+    if (!inBubbleText) {
+      ioText << "  " ;
+    }
+    ioText << "Data [" << inFrame.mData1 << "]:" ;
+    for (U32 i = 0 ; i < std::min (U32 (inFrame.mData1), U32 (8)) ; i++) {
+      snprintf (numberString, 128, " %02llX", (inFrame.mData2 >> (56 - 8 * i)) & 0xFF) ;
+      ioText << numberString ;
+    }
+    ioText << ((inFrame.mData1 > 8) ? " ...\n" : "\n") ;
+    break ;
+  case FCRC_FIELD_RESULT : // Data1: CRC, Data2: is 0 if CRC ok
+    if (!inBubbleText) {
+      ioText << "  " ;
+    }
+    snprintf (numberString, 128, "0x%08llX", inFrame.mData1) ;
+    ioText << "FCRC: " << numberString ;
+    if (inFrame.mData2 != 0) {
+      ioText << " (error)" ;
+    }
+    ioText << "\n" ;
+    break ;
   case EOF_FIELD_RESULT :
     if (inBubbleText) {
       ioText << "EOF\n" ;
@@ -140,6 +197,70 @@ void CANFDMolinaroAnalyzerResults::GenerateText (const Frame & inFrame,
       ioText << "IFS\n" ;
     }
     break ;
+  case ARCHIVED_FRAME_RESULT :
+    { std::vector <Frame> fields ;
+      rebuildArchivedFrameFields (U32 (inFrame.mData1), fields) ;
+      bool first = true ;
+      for (const Frame & field : fields) {
+        std::stringstream fieldText ;
+        GenerateText (field, inDisplayBase, true, fieldText) ;
+        std::string str = fieldText.str () ;
+        while ((str.length () > 0) && (str.back () == '\n')) {
+          str.pop_back () ;
+        }
+        if (str.length () > 0) {
+          ioText << (first ? "" : " ") << str ;
+          first = false ;
+        }
+      }
+      ioText << "\n" ;
+    }
+    break ;
+  case LIVE_FRAME_RESULT :
+    { CANFDMolinaroFrameStore & store = mAnalyzer->frameStore () ;
+      std::lock_guard <std::mutex> lock (store.mutex ()) ;
+      const U32 storeIndex = U32 (inFrame.mData2) ;
+      if ((storeIndex == 0) || (storeIndex > store.size ())) { // Frame not received
+        ioText << "Error\n" ;
+      }else{
+        const U32 idx = storeIndex - 1 ;
+        const U8 flags = store.flags (idx) ;
+        const bool extended = (flags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0 ;
+        const bool remote = (flags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0 ;
+        snprintf (numberString, 128, extended ? "0x%08llX" : "0x%03llX", inFrame.mData1) ;
+        ioText << (extended ? "Ext " : "Std ") << (remote ? "Remote" : "Data") << " idf: " << numberString ;
+        if ((flags & CANFDMolinaroFrameStore::CANFD_FLAG) != 0) {
+          ioText << " (FDF" ;
+          if ((flags & CANFDMolinaroFrameStore::BRS_FLAG) != 0) {
+            ioText << ", BRS" ;
+          }
+          if ((flags & CANFDMolinaroFrameStore::ESI_FLAG) != 0) {
+            ioText << ", ESI" ;
+          }
+          ioText << ")" ;
+        }else if ((flags & CANFDMolinaroFrameStore::CANXL_FLAG) != 0) {
+          ioText << " (XL)" ;
+        }
+        ioText << " [" << U32 (store.dataCodeLength (idx)) << "]" ;
+        const U8 * data = store.payload (idx) ;
+        const U32 dataLength = store.dataLength (idx) ;
+        for (U32 i = 0 ; i < std::min (dataLength, LIVE_FRAME_TEXT_MAX_LENGTH) ; i++) {
+          snprintf (numberString, 128, " %02X", data [i]) ;
+          ioText << numberString ;
+        }
+        if (dataLength > LIVE_FRAME_TEXT_MAX_LENGTH) {
+          ioText << " ..." ;
+        }
+        if ((flags & CANFDMolinaroFrameStore::CRC_ERROR_FLAG) != 0) {
+          ioText << " (CRC error)" ;
+        }
+        if ((flags & CANFDMolinaroFrameStore::NAK_FLAG) != 0) {
+          ioText << " NAK" ;
+        }
+        ioText << "\n" ;
+      }
+    }
+    break ;
   default :
     if (!inBubbleText) {
       ioText << "  " ;
@@ -155,10 +276,14 @@ void CANFDMolinaroAnalyzerResults::GenerateBubbleText (const U64 inFrameIndex,
                                                      Channel& channel,
                                                      const DisplayBase inDisplayBase) {
   const Frame frame = GetFrame (inFrameIndex) ;
-  std::stringstream text ;
-  GenerateText (frame, inDisplayBase, true, text) ;
   ClearResultStrings () ;
-  AddResultString (text.str().c_str ()) ;
+//--- Multi-bus decoding: a field bubble appears on its bus channel only
+  const bool multiBus = mSettings->busCount () > 1 ;
+  if (!multiBus || (channel == mSettings->busChannel (frame.mFlags & FRAME_BUS_MASK))) {
+    std::stringstream text ;
+    GenerateText (frame, inDisplayBase, true, text) ;
+    AddResultString (text.str().c_str ()) ;
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -168,6 +293,9 @@ void CANFDMolinaroAnalyzerResults::GenerateFrameTabularText (const U64 inFrameIn
   #ifdef SUPPORTS_PROTOCOL_SEARCH
     const Frame frame = GetFrame (inFrameIndex) ;
     std::stringstream text ;
+    if (mSettings->busCount () > 1) {
+      text << "Bus " << ((frame.mFlags & FRAME_BUS_MASK) + 1) << " " ;
+    }
     GenerateText (frame, inDisplayBase, false, text) ;
     ClearTabularText () ;
     if (text.str().length () > 0) {
@@ -181,12 +309,26 @@ void CANFDMolinaroAnalyzerResults::GenerateFrameTabularText (const U64 inFrameIn
 void CANFDMolinaroAnalyzerResults::GenerateExportFile (const char* file,
                                                        DisplayBase display_base,
                                                        U32 export_type_user_id) {
+  if (export_type_user_id == 1) {
+    GenerateSignalsExportFile (file) ;
+    return ;
+  }else if (export_type_user_id == 2) {
+    GenerateArchivedFieldsExportFile (file, display_base) ;
+    return ;
+  }else if (export_type_user_id == 3) {
+    GenerateGatewayExportFile (file) ;
+    return ;
+  }else if (export_type_user_id == 4) {
+    GenerateCountersExportFile (file) ;
+    return ;
+  }
   std::ofstream file_stream (file, std::ios::out) ;
 
   const U64 trigger_sample = mAnalyzer->GetTriggerSample();
   const U32 sample_rate = mAnalyzer->GetSampleRate();
 
-  file_stream << "Time [s],Value" << std::endl;
+  const bool multiBus = mSettings->busCount () > 1 ;
+  file_stream << (multiBus ? "Time [s],Bus,Value" : "Time [s],Value") << std::endl;
 
   U64 num_frames = GetNumFrames();
   for(U32 i = 0 ; i < num_frames ; i++) {
@@ -198,7 +340,11 @@ void CANFDMolinaroAnalyzerResults::GenerateExportFile (const char* file,
     char number_str[128] ;
     AnalyzerHelpers::GetNumberString (frame.mData1, display_base, 8, number_str, 128) ;
 
-    file_stream << time_str << "," << number_str << std::endl;
+    file_stream << time_str << "," ;
+    if (multiBus) {
+      file_stream << ((frame.mFlags & FRAME_BUS_MASK) + 1) << "," ;
+    }
+    file_stream << number_str << std::endl;
 
     if (UpdateExportProgressAndCheckForCancel (i, num_frames) == true) {
       file_stream.close () ;
@@ -224,3 +370,192 @@ void CANFDMolinaroAnalyzerResults::GenerateTransactionTabularText (U64 transacti
 }
 
 //----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+//   Decoded signals export: every data frame of the frame store with a valid CRC is
+//   decoded with the DBC file.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerResults::GenerateSignalsExportFile (const char * inFilePath) {
+  std::ofstream file_stream (inFilePath, std::ios::out) ;
+  const bool multiBus = mSettings->busCount () > 1 ;
+  file_stream << (multiBus ? "Time [s],Bus,Message,Signal,Value,Unit" : "Time [s],Message,Signal,Value,Unit") << std::endl ;
+  CANFDMolinaroSignalDatabase database ;
+  std::string errorMessage ;
+  if (mSettings->signalDatabaseFile ().length () > 0) {
+    database.load (mSettings->signalDatabaseFile (), errorMessage) ;
+  }
+  const U64 trigger_sample = mAnalyzer->GetTriggerSample () ;
+  const U32 sample_rate = mAnalyzer->GetSampleRate () ;
+  std::vector <CANFDMolinaroSignalDatabase::SignalValue> signalValues ;
+  std::string messageName ;
+  CANFDMolinaroFrameStore & store = mAnalyzer->frameStore () ;
+  std::lock_guard <std::mutex> lock (store.mutex ()) ;
+  const U32 frameCount = database.isEmpty () ? 0 : store.size () ;
+  for (U32 i = 0 ; i < frameCount ; i++) {
+    const U8 flags = store.flags (i) ;
+    const bool decode = ((flags & (CANFDMolinaroFrameStore::REMOTE_FLAG | CANFDMolinaroFrameStore::CRC_ERROR_FLAG)) == 0)
+      && database.decode (store.identifier (i),
+                          (flags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0,
+                          store.payload (i),
+                          store.dataLength (i),
+                          signalValues,
+                          messageName) ;
+    if (decode) {
+      char time_str [128] ;
+      AnalyzerHelpers::GetTimeString (store.startSampleNumber (i), trigger_sample, sample_rate, time_str, 128) ;
+      for (const CANFDMolinaroSignalDatabase::SignalValue & signal : signalValues) {
+        file_stream << time_str << "," ;
+        if (multiBus) {
+          file_stream << (U32 (store.bus (i)) + 1) << "," ;
+        }
+        file_stream << messageName << ","
+                    << database.signalName (signal.mSignalIndex) << ","
+                    << signal.mValue << ","
+                    << database.signalUnit (signal.mSignalIndex) << std::endl ;
+      }
+    }
+    if (UpdateExportProgressAndCheckForCancel (i, frameCount) == true) {
+      file_stream.close () ;
+      return ;
+    }
+  }
+  file_stream.close () ;
+}
+
+//----------------------------------------------------------------------------------------
+//   Bit archive: fields of an archived frame are rebuilt by replaying its bits in a
+//   private decoder, whose field bubbles are collected as frames.
+//----------------------------------------------------------------------------------------
+
+class ArchivedFieldCollector : public CANFDMolinaroDecoderOutput {
+  public: ArchivedFieldCollector (std::vector <Frame> & outFields) :
+  mFields (outFields) {
+  }
+
+  public: virtual void decoderMark (const U64 /* inSampleNumber */,
+                                    const AnalyzerResults::MarkerType /* inMarker */) {
+  }
+
+  public: virtual void decoderBubble (const U8 inBubbleType,
+                                      const U64 inData1,
+                                      const U64 inData2,
+                                      const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber) {
+    Frame frame ;
+    frame.mType = inBubbleType ;
+    frame.mFlags = 0 ;
+    frame.mData1 = inData1 ;
+    frame.mData2 = inData2 ;
+    frame.mStartingSampleInclusive = inStartSampleNumber ;
+    frame.mEndingSampleInclusive = inEndSampleNumber ;
+    mFields.push_back (frame) ;
+  }
+
+  private: std::vector <Frame> & mFields ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerResults::rebuildArchivedFrameFields (const U32 inArchiveIndex,
+                                                               std::vector <Frame> & outFields) {
+  outFields.clear () ;
+  ArchivedFieldCollector collector (outFields) ;
+  CANFDMolinaroBitArchive & archive = mAnalyzer->bitArchive () ;
+//--- The archive lock also serializes the use of the shared replay decoder: the SDK
+//    may call GenerateBubbleText and the export functions from different threads
+  std::lock_guard <std::mutex> lock (archive.mutex ()) ;
+  mReplayDecoder.configure (*mSettings, 0, mAnalyzer->GetSampleRate ()) ;
+  mReplayDecoder.setOutput (&collector) ;
+  mReplayDecoder.setMarkerOutput (false) ; // Only field bubbles are collected
+  if (inArchiveIndex < archive.frameCount ()) {
+    archive.replayFrame (inArchiveIndex, mReplayDecoder, collector) ;
+  }
+  mReplayDecoder.setOutput (nullptr) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerResults::GenerateArchivedFieldsExportFile (const char * inFilePath,
+                                                                     const DisplayBase inDisplayBase) {
+  std::ofstream file_stream (inFilePath, std::ios::out) ;
+  file_stream << "Time [s],Frame,Field" << std::endl ;
+  const U64 trigger_sample = mAnalyzer->GetTriggerSample () ;
+  const U32 sample_rate = mAnalyzer->GetSampleRate () ;
+  std::vector <Frame> fields ;
+  const U64 num_frames = GetNumFrames () ;
+  for (U64 i = 0 ; i < num_frames ; i++) {
+    const Frame frame = GetFrame (i) ;
+    if (frame.mType == ARCHIVED_FRAME_RESULT) {
+      rebuildArchivedFrameFields (U32 (frame.mData1), fields) ;
+      for (const Frame & field : fields) {
+        std::stringstream text ;
+        GenerateText (field, inDisplayBase, true, text) ;
+        std::string str = text.str () ;
+        while ((str.length () > 0) && (str.back () == '\n')) {
+          str.pop_back () ;
+        }
+        if (str.length () > 0) {
+          char time_str [128] ;
+          AnalyzerHelpers::GetTimeString (field.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128) ;
+          file_stream << time_str << "," << frame.mData1 << "," << str << std::endl ;
+        }
+      }
+    }
+    if (UpdateExportProgressAndCheckForCancel (i, num_frames) == true) {
+      file_stream.close () ;
+      return ;
+    }
+  }
+  file_stream.close () ;
+}
+
+//----------------------------------------------------------------------------------------
+//   Gateway latency export: one line per route of the gateway monitor.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerResults::GenerateGatewayExportFile (const char * inFilePath) {
+  std::ofstream file_stream (inFilePath, std::ios::out) ;
+  file_stream << "Route,Forwarded,Late,Unmatched,Min [us],Mean [us],P99 [us],Max [us]" << std::endl ;
+  CANFDMolinaroGatewayMonitor & monitor = mAnalyzer->gatewayMonitor () ;
+  std::lock_guard <std::mutex> lock (monitor.mutex ()) ;
+  for (U32 route = 0 ; route < monitor.routeCount () ; route++) {
+    file_stream << monitor.routeName (route) << ","
+                << monitor.forwardedCount (route) << ","
+                << monitor.lateCount (route) << ","
+                << monitor.unmatchedCount (route) << ","
+                << monitor.minLatency (route) * 1.0e6 << ","
+                << monitor.meanLatency (route) * 1.0e6 << ","
+                << monitor.percentileLatency (route, 0.99) * 1.0e6 << ","
+                << monitor.maxLatency (route) * 1.0e6 << std::endl ;
+  }
+  file_stream.close () ;
+}
+
+//----------------------------------------------------------------------------------------
+//   Decoder counters export: one line per counter (counters are read while decoding
+//   runs).
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerResults::GenerateCountersExportFile (const char * inFilePath) {
+  std::ofstream file_stream (inFilePath, std::ios::out) ;
+  file_stream << "Counter,Value" << std::endl ;
+  for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+    const CANFDMolinaroDecoderCounters::Counter counter = CANFDMolinaroDecoderCounters::Counter (i) ;
+    file_stream << CANFDMolinaroDecoderCounters::name (counter) << ","
+                << mAnalyzer->counterValue (counter) << std::endl ;
+  }
+//--- Live decoding lag statistics
+  CANFDMolinaroLatencyMonitor & liveLatency = mAnalyzer->liveLatency () ;
+  std::lock_guard <std::mutex> lock (liveLatency.mutex ()) ;
+  if (liveLatency.count () > 0) {
+    file_stream << "Live Commits," << liveLatency.count () << std::endl ;
+    file_stream << "Live Mean Lag (ms)," << liveLatency.meanLag () * 1.0e3 << std::endl ;
+    file_stream << "Live Max Lag (ms)," << liveLatency.maxLag () * 1.0e3 << std::endl ;
+    file_stream << "Live Commits Over " << U32 (CANFDMolinaroLatencyMonitor::LAG_LIMIT * 1.0e3) << " ms,"
+                << liveLatency.countOverLimit () << std::endl ;
+  }
+  file_stream.close () ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -4,6 +4,8 @@
 //----------------------------------------------------------------------------------------
 
 #include <AnalyzerResults.h>
+#include "CANFDMolinaroFrameDecoder.h"
+#include <vector>
 
 //----------------------------------------------------------------------------------------
 
@@ -20,9 +22,20 @@ enum CanFrameType {
   ACK_FIELD_RESULT,
   EOF_FIELD_RESULT,
   INTERMISSION_FIELD_RESULT,
-  CAN_ERROR_RESULT
+  CAN_ERROR_RESULT,
+  ARCHIVED_FRAME_RESULT, // Data1: bit archive frame index, Data2: identifier
+  LIVE_FRAME_RESULT, // Whole frame; Data1: identifier, Data2: frame store index + 1 (0 if not stored)
+  CANXL_CONTROL_FIELD_RESULT, // Data1: DLC, Data2: SDT | (SEC << 8)
+  PCRC_FIELD_RESULT, // Data1: PCRC, Data2: is 0 if PCRC ok
+  CANXL_ACCEPTANCE_FIELD_RESULT, // Data1: AF, Data2: VCID
+  CANXL_DATA_FIELD_RESULT, // Data1: data length, Data2: first 8 bytes, big endian
+  FCRC_FIELD_RESULT // Data1: FCRC, Data2: is 0 if FCRC ok
 } ;
 
+//--- Frame flags of field results: bus index (multi-bus decoding)
+
+static const U8 FRAME_BUS_MASK = 0x0F ;
+
 //----------------------------------------------------------------------------------------
 
 class CANFDMolinaroAnalyzer;
@@ -47,10 +60,16 @@ protected: //functions
                      const DisplayBase inDisplayBase,
                      const bool inBubbleText,
                      std::stringstream & ioText) ;
+  void GenerateSignalsExportFile (const char * inFilePath) ;
+  void GenerateArchivedFieldsExportFile (const char * inFilePath, const DisplayBase inDisplayBase) ;
+  void GenerateGatewayExportFile (const char * inFilePath) ;
+  void GenerateCountersExportFile (const char * inFilePath) ;
+  void rebuildArchivedFrameFields (const U32 inArchiveIndex, std::vector <Frame> & outFields) ;
 
 protected:  //vars
   CANFDMolinaroAnalyzerSettings* mSettings;
   CANFDMolinaroAnalyzer* mAnalyzer;
+  CANFDMolinaroFrameDecoder mReplayDecoder ;
 };
 
 //----------------------------------------------------------------------------------------
@@ -1,4 +1,9 @@
 #include "CANFDMolinaroAnalyzerSettings.h"
+#include "CANFDMolinaroAcceptanceFilter.h"
+#include "CANFDMolinaroSignalDatabase.h"
+#include "CANFDMolinaroTraceReader.h"
+#include "CANFDMolinaroErrorInjector.h"
+#include "CANFDMolinaroGatewayMonitor.h"
 #include <AnalyzerHelpers.h>
 
 //----------------------------------------------------------------------------------------
@@ -11,6 +16,14 @@ mDataBitRate (500 * 1000) {
   mInputChannelInterface->SetTitleAndTooltip ("Serial", "Standard Molinaro's CAN");
   mInputChannelInterface->SetChannel (mInputChannel);
 
+//--- TXD channel
+  mTxdChannel = UNDEFINED_CHANNEL ;
+  mTxdChannelInterface.reset (new AnalyzerSettingInterfaceChannel ()) ;
+  mTxdChannelInterface->SetTitleAndTooltip ("TXD Channel",
+    "TXD of the local node, for loop delay, arbitration loss and bit error detection (single bus only)") ;
+  mTxdChannelInterface->SetChannel (mTxdChannel) ;
+  mTxdChannelInterface->SetSelectionOfNoneIsAllowed (true) ;
+
 //--- Arbitration Bit Rate
   mArbitrationBitRateInterface.reset (new AnalyzerSettingInterfaceInteger ()) ;
   mArbitrationBitRateInterface->SetTitleAndTooltip ("CAN Arbitration Bit Rate (bit/s)",
@@ -32,7 +45,7 @@ mDataBitRate (500 * 1000) {
   mDataBitRateInterface->SetTitleAndTooltip ("CAN Data Bit Rate (bit/s)",
                             "CAN data bit rate in bits per second, a multiple of Arbitration Bit Rate." );
 
-  mDataBitRateInterface->SetMax (12 * 1000 * 1000) ;
+  mDataBitRateInterface->SetMax (20 * 1000 * 1000) ;
   mDataBitRateInterface->SetMin (1) ;
   mDataBitRateInterface->SetInteger (mDataBitRate) ;
 
@@ -54,6 +67,15 @@ mDataBitRate (500 * 1000) {
   mDataSamplePointInterface->SetMin (50) ;
   mDataSamplePointInterface->SetInteger (mDataSamplePoint) ;
 
+//--- Data phase resynchronization
+  mDataPhaseSJWInterface.reset (new AnalyzerSettingInterfaceInteger ()) ;
+  mDataPhaseSJWInterface->SetTitleAndTooltip ("Data Phase SJW (%)",
+    "0: data bits are sampled at bit center after every edge. Otherwise, data bits are sampled at "
+    "Data Sample Point, and only recessive to dominant edges resynchronize, by at most SJW") ;
+  mDataPhaseSJWInterface->SetMax (50) ;
+  mDataPhaseSJWInterface->SetMin (0) ;
+  mDataPhaseSJWInterface->SetInteger (mDataPhaseSJW) ;
+
 //--- Add Channel level inversion
   mCanChannelInvertedInterface.reset (new AnalyzerSettingInterfaceNumberList ( )) ;
   mCanChannelInvertedInterface->SetTitleAndTooltip ("Dominant Logic Level", "" );
@@ -69,6 +91,7 @@ mDataBitRate (500 * 1000) {
   mProtocolInterface->SetTitleAndTooltip ("CANFD Protocol", "" );
   mProtocolInterface->AddNumber (0.0, "ISO", "") ;
   mProtocolInterface->AddNumber (1.0, "Non IS0", "") ;
+  mProtocolInterface->AddNumber (2.0, "CAN XL", "ISO CANFD frames, and CAN XL frames (XLF recessive)") ;
 
 //--- Simulator ACK level
   mSimulatorAckGenerationInterface.reset (new AnalyzerSettingInterfaceNumberList ()) ;
@@ -121,26 +144,218 @@ mDataBitRate (500 * 1000) {
   mSimulatorFrameTypeGenerationInterface->AddNumber (6.0, "Only CANFD Extended Data Frames, 0-16 bytes", "") ;
   mSimulatorFrameTypeGenerationInterface->AddNumber (7.0, "Only CANFD Base Data Frames, 20-64 bytes", "") ;
   mSimulatorFrameTypeGenerationInterface->AddNumber (8.0, "Only CANFD Extended Data Frames, 20-64 bytes", "") ;
+  mSimulatorFrameTypeGenerationInterface->AddNumber (9.0, "Only CAN XL Data Frames, 1-2048 bytes",
+    "Needs the CAN XL protocol to be decoded") ;
   mSimulatorFrameTypeGenerationInterface->SetNumber (0.0) ;
 
+//--- Simulator stuffing pattern
+  mSimulatorStuffingPatternInterface.reset (new AnalyzerSettingInterfaceNumberList ()) ;
+  mSimulatorStuffingPatternInterface->SetTitleAndTooltip ("Simulator Stuffing Pattern",
+    "Identifier and payload of generated frames") ;
+  mSimulatorStuffingPatternInterface->AddNumber (0.0, "Random", "") ;
+  mSimulatorStuffingPatternInterface->AddNumber (1.0, "Maximum stuffing", "Largest data length, a stuff bit every 4 bits") ;
+  mSimulatorStuffingPatternInterface->AddNumber (2.0, "Minimum stuffing", "Largest data length, alternating bits") ;
+  mSimulatorStuffingPatternInterface->AddNumber (3.0, "All-zero payload", "") ;
+  mSimulatorStuffingPatternInterface->AddNumber (4.0, "All-one payload", "") ;
+  mSimulatorStuffingPatternInterface->AddNumber (5.0, "Stuff bit next to BRS", "Maximum stuffing, last arbitration phase stuff bit as close as possible to BRS") ;
+  mSimulatorStuffingPatternInterface->AddNumber (6.0, "Stuff bit at data field end", "Maximum stuffing, a run of 5 bits ends with the last data bit") ;
+  mSimulatorStuffingPatternInterface->SetNumber (double (mSimulatorStuffingPattern)) ;
+
+//--- Acceptance filter
+  mAcceptanceFilterInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mAcceptanceFilterInterface->SetTitleAndTooltip ("Acceptance Filter",
+    "Only matching frames are displayed, empty for all frames. "
+    "Terms: 0x123, 0x100-0x1FF, 0x700/0x7F0, x:0x123 (extended), fd, classic, base, ext, d0=0x12, d0=0x10/0xF0") ;
+  mAcceptanceFilterInterface->SetText (mAcceptanceFilter.c_str ()) ;
+
+//--- Signal database
+  mSignalDatabaseFileInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mSignalDatabaseFileInterface->SetTitleAndTooltip ("DBC File",
+    "Signals of the messages defined in this DBC file are decoded, empty for no signal decoding") ;
+  mSignalDatabaseFileInterface->SetTextType (AnalyzerSettingInterfaceText::FilePath) ;
+  mSignalDatabaseFileInterface->SetText (mSignalDatabaseFile.c_str ()) ;
+
+//--- Decoding mode
+  mDecodingModeInterface.reset (new AnalyzerSettingInterfaceNumberList ()) ;
+  mDecodingModeInterface->SetTitleAndTooltip ("Decoding Mode", "") ;
+  mDecodingModeInterface->AddNumber (0.0,
+                                     "Field level (markers and field bubbles)",
+                                     "Every bit is marked, every frame field has its bubble") ;
+  mDecodingModeInterface->AddNumber (1.0,
+                                     "Frame level (fields rebuilt from raw bit archive)",
+                                     "One bubble per frame, fields are decoded again from the frame bits when displayed or exported") ;
+  mDecodingModeInterface->AddNumber (2.0,
+                                     "Live (one result per frame, low latency)",
+                                     "No marker, one result per completed frame, committed as soon as the frame ends") ;
+  mDecodingModeInterface->SetNumber (0.0) ;
+
+//--- Result output
+  mResultOutputInterface.reset (new AnalyzerSettingInterfaceNumberList ()) ;
+  mResultOutputInterface->SetTitleAndTooltip ("Field Results", "Result kinds of field level decoding") ;
+  mResultOutputInterface->AddNumber (0.0,
+                                     "Bubbles and data table",
+                                     "Every field has a bubble and a data table row") ;
+  mResultOutputInterface->AddNumber (1.0,
+                                     "Bubbles only",
+                                     "Every field has a bubble, no data table row (no high level analyzer input)") ;
+  mResultOutputInterface->AddNumber (2.0,
+                                     "Data table only",
+                                     "Every field has a data table row, every frame has a single bubble") ;
+  mResultOutputInterface->SetNumber (0.0) ;
+
+//--- Simulator traffic scheduler
+  mSimulatorBusLoadInterface.reset (new AnalyzerSettingInterfaceInteger ()) ;
+  mSimulatorBusLoadInterface->SetTitleAndTooltip ("Simulator Bus Load (%)",
+    "0: random frames back to back; otherwise, periodic and sporadic messages of virtual nodes "
+    "are scheduled with arbitration, for this target bus load") ;
+  mSimulatorBusLoadInterface->SetMax (100) ;
+  mSimulatorBusLoadInterface->SetMin (0) ;
+  mSimulatorBusLoadInterface->SetInteger (mSimulatorBusLoad) ;
+
+  mSimulatorNodeCountInterface.reset (new AnalyzerSettingInterfaceInteger ()) ;
+  mSimulatorNodeCountInterface->SetTitleAndTooltip ("Simulator Node Count",
+    "Number of virtual nodes of the traffic scheduler (used when bus load is not 0)") ;
+  mSimulatorNodeCountInterface->SetMax (32) ;
+  mSimulatorNodeCountInterface->SetMin (1) ;
+  mSimulatorNodeCountInterface->SetInteger (mSimulatorNodeCount) ;
+
+//--- Simulator bit timing
+  mSimulatorBitTimingInterface.reset (new AnalyzerSettingInterfaceNumberList ()) ;
+  mSimulatorBitTimingInterface->SetTitleAndTooltip ("Simulator Bit Timing", "") ;
+  mSimulatorBitTimingInterface->AddNumber (0.0, "Integer samples per bit",
+    "Bit time is sample rate / bit rate, rounded down") ;
+  mSimulatorBitTimingInterface->AddNumber (1.0, "Fractional samples per bit, clock skew",
+    "Exact bit time, sub-sample part carried from bit to bit; transmitter clocks are skewed") ;
+  mSimulatorBitTimingInterface->SetNumber (double (mSimulatorBitTiming)) ;
+
+  mSimulatorClockToleranceInterface.reset (new AnalyzerSettingInterfaceInteger ()) ;
+  mSimulatorClockToleranceInterface->SetTitleAndTooltip ("Simulator Clock Tolerance (ppm)",
+    "With fractional bit timing, each transmitter clock is skewed by a random value within "
+    "± tolerance: per virtual node with the traffic scheduler, per frame otherwise") ;
+  mSimulatorClockToleranceInterface->SetMax (20000) ;
+  mSimulatorClockToleranceInterface->SetMin (0) ;
+  mSimulatorClockToleranceInterface->SetInteger (mSimulatorClockTolerance) ;
+
+//--- Simulator trace replay
+  mSimulatorTraceFileInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mSimulatorTraceFileInterface->SetTitleAndTooltip ("Simulator Trace File",
+    "candump log or CSV (timestamp, id, flags, payload) file whose frames are sent by the simulator "
+    "at their recorded times, empty for generated frames") ;
+  mSimulatorTraceFileInterface->SetTextType (AnalyzerSettingInterfaceText::FilePath) ;
+  mSimulatorTraceFileInterface->SetText (mSimulatorTraceFile.c_str ()) ;
+
+//--- Simulator error injection
+  mSimulatorErrorInjectionInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mSimulatorErrorInjectionInterface->SetTitleAndTooltip ("Simulator Error Injection",
+    "Faults injected in generated frames, empty for none. Terms: kind=rate or kind=rate@position, "
+    "rate in % of frames; kinds: flip, stuff, crc, form, glitch, errorflag, overload") ;
+  mSimulatorErrorInjectionInterface->SetText (mSimulatorErrorInjection.c_str ()) ;
+
+//--- Extra buses (multi-bus decoding)
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    const std::string bus = "Bus " + std::to_string (i + 2) ;
+    mExtraBusChannels [i] = UNDEFINED_CHANNEL ;
+    mExtraBusBitTimings [i] = busBitTiming (0) ;
+
+    mExtraBusChannelInterfaces [i].reset (new AnalyzerSettingInterfaceChannel ()) ;
+    mExtraBusChannelInterfaces [i]->SetTitleAndTooltip ((bus + " Channel").c_str (),
+      "Channel of an extra bus, decoded concurrently with the Serial channel (None for single bus decoding)") ;
+    mExtraBusChannelInterfaces [i]->SetChannel (mExtraBusChannels [i]) ;
+    mExtraBusChannelInterfaces [i]->SetSelectionOfNoneIsAllowed (true) ;
+
+    mExtraBusArbitrationBitRateInterfaces [i].reset (new AnalyzerSettingInterfaceInteger ()) ;
+    mExtraBusArbitrationBitRateInterfaces [i]->SetTitleAndTooltip ((bus + " Arbitration Bit Rate (bit/s)").c_str (), "") ;
+    mExtraBusArbitrationBitRateInterfaces [i]->SetMax (1 * 1000 * 1000) ;
+    mExtraBusArbitrationBitRateInterfaces [i]->SetMin (1) ;
+    mExtraBusArbitrationBitRateInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mArbitrationBitRate) ;
+
+    mExtraBusDataBitRateInterfaces [i].reset (new AnalyzerSettingInterfaceInteger ()) ;
+    mExtraBusDataBitRateInterfaces [i]->SetTitleAndTooltip ((bus + " Data Bit Rate (bit/s)").c_str (), "") ;
+    mExtraBusDataBitRateInterfaces [i]->SetMax (20 * 1000 * 1000) ;
+    mExtraBusDataBitRateInterfaces [i]->SetMin (1) ;
+    mExtraBusDataBitRateInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mDataBitRate) ;
+
+    mExtraBusArbitrationSamplePointInterfaces [i].reset (new AnalyzerSettingInterfaceInteger ()) ;
+    mExtraBusArbitrationSamplePointInterfaces [i]->SetTitleAndTooltip ((bus + " Arbitration Sample Point (%)").c_str (), "") ;
+    mExtraBusArbitrationSamplePointInterfaces [i]->SetMax (90) ;
+    mExtraBusArbitrationSamplePointInterfaces [i]->SetMin (50) ;
+    mExtraBusArbitrationSamplePointInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mArbitrationSamplePoint) ;
+
+    mExtraBusDataSamplePointInterfaces [i].reset (new AnalyzerSettingInterfaceInteger ()) ;
+    mExtraBusDataSamplePointInterfaces [i]->SetTitleAndTooltip ((bus + " Data Sample Point (%)").c_str (), "") ;
+    mExtraBusDataSamplePointInterfaces [i]->SetMax (90) ;
+    mExtraBusDataSamplePointInterfaces [i]->SetMin (50) ;
+    mExtraBusDataSamplePointInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mDataSamplePoint) ;
+  }
+
+//--- Gateway latency measurement
+  mGatewayRoutesInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mGatewayRoutesInterface->SetTitleAndTooltip ("Gateway Routes",
+    "Frames forwarded between buses whose latency is measured, empty for none. Terms: src>dst, "
+    "src>dst:id=id (identifier mapping), window=µs (matching window), late=µs (late threshold)") ;
+  mGatewayRoutesInterface->SetText (mGatewayRoutes.c_str ()) ;
+
+//--- Trace file (archived in every build, shown in CANFD_TRACE builds only)
+  mTraceFileInterface.reset (new AnalyzerSettingInterfaceText ()) ;
+  mTraceFileInterface->SetTitleAndTooltip ("Trace File",
+    "Chrome / Perfetto trace-event JSON file written while decoding, with the time spent in edge iteration, "
+    "decoding and SDK result calls, per batch of frames; empty for none") ;
+  mTraceFileInterface->SetText (mTraceFile.c_str ()) ;
+
 //--- Install interfaces
   AddInterface (mInputChannelInterface.get ()) ;
+  AddInterface (mTxdChannelInterface.get ()) ;
   AddInterface (mArbitrationBitRateInterface.get ());
   AddInterface (mDataBitRateInterface.get ());
   AddInterface (mCanChannelInvertedInterface.get ());
   AddInterface (mArbitrationSamplePointInterface.get ());
   AddInterface (mDataSamplePointInterface.get ());
+  AddInterface (mDataPhaseSJWInterface.get ()) ;
   AddInterface (mProtocolInterface.get ());
+  AddInterface (mAcceptanceFilterInterface.get ());
+  AddInterface (mSignalDatabaseFileInterface.get ());
+  AddInterface (mDecodingModeInterface.get ());
+  AddInterface (mResultOutputInterface.get ()) ;
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    AddInterface (mExtraBusChannelInterfaces [i].get ()) ;
+    AddInterface (mExtraBusArbitrationBitRateInterfaces [i].get ()) ;
+    AddInterface (mExtraBusDataBitRateInterfaces [i].get ()) ;
+    AddInterface (mExtraBusArbitrationSamplePointInterfaces [i].get ()) ;
+    AddInterface (mExtraBusDataSamplePointInterfaces [i].get ()) ;
+  }
+  AddInterface (mGatewayRoutesInterface.get ()) ;
+#ifdef CANFD_TRACE
+  AddInterface (mTraceFileInterface.get ()) ;
+#endif
   AddInterface (mSimulatorRandomSeedInterface.get ());
   AddInterface (mSimulatorAckGenerationInterface.get ());
   AddInterface (mSimulatorFrameTypeGenerationInterface.get ());
+  AddInterface (mSimulatorStuffingPatternInterface.get ());
   AddInterface (mSimulatorBSRGenerationInterface.get ());
   AddInterface (mSimulatorESIGenerationInterface.get ());
+  AddInterface (mSimulatorBusLoadInterface.get ());
+  AddInterface (mSimulatorNodeCountInterface.get ());
+  AddInterface (mSimulatorBitTimingInterface.get ());
+  AddInterface (mSimulatorClockToleranceInterface.get ());
+  AddInterface (mSimulatorTraceFileInterface.get ());
+  AddInterface (mSimulatorErrorInjectionInterface.get ());
 
   AddExportOption( 0, "Export as text/csv file" );
   AddExportExtension( 0, "text", "txt" );
   AddExportExtension( 0, "csv", "csv" );
 
+  AddExportOption (1, "Export decoded DBC signals as csv file") ;
+  AddExportExtension (1, "csv", "csv") ;
+
+  AddExportOption (2, "Export frame fields rebuilt from bit archive as csv file") ;
+  AddExportExtension (2, "csv", "csv") ;
+
+  AddExportOption (3, "Export gateway latency statistics as csv file") ;
+  AddExportExtension (3, "csv", "csv") ;
+
+  AddExportOption (4, "Export decoder counters as csv file") ;
+  AddExportExtension (4, "csv", "csv") ;
+
   ClearChannels ();
   AddChannel (mInputChannel, "Serial", false) ;
 }
@@ -150,6 +365,39 @@ mDataBitRate (500 * 1000) {
 CANFDMolinaroAnalyzerSettings::~CANFDMolinaroAnalyzerSettings(){
 }
 
+//----------------------------------------------------------------------------------------
+//  MULTI-BUS
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroAnalyzerSettings::busCount (void) const {
+  U32 result = 1 ;
+  while ((result < CANFD_MAX_BUS_COUNT) && (mExtraBusChannels [result - 1] != UNDEFINED_CHANNEL)) {
+    result += 1 ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+Channel CANFDMolinaroAnalyzerSettings::busChannel (const U32 inBus) const {
+  return (inBus == 0) ? mInputChannel : mExtraBusChannels [inBus - 1] ;
+}
+
+//----------------------------------------------------------------------------------------
+
+BusBitTiming CANFDMolinaroAnalyzerSettings::busBitTiming (const U32 inBus) const {
+  BusBitTiming result ;
+  if (inBus == 0) {
+    result.mArbitrationBitRate = mArbitrationBitRate ;
+    result.mDataBitRate = mDataBitRate ;
+    result.mArbitrationSamplePoint = mArbitrationSamplePoint ;
+    result.mDataSamplePoint = mDataSamplePoint ;
+  }else{
+    result = mExtraBusBitTimings [inBus - 1] ;
+  }
+  return result ;
+}
+
 //----------------------------------------------------------------------------------------
 
 bool CANFDMolinaroAnalyzerSettings::SetSettingsFromInterfaces () {
@@ -157,6 +405,7 @@ bool CANFDMolinaroAnalyzerSettings::SetSettingsFromInterfaces () {
 
   mArbitrationSamplePoint = mArbitrationSamplePointInterface->GetInteger();
   mDataSamplePoint = mDataSamplePointInterface->GetInteger();
+  mDataPhaseSJW = mDataPhaseSJWInterface->GetInteger () ;
   mArbitrationBitRate = mArbitrationBitRateInterface->GetInteger();
   mSimulatorRandomSeed = mSimulatorRandomSeedInterface->GetInteger () ;
   mDataBitRate = mDataBitRateInterface->GetInteger();
@@ -177,8 +426,118 @@ bool CANFDMolinaroAnalyzerSettings::SetSettingsFromInterfaces () {
   mSimulatorGeneratedESISlot
     = SimulatorGeneratedBit (mSimulatorESIGenerationInterface->GetNumber ()) ;
 
+  const std::string acceptanceFilter = mAcceptanceFilterInterface->GetText () ;
+  CANFDMolinaroAcceptanceFilter filter ;
+  std::string errorMessage ;
+  if (!filter.compile (acceptanceFilter, errorMessage)) {
+    SetErrorText (errorMessage.c_str ()) ;
+    return false ;
+  }
+  mAcceptanceFilter = acceptanceFilter ;
+
+  const std::string signalDatabaseFile = mSignalDatabaseFileInterface->GetText () ;
+  if (signalDatabaseFile.length () > 0) {
+    CANFDMolinaroSignalDatabase database ;
+    if (!database.load (signalDatabaseFile, errorMessage)) {
+      SetErrorText (errorMessage.c_str ()) ;
+      return false ;
+    }
+  }
+  mSignalDatabaseFile = signalDatabaseFile ;
+
+  mDecodingMode = DecodingMode (mDecodingModeInterface->GetNumber ()) ;
+  mResultOutput = ResultOutput (mResultOutputInterface->GetNumber ()) ;
+
+  mSimulatorBusLoad = mSimulatorBusLoadInterface->GetInteger () ;
+  mSimulatorNodeCount = mSimulatorNodeCountInterface->GetInteger () ;
+  mSimulatorStuffingPattern = SimulatorStuffingPattern (mSimulatorStuffingPatternInterface->GetNumber ()) ;
+  mSimulatorBitTiming = SimulatorBitTiming (mSimulatorBitTimingInterface->GetNumber ()) ;
+  mSimulatorClockTolerance = mSimulatorClockToleranceInterface->GetInteger () ;
+
+  const std::string simulatorTraceFile = mSimulatorTraceFileInterface->GetText () ;
+  if (simulatorTraceFile.length () > 0) {
+    CANFDMolinaroTraceReader reader ;
+    if (!reader.open (simulatorTraceFile, errorMessage)) {
+      SetErrorText (errorMessage.c_str ()) ;
+      return false ;
+    }
+  }
+  mSimulatorTraceFile = simulatorTraceFile ;
+
+  const std::string simulatorErrorInjection = mSimulatorErrorInjectionInterface->GetText () ;
+  CANFDMolinaroErrorInjector injector ;
+  if (!injector.compile (simulatorErrorInjection, errorMessage)) {
+    SetErrorText (errorMessage.c_str ()) ;
+    return false ;
+  }
+  mSimulatorErrorInjection = simulatorErrorInjection ;
+
+//--- Extra buses: channels are used in order, and are all distinct
+  Channel extraBusChannels [CANFD_MAX_BUS_COUNT - 1] ;
+  bool previousDefined = true ;
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    extraBusChannels [i] = mExtraBusChannelInterfaces [i]->GetChannel () ;
+    const bool defined = extraBusChannels [i] != UNDEFINED_CHANNEL ;
+    if (defined && !previousDefined) {
+      const std::string message = "Bus " + std::to_string (i + 2) + " Channel is set, but Bus "
+        + std::to_string (i + 1) + " Channel is not" ;
+      SetErrorText (message.c_str ()) ;
+      return false ;
+    }
+    if (defined && (extraBusChannels [i] == mInputChannel)) {
+      SetErrorText ("Every bus should use a distinct channel") ;
+      return false ;
+    }
+    for (U32 j = 0 ; defined && (j < i) ; j++) {
+      if (extraBusChannels [i] == extraBusChannels [j]) {
+        SetErrorText ("Every bus should use a distinct channel") ;
+        return false ;
+      }
+    }
+    previousDefined = defined ;
+  }
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    mExtraBusChannels [i] = extraBusChannels [i] ;
+    mExtraBusBitTimings [i].mArbitrationBitRate = mExtraBusArbitrationBitRateInterfaces [i]->GetInteger () ;
+    mExtraBusBitTimings [i].mDataBitRate = mExtraBusDataBitRateInterfaces [i]->GetInteger () ;
+    mExtraBusBitTimings [i].mArbitrationSamplePoint = mExtraBusArbitrationSamplePointInterfaces [i]->GetInteger () ;
+    mExtraBusBitTimings [i].mDataSamplePoint = mExtraBusDataSamplePointInterfaces [i]->GetInteger () ;
+  }
+
+//--- Gateway routes: every route bus should be decoded
+  const std::string gatewayRoutes = mGatewayRoutesInterface->GetText () ;
+  CANFDMolinaroGatewayMonitor gatewayMonitor ;
+  if (!gatewayMonitor.compile (gatewayRoutes, errorMessage)) {
+    SetErrorText (errorMessage.c_str ()) ;
+    return false ;
+  }
+  if (gatewayMonitor.requiredBusCount () > busCount ()) {
+    const std::string message = "Gateway routes use bus " + std::to_string (gatewayMonitor.requiredBusCount ())
+      + ", but only " + std::to_string (busCount ()) + " bus(es) are decoded" ;
+    SetErrorText (message.c_str ()) ;
+    return false ;
+  }
+  mGatewayRoutes = gatewayRoutes ;
+
+//--- TXD channel: single bus decoding
+  const Channel txdChannel = mTxdChannelInterface->GetChannel () ;
+  if (txdChannel != UNDEFINED_CHANNEL) {
+    if (busCount () > 1) {
+      SetErrorText ("TXD Channel is only available with a single bus") ;
+      return false ;
+    }
+    if (txdChannel == mInputChannel) {
+      SetErrorText ("TXD Channel should be distinct from Serial channel") ;
+      return false ;
+    }
+  }
+  mTxdChannel = txdChannel ;
+
+  mTraceFile = mTraceFileInterface->GetText () ;
+
   ClearChannels();
   AddChannel (mInputChannel, "CANFD", true) ;
+  addOptionalChannels () ;
 
   return true;
 }
@@ -196,8 +555,42 @@ void CANFDMolinaroAnalyzerSettings::UpdateInterfacesFromSettings () {
   mProtocolInterface->SetNumber (double (mProtocol)) ;
   mSimulatorAckGenerationInterface->SetNumber (mSimulatorGeneratedAckSlot) ;
   mSimulatorFrameTypeGenerationInterface->SetNumber (mSimulatorGeneratedFrameType) ;
+  mSimulatorStuffingPatternInterface->SetNumber (mSimulatorStuffingPattern) ;
+  mSimulatorBitTimingInterface->SetNumber (mSimulatorBitTiming) ;
+  mSimulatorClockToleranceInterface->SetInteger (mSimulatorClockTolerance) ;
   mSimulatorBSRGenerationInterface->SetNumber (mSimulatorGeneratedBSRSlot) ;
   mSimulatorESIGenerationInterface->SetNumber (mSimulatorGeneratedESISlot) ;
+  mAcceptanceFilterInterface->SetText (mAcceptanceFilter.c_str ()) ;
+  mSignalDatabaseFileInterface->SetText (mSignalDatabaseFile.c_str ()) ;
+  mDecodingModeInterface->SetNumber (double (mDecodingMode)) ;
+  mResultOutputInterface->SetNumber (double (mResultOutput)) ;
+  mSimulatorBusLoadInterface->SetInteger (mSimulatorBusLoad) ;
+  mSimulatorNodeCountInterface->SetInteger (mSimulatorNodeCount) ;
+  mSimulatorTraceFileInterface->SetText (mSimulatorTraceFile.c_str ()) ;
+  mSimulatorErrorInjectionInterface->SetText (mSimulatorErrorInjection.c_str ()) ;
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    mExtraBusChannelInterfaces [i]->SetChannel (mExtraBusChannels [i]) ;
+    mExtraBusArbitrationBitRateInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mArbitrationBitRate) ;
+    mExtraBusDataBitRateInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mDataBitRate) ;
+    mExtraBusArbitrationSamplePointInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mArbitrationSamplePoint) ;
+    mExtraBusDataSamplePointInterfaces [i]->SetInteger (mExtraBusBitTimings [i].mDataSamplePoint) ;
+  }
+  mGatewayRoutesInterface->SetText (mGatewayRoutes.c_str ()) ;
+  mTxdChannelInterface->SetChannel (mTxdChannel) ;
+  mDataPhaseSJWInterface->SetInteger (mDataPhaseSJW) ;
+  mTraceFileInterface->SetText (mTraceFile.c_str ()) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroAnalyzerSettings::addOptionalChannels (void) {
+  for (U32 bus = 1 ; bus < busCount () ; bus++) {
+    const std::string name = "CANFD Bus " + std::to_string (bus + 1) ;
+    AddChannel (mExtraBusChannels [bus - 1], name.c_str (), true) ;
+  }
+  if (mTxdChannel != UNDEFINED_CHANNEL) {
+    AddChannel (mTxdChannel, "TXD", true) ;
+  }
 }
 
 //----------------------------------------------------------------------------------------
@@ -229,8 +622,90 @@ void CANFDMolinaroAnalyzerSettings::LoadSettings (const char* settings) {
   text_archive >> value ;
   mSimulatorGeneratedBSRSlot = SimulatorGeneratedBit (value) ;
 
+  const char * acceptanceFilter = "" ;
+  if (text_archive >> &acceptanceFilter) {
+    mAcceptanceFilter = acceptanceFilter ;
+  }
+
+  const char * signalDatabaseFile = "" ;
+  if (text_archive >> &signalDatabaseFile) {
+    mSignalDatabaseFile = signalDatabaseFile ;
+  }
+
+  if (text_archive >> value) {
+    mDecodingMode = DecodingMode (value) ;
+  }
+
+  if (text_archive >> value) {
+    mSimulatorBusLoad = value ;
+  }
+
+  if (text_archive >> value) {
+    mSimulatorNodeCount = value ;
+  }
+
+  const char * simulatorTraceFile = "" ;
+  if (text_archive >> &simulatorTraceFile) {
+    mSimulatorTraceFile = simulatorTraceFile ;
+  }
+
+  const char * simulatorErrorInjection = "" ;
+  if (text_archive >> &simulatorErrorInjection) {
+    mSimulatorErrorInjection = simulatorErrorInjection ;
+  }
+
+  if (text_archive >> value) {
+    mSimulatorStuffingPattern = SimulatorStuffingPattern (value) ;
+  }
+
+  if (text_archive >> value) {
+    mSimulatorBitTiming = SimulatorBitTiming (value) ;
+  }
+
+  if (text_archive >> value) {
+    mSimulatorClockTolerance = value ;
+  }
+
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    Channel channel ;
+    BusBitTiming timing ;
+    const bool ok = (text_archive >> channel)
+      && (text_archive >> timing.mArbitrationBitRate)
+      && (text_archive >> timing.mDataBitRate)
+      && (text_archive >> timing.mArbitrationSamplePoint)
+      && (text_archive >> timing.mDataSamplePoint) ;
+    if (ok) {
+      mExtraBusChannels [i] = channel ;
+      mExtraBusBitTimings [i] = timing ;
+    }
+  }
+
+  const char * gatewayRoutes = "" ;
+  if (text_archive >> &gatewayRoutes) {
+    mGatewayRoutes = gatewayRoutes ;
+  }
+
+  Channel txdChannel ;
+  if (text_archive >> txdChannel) {
+    mTxdChannel = txdChannel ;
+  }
+
+  if (text_archive >> value) {
+    mDataPhaseSJW = value ;
+  }
+
+  if (text_archive >> value) {
+    mResultOutput = ResultOutput (value) ;
+  }
+
+  const char * traceFile = "" ;
+  if (text_archive >> &traceFile) {
+    mTraceFile = traceFile ;
+  }
+
   ClearChannels();
   AddChannel( mInputChannel, "CANFD (Molinaro)", true );
+  addOptionalChannels () ;
 
   UpdateInterfacesFromSettings();
 }
@@ -244,11 +719,35 @@ const char* CANFDMolinaroAnalyzerSettings::SaveSettings () {
   text_archive << mArbitrationBitRate;
   text_archive << mDataBitRate;
   text_archive << mInverted;
+  text_archive << mArbitrationSamplePoint ;
+  text_archive << mDataSamplePoint ;
   text_archive << U32 (mProtocol) ;
   text_archive << U32 (mSimulatorGeneratedAckSlot) ;
   text_archive << U32 (mSimulatorGeneratedFrameType) ;
-  text_archive << U32 (mSimulatorGeneratedBSRSlot) ;
   text_archive << U32 (mSimulatorGeneratedESISlot) ;
+  text_archive << U32 (mSimulatorGeneratedBSRSlot) ;
+  text_archive << mAcceptanceFilter.c_str () ;
+  text_archive << mSignalDatabaseFile.c_str () ;
+  text_archive << U32 (mDecodingMode) ;
+  text_archive << mSimulatorBusLoad ;
+  text_archive << mSimulatorNodeCount ;
+  text_archive << mSimulatorTraceFile.c_str () ;
+  text_archive << mSimulatorErrorInjection.c_str () ;
+  text_archive << U32 (mSimulatorStuffingPattern) ;
+  text_archive << U32 (mSimulatorBitTiming) ;
+  text_archive << mSimulatorClockTolerance ;
+  for (U32 i = 0 ; i < (CANFD_MAX_BUS_COUNT - 1) ; i++) {
+    text_archive << mExtraBusChannels [i] ;
+    text_archive << mExtraBusBitTimings [i].mArbitrationBitRate ;
+    text_archive << mExtraBusBitTimings [i].mDataBitRate ;
+    text_archive << mExtraBusBitTimings [i].mArbitrationSamplePoint ;
+    text_archive << mExtraBusBitTimings [i].mDataSamplePoint ;
+  }
+  text_archive << mGatewayRoutes.c_str () ;
+  text_archive << mTxdChannel ;
+  text_archive << mDataPhaseSJW ;
+  text_archive << U32 (mResultOutput) ;
+  text_archive << mTraceFile.c_str () ;
 
   return SetReturnString (text_archive.GetString ()) ;
 }
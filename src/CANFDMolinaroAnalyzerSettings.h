@@ -5,16 +5,37 @@
 
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
+#include <string>
 
 //----------------------------------------------------------------------------------------
 
 typedef enum {
   CANFD_ISO_PROTOCOL,
-  CANFD_NON_ISO_PROTOCOL
+  CANFD_NON_ISO_PROTOCOL,
+  CANXL_PROTOCOL // ISO CANFD, and CAN XL frames
 } ProtocolSetting ;
 
 //----------------------------------------------------------------------------------------
 
+typedef enum {
+  FIELD_DECODING_MODE,
+  BIT_ARCHIVE_DECODING_MODE,
+  LIVE_DECODING_MODE
+} DecodingMode ;
+
+//----------------------------------------------------------------------------------------
+//  Field results of field level decoding: legacy frames (bubbles, tabular text, export)
+//  and FrameV2 (data table, high level analyzers). With FrameV2 only, every frame has a
+//  single legacy result, whose text comes from the frame store.
+
+typedef enum {
+  LEGACY_AND_FRAMEV2_RESULTS,
+  LEGACY_RESULTS_ONLY,
+  FRAMEV2_RESULTS_ONLY
+} ResultOutput ;
+
+//----------------------------------------------------------------------------------------
+
 typedef enum {
   GENERATE_BIT_DOMINANT,
   GENERATE_BIT_RECESSIVE,
@@ -32,11 +53,46 @@ typedef enum {
   GENERATE_ONLY_CANFD_BASE_0_16,
   GENERATE_ONLY_CANFD_EXTENDED_0_16,
   GENERATE_ONLY_CANFD_BASE_20_64,
-  GENERATE_ONLY_CANFD_EXTENDED_20_64
+  GENERATE_ONLY_CANFD_EXTENDED_20_64,
+  GENERATE_ONLY_CANXL_DATA
 } SimulatorGeneratedFrameType ;
 
 //----------------------------------------------------------------------------------------
 
+typedef enum {
+  GENERATE_RANDOM_CONTENTS,
+  GENERATE_MAXIMUM_STUFFING,
+  GENERATE_MINIMUM_STUFFING,
+  GENERATE_ALL_ZERO_PAYLOAD,
+  GENERATE_ALL_ONE_PAYLOAD,
+  GENERATE_STUFF_BIT_AT_BRS,
+  GENERATE_STUFF_BIT_AT_DATA_END
+} SimulatorStuffingPattern ;
+
+//----------------------------------------------------------------------------------------
+
+typedef enum {
+  INTEGER_BIT_TIMING,
+  FRACTIONAL_BIT_TIMING
+} SimulatorBitTiming ;
+
+//----------------------------------------------------------------------------------------
+//  Multi-bus decoding: bus 0 uses the main channel and bit timing settings, every extra
+//  bus has its own channel and bit timing settings (dominant level and protocol are
+//  shared by all buses)
+//----------------------------------------------------------------------------------------
+
+static const U32 CANFD_MAX_BUS_COUNT = 4 ;
+
+typedef struct {
+  U32 mArbitrationBitRate ;
+  U32 mDataBitRate ;
+  U32 mArbitrationSamplePoint ;
+  U32 mDataSamplePoint ;
+} BusBitTiming ;
+
+//----------------------------------------------------------------------------------------
+
 class CANFDMolinaroAnalyzerSettings : public AnalyzerSettings {
 public:
   CANFDMolinaroAnalyzerSettings();
@@ -72,6 +128,10 @@ public:
    return mSimulatorGeneratedFrameType ;
   }
 
+  public: SimulatorStuffingPattern stuffingPattern (void) const {
+   return mSimulatorStuffingPattern ;
+  }
+
   public: ProtocolSetting protocol (void) const {
    return mProtocol ;
   }
@@ -88,30 +148,136 @@ public:
    return mDataSamplePoint ;
   }
 
+//--- 0: data phase bits are sampled at bit center, from every edge
+  public: U32 dataPhaseSJW (void) const {
+   return mDataPhaseSJW ;
+  }
+
+  public: const std::string & acceptanceFilter (void) const {
+   return mAcceptanceFilter ;
+  }
+
+  public: const std::string & signalDatabaseFile (void) const {
+   return mSignalDatabaseFile ;
+  }
+
+  public: DecodingMode decodingMode (void) const {
+   return mDecodingMode ;
+  }
+
+  public: ResultOutput resultOutput (void) const {
+   return mResultOutput ;
+  }
+
+  public: U32 simulatorBusLoad (void) const {
+   return mSimulatorBusLoad ;
+  }
+
+  public: U32 simulatorNodeCount (void) const {
+   return mSimulatorNodeCount ;
+  }
+
+  public: SimulatorBitTiming simulatorBitTiming (void) const {
+   return mSimulatorBitTiming ;
+  }
+
+  public: U32 simulatorClockTolerance (void) const {
+   return mSimulatorClockTolerance ;
+  }
+
+  public: const std::string & simulatorTraceFile (void) const {
+   return mSimulatorTraceFile ;
+  }
+
+  public: const std::string & simulatorErrorInjection (void) const {
+   return mSimulatorErrorInjection ;
+  }
+
+//--- Multi-bus: extra buses are the defined "Bus n Channel" settings (1 if none)
+  public: U32 busCount (void) const ;
+
+  public: Channel busChannel (const U32 inBus) const ;
+
+  public: BusBitTiming busBitTiming (const U32 inBus) const ;
+
+//--- Local node TXD channel (UNDEFINED_CHANNEL if none), single bus decoding only
+  public: Channel txdChannel (void) const {
+   return mTxdChannel ;
+  }
+
+//--- Gateway latency measurement between buses, empty for none
+  public: const std::string & gatewayRoutes (void) const {
+   return mGatewayRoutes ;
+  }
+
+//--- Chrome trace-event file of WorkerThread phases, empty for none (CANFD_TRACE builds)
+  public: const std::string & traceFile (void) const {
+   return mTraceFile ;
+  }
+
+  protected: void addOptionalChannels (void) ;
+
   protected: std::shared_ptr <AnalyzerSettingInterfaceChannel> mInputChannelInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceChannel> mTxdChannelInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mArbitrationBitRateInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mDataBitRateInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mArbitrationSamplePointInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mDataSamplePointInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mDataPhaseSJWInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mCanChannelInvertedInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorAckGenerationInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorESIGenerationInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorBSRGenerationInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorFrameTypeGenerationInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorStuffingPatternInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mProtocolInterface ;
   protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mSimulatorRandomSeedInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mAcceptanceFilterInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mSignalDatabaseFileInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mDecodingModeInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mResultOutputInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mSimulatorBusLoadInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mSimulatorNodeCountInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceNumberList> mSimulatorBitTimingInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mSimulatorClockToleranceInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mSimulatorTraceFileInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mSimulatorErrorInjectionInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceChannel> mExtraBusChannelInterfaces [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mExtraBusArbitrationBitRateInterfaces [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mExtraBusDataBitRateInterfaces [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mExtraBusArbitrationSamplePointInterfaces [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceInteger> mExtraBusDataSamplePointInterfaces [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mGatewayRoutesInterface ;
+  protected: std::shared_ptr <AnalyzerSettingInterfaceText> mTraceFileInterface ;
 
   protected: U32 mArbitrationBitRate ;
   protected: U32 mDataBitRate ;
   protected: U32 mSimulatorRandomSeed ;
   protected: U32 mArbitrationSamplePoint = 75 ;
   protected: U32 mDataSamplePoint = 75 ;
+  protected: U32 mDataPhaseSJW = 0 ; // % of data bit
   protected: SimulatorGeneratedBit mSimulatorGeneratedAckSlot = GENERATE_BIT_DOMINANT ;
   protected: SimulatorGeneratedBit mSimulatorGeneratedESISlot = GENERATE_BIT_DOMINANT ;
   protected: SimulatorGeneratedBit mSimulatorGeneratedBSRSlot = GENERATE_BIT_DOMINANT ;
   protected: SimulatorGeneratedFrameType mSimulatorGeneratedFrameType = GENERATE_ALL_FRAME_TYPES ;
+  protected: SimulatorStuffingPattern mSimulatorStuffingPattern = GENERATE_RANDOM_CONTENTS ;
   protected: ProtocolSetting mProtocol = CANFD_ISO_PROTOCOL ;
   protected: bool mInverted = false ;
+  protected: std::string mAcceptanceFilter ;
+  protected: std::string mSignalDatabaseFile ;
+  protected: DecodingMode mDecodingMode = FIELD_DECODING_MODE ;
+  protected: ResultOutput mResultOutput = LEGACY_AND_FRAMEV2_RESULTS ;
+  protected: U32 mSimulatorBusLoad = 0 ; // 0: frames are generated back to back, without scheduler
+  protected: U32 mSimulatorNodeCount = 4 ;
+  protected: SimulatorBitTiming mSimulatorBitTiming = INTEGER_BIT_TIMING ;
+  protected: U32 mSimulatorClockTolerance = 0 ; // ppm
+  protected: std::string mSimulatorTraceFile ;
+  protected: std::string mSimulatorErrorInjection ;
+  protected: Channel mExtraBusChannels [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: BusBitTiming mExtraBusBitTimings [CANFD_MAX_BUS_COUNT - 1] ;
+  protected: std::string mGatewayRoutes ;
+  protected: Channel mTxdChannel ;
+  protected: std::string mTraceFile ;
 };
 
 //----------------------------------------------------------------------------------------
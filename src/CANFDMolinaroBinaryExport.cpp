@@ -0,0 +1,173 @@
+#include "CANFDMolinaroBinaryExport.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroBinaryExport::CANFDMolinaroBinaryExport (void) :
+mFileDescriptor (-1),
+mFileSize (0),
+mWindow (nullptr),
+mWindowOffset (0),
+mWindowLength (0),
+mPosition (0),
+mTransitionCount (0),
+mReadTransitionCount (0),
+mBeginTime (0.0),
+mEndTime (0.0),
+mSampleRate (1.0),
+mInitialLevel (true),
+mErrorMessage () {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroBinaryExport::~CANFDMolinaroBinaryExport (void) {
+  close () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroBinaryExport::open (const std::string & inFilePath,
+                                      const U32 inSampleRateHz,
+                                      std::string & outErrorMessage) {
+  close () ;
+  mSampleRate = double (inSampleRateHz) ;
+  mFileDescriptor = ::open (inFilePath.c_str (), O_RDONLY) ;
+  bool ok = mFileDescriptor >= 0 ;
+  if (!ok) {
+    outErrorMessage = "cannot open '" + inFilePath + "'" ;
+  }else{
+    struct stat status ;
+    ok = (fstat (mFileDescriptor, &status) == 0) && (U64 (status.st_size) >= HEADER_SIZE) ;
+    mFileSize = ok ? U64 (status.st_size) : 0 ;
+    ok = ok && mapWindow (0) ;
+    if (!ok) {
+      outErrorMessage = "'" + inFilePath + "' is not a Logic 2 binary export" ;
+    }
+  }
+//--- Header
+  if (ok) {
+    S32 version ;
+    S32 type ;
+    U32 initialState ;
+    memcpy (&version, mWindow + 8, 4) ;
+    memcpy (&type, mWindow + 12, 4) ;
+    memcpy (&initialState, mWindow + 16, 4) ;
+    memcpy (&mBeginTime, mWindow + 20, 8) ;
+    memcpy (&mEndTime, mWindow + 28, 8) ;
+    memcpy (&mTransitionCount, mWindow + 36, 8) ;
+    if ((memcmp (mWindow, "<SALEAE>", 8) != 0) || (version < 0) || (version > 1)) {
+      outErrorMessage = "'" + inFilePath + "' is not a Logic 2 binary export" ;
+      ok = false ;
+    }else if (type != 0) {
+      outErrorMessage = "'" + inFilePath + "' is not a digital channel export" ;
+      ok = false ;
+    }else if (mTransitionCount > ((mFileSize - HEADER_SIZE) / 8)) {
+      outErrorMessage = "'" + inFilePath + "' is truncated" ;
+      ok = false ;
+    }
+    mInitialLevel = initialState != 0 ;
+    mPosition = HEADER_SIZE ;
+    mReadTransitionCount = 0 ;
+  }
+  if (!ok) {
+    close () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBinaryExport::close (void) {
+  unmapWindow () ;
+  if (mFileDescriptor >= 0) {
+    ::close (mFileDescriptor) ;
+    mFileDescriptor = -1 ;
+  }
+  mFileSize = 0 ;
+  mTransitionCount = 0 ;
+  mReadTransitionCount = 0 ;
+  mErrorMessage.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+//  The window starts at the page containing inFileOffset
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroBinaryExport::mapWindow (const U64 inFileOffset) {
+  unmapWindow () ;
+  const U64 pageSize = U64 (sysconf (_SC_PAGESIZE)) ;
+  const U64 offset = inFileOffset - (inFileOffset % pageSize) ;
+  const size_t length = size_t (std::min (U64 (WINDOW_SIZE), mFileSize - offset)) ;
+  void * window = mmap (nullptr, length, PROT_READ, MAP_PRIVATE, mFileDescriptor, off_t (offset)) ;
+  const bool ok = window != MAP_FAILED ;
+  if (ok) {
+    madvise (window, length, MADV_SEQUENTIAL) ;
+    mWindow = static_cast <const U8 *> (window) ;
+    mWindowOffset = offset ;
+    mWindowLength = length ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBinaryExport::unmapWindow (void) {
+  if (mWindow != nullptr) {
+    munmap (const_cast <U8 *> (mWindow), mWindowLength) ;
+    mWindow = nullptr ;
+    mWindowOffset = 0 ;
+    mWindowLength = 0 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroBinaryExport::sampleNumber (const double inTime) const {
+  const double sample = (inTime - mBeginTime) * mSampleRate ;
+  return (sample > 0.0) ? U64 (sample + 0.5) : 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroBinaryExport::endSampleNumber (void) const {
+  return sampleNumber (mEndTime) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+size_t CANFDMolinaroBinaryExport::readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) {
+  size_t count = 0 ;
+  bool ok = mFileDescriptor >= 0 ;
+  while (ok && (count < inMaxCount) && (mReadTransitionCount < mTransitionCount)) {
+    if ((mWindow == nullptr) || ((mPosition + 8) > (mWindowOffset + mWindowLength))) {
+      ok = mapWindow (mPosition) ;
+      if (!ok) {
+        mErrorMessage = "cannot map input file" ;
+      }
+    }
+    if (ok) {
+      const U8 * p = mWindow + (mPosition - mWindowOffset) ;
+      U64 n = (mWindowOffset + mWindowLength - mPosition) / 8 ;
+      n = std::min (n, U64 (inMaxCount - count)) ;
+      n = std::min (n, mTransitionCount - mReadTransitionCount) ;
+      for (U64 i = 0 ; i < n ; i++) {
+        double time ;
+        memcpy (&time, p, 8) ;
+        outEdges.push_back (sampleNumber (time)) ;
+        p += 8 ;
+      }
+      count += size_t (n) ;
+      mPosition += n * 8 ;
+      mReadTransitionCount += n ;
+    }
+  }
+  return count ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,77 @@
+#ifndef CANFDMOLINARO_BINARY_EXPORT_H
+#define CANFDMOLINARO_BINARY_EXPORT_H
+
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroEdgeSource.h"
+
+//----------------------------------------------------------------------------------------
+//  Streaming reader of a Logic 2 binary export of one digital channel (digital_N.bin).
+//  File layout (little endian):
+//
+//    char identifier [8]          "<SALEAE>"
+//    int32 version                0 or 1
+//    int32 type                   0: digital
+//    uint32 initial_state         level at begin_time
+//    double begin_time            s
+//    double end_time              s
+//    uint64 num_transitions
+//    double transition_times [num_transitions]
+//
+//  The file is memory mapped by windows of WINDOW_SIZE bytes, read sequentially, and
+//  every window is unmapped when consumed: memory use does not depend on file size.
+//  Transition times are converted to sample numbers at the given sample rate, sample 0
+//  being begin_time.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroBinaryExport : public CANFDMolinaroEdgeSource {
+  public: CANFDMolinaroBinaryExport (void) ;
+  public: virtual ~CANFDMolinaroBinaryExport (void) ;
+
+//--- Returns false and sets outErrorMessage if the file is not a digital binary export
+  public: bool open (const std::string & inFilePath,
+                     const U32 inSampleRateHz,
+                     std::string & outErrorMessage) ;
+
+  public: void close (void) ;
+
+  public: inline double beginTime (void) const { return mBeginTime ; }
+  public: inline U64 transitionCount (void) const { return mTransitionCount ; }
+
+//--- Edge source
+  public: virtual bool initialLevel (void) const { return mInitialLevel ; }
+  public: virtual size_t readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) ;
+  public: virtual U64 endSampleNumber (void) const ;
+  public: virtual const std::string & errorMessage (void) const { return mErrorMessage ; }
+  public: virtual U64 fileSize (void) const { return mFileSize ; }
+
+//--- Private methods
+  private: bool mapWindow (const U64 inFileOffset) ;
+  private: void unmapWindow (void) ;
+  private: U64 sampleNumber (const double inTime) const ;
+
+//--- Private properties
+  private: static const size_t WINDOW_SIZE = 16 * 1024 * 1024 ;
+  private: static const U64 HEADER_SIZE = 44 ;
+  private: int mFileDescriptor ;
+  private: U64 mFileSize ;
+  private: const U8 * mWindow ;
+  private: U64 mWindowOffset ; // File offset of mWindow [0]
+  private: size_t mWindowLength ;
+  private: U64 mPosition ; // File offset of next transition
+  private: U64 mTransitionCount ;
+  private: U64 mReadTransitionCount ;
+  private: double mBeginTime ;
+  private: double mEndTime ;
+  private: double mSampleRate ;
+  private: bool mInitialLevel ;
+  private: std::string mErrorMessage ;
+
+//--- No copy
+  private: CANFDMolinaroBinaryExport (const CANFDMolinaroBinaryExport &) = delete ;
+  private: CANFDMolinaroBinaryExport & operator = (const CANFDMolinaroBinaryExport &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_BINARY_EXPORT_H
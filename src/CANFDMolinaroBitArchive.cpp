@@ -0,0 +1,138 @@
+#include "CANFDMolinaroBitArchive.h"
+#include "CANFDMolinaroFrameDecoder.h"
+
+#include <algorithm>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroBitArchive::CANFDMolinaroBitArchive (void) :
+mBits (),
+mBitCount (0),
+mFrames (),
+mMutex () {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBitArchive::clear (void) {
+  mBits.clear () ;
+  mBitCount = 0 ;
+  mFrames.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBitArchive::beginFrame (const U64 inStartSampleNumber) {
+  const FrameRecord frame = { inStartSampleNumber, mBitCount, 0, 0, 0 } ;
+  mFrames.push_back (frame) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBitArchive::bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) {
+  FrameRecord & frame = mFrames.back () ;
+  const U32 offset = U32 (inSampleNumber - frame.mStartSampleNumber) ;
+  if (inDataBitRate) {
+    frame.mDataPhaseOffset = offset ;
+  }else{
+    frame.mArbitrationPhaseOffset = offset ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBitArchive::truncate (const U64 inSampleNumber) {
+  const auto it = std::lower_bound (mFrames.begin (), mFrames.end (), inSampleNumber,
+                                    [] (const FrameRecord & inFrame, const U64 inValue) {
+                                      return inFrame.mStartSampleNumber < inValue ;
+                                    }) ;
+  if (it != mFrames.end ()) {
+    mBitCount = it->mFirstBit ;
+    mBits.resize ((mBitCount + 63) / 64) ;
+    if ((mBitCount % 64) != 0) { // Clear bits after the last kept bit
+      mBits.back () &= (U64 (1) << (mBitCount % 64)) - 1 ;
+    }
+    mFrames.erase (it, mFrames.end ()) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  REPLAY
+//----------------------------------------------------------------------------------------
+
+class ReplayOutput : public CANFDMolinaroDecoderOutput {
+  public: ReplayOutput (CANFDMolinaroDecoderOutput & inOutput) :
+  mOutput (inOutput),
+  mSwitched (false),
+  mDataBitRate (false) {
+  }
+
+  public: virtual void decoderMark (const U64 inSampleNumber,
+                                    const AnalyzerResults::MarkerType inMarker) {
+    mOutput.decoderMark (inSampleNumber, inMarker) ;
+  }
+
+  public: virtual void decoderBubble (const U8 inBubbleType,
+                                      const U64 inData1,
+                                      const U64 inData2,
+                                      const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber) {
+    mOutput.decoderBubble (inBubbleType, inData1, inData2, inStartSampleNumber, inEndSampleNumber) ;
+  }
+
+  public: virtual void frameReceived (const CANFDMolinaroFrameDecoder & inDecoder,
+                                      const U64 inEndSampleNumber) {
+    mOutput.frameReceived (inDecoder, inEndSampleNumber) ;
+  }
+
+  public: virtual void frameError (void) {
+    mOutput.frameError () ;
+  }
+
+  public: virtual void bitRateSwitch (const U64 /* inSampleNumber */, const bool inDataBitRate) {
+    mSwitched = true ;
+    mDataBitRate = inDataBitRate ;
+  }
+
+  public: CANFDMolinaroDecoderOutput & mOutput ;
+  public: bool mSwitched ;
+  public: bool mDataBitRate ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBitArchive::replayFrame (const U32 inIndex,
+                                           CANFDMolinaroFrameDecoder & ioDecoder,
+                                           CANFDMolinaroDecoderOutput & ioOutput) const {
+  const FrameRecord & frame = mFrames [inIndex] ;
+  const double arbitrationBitDuration = double (ioDecoder.sampleRateHz ()) / double (ioDecoder.arbitrationBitRate ()) ;
+  const double dataBitDuration = double (ioDecoder.sampleRateHz ()) / double (ioDecoder.dataBitRate ()) ;
+  ReplayOutput output (ioOutput) ;
+  ioDecoder.setOutput (&output) ;
+  ioDecoder.reset (true) ;
+//--- Bit centers are computed from the start of current phase, without rounding accumulation
+  double phaseStart = double (frame.mStartSampleNumber) ;
+  double bitDuration = arbitrationBitDuration ;
+  U32 bitIndexInPhase = 0 ;
+  U32 samplesPerBit = ioDecoder.currentSamplesPerBit () ;
+  for (U32 i=0 ; i<frame.mBitCount ; i++) {
+    U64 bitCenter = U64 (phaseStart + (bitIndexInPhase + 0.5) * bitDuration) ;
+    ioDecoder.enterBit (bit (frame.mFirstBit + i), bitCenter) ;
+    bitIndexInPhase += 1 ;
+    if (output.mSwitched) { // BRS or CRC DEL: use recorded timing point
+      output.mSwitched = false ;
+      phaseStart = double (frame.mStartSampleNumber)
+        + (output.mDataBitRate ? frame.mDataPhaseOffset : frame.mArbitrationPhaseOffset) ;
+      bitDuration = output.mDataBitRate ? dataBitDuration : arbitrationBitDuration ;
+      bitIndexInPhase = 0 ;
+    }else if (ioDecoder.currentSamplesPerBit () != samplesPerBit) { // Error at data bit rate
+      phaseStart += bitIndexInPhase * bitDuration ;
+      bitDuration = arbitrationBitDuration ;
+      bitIndexInPhase = 0 ;
+    }
+    samplesPerBit = ioDecoder.currentSamplesPerBit () ;
+  }
+  ioDecoder.setOutput (&ioOutput) ;
+}
+
+//----------------------------------------------------------------------------------------
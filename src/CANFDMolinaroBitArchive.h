@@ -0,0 +1,75 @@
+#ifndef CANFDMOLINARO_BIT_ARCHIVE_H
+#define CANFDMOLINARO_BIT_ARCHIVE_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <mutex>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroFrameDecoder ;
+class CANFDMolinaroDecoderOutput ;
+
+//----------------------------------------------------------------------------------------
+//  Raw bit archive: every frame is stored as the sequence of its sampled bits (stuff bits
+//  included, from SOF up to the end of intermission or error), packed in 64-bit words,
+//  with the timing points of the bit rate switches. Markers and field bubbles of a frame
+//  are rebuilt on demand by replaying its bits in a decoder.
+//
+//  Frames are appended by the decoder thread; readers should lock mutex () while reading.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroBitArchive {
+  public: CANFDMolinaroBitArchive (void) ;
+
+  public: typedef struct {
+    U64 mStartSampleNumber ; // SOF edge
+    U64 mFirstBit ;
+    U32 mBitCount ;
+    U32 mDataPhaseOffset ; // From mStartSampleNumber, 0 if no data bit rate phase
+    U32 mArbitrationPhaseOffset ; // From mStartSampleNumber, start of bits after CRC DEL
+  } FrameRecord ;
+
+  public: void clear (void) ;
+
+//--- Recording
+  public: void beginFrame (const U64 inStartSampleNumber) ;
+  public: inline void appendBit (const bool inBit) {
+    if ((mBitCount % 64) == 0) {
+      mBits.push_back (0) ;
+    }
+    mBits.back () |= U64 (inBit) << (mBitCount % 64) ;
+    mBitCount += 1 ;
+    mFrames.back ().mBitCount += 1 ;
+  }
+  public: void bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) ;
+
+//--- Removes frames starting at or after inSampleNumber
+  public: void truncate (const U64 inSampleNumber) ;
+
+//--- Accessors
+  public: inline U32 frameCount (void) const { return U32 (mFrames.size ()) ; }
+  public: inline const FrameRecord & frame (const U32 inIndex) const { return mFrames [inIndex] ; }
+  public: inline bool bit (const U64 inBitIndex) const { return ((mBits [inBitIndex / 64] >> (inBitIndex % 64)) & 1) != 0 ; }
+  public: inline U64 bitCount (void) const { return mBitCount ; }
+
+//--- Feeds the bits of a frame into ioDecoder (whose output should be ioOutput), with
+//    bit centers computed from the frame timing points. The decoder is reset first.
+  public: void replayFrame (const U32 inIndex,
+                            CANFDMolinaroFrameDecoder & ioDecoder,
+                            CANFDMolinaroDecoderOutput & ioOutput) const ;
+
+  public: inline std::mutex & mutex (void) { return mMutex ; }
+
+//--- Private properties
+  private: std::vector <U64> mBits ;
+  private: U64 mBitCount ;
+  private: std::vector <FrameRecord> mFrames ;
+  private: std::mutex mMutex ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_BIT_ARCHIVE_H
@@ -0,0 +1,322 @@
+#include "CANFDMolinaroBusDecoder.h"
+#include "CANFDMolinaroFrameStore.h"
+#include <algorithm>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroBusDecoder::CANFDMolinaroBusDecoder (void) :
+mMarkers (),
+mBubbles (),
+mFrameRecords (),
+mSnapshots (),
+mSnapshotInterval (0),
+mForwardOutput (nullptr),
+mDecoder (),
+mAcceptanceFilter (),
+mFilterDecision (FilterDecision::FILTER_ACCEPTED),
+mPendingMarkers (),
+mPendingBubbles (),
+mLevel (true),
+mCurrentCenter (0),
+mEndSampleNumber (0) {
+  mDecoder.setOutput (this) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::configure (const CANFDMolinaroAnalyzerSettings & inSettings,
+                                         const U32 inBus,
+                                         const U32 inSampleRateHz) {
+  mDecoder.configure (inSettings, inBus, inSampleRateHz) ;
+  std::string errorMessage ; // Already checked by settings
+  mAcceptanceFilter.compile (inSettings.acceptanceFilter (), errorMessage) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::reset (const bool inBusLevel, const U64 inSampleNumber) {
+  mDecoder.reset (inBusLevel) ;
+  mFilterDecision = FilterDecision::FILTER_ACCEPTED ;
+  mPendingMarkers.clear () ;
+  mPendingBubbles.clear () ;
+  mMarkers.clear () ;
+  mBubbles.clear () ;
+  mFrameRecords.clear () ;
+  mSnapshots.clear () ;
+  mLevel = inBusLevel ;
+  mCurrentCenter = inSampleNumber + mDecoder.currentSamplesPerBit () / 2 ;
+  mEndSampleNumber = inSampleNumber ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Bit centers are computed as in single bus decoding: the first center is half a bit
+//  after an edge (or resynchronized by the decoder in data phase, with Data Phase SJW),
+//  and the following ones are a bit apart until the next edge.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::decodeBlock (const std::vector <U64> & inEdges,
+                                           const U64 inEndSampleNumber) {
+  for (const U64 edge : inEdges) {
+    while (mCurrentCenter < edge) {
+      mDecoder.enterBit (mLevel, mCurrentCenter) ;
+      mCurrentCenter += mDecoder.currentSamplesPerBit () ;
+    }
+    mLevel ^= true ;
+    mCurrentCenter = mDecoder.resynchronize (edge, mCurrentCenter, !mLevel) ;
+  }
+  while (mCurrentCenter <= inEndSampleNumber) {
+    mDecoder.enterBit (mLevel, mCurrentCenter) ;
+    mCurrentCenter += mDecoder.currentSamplesPerBit () ;
+  }
+  mEndSampleNumber = inEndSampleNumber ;
+}
+
+//----------------------------------------------------------------------------------------
+//  A snapshot is taken at SOF, whose bit is dominant and centered half a bit after the
+//  snapshot sample: decoding resumes from there, with the edges after it.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::resume (const Snapshot & inSnapshot) {
+  const U64 sampleNumber = inSnapshot.mDecoderSnapshot.mSampleNumber ;
+  reset (false, sampleNumber) ;
+  mDecoder.restoreSnapshot (inSnapshot.mDecoderSnapshot) ;
+  for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+    mDecoder.setCounter (CANFDMolinaroDecoderCounters::Counter (i), inSnapshot.mCounterValues [i]) ;
+  }
+  mCurrentCenter = sampleNumber + mDecoder.currentSamplesPerBit () / 2 ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Within a frame, every result starts at or after SOF; while the bus is idle, the next
+//  SOF is after the end of the last decoded block. A bus that stays busy longer than the
+//  longest frame (stuck dominant, error frame never ended, channel cut in a frame) would
+//  hold the merge of every bus: the watermark is at most the duration of the longest
+//  frame, at arbitration bit rate, before the end of the last decoded block. Results of
+//  such a bus released later may be merged out of order.
+//----------------------------------------------------------------------------------------
+
+static const U64 LONGEST_FRAME_BITS = 20 * 1000 ; // CAN XL, 2048 data bytes, stuff bits included
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroBusDecoder::watermark (void) const {
+  U64 result = mEndSampleNumber + 1 ;
+  if (!mDecoder.isIdle ()) {
+    const U64 longestFrame = LONGEST_FRAME_BITS * mDecoder.samplesPerArbitrationBit () ;
+    const U64 lowest = (result > longestFrame) ? (result - longestFrame) : 0 ;
+    result = std::max (mDecoder.startOfFrameSampleNumber (), lowest) ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+//  DECODER OUTPUT
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::decoderMark (const U64 inSampleNumber,
+                                           const AnalyzerResults::MarkerType inMarker) {
+  const Marker marker = { inSampleNumber, inMarker } ;
+  switch (mFilterDecision) {
+  case FilterDecision::FILTER_ACCEPTED :
+    if (mForwardOutput != nullptr) {
+      mForwardOutput->decoderMark (inSampleNumber, inMarker) ;
+    }else{
+      mMarkers.push_back (marker) ;
+    }
+    break ;
+  case FilterDecision::FILTER_PENDING :
+  case FilterDecision::FILTER_REJECTED : // Released if the frame gets an error
+    mPendingMarkers.push_back (marker) ;
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::decoderBubble (const U8 inBubbleType,
+                                             const U64 inData1,
+                                             const U64 inData2,
+                                             const U64 inStartSampleNumber,
+                                             const U64 inEndSampleNumber) {
+  const Bubble bubble = { inStartSampleNumber, inEndSampleNumber, inData1, inData2, inBubbleType } ;
+  switch (mFilterDecision) {
+  case FilterDecision::FILTER_ACCEPTED :
+    if (mForwardOutput != nullptr) {
+      mForwardOutput->decoderBubble (inBubbleType, inData1, inData2, inStartSampleNumber, inEndSampleNumber) ;
+    }else{
+      mBubbles.push_back (bubble) ;
+    }
+    break ;
+  case FilterDecision::FILTER_PENDING :
+  case FilterDecision::FILTER_REJECTED : // Released if the frame gets an error
+    mPendingBubbles.push_back (bubble) ;
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::busIdleBit (void) {
+  mFilterDecision = FilterDecision::FILTER_ACCEPTED ;
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->busIdleBit () ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::startOfFrame (const CANFDMolinaroFrameDecoder & inDecoder,
+                                            const U64 inSampleNumber) {
+  mFilterDecision = mAcceptanceFilter.isEmpty ()
+    ? FilterDecision::FILTER_ACCEPTED
+    : FilterDecision::FILTER_PENDING ;
+  mPendingMarkers.clear () ;
+  mPendingBubbles.clear () ;
+  if ((mSnapshotInterval > 0) && ((inDecoder.frameIndex () % mSnapshotInterval) == 0)) {
+    Snapshot snapshot ;
+    snapshot.mDecoderSnapshot = inDecoder.takeSnapshot (inSampleNumber) ;
+    for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+      snapshot.mCounterValues [i] = inDecoder.counters ().value (CANFDMolinaroDecoderCounters::Counter (i)) ;
+    }
+    snapshot.mCounterValues [CANFDMolinaroDecoderCounters::ARBITRATION_BITS] -= 1 ; // SOF bit is decoded again
+    snapshot.mFrameRecordCount = mFrameRecords.size () ;
+    mSnapshots.push_back (snapshot) ;
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->startOfFrame (inDecoder, inSampleNumber) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::frameHeaderDecoded (const CANFDMolinaroFrameDecoder & inDecoder,
+                                                  const bool inFDF) {
+  if (mFilterDecision == FilterDecision::FILTER_PENDING) {
+    const bool accepted = mAcceptanceFilter.acceptsHeader (inDecoder.identifier (),
+                                                           inDecoder.isExtended (),
+                                                           inFDF) ;
+    if (!accepted) {
+      mFilterDecision = FilterDecision::FILTER_REJECTED ;
+    }else if (!mAcceptanceFilter.needsPayload ()) {
+      flushPendingResults () ;
+    }
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->frameHeaderDecoded (inDecoder, inFDF) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::framePayloadDecoded (const CANFDMolinaroFrameDecoder & inDecoder) {
+  if (mFilterDecision == FilterDecision::FILTER_PENDING) {
+    if (mAcceptanceFilter.acceptsPayload (inDecoder.data (), inDecoder.dataLength ())) {
+      flushPendingResults () ;
+    }else{
+      mFilterDecision = FilterDecision::FILTER_REJECTED ;
+    }
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->framePayloadDecoded (inDecoder) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::frameError (void) {
+  if (mFilterDecision != FilterDecision::FILTER_ACCEPTED) { // Erroneous frames are always displayed
+    flushPendingResults () ;
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->frameError () ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Forwarded markers are released before bubbles, so that they are committed with them
+
+void CANFDMolinaroBusDecoder::flushPendingResults (void) {
+  mFilterDecision = FilterDecision::FILTER_ACCEPTED ;
+  if (mForwardOutput != nullptr) {
+    for (const Marker & marker : mPendingMarkers) {
+      mForwardOutput->decoderMark (marker.mSampleNumber, marker.mType) ;
+    }
+    for (const Bubble & bubble : mPendingBubbles) {
+      mForwardOutput->decoderBubble (bubble.mType, bubble.mData1, bubble.mData2,
+                                     bubble.mStartSampleNumber, bubble.mEndSampleNumber) ;
+    }
+  }else{
+    mMarkers.insert (mMarkers.end (), mPendingMarkers.begin (), mPendingMarkers.end ()) ;
+    mBubbles.insert (mBubbles.end (), mPendingBubbles.begin (), mPendingBubbles.end ()) ;
+  }
+  mPendingMarkers.clear () ;
+  mPendingBubbles.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U8 CANFDMolinaroBusDecoder::frameFlags (const CANFDMolinaroFrameDecoder & inDecoder) {
+  U8 flags = 0 ;
+  if (inDecoder.isExtended ()) {
+    flags |= CANFDMolinaroFrameStore::EXTENDED_FLAG ;
+  }
+  if (inDecoder.isCANXL ()) {
+    flags |= CANFDMolinaroFrameStore::CANXL_FLAG ;
+  }else if (inDecoder.isCANFD ()) {
+    flags |= CANFDMolinaroFrameStore::CANFD_FLAG ;
+    flags |= inDecoder.BRS () ? CANFDMolinaroFrameStore::BRS_FLAG : 0 ;
+    flags |= inDecoder.ESI () ? CANFDMolinaroFrameStore::ESI_FLAG : 0 ;
+  }else if (inDecoder.isRemote ()) {
+    flags |= CANFDMolinaroFrameStore::REMOTE_FLAG ;
+  }
+  flags |= inDecoder.crcIsValid () ? 0 : CANFDMolinaroFrameStore::CRC_ERROR_FLAG ;
+  flags |= inDecoder.ackSlotIsRecessive () ? CANFDMolinaroFrameStore::NAK_FLAG : 0 ;
+  return flags ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::frameReceived (const CANFDMolinaroFrameDecoder & inDecoder,
+                                             const U64 inEndSampleNumber) {
+  if (!inDecoder.crcIsValid () && (mFilterDecision != FilterDecision::FILTER_ACCEPTED)) { // CRC error
+    flushPendingResults () ;
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->frameReceived (inDecoder, inEndSampleNumber) ;
+  }else if (mFilterDecision == FilterDecision::FILTER_ACCEPTED) {
+    FrameRecord record ;
+    record.mStartSampleNumber = inDecoder.startOfFrameSampleNumber () ;
+    record.mEndSampleNumber = inEndSampleNumber ;
+    record.mIdentifier = inDecoder.identifier () ;
+    record.mFlags = frameFlags (inDecoder) ;
+    record.mDataCodeLength = U16 (inDecoder.dataCodeLength ()) ;
+    record.mData.assign (inDecoder.data (), inDecoder.data () + inDecoder.dataLength ()) ;
+    record.mServiceDataUnitType = U8 (inDecoder.serviceDataUnitType ()) ;
+    record.mVirtualCANNetworkIdentifier = U8 (inDecoder.virtualCANNetworkIdentifier ()) ;
+    record.mSEC = inDecoder.SEC () ;
+    record.mAcceptanceField = inDecoder.acceptanceField () ;
+    mFrameRecords.push_back (record) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) {
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->bitRateSwitch (inSampleNumber, inDataBitRate) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroBusDecoder::endOfFrame (const U64 inEndSampleNumber) {
+  if (mFilterDecision == FilterDecision::FILTER_REJECTED) { // Rejected frame without error
+    mPendingMarkers.clear () ;
+    mPendingBubbles.clear () ;
+  }
+  if (mForwardOutput != nullptr) {
+    mForwardOutput->endOfFrame (inEndSampleNumber) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
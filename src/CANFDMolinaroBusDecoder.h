@@ -0,0 +1,146 @@
+#ifndef CANFDMOLINARO_BUS_DECODER_H
+#define CANFDMOLINARO_BUS_DECODER_H
+
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroFrameDecoder.h"
+#include "CANFDMolinaroAcceptanceFilter.h"
+#include <deque>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Decoder of one bus, with the acceptance filter: results of a frame are buffered until
+//  the filter decides. Results of a rejected frame are kept until its end, and released
+//  if it gets an error (erroneous frames are always displayed). It does not call the SDK.
+//
+//  By default, released results are queued: in multi-bus decoding, the analyzer thread
+//  reads edge blocks from the bus channel, a worker thread decodes them, and the analyzer
+//  thread merges the released results of all buses in time order. Released bubbles and
+//  frame records are sorted by start sample; every future result starts at or after
+//  watermark (), unless its frame lasts longer than the longest valid frame.
+//
+//  With a forward output (single bus decoding), the caller enters bits in the frame
+//  decoder; released markers and bubbles, and all frame events, are forwarded to it.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroBusDecoder : public CANFDMolinaroDecoderOutput {
+  public: CANFDMolinaroBusDecoder (void) ;
+
+  public: void configure (const CANFDMolinaroAnalyzerSettings & inSettings,
+                          const U32 inBus,
+                          const U32 inSampleRateHz) ;
+
+//--- inBusLevel is the (not inverted) bus level at inSampleNumber
+  public: void reset (const bool inBusLevel, const U64 inSampleNumber) ;
+
+//--- Decodes bus level changes: inEdges are the edges in the block
+//    (previous block end, inEndSampleNumber], in increasing order
+  public: void decodeBlock (const std::vector <U64> & inEdges, const U64 inEndSampleNumber) ;
+
+  public: U64 watermark (void) const ;
+
+//--- Snapshots of queued decoding: one is taken every inFrameCount SOF (0, default: none),
+//    with the decoder counters and the count of frame records queued before the frame.
+//    After resume (), the next decoded block begins after the snapshot sample.
+  public: typedef struct {
+    CANFDMolinaroDecoderSnapshot mDecoderSnapshot ;
+    U64 mCounterValues [CANFDMolinaroDecoderCounters::COUNTER_COUNT] ;
+    size_t mFrameRecordCount ;
+  } Snapshot ;
+  public: inline void setSnapshotInterval (const U32 inFrameCount) { mSnapshotInterval = inFrameCount ; }
+  public: inline std::deque <Snapshot> & snapshots (void) { return mSnapshots ; }
+  public: void resume (const Snapshot & inSnapshot) ;
+
+  public: inline const CANFDMolinaroDecoderCounters & counters (void) const { return mDecoder.counters () ; }
+
+//--- Markers are released by default (frame level consumers disable them)
+  public: inline void setMarkerOutput (const bool inEnabled) { mDecoder.setMarkerOutput (inEnabled) ; }
+
+//--- Forward output (nullptr: results are queued)
+  public: inline void setForwardOutput (CANFDMolinaroDecoderOutput * inOutput) { mForwardOutput = inOutput ; }
+
+  public: inline CANFDMolinaroFrameDecoder & frameDecoder (void) { return mDecoder ; }
+
+//--- Current frame is rejected by the acceptance filter (valid from frame header, or
+//    payload if the filter tests it)
+  public: inline bool frameIsRejected (void) const { return mFilterDecision == FilterDecision::FILTER_REJECTED ; }
+
+//--- CANFDMolinaroFrameStore flags of the frame being received
+  public: static U8 frameFlags (const CANFDMolinaroFrameDecoder & inDecoder) ;
+
+//--- Released results
+  public: typedef struct {
+    U64 mSampleNumber ;
+    AnalyzerResults::MarkerType mType ;
+  } Marker ;
+
+  public: typedef struct {
+    U64 mStartSampleNumber ;
+    U64 mEndSampleNumber ;
+    U64 mData1 ;
+    U64 mData2 ;
+    U8 mType ;
+  } Bubble ;
+
+  public: typedef struct {
+    U64 mStartSampleNumber ;
+    U64 mEndSampleNumber ;
+    U32 mIdentifier ;
+    U8 mFlags ; // CANFDMolinaroFrameStore flags
+    U16 mDataCodeLength ;
+    std::vector <U8> mData ; // Payload, data length bytes
+    U8 mServiceDataUnitType ; // CAN XL
+    U8 mVirtualCANNetworkIdentifier ; // CAN XL
+    bool mSEC ; // CAN XL
+    U32 mAcceptanceField ; // CAN XL
+  } FrameRecord ;
+
+//--- Queued results, consumed by the caller
+  public: inline std::deque <Marker> & markers (void) { return mMarkers ; }
+  public: inline std::deque <Bubble> & bubbles (void) { return mBubbles ; }
+  public: inline std::deque <FrameRecord> & frameRecords (void) { return mFrameRecords ; }
+
+//---------------- Decoder output
+  public: virtual void decoderMark (const U64 inSampleNumber,
+                                    const AnalyzerResults::MarkerType inMarker) ;
+  public: virtual void decoderBubble (const U8 inBubbleType,
+                                      const U64 inData1,
+                                      const U64 inData2,
+                                      const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber) ;
+  public: virtual void busIdleBit (void) ;
+  public: virtual void startOfFrame (const CANFDMolinaroFrameDecoder & inDecoder,
+                                     const U64 inSampleNumber) ;
+  public: virtual void frameHeaderDecoded (const CANFDMolinaroFrameDecoder & inDecoder,
+                                           const bool inFDF) ;
+  public: virtual void framePayloadDecoded (const CANFDMolinaroFrameDecoder & inDecoder) ;
+  public: virtual void frameReceived (const CANFDMolinaroFrameDecoder & inDecoder,
+                                      const U64 inEndSampleNumber) ;
+  public: virtual void frameError (void) ;
+  public: virtual void bitRateSwitch (const U64 inSampleNumber, const bool inDataBitRate) ;
+  public: virtual void endOfFrame (const U64 inEndSampleNumber) ;
+
+//--- Private methods
+  private: void flushPendingResults (void) ;
+
+//--- Private properties
+  private: std::deque <Marker> mMarkers ;
+  private: std::deque <Bubble> mBubbles ;
+  private: std::deque <FrameRecord> mFrameRecords ;
+  private: std::deque <Snapshot> mSnapshots ;
+  private: U32 mSnapshotInterval ;
+  private: CANFDMolinaroDecoderOutput * mForwardOutput ;
+  private: CANFDMolinaroFrameDecoder mDecoder ;
+  private: CANFDMolinaroAcceptanceFilter mAcceptanceFilter ;
+  private: typedef enum {FILTER_ACCEPTED, FILTER_PENDING, FILTER_REJECTED} FilterDecision ;
+  private: FilterDecision mFilterDecision ;
+  private: std::vector <Marker> mPendingMarkers ;
+  private: std::vector <Bubble> mPendingBubbles ;
+  private: bool mLevel ;
+  private: U64 mCurrentCenter ;
+  private: U64 mEndSampleNumber ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_BUS_DECODER_H
@@ -0,0 +1,1049 @@
+//----------------------------------------------------------------------------------------
+//  canfd-decode: offline decoder of capture files (Logic 2 binary digital exports, VCD
+//  files, sigrok session files), with the decoding logic of the analyzer (multi-bus
+//  decoding bus decoder). Frames are written as CSV (simulator trace file format) and
+//  pcapng; a frame summary is printed at end. In batch mode, the files of a directory
+//  or of a list are decoded in parallel, and their summaries are merged. A single file
+//  decoding can write checkpoints, and be resumed from the last one.
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroAnalyzerSettings.h"
+#include "CANFDMolinaroAcceptanceFilter.h"
+#include "CANFDMolinaroBinaryExport.h"
+#include "CANFDMolinaroBusDecoder.h"
+#include "CANFDMolinaroFrameStore.h"
+#include "CANFDMolinaroPcapngWriter.h"
+#include "CANFDMolinaroSigrokSession.h"
+#include "CANFDMolinaroVCDReader.h"
+#include "CANFDMolinaroWorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------------------
+//  Settings are the analyzer settings: a saved settings string is loaded first, then
+//  command line flags override it
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroCommandLineSettings : public CANFDMolinaroAnalyzerSettings {
+  public: void setArbitrationBitRate (const U32 inValue) { mArbitrationBitRate = inValue ; }
+  public: void setDataBitRate (const U32 inValue) { mDataBitRate = inValue ; }
+  public: void setArbitrationSamplePoint (const U32 inValue) { mArbitrationSamplePoint = inValue ; }
+  public: void setDataSamplePoint (const U32 inValue) { mDataSamplePoint = inValue ; }
+  public: void setDataPhaseSJW (const U32 inValue) { mDataPhaseSJW = inValue ; }
+  public: void setProtocol (const ProtocolSetting inValue) { mProtocol = inValue ; }
+  public: void setInverted (const bool inValue) { mInverted = inValue ; }
+  public: void setAcceptanceFilter (const std::string & inValue) { mAcceptanceFilter = inValue ; }
+} ;
+
+//----------------------------------------------------------------------------------------
+
+static const U32 DEFAULT_SAMPLE_RATE_HZ = 1000 * 1000 * 1000 ;
+static const size_t EDGE_BLOCK_SIZE = 64 * 1024 ;
+
+//--- Batch mode: a job is estimated to use JOB_MEMORY_BYTES (input buffer, edge block,
+//    decoder results); the memory budget caps the job count. Memory is not measured: an
+//    oversized VCD line or sigrok chunk makes a job use more
+static const U64 JOB_MEMORY_BYTES = 24 * 1024 * 1024 ;
+
+//--- Checkpoints are written every DEFAULT_CHECKPOINT_INTERVAL frames by default
+static const U32 DEFAULT_CHECKPOINT_INTERVAL = 100 * 1000 ;
+
+//----------------------------------------------------------------------------------------
+
+static void printUsage (const char * inProgramName) {
+  fprintf (stderr,
+    "Usage: %s [options] <digital_N.bin | file.vcd | file.sr>\n"
+    "       %s [options] --batch <directory | list file> [--output-dir <directory>]\n"
+    "Decodes a CAN signal of a Logic 2 binary export, a VCD file or a sigrok session.\n"
+    "  --signal <name>                  VCD variable, or sigrok probe name or number\n"
+    "  --settings <string>              saved analyzer settings (LoadSettings format)\n"
+    "  --settings-file <path>           file containing saved analyzer settings\n"
+    "  --arbitration-bit-rate <bit/s>   default 125000\n"
+    "  --data-bit-rate <bit/s>          default 500000\n"
+    "  --arbitration-sample-point <%%>   50 to 90, default 75\n"
+    "  --data-sample-point <%%>          50 to 90, default 75\n"
+    "  --data-sjw <%%>                   0 to 50, default 0\n"
+    "  --protocol iso|non-iso|xl        default iso\n"
+    "  --inverted                       dominant level is high\n"
+    "  --filter <acceptance filter>     analyzer Acceptance Filter syntax\n"
+    "  --sample-rate <Hz>               timestamp conversion rate, default %u\n"
+    "  --csv <path>                     write frames as CSV\n"
+    "  --pcapng <path>                  write frames as pcapng (LINKTYPE_CAN_SOCKETCAN)\n"
+    "  --checkpoint <path>              write a checkpoint every checkpoint interval\n"
+    "  --checkpoint-interval <frames>   default %u\n"
+    "  --resume                         resume from the checkpoint, if it exists\n"
+    "Batch mode:\n"
+    "  --batch <directory | list file>  decode the .bin, .vcd, .sr files of a directory,\n"
+    "                                   or the files of a list (one path per line)\n"
+    "  --output-dir <directory>         write <file>.csv, <file>.pcapng, <file>.txt\n"
+    "  --jobs <count>                   files decoded in parallel, default %u\n"
+    "  --max-jobs-by-memory <MiB>       at most <MiB> / %u jobs (%u MiB: estimate per job)\n",
+    inProgramName,
+    inProgramName,
+    DEFAULT_SAMPLE_RATE_HZ,
+    DEFAULT_CHECKPOINT_INTERVAL,
+    std::max (1U, std::thread::hardware_concurrency ()),
+    U32 (JOB_MEMORY_BYTES / (1024 * 1024)),
+    U32 (JOB_MEMORY_BYTES / (1024 * 1024))) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool parseUnsigned (const char * inString, U32 & outValue) {
+  char * end = nullptr ;
+  const unsigned long long value = strtoull (inString, &end, 10) ;
+  const bool ok = (*inString != '\0') && (*end == '\0') && (value <= 0xFFFFFFFFULL) ;
+  if (ok) {
+    outValue = U32 (value) ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Timestamps are exact: seconds since capture start, and nanoseconds
+//----------------------------------------------------------------------------------------
+
+static U64 timestampNs (const U64 inSampleNumber, const U32 inSampleRateHz) {
+  return (inSampleNumber / inSampleRateHz) * 1000000000
+    + ((inSampleNumber % inSampleRateHz) * 1000000000) / inSampleRateHz ;
+}
+
+//----------------------------------------------------------------------------------------
+//  CSV line: timestamp, identifier, flags, payload (or DLC of a remote frame), as read
+//  by the simulator trace reader. CAN XL frames have the L flag (skipped by the reader).
+
+static void writeCSVLine (FILE * inFile,
+                          const CANFDMolinaroBusDecoder::FrameRecord & inFrame,
+                          const U64 inTimestampNs) {
+  const bool extended = (inFrame.mFlags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0 ;
+  char flags [8] ;
+  U32 idx = 0 ;
+  if (extended) { flags [idx++] = 'X' ; }
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0) { flags [idx++] = 'R' ; }
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::CANFD_FLAG) != 0) { flags [idx++] = 'F' ; }
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::BRS_FLAG) != 0) { flags [idx++] = 'B' ; }
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::ESI_FLAG) != 0) { flags [idx++] = 'E' ; }
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::CANXL_FLAG) != 0) { flags [idx++] = 'L' ; }
+  flags [idx] = '\0' ;
+  fprintf (inFile, "%llu.%09llu,0x%0*X,%s,",
+           (unsigned long long) (inTimestampNs / 1000000000),
+           (unsigned long long) (inTimestampNs % 1000000000),
+           extended ? 8 : 3,
+           inFrame.mIdentifier,
+           flags) ;
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0) {
+    fprintf (inFile, "%u\n", U32 (inFrame.mDataCodeLength)) ;
+  }else{
+    static const char HEX [] = "0123456789ABCDEF" ;
+    std::string payload ;
+    payload.reserve (inFrame.mData.size () * 3) ;
+    for (const U8 byte : inFrame.mData) {
+      if (payload.length () > 0) {
+        payload += ' ' ;
+      }
+      payload += HEX [byte >> 4] ;
+      payload += HEX [byte & 15] ;
+    }
+    fprintf (inFile, "%s\n", payload.c_str ()) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Frame summary, by identifier (CRC errors excluded). The period is the mean interval
+//  between consecutive frames of a file, so summaries of several files can be merged.
+//----------------------------------------------------------------------------------------
+
+typedef struct {
+  U64 mCount ;
+  U64 mIntervalCount ;
+  U64 mIntervalSampleCount ; // Sum of intervals
+  U64 mLastSampleNumber ;
+  U32 mMinimumLength ;
+  U32 mMaximumLength ;
+} IdentifierSummary ;
+
+typedef std::map <U64, IdentifierSummary> SummaryMap ; // Key: identifier | extended << 32 | XL << 33
+
+//----------------------------------------------------------------------------------------
+//  A write error of an output (disk full, I/O error) fails the run
+
+static bool outputsAreWritten (FILE * inCSVFile,
+                               const std::string & inCSVPath,
+                               const CANFDMolinaroPcapngWriter & inPcapng,
+                               const std::string & inPcapngPath,
+                               std::string & outErrorMessage) {
+  bool ok = true ;
+  if ((inCSVFile != nullptr) && (ferror (inCSVFile) != 0)) {
+    outErrorMessage = "cannot write '" + inCSVPath + "'" ;
+    ok = false ;
+  }else if (inPcapng.isOpen () && !inPcapng.isGood ()) {
+    outErrorMessage = "cannot write '" + inPcapngPath + "'" ;
+    ok = false ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Writes a decoded frame (CRC errors excluded) to the outputs, and adds it to summaries
+
+static void writeFrame (const CANFDMolinaroBusDecoder::FrameRecord & inFrame,
+                        const U32 inSampleRateHz,
+                        FILE * inCSVFile,
+                        CANFDMolinaroPcapngWriter & inPcapng,
+                        SummaryMap & ioSummaries) {
+  if ((inFrame.mFlags & CANFDMolinaroFrameStore::CRC_ERROR_FLAG) == 0) {
+    const U64 timestamp = timestampNs (inFrame.mStartSampleNumber, inSampleRateHz) ;
+    if (inCSVFile != nullptr) {
+      writeCSVLine (inCSVFile, inFrame, timestamp) ;
+    }
+    if (inPcapng.isOpen ()) {
+      inPcapng.writeFrame (inFrame, timestamp) ;
+    }
+    U64 key = inFrame.mIdentifier ;
+    key |= ((inFrame.mFlags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0) ? (U64 (1) << 32) : 0 ;
+    key |= ((inFrame.mFlags & CANFDMolinaroFrameStore::CANXL_FLAG) != 0) ? (U64 (1) << 33) : 0 ;
+    const U32 length = ((inFrame.mFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0)
+      ? inFrame.mDataCodeLength
+      : U32 (inFrame.mData.size ()) ;
+    auto it = ioSummaries.find (key) ;
+    if (it == ioSummaries.end ()) {
+      const IdentifierSummary summary = {
+        1, 0, 0, inFrame.mStartSampleNumber, length, length
+      } ;
+      ioSummaries [key] = summary ;
+    }else{
+      it->second.mCount += 1 ;
+      it->second.mIntervalCount += 1 ;
+      it->second.mIntervalSampleCount += inFrame.mStartSampleNumber - it->second.mLastSampleNumber ;
+      it->second.mLastSampleNumber = inFrame.mStartSampleNumber ;
+      it->second.mMinimumLength = std::min (it->second.mMinimumLength, length) ;
+      it->second.mMaximumLength = std::max (it->second.mMaximumLength, length) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void mergeSummaries (const SummaryMap & inSummaries, SummaryMap & ioMergedSummaries) {
+  for (const auto & entry : inSummaries) {
+    const IdentifierSummary & summary = entry.second ;
+    auto it = ioMergedSummaries.find (entry.first) ;
+    if (it == ioMergedSummaries.end ()) {
+      ioMergedSummaries [entry.first] = summary ;
+    }else{
+      it->second.mCount += summary.mCount ;
+      it->second.mIntervalCount += summary.mIntervalCount ;
+      it->second.mIntervalSampleCount += summary.mIntervalSampleCount ;
+      it->second.mMinimumLength = std::min (it->second.mMinimumLength, summary.mMinimumLength) ;
+      it->second.mMaximumLength = std::max (it->second.mMaximumLength, summary.mMaximumLength) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void mergeCounters (const CANFDMolinaroDecoderCounters & inCounters,
+                           CANFDMolinaroDecoderCounters & ioMergedCounters) {
+  for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+    const CANFDMolinaroDecoderCounters::Counter counter = CANFDMolinaroDecoderCounters::Counter (i) ;
+    ioMergedCounters.add (counter, inCounters.value (counter)) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static void printSummary (FILE * inFile,
+                          const SummaryMap & inSummaries,
+                          const CANFDMolinaroDecoderCounters & inCounters,
+                          const U64 inFileSize,
+                          const U32 inSampleRateHz) {
+  fprintf (inFile, "%-14s %10s %12s %8s\n", "Identifier", "Frames", "Period (ms)", "Length") ;
+  for (const auto & entry : inSummaries) {
+    const IdentifierSummary & summary = entry.second ;
+    const U32 identifier = U32 (entry.first) ;
+    char name [16] ;
+    if ((entry.first >> 33) != 0) {
+      snprintf (name, sizeof (name), "XL 0x%03X", identifier) ;
+    }else if (((entry.first >> 32) & 1) != 0) {
+      snprintf (name, sizeof (name), "0x%08X", identifier) ;
+    }else{
+      snprintf (name, sizeof (name), "0x%03X", identifier) ;
+    }
+    char period [16] = "-" ;
+    if (summary.mIntervalCount > 0) {
+      const double samples = double (summary.mIntervalSampleCount) / double (summary.mIntervalCount) ;
+      snprintf (period, sizeof (period), "%.3f", samples * 1000.0 / double (inSampleRateHz)) ;
+    }
+    char length [16] ;
+    if (summary.mMinimumLength == summary.mMaximumLength) {
+      snprintf (length, sizeof (length), "%u", summary.mMinimumLength) ;
+    }else{
+      snprintf (length, sizeof (length), "%u-%u", summary.mMinimumLength, summary.mMaximumLength) ;
+    }
+    fprintf (inFile, "%-14s %10llu %12s %8s\n", name, (unsigned long long) summary.mCount, period, length) ;
+  }
+  fprintf (inFile, "\n") ;
+  for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+    const CANFDMolinaroDecoderCounters::Counter counter = CANFDMolinaroDecoderCounters::Counter (i) ;
+    if ((counter != CANFDMolinaroDecoderCounters::MARKERS) && (counter != CANFDMolinaroDecoderCounters::FRAMEV2_RESULTS)) {
+      fprintf (inFile, "%-22s %llu\n",
+               CANFDMolinaroDecoderCounters::name (counter),
+               (unsigned long long) inCounters.value (counter)) ;
+    }
+  }
+  const U64 wallTime = inCounters.value (CANFDMolinaroDecoderCounters::WALL_TIME_US) ;
+  if (wallTime > 0) {
+    fprintf (inFile, "%-22s %.1f\n", "Throughput (MB/s)", double (inFileSize) / double (wallTime)) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Checkpoints: an interrupted decoding can be resumed. A checkpoint is taken at the SOF
+//  of every checkpoint interval frame: bus decoder snapshot, input edge count, output
+//  file sizes and identifier summaries at this point. It is written to a temporary file, renamed over
+//  the previous checkpoint. The checkpoint identity (settings, signal), input file size
+//  and sample rate should be the ones of the resumed decoding.
+//----------------------------------------------------------------------------------------
+
+static const char CHECKPOINT_MAGIC [8] = {'C', 'A', 'N', 'F', 'D', 'C', 'K', 'P'} ;
+static const U64 CHECKPOINT_VERSION = 2 ;
+
+typedef struct {
+  std::string mPath ; // Empty: no checkpoint
+  std::string mIdentity ;
+  U32 mFrameInterval ;
+  bool mResume ;
+} CheckpointOptions ;
+
+typedef struct {
+  CANFDMolinaroBusDecoder::Snapshot mSnapshot ;
+  U64 mEdgeCount ; // Input edges up to the snapshot sample
+  U64 mCSVFileSize ; // 0 without CSV output
+  U64 mPcapngFileSize ; // 0 without pcapng output
+  SummaryMap mSummaries ;
+} Checkpoint ;
+
+//----------------------------------------------------------------------------------------
+
+static void appendU64 (std::string & ioBytes, const U64 inValue) {
+  for (U32 i = 0 ; i < 8 ; i++) {
+    ioBytes += char (U8 (inValue >> (8 * i))) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool readU64 (const std::string & inBytes, size_t & ioIndex, U64 & outValue) {
+  const bool ok = (ioIndex + 8) <= inBytes.size () ;
+  if (ok) {
+    outValue = 0 ;
+    for (U32 i = 0 ; i < 8 ; i++) {
+      outValue |= U64 (U8 (inBytes [ioIndex + i])) << (8 * i) ;
+    }
+    ioIndex += 8 ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool writeCheckpoint (const CheckpointOptions & inOptions,
+                             const U64 inInputFileSize,
+                             const U32 inSampleRateHz,
+                             const Checkpoint & inCheckpoint,
+                             std::string & outErrorMessage) {
+  std::string bytes (CHECKPOINT_MAGIC, sizeof (CHECKPOINT_MAGIC)) ;
+  appendU64 (bytes, CHECKPOINT_VERSION) ;
+  appendU64 (bytes, inOptions.mIdentity.size ()) ;
+  bytes += inOptions.mIdentity ;
+  appendU64 (bytes, inInputFileSize) ;
+  appendU64 (bytes, inSampleRateHz) ;
+  U8 snapshot [CANFDMolinaroDecoderSnapshot::SERIALIZED_SIZE] ;
+  inCheckpoint.mSnapshot.mDecoderSnapshot.serialize (snapshot) ;
+  bytes.append ((const char *) snapshot, sizeof (snapshot)) ;
+  appendU64 (bytes, CANFDMolinaroDecoderCounters::COUNTER_COUNT) ;
+  for (U32 i = 0 ; i < CANFDMolinaroDecoderCounters::COUNTER_COUNT ; i++) {
+    appendU64 (bytes, inCheckpoint.mSnapshot.mCounterValues [i]) ;
+  }
+  appendU64 (bytes, inCheckpoint.mEdgeCount) ;
+  appendU64 (bytes, inCheckpoint.mCSVFileSize) ;
+  appendU64 (bytes, inCheckpoint.mPcapngFileSize) ;
+  appendU64 (bytes, inCheckpoint.mSummaries.size ()) ;
+  for (const auto & entry : inCheckpoint.mSummaries) {
+    appendU64 (bytes, entry.first) ;
+    appendU64 (bytes, entry.second.mCount) ;
+    appendU64 (bytes, entry.second.mIntervalCount) ;
+    appendU64 (bytes, entry.second.mIntervalSampleCount) ;
+    appendU64 (bytes, entry.second.mLastSampleNumber) ;
+    appendU64 (bytes, entry.second.mMinimumLength) ;
+    appendU64 (bytes, entry.second.mMaximumLength) ;
+  }
+  const std::string temporaryPath = inOptions.mPath + ".tmp" ;
+  FILE * file = fopen (temporaryPath.c_str (), "wb") ;
+  bool ok = file != nullptr ;
+  if (ok) {
+    ok = fwrite (bytes.data (), 1, bytes.size (), file) == bytes.size () ;
+    ok = (fclose (file) == 0) && ok ;
+    ok = ok && (rename (temporaryPath.c_str (), inOptions.mPath.c_str ()) == 0) ;
+  }
+  if (!ok) {
+    outErrorMessage = "cannot write checkpoint '" + inOptions.mPath + "'" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  outFound is false if there is no checkpoint file
+
+static bool readCheckpoint (const CheckpointOptions & inOptions,
+                            const U64 inInputFileSize,
+                            const U32 inSampleRateHz,
+                            Checkpoint & outCheckpoint,
+                            bool & outFound,
+                            std::string & outErrorMessage) {
+  std::ifstream file (inOptions.mPath, std::ios::in | std::ios::binary) ;
+  outFound = file.is_open () ;
+  std::stringstream contents ;
+  contents << file.rdbuf () ;
+  const std::string bytes = contents.str () ;
+  size_t index = sizeof (CHECKPOINT_MAGIC) ;
+  U64 version = 0 ;
+  U64 identityLength = 0 ;
+  bool ok = !outFound || ((bytes.compare (0, index, CHECKPOINT_MAGIC, index) == 0)
+    && readU64 (bytes, index, version) && (version == CHECKPOINT_VERSION)
+    && readU64 (bytes, index, identityLength) && ((index + identityLength) <= bytes.size ())) ;
+  if (outFound && !ok) {
+    outErrorMessage = "'" + inOptions.mPath + "' is not a checkpoint" ;
+  }else if (outFound) {
+    const std::string identity = bytes.substr (index, identityLength) ;
+    index += identityLength ;
+    U64 inputFileSize = 0 ;
+    U64 sampleRateHz = 0 ;
+    ok = readU64 (bytes, index, inputFileSize) && readU64 (bytes, index, sampleRateHz) ;
+    if (ok && ((identity != inOptions.mIdentity) || (inputFileSize != inInputFileSize) || (sampleRateHz != inSampleRateHz))) {
+      outErrorMessage = "checkpoint '" + inOptions.mPath + "' is not for this input file and settings" ;
+      ok = false ;
+    }else if (ok) {
+      ok = ((index + CANFDMolinaroDecoderSnapshot::SERIALIZED_SIZE) <= bytes.size ())
+        && outCheckpoint.mSnapshot.mDecoderSnapshot.deserialize ((const U8 *) bytes.data () + index) ;
+      index += CANFDMolinaroDecoderSnapshot::SERIALIZED_SIZE ;
+      U64 counterCount = 0 ;
+      ok = ok && readU64 (bytes, index, counterCount) && (counterCount == CANFDMolinaroDecoderCounters::COUNTER_COUNT) ;
+      for (U32 i = 0 ; ok && (i < CANFDMolinaroDecoderCounters::COUNTER_COUNT) ; i++) {
+        ok = readU64 (bytes, index, outCheckpoint.mSnapshot.mCounterValues [i]) ;
+      }
+      U64 summaryCount = 0 ;
+      ok = ok && readU64 (bytes, index, outCheckpoint.mEdgeCount)
+        && readU64 (bytes, index, outCheckpoint.mCSVFileSize)
+        && readU64 (bytes, index, outCheckpoint.mPcapngFileSize)
+        && readU64 (bytes, index, summaryCount) ;
+      for (U64 i = 0 ; ok && (i < summaryCount) ; i++) {
+        U64 key = 0 ;
+        U64 minimumLength = 0 ;
+        U64 maximumLength = 0 ;
+        IdentifierSummary summary ;
+        ok = readU64 (bytes, index, key)
+          && readU64 (bytes, index, summary.mCount)
+          && readU64 (bytes, index, summary.mIntervalCount)
+          && readU64 (bytes, index, summary.mIntervalSampleCount)
+          && readU64 (bytes, index, summary.mLastSampleNumber)
+          && readU64 (bytes, index, minimumLength)
+          && readU64 (bytes, index, maximumLength) ;
+        summary.mMinimumLength = U32 (minimumLength) ;
+        summary.mMaximumLength = U32 (maximumLength) ;
+        outCheckpoint.mSummaries [key] = summary ;
+      }
+      if (!ok) {
+        outErrorMessage = "checkpoint '" + inOptions.mPath + "' is truncated" ;
+      }
+    }
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Resumed decoding: an output file is truncated to its checkpoint size
+
+static bool truncateOutput (const std::string & inPath, const U64 inSize, std::string & outErrorMessage) {
+  struct stat status ;
+  const bool ok = (stat (inPath.c_str (), &status) == 0)
+    && (U64 (status.st_size) >= inSize)
+    && (truncate (inPath.c_str (), off_t (inSize)) == 0) ;
+  if (!ok) {
+    outErrorMessage = "cannot resume output '" + inPath + "'" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Decodes one capture file, writes its frames to the CSV and pcapng files (if path is
+//  not empty), and adds its identifier summaries and counters (decoder counters, and
+//  wall time) to outSummaries and outCounters. Several files can be decoded at the
+//  same time: settings are only read.
+//----------------------------------------------------------------------------------------
+
+static bool decodeFile (const CANFDMolinaroAnalyzerSettings & inSettings,
+                        const U32 inSampleRateHz,
+                        const std::string & inInputPath,
+                        const std::string & inSignal,
+                        const std::string & inCSVPath,
+                        const std::string & inPcapngPath,
+                        const CheckpointOptions & inCheckpointOptions,
+                        SummaryMap & outSummaries,
+                        CANFDMolinaroDecoderCounters & outCounters,
+                        U64 & outFileSize,
+                        std::string & outErrorMessage) {
+//--- Input, by file extension
+  CANFDMolinaroBinaryExport binaryExport ;
+  CANFDMolinaroVCDReader vcdReader ;
+  CANFDMolinaroSigrokSession sigrokSession ;
+  CANFDMolinaroEdgeSource * source = &binaryExport ;
+  const std::string extension = inInputPath.substr (std::min (inInputPath.rfind ('.'), inInputPath.length ())) ;
+  bool ok = true ;
+  if (extension == ".vcd") {
+    ok = vcdReader.open (inInputPath, inSignal, inSampleRateHz, outErrorMessage) ;
+    source = &vcdReader ;
+  }else if (extension == ".sr") {
+    ok = sigrokSession.open (inInputPath, inSignal, inSampleRateHz, outErrorMessage) ;
+    source = &sigrokSession ;
+  }else{
+    ok = binaryExport.open (inInputPath, inSampleRateHz, outErrorMessage) ;
+  }
+  CANFDMolinaroEdgeSource & input = *source ;
+  outFileSize = input.fileSize () ;
+//--- Checkpoint to resume from
+  Checkpoint checkpoint ;
+  bool resumed = false ;
+  if (ok && inCheckpointOptions.mResume) {
+    ok = readCheckpoint (inCheckpointOptions, outFileSize, inSampleRateHz, checkpoint, resumed, outErrorMessage) ;
+  }
+  if (ok && resumed
+   && (((checkpoint.mCSVFileSize > 0) != (inCSVPath.length () > 0))
+    || ((checkpoint.mPcapngFileSize > 0) != (inPcapngPath.length () > 0)))) {
+    outErrorMessage = "outputs are not the ones of the checkpoint" ;
+    ok = false ;
+  }
+//--- Outputs; resumed outputs are truncated to their checkpoint sizes
+  FILE * csvFile = nullptr ;
+  if (ok && (inCSVPath.length () > 0)) {
+    if (resumed) {
+      ok = truncateOutput (inCSVPath, checkpoint.mCSVFileSize, outErrorMessage) ;
+    }
+    csvFile = ok ? fopen (inCSVPath.c_str (), resumed ? "a" : "w") : nullptr ;
+    if (csvFile == nullptr) {
+      outErrorMessage = ok ? ("cannot create '" + inCSVPath + "'") : outErrorMessage ;
+      ok = false ;
+    }else if (!resumed) {
+      fprintf (csvFile, "Time [s],Identifier,Flags,Payload\n") ;
+    }
+  }
+  CANFDMolinaroPcapngWriter pcapng ;
+  if (ok && (inPcapngPath.length () > 0)) {
+    if (resumed) {
+      ok = truncateOutput (inPcapngPath, checkpoint.mPcapngFileSize, outErrorMessage)
+        && pcapng.openForAppend (inPcapngPath, outErrorMessage) ;
+    }else{
+      ok = pcapng.open (inPcapngPath, outErrorMessage) ;
+    }
+  }
+//--- Synchronize to recessive level, as the analyzer, or resume from checkpoint
+  const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now () ;
+  CANFDMolinaroDecoderCounters counters ;
+  CANFDMolinaroBusDecoder decoder ;
+  SummaryMap summaries ;
+  if (ok) {
+    decoder.configure (inSettings, 0, inSampleRateHz) ;
+    decoder.setMarkerOutput (false) ;
+    decoder.setSnapshotInterval (inCheckpointOptions.mPath.empty () ? 0 : inCheckpointOptions.mFrameInterval) ;
+    std::vector <U64> edges ;
+    edges.reserve (EDGE_BLOCK_SIZE) ;
+    U64 startSampleNumber = 0 ;
+    if (resumed) {
+      startSampleNumber = checkpoint.mSnapshot.mDecoderSnapshot.mSampleNumber ;
+      decoder.resume (checkpoint.mSnapshot) ;
+      counters.set (CANFDMolinaroDecoderCounters::EDGES, checkpoint.mEdgeCount) ;
+      summaries = checkpoint.mSummaries ;
+      fprintf (stderr, "canfd-decode: resuming at %.6f s\n", double (startSampleNumber) / double (inSampleRateHz)) ;
+    }else{
+      bool level = input.initialLevel () ^ inSettings.inverted () ;
+      if (!level && (input.readEdges (edges, 1) > 0)) {
+        startSampleNumber = edges.back () ;
+        level = true ;
+        counters.increment (CANFDMolinaroDecoderCounters::EDGES) ;
+        edges.clear () ;
+      }
+      decoder.reset (level, startSampleNumber) ;
+    }
+  //--- Decode by edge blocks; the last block is decoded up to capture end. Resumed
+  //    decoding skips edges up to the snapshot sample, counted by the checkpoint
+    U64 endSampleNumber = startSampleNumber ;
+    bool done = false ;
+    while (ok && !done) {
+      done = input.readEdges (edges, EDGE_BLOCK_SIZE) == 0 ;
+      endSampleNumber = done
+        ? std::max (endSampleNumber, input.endSampleNumber ())
+        : edges.back () ;
+      if (resumed && (edges.size () > 0) && (edges.front () <= startSampleNumber)) {
+        edges.erase (edges.begin (), std::upper_bound (edges.begin (), edges.end (), startSampleNumber)) ;
+      }
+      const U64 blockStartEdgeCount = counters.value (CANFDMolinaroDecoderCounters::EDGES) ;
+      counters.add (CANFDMolinaroDecoderCounters::EDGES, edges.size ()) ;
+      decoder.decodeBlock (edges, endSampleNumber) ;
+      decoder.bubbles ().clear () ;
+    //--- Frames, and checkpoint of the last snapshot of the block
+      std::deque <CANFDMolinaroBusDecoder::FrameRecord> & frames = decoder.frameRecords () ;
+      std::deque <CANFDMolinaroBusDecoder::Snapshot> & snapshots = decoder.snapshots () ;
+      const size_t checkpointIndex = snapshots.empty () ? SIZE_MAX : snapshots.back ().mFrameRecordCount ;
+      for (size_t i = 0 ; ok && (i <= frames.size ()) ; i++) {
+        if (i == checkpointIndex) { // Output sizes are recorded once outputs are flushed
+          checkpoint.mSnapshot = snapshots.back () ;
+          checkpoint.mEdgeCount = blockStartEdgeCount + U64 (std::upper_bound (edges.begin (), edges.end (),
+            checkpoint.mSnapshot.mDecoderSnapshot.mSampleNumber) - edges.begin ()) ;
+          checkpoint.mCSVFileSize = 0 ;
+          if (csvFile != nullptr) {
+            fflush (csvFile) ;
+            fseeko (csvFile, 0, SEEK_END) ;
+            checkpoint.mCSVFileSize = U64 (ftello (csvFile)) ;
+          }
+          checkpoint.mPcapngFileSize = pcapng.isOpen () ? pcapng.fileSize () : 0 ;
+          checkpoint.mSummaries = summaries ;
+          ok = outputsAreWritten (csvFile, inCSVPath, pcapng, inPcapngPath, outErrorMessage)
+            && writeCheckpoint (inCheckpointOptions, outFileSize, inSampleRateHz, checkpoint, outErrorMessage) ;
+        }
+        if (i < frames.size ()) {
+          writeFrame (frames [i], inSampleRateHz, csvFile, pcapng, summaries) ;
+        }
+      }
+      frames.clear () ;
+      snapshots.clear () ;
+      edges.clear () ;
+      ok = ok && outputsAreWritten (csvFile, inCSVPath, pcapng, inPcapngPath, outErrorMessage) ;
+    }
+    if (ok && !input.errorMessage ().empty ()) {
+      outErrorMessage = input.errorMessage () ;
+      ok = false ;
+    }
+  }
+  if ((csvFile != nullptr) && (fclose (csvFile) != 0) && ok) {
+    outErrorMessage = "cannot write '" + inCSVPath + "'" ;
+    ok = false ;
+  }
+  if (!pcapng.close () && ok) {
+    outErrorMessage = "cannot write '" + inPcapngPath + "'" ;
+    ok = false ;
+  }
+  const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now () - startTime ;
+  counters.set (CANFDMolinaroDecoderCounters::WALL_TIME_US,
+                U64 (std::chrono::duration_cast <std::chrono::microseconds> (duration).count ())) ;
+  mergeSummaries (summaries, outSummaries) ;
+  mergeCounters (decoder.counters (), outCounters) ;
+  mergeCounters (counters, outCounters) ;
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Batch mode: the capture files of a directory (.bin, .vcd and .sr files, in name
+//  order), or of a list file (one path per line, # starts a comment line)
+//----------------------------------------------------------------------------------------
+
+static bool listBatchFiles (const std::string & inPath,
+                            std::vector <std::string> & outPaths,
+                            std::string & outErrorMessage) {
+  struct stat status ;
+  bool ok = stat (inPath.c_str (), &status) == 0 ;
+  if (!ok) {
+    outErrorMessage = "cannot read '" + inPath + "'" ;
+  }else if (S_ISDIR (status.st_mode)) {
+    DIR * directory = opendir (inPath.c_str ()) ;
+    ok = directory != nullptr ;
+    if (ok) {
+      const struct dirent * entry = readdir (directory) ;
+      while (entry != nullptr) {
+        const std::string name = entry->d_name ;
+        const std::string extension = name.substr (std::min (name.rfind ('.'), name.length ())) ;
+        const std::string path = inPath + "/" + name ;
+        struct stat fileStatus ;
+        if (((extension == ".bin") || (extension == ".vcd") || (extension == ".sr"))
+         && (stat (path.c_str (), &fileStatus) == 0) && S_ISREG (fileStatus.st_mode)) {
+          outPaths.push_back (path) ;
+        }
+        entry = readdir (directory) ;
+      }
+      closedir (directory) ;
+      std::sort (outPaths.begin (), outPaths.end ()) ;
+    }else{
+      outErrorMessage = "cannot read directory '" + inPath + "'" ;
+    }
+  }else{
+    std::ifstream file (inPath) ;
+    ok = file.is_open () ;
+    std::string line ;
+    while (ok && std::getline (file, line)) {
+      const size_t first = line.find_first_not_of (" \t\r") ;
+      if ((first != std::string::npos) && (line [first] != '#')) {
+        const size_t last = line.find_last_not_of (" \t\r") ;
+        outPaths.push_back (line.substr (first, last + 1 - first)) ;
+      }
+    }
+    if (!ok) {
+      outErrorMessage = "cannot read '" + inPath + "'" ;
+    }
+  }
+  if (ok && outPaths.empty ()) {
+    outErrorMessage = "no capture file in '" + inPath + "'" ;
+    ok = false ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+typedef struct {
+  std::string mInputPath ;
+  std::string mOutputName ; // Output files are <output directory>/<name>.csv, .pcapng, .txt
+  U64 mFileSize ;
+  U64 mFrameCount ;
+  U64 mWallTimeUs ;
+  std::string mErrorMessage ;
+} BatchFile ;
+
+//----------------------------------------------------------------------------------------
+//  Files are decoded on the worker pool: every job takes the next file, largest files
+//  first, so that jobs finish together
+//----------------------------------------------------------------------------------------
+
+static int decodeBatch (const CANFDMolinaroAnalyzerSettings & inSettings,
+                        const U32 inSampleRateHz,
+                        const std::vector <std::string> & inInputPaths,
+                        const std::string & inSignal,
+                        const std::string & inOutputDirectory,
+                        const U32 inJobCount,
+                        const U64 inMemoryBudget) {
+  const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now () ;
+  const U32 fileCount = U32 (inInputPaths.size ()) ;
+//--- Output names are input file names; a duplicate name gets a -2, -3... suffix
+  std::vector <BatchFile> files (fileCount) ;
+  std::map <std::string, U32> nameCounts ;
+  U64 totalSize = 0 ;
+  for (U32 i = 0 ; i < fileCount ; i++) {
+    BatchFile & file = files [i] ;
+    file.mInputPath = inInputPaths [i] ;
+    const std::string name = file.mInputPath.substr (file.mInputPath.rfind ('/') + 1) ;
+    const U32 count = ++ nameCounts [name] ;
+    file.mOutputName = (count == 1) ? name : (name + "-" + std::to_string (count)) ;
+    struct stat status ;
+    file.mFileSize = (stat (file.mInputPath.c_str (), &status) == 0) ? U64 (status.st_size) : 0 ;
+    file.mFrameCount = 0 ;
+    file.mWallTimeUs = 0 ;
+    totalSize += file.mFileSize ;
+  }
+  std::vector <U32> order (fileCount) ;
+  for (U32 i = 0 ; i < fileCount ; i++) {
+    order [i] = i ;
+  }
+  std::stable_sort (order.begin (), order.end (), [&files] (const U32 inA, const U32 inB) {
+    return files [inA].mFileSize > files [inB].mFileSize ;
+  }) ;
+  U32 jobCount = std::min (inJobCount, fileCount) ;
+  if (inMemoryBudget > 0) {
+    jobCount = std::min (jobCount, U32 (std::max (U64 (1), inMemoryBudget / JOB_MEMORY_BYTES))) ;
+  }
+  fprintf (stderr, "canfd-decode: %u files, %.1f MB, %u jobs\n", fileCount, double (totalSize) / 1.0e6, jobCount) ;
+//--- Decoding jobs: results are merged, and progress is reported, under mutex
+  std::mutex mutex ;
+  U32 nextFile = 0 ;
+  U32 doneFileCount = 0 ;
+  U64 doneSize = 0 ;
+  SummaryMap mergedSummaries ;
+  CANFDMolinaroDecoderCounters mergedCounters ;
+  const CheckpointOptions noCheckpoint = { "", "", 0, false } ;
+  const std::function <void (const U32)> job = [&] (const U32) {
+    bool done = false ;
+    while (!done) {
+      U32 index = 0 ;
+      { std::lock_guard <std::mutex> lock (mutex) ;
+        done = nextFile == fileCount ;
+        if (!done) {
+          index = order [nextFile] ;
+          nextFile += 1 ;
+        }
+      }
+      if (!done) {
+        BatchFile & file = files [index] ;
+        const std::string outputPath = inOutputDirectory.empty () ? "" : (inOutputDirectory + "/" + file.mOutputName) ;
+        SummaryMap summaries ;
+        CANFDMolinaroDecoderCounters counters ;
+        U64 fileSize = 0 ;
+        const bool ok = decodeFile (inSettings,
+                                    inSampleRateHz,
+                                    file.mInputPath,
+                                    inSignal,
+                                    outputPath.empty () ? "" : (outputPath + ".csv"),
+                                    outputPath.empty () ? "" : (outputPath + ".pcapng"),
+                                    noCheckpoint,
+                                    summaries,
+                                    counters,
+                                    fileSize,
+                                    file.mErrorMessage) ;
+        for (const auto & entry : summaries) {
+          file.mFrameCount += entry.second.mCount ;
+        }
+        file.mWallTimeUs = counters.value (CANFDMolinaroDecoderCounters::WALL_TIME_US) ;
+        if (outputPath.empty ()) {
+        }else if (ok) {
+          FILE * summaryFile = fopen ((outputPath + ".txt").c_str (), "w") ;
+          if (summaryFile != nullptr) {
+            printSummary (summaryFile, summaries, counters, fileSize, inSampleRateHz) ;
+            fclose (summaryFile) ;
+          }
+        }else{ // No partial output
+          remove ((outputPath + ".csv").c_str ()) ;
+          remove ((outputPath + ".pcapng").c_str ()) ;
+        }
+        std::lock_guard <std::mutex> lock (mutex) ;
+        doneFileCount += 1 ;
+        doneSize += file.mFileSize ;
+        fprintf (stderr, "[%u/%u %3.0f%%] %s: ",
+                 doneFileCount, fileCount,
+                 (totalSize > 0) ? (100.0 * double (doneSize) / double (totalSize)) : 100.0,
+                 file.mInputPath.c_str ()) ;
+        if (ok) {
+          mergeSummaries (summaries, mergedSummaries) ;
+          mergeCounters (counters, mergedCounters) ;
+          fprintf (stderr, "%llu frames, %.1f MB/s\n",
+                   (unsigned long long) file.mFrameCount,
+                   double (fileSize) / double (std::max (file.mWallTimeUs, U64 (1)))) ;
+        }else{
+          fprintf (stderr, "%s\n", file.mErrorMessage.c_str ()) ;
+        }
+      }
+    }
+  } ;
+  CANFDMolinaroWorkerPool pool ;
+  pool.run (jobCount, job) ;
+//--- Report: files in input order, then merged summary of decoded files
+  U32 errorCount = 0 ;
+  printf ("%-40s %10s %10s %10s  %s\n", "File", "Size (MB)", "Frames", "Time (s)", "Status") ;
+  for (const BatchFile & file : files) {
+    printf ("%-40s %10.1f %10llu %10.3f  %s\n",
+            file.mInputPath.c_str (),
+            double (file.mFileSize) / 1.0e6,
+            (unsigned long long) file.mFrameCount,
+            double (file.mWallTimeUs) / 1.0e6,
+            file.mErrorMessage.empty () ? "ok" : file.mErrorMessage.c_str ()) ;
+    errorCount += file.mErrorMessage.empty () ? 0 : 1 ;
+  }
+  printf ("\n") ;
+  const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now () - startTime ;
+  mergedCounters.set (CANFDMolinaroDecoderCounters::WALL_TIME_US,
+                      U64 (std::chrono::duration_cast <std::chrono::microseconds> (duration).count ())) ;
+  printSummary (stdout, mergedSummaries, mergedCounters, doneSize, inSampleRateHz) ;
+  if (errorCount > 0) {
+    fprintf (stderr, "canfd-decode: %u of %u files not decoded\n", errorCount, fileCount) ;
+  }
+  return (errorCount > 0) ? 1 : 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+int main (int argc, char ** argv) {
+  CANFDMolinaroCommandLineSettings settings ;
+  U32 sampleRateHz = DEFAULT_SAMPLE_RATE_HZ ;
+  std::string inputPath ;
+  std::string signal ;
+  std::string csvPath ;
+  std::string pcapngPath ;
+  std::string batchPath ;
+  std::string outputDirectory ;
+  U32 jobCount = std::max (1U, std::thread::hardware_concurrency ()) ;
+  U32 memoryBudgetMiB = 0 ;
+  CheckpointOptions checkpointOptions = { "", "", DEFAULT_CHECKPOINT_INTERVAL, false } ;
+  std::string errorMessage ;
+  bool ok = true ;
+//--- Saved settings are loaded before flags, wherever they appear
+  for (int i = 1 ; ok && (i < argc) ; i++) {
+    const bool isSettings = strcmp (argv [i], "--settings") == 0 ;
+    const bool isSettingsFile = strcmp (argv [i], "--settings-file") == 0 ;
+    if ((isSettings || isSettingsFile) && ((i + 1) < argc)) {
+      i += 1 ;
+      if (isSettings) {
+        settings.LoadSettings (argv [i]) ;
+      }else{
+        std::ifstream file (argv [i]) ;
+        std::stringstream contents ;
+        contents << file.rdbuf () ;
+        ok = file.is_open () ;
+        if (ok) {
+          settings.LoadSettings (contents.str ().c_str ()) ;
+        }else{
+          errorMessage = std::string ("cannot read '") + argv [i] + "'" ;
+        }
+      }
+    }
+  }
+//--- Flags
+  for (int i = 1 ; ok && (i < argc) ; i++) {
+    const std::string flag = argv [i] ;
+    const bool hasValue = (i + 1) < argc ;
+    const char * value = hasValue ? argv [i + 1] : "" ;
+    U32 number = 0 ;
+    if ((flag == "--settings") || (flag == "--settings-file")) {
+      ok = hasValue ;
+      i += 1 ;
+    }else if (flag == "--arbitration-bit-rate") {
+      ok = hasValue && parseUnsigned (value, number) && (number >= 1) && (number <= 1000000) ;
+      settings.setArbitrationBitRate (number) ;
+      i += 1 ;
+    }else if (flag == "--data-bit-rate") {
+      ok = hasValue && parseUnsigned (value, number) && (number >= 1) && (number <= 20000000) ;
+      settings.setDataBitRate (number) ;
+      i += 1 ;
+    }else if (flag == "--arbitration-sample-point") {
+      ok = hasValue && parseUnsigned (value, number) && (number >= 50) && (number <= 90) ;
+      settings.setArbitrationSamplePoint (number) ;
+      i += 1 ;
+    }else if (flag == "--data-sample-point") {
+      ok = hasValue && parseUnsigned (value, number) && (number >= 50) && (number <= 90) ;
+      settings.setDataSamplePoint (number) ;
+      i += 1 ;
+    }else if (flag == "--data-sjw") {
+      ok = hasValue && parseUnsigned (value, number) && (number <= 50) ;
+      settings.setDataPhaseSJW (number) ;
+      i += 1 ;
+    }else if (flag == "--protocol") {
+      const std::string protocol = value ;
+      if (protocol == "iso") {
+        settings.setProtocol (CANFD_ISO_PROTOCOL) ;
+      }else if (protocol == "non-iso") {
+        settings.setProtocol (CANFD_NON_ISO_PROTOCOL) ;
+      }else if (protocol == "xl") {
+        settings.setProtocol (CANXL_PROTOCOL) ;
+      }else{
+        ok = false ;
+      }
+      i += 1 ;
+    }else if (flag == "--inverted") {
+      settings.setInverted (true) ;
+    }else if (flag == "--filter") {
+      CANFDMolinaroAcceptanceFilter filter ;
+      ok = hasValue && filter.compile (value, errorMessage) ;
+      settings.setAcceptanceFilter (value) ;
+      i += 1 ;
+    }else if (flag == "--signal") {
+      ok = hasValue ;
+      signal = value ;
+      i += 1 ;
+    }else if (flag == "--sample-rate") {
+      ok = hasValue && parseUnsigned (value, sampleRateHz) && (sampleRateHz > 0) ;
+      i += 1 ;
+    }else if (flag == "--csv") {
+      ok = hasValue ;
+      csvPath = value ;
+      i += 1 ;
+    }else if (flag == "--pcapng") {
+      ok = hasValue ;
+      pcapngPath = value ;
+      i += 1 ;
+    }else if (flag == "--checkpoint") {
+      ok = hasValue ;
+      checkpointOptions.mPath = value ;
+      i += 1 ;
+    }else if (flag == "--checkpoint-interval") {
+      ok = hasValue && parseUnsigned (value, checkpointOptions.mFrameInterval) && (checkpointOptions.mFrameInterval >= 1) ;
+      i += 1 ;
+    }else if (flag == "--resume") {
+      checkpointOptions.mResume = true ;
+    }else if (flag == "--batch") {
+      ok = hasValue ;
+      batchPath = value ;
+      i += 1 ;
+    }else if (flag == "--output-dir") {
+      ok = hasValue ;
+      outputDirectory = value ;
+      i += 1 ;
+    }else if (flag == "--jobs") {
+      ok = hasValue && parseUnsigned (value, jobCount) && (jobCount >= 1) && (jobCount <= 1024) ;
+      i += 1 ;
+    }else if (flag == "--max-jobs-by-memory") {
+      ok = hasValue && parseUnsigned (value, memoryBudgetMiB) && (memoryBudgetMiB >= 1) ;
+      i += 1 ;
+    }else if ((flag.length () > 0) && (flag [0] != '-') && (inputPath.length () == 0)) {
+      inputPath = flag ;
+    }else{
+      ok = false ;
+    }
+    if (!ok && (errorMessage.length () == 0)) {
+      errorMessage = "invalid argument '" + flag + "'" ;
+    }
+  }
+  const bool batch = batchPath.length () > 0 ;
+  if (ok && !batch && (inputPath.length () == 0)) {
+    errorMessage = "no input file" ;
+    ok = false ;
+  }
+  if (ok && batch && ((inputPath.length () > 0) || (csvPath.length () > 0) || (pcapngPath.length () > 0))) {
+    errorMessage = "in batch mode, input files are given by --batch, outputs by --output-dir" ;
+    ok = false ;
+  }
+  if (ok && batch && (checkpointOptions.mPath.length () > 0)) {
+    errorMessage = "checkpoints are not available in batch mode" ;
+    ok = false ;
+  }
+  if (ok && checkpointOptions.mResume && (checkpointOptions.mPath.length () == 0)) {
+    errorMessage = "--resume requires --checkpoint" ;
+    ok = false ;
+  }
+  if (ok && (sampleRateHz < (12 * std::max (settings.arbitrationBitRate (), settings.dataBitRate ())))) {
+    errorMessage = "sample rate should be at least 12 times the greatest bit rate" ;
+    ok = false ;
+  }
+  if (!ok) {
+    fprintf (stderr, "canfd-decode: %s\n", errorMessage.c_str ()) ;
+    printUsage (argv [0]) ;
+    return 1 ;
+  }
+//--- Batch mode
+  if (batch) {
+    std::vector <std::string> inputPaths ;
+    ok = listBatchFiles (batchPath, inputPaths, errorMessage) ;
+    if (ok && (outputDirectory.length () > 0)) {
+      mkdir (outputDirectory.c_str (), 0777) ;
+      struct stat status ;
+      ok = (stat (outputDirectory.c_str (), &status) == 0) && S_ISDIR (status.st_mode) ;
+      if (!ok) {
+        errorMessage = "cannot create directory '" + outputDirectory + "'" ;
+      }
+    }
+    if (!ok) {
+      fprintf (stderr, "canfd-decode: %s\n", errorMessage.c_str ()) ;
+      return 1 ;
+    }
+    return decodeBatch (settings, sampleRateHz, inputPaths, signal, outputDirectory,
+                        jobCount, U64 (memoryBudgetMiB) * 1024 * 1024) ;
+  }
+//--- Single file
+  SummaryMap summaries ;
+  CANFDMolinaroDecoderCounters counters ;
+  U64 fileSize = 0 ;
+  checkpointOptions.mIdentity = std::string (settings.SaveSettings ()) + "\n" + signal ;
+  ok = decodeFile (settings, sampleRateHz, inputPath, signal, csvPath, pcapngPath, checkpointOptions,
+                   summaries, counters, fileSize, errorMessage) ;
+  if (!ok) {
+    fprintf (stderr, "canfd-decode: %s\n", errorMessage.c_str ()) ;
+    return 1 ;
+  }
+  printSummary (stdout, summaries, counters, fileSize, sampleRateHz) ;
+  return 0 ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,43 @@
+#include "CANFDMolinaroDecoderCounters.h"
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroDecoderCounters::CANFDMolinaroDecoderCounters (void) :
+mValues () {
+  reset () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroDecoderCounters::reset (void) {
+  for (U32 i = 0 ; i < COUNTER_COUNT ; i++) {
+    mValues [i].store (0, std::memory_order_relaxed) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+const char * CANFDMolinaroDecoderCounters::name (const Counter inCounter) {
+  const char * result = "" ;
+  switch (inCounter) {
+  case EDGES : result = "Edges" ; break ;
+  case ARBITRATION_BITS : result = "Arbitration Bits" ; break ;
+  case DATA_BITS : result = "Data Bits" ; break ;
+  case STUFF_BITS : result = "Stuff Bits" ; break ;
+  case CAN_DATA_FRAMES : result = "CAN Data Frames" ; break ;
+  case CAN_REMOTE_FRAMES : result = "CAN Remote Frames" ; break ;
+  case CANFD_FRAMES : result = "CANFD Frames" ; break ;
+  case CANXL_FRAMES : result = "CAN XL Frames" ; break ;
+  case STUFF_ERRORS : result = "Stuff Errors" ; break ;
+  case FORM_ERRORS : result = "Form Errors" ; break ;
+  case CRC_ERRORS : result = "CRC Errors" ; break ;
+  case ACK_DELIMITER_ERRORS : result = "ACK Delimiter Errors" ; break ;
+  case MARKERS : result = "Markers" ; break ;
+  case FRAMEV2_RESULTS : result = "FrameV2 Results" ; break ;
+  case WALL_TIME_US : result = "Wall Time (us)" ; break ;
+  case COUNTER_COUNT : break ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+#ifndef CANFDMOLINARO_DECODER_COUNTERS_H
+#define CANFDMOLINARO_DECODER_COUNTERS_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <atomic>
+
+//----------------------------------------------------------------------------------------
+//  Decoder performance counters. Every counter set has a single writer thread (a frame
+//  decoder, or the analyzer thread), so a counter is updated by a relaxed load and
+//  store, without read-modify-write; any thread may read them while decoding runs.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroDecoderCounters {
+  public: CANFDMolinaroDecoderCounters (void) ;
+
+  public: typedef enum {
+    EDGES,
+    ARBITRATION_BITS,
+    DATA_BITS,
+    STUFF_BITS, // Dynamic and fixed stuff bits
+    CAN_DATA_FRAMES,
+    CAN_REMOTE_FRAMES,
+    CANFD_FRAMES,
+    CANXL_FRAMES,
+    STUFF_ERRORS,
+    FORM_ERRORS,
+    CRC_ERRORS,
+    ACK_DELIMITER_ERRORS,
+    MARKERS,
+    FRAMEV2_RESULTS,
+    WALL_TIME_US, // In WorkerThread
+    COUNTER_COUNT
+  } Counter ;
+
+  public: inline void add (const Counter inCounter, const U64 inValue) {
+    mValues [inCounter].store (mValues [inCounter].load (std::memory_order_relaxed) + inValue,
+                               std::memory_order_relaxed) ;
+  }
+
+  public: inline void increment (const Counter inCounter) { add (inCounter, 1) ; }
+
+  public: inline void set (const Counter inCounter, const U64 inValue) {
+    mValues [inCounter].store (inValue, std::memory_order_relaxed) ;
+  }
+
+  public: inline U64 value (const Counter inCounter) const {
+    return mValues [inCounter].load (std::memory_order_relaxed) ;
+  }
+
+  public: void reset (void) ;
+
+  public: static const char * name (const Counter inCounter) ;
+
+//--- Private properties
+  private: std::atomic <U64> mValues [COUNTER_COUNT] ;
+
+//--- No copy
+  private: CANFDMolinaroDecoderCounters (const CANFDMolinaroDecoderCounters &) = delete ;
+  private: CANFDMolinaroDecoderCounters & operator = (const CANFDMolinaroDecoderCounters &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_DECODER_COUNTERS_H
@@ -0,0 +1,85 @@
+#include "CANFDMolinaroDecoderSnapshot.h"
+
+//----------------------------------------------------------------------------------------
+
+static const U8 SNAPSHOT_FORMAT_VERSION = 1 ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroDecoderSnapshot::CANFDMolinaroDecoderSnapshot (void) :
+mSampleNumber (0),
+mFrameIndex (0),
+mSamplesPerBit (0),
+mFrameFieldEngineState (0),
+mFieldBitIndex (0),
+mConsecutiveBitCountOfSamePolarity (0),
+mPreviousBit (true),
+mUnstuffingActive (false),
+mCRC15Accumulator (0),
+mCRC17Accumulator (0),
+mCRC21Accumulator (0),
+mStuffBitCount (0) {
+}
+
+//----------------------------------------------------------------------------------------
+
+static U8 * writeValue (U8 * p, const U64 inValue, const U32 inByteCount) {
+  for (U32 i=0 ; i<inByteCount ; i++) {
+    p [i] = U8 (inValue >> (8 * i)) ;
+  }
+  return p + inByteCount ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static U64 readValue (const U8 * & p, const U32 inByteCount) {
+  U64 value = 0 ;
+  for (U32 i=0 ; i<inByteCount ; i++) {
+    value |= U64 (p [i]) << (8 * i) ;
+  }
+  p += inByteCount ;
+  return value ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroDecoderSnapshot::serialize (U8 outBytes [SERIALIZED_SIZE]) const {
+  U8 * p = outBytes ;
+  p = writeValue (p, SNAPSHOT_FORMAT_VERSION, 1) ;
+  p = writeValue (p, mSampleNumber, 8) ;
+  p = writeValue (p, mFrameIndex, 8) ;
+  p = writeValue (p, mSamplesPerBit, 4) ;
+  p = writeValue (p, mFrameFieldEngineState, 1) ;
+  p = writeValue (p, mFieldBitIndex, 1) ;
+  p = writeValue (p, mConsecutiveBitCountOfSamePolarity, 1) ;
+  p = writeValue (p, mPreviousBit, 1) ;
+  p = writeValue (p, mUnstuffingActive, 1) ;
+  p = writeValue (p, mCRC15Accumulator, 2) ;
+  p = writeValue (p, mCRC17Accumulator, 4) ;
+  p = writeValue (p, mCRC21Accumulator, 4) ;
+  p = writeValue (p, mStuffBitCount, 4) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroDecoderSnapshot::deserialize (const U8 inBytes [SERIALIZED_SIZE]) {
+  const U8 * p = inBytes ;
+  const bool ok = readValue (p, 1) == SNAPSHOT_FORMAT_VERSION ;
+  if (ok) {
+    mSampleNumber = readValue (p, 8) ;
+    mFrameIndex = readValue (p, 8) ;
+    mSamplesPerBit = U32 (readValue (p, 4)) ;
+    mFrameFieldEngineState = U8 (readValue (p, 1)) ;
+    mFieldBitIndex = U8 (readValue (p, 1)) ;
+    mConsecutiveBitCountOfSamePolarity = U8 (readValue (p, 1)) ;
+    mPreviousBit = readValue (p, 1) != 0 ;
+    mUnstuffingActive = readValue (p, 1) != 0 ;
+    mCRC15Accumulator = U16 (readValue (p, 2)) ;
+    mCRC17Accumulator = U32 (readValue (p, 4)) ;
+    mCRC21Accumulator = U32 (readValue (p, 4)) ;
+    mStuffBitCount = U32 (readValue (p, 4)) ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+#ifndef CANFDMOLINARO_DECODER_SNAPSHOT_H
+#define CANFDMOLINARO_DECODER_SNAPSHOT_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+
+//----------------------------------------------------------------------------------------
+//  Decoder state snapshot.
+//
+//  A snapshot is taken at a frame boundary (the SOF edge that ends an idle period), so
+//  decoding can be resumed by seeking the channel to mSampleNumber and restoring the
+//  engine state: no frame field is pending at this point, the first decoded bit is the SOF.
+//  The serialized form is a fixed size little endian byte array, with a version byte.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroDecoderSnapshot {
+  public: CANFDMolinaroDecoderSnapshot (void) ;
+
+//--- Serialization
+  public: static const U32 SERIALIZED_SIZE = 40 ;
+  public: void serialize (U8 outBytes [SERIALIZED_SIZE]) const ;
+  public: bool deserialize (const U8 inBytes [SERIALIZED_SIZE]) ; // Returns false if invalid
+
+//--- Resume point
+  public: U64 mSampleNumber ; // Sample of the SOF edge
+  public: U64 mFrameIndex ; // Number of SOF seen before this one
+
+//--- Bit timing
+  public: U32 mSamplesPerBit ;
+
+//--- Frame field engine
+  public: U8 mFrameFieldEngineState ;
+  public: U8 mFieldBitIndex ;
+  public: U8 mConsecutiveBitCountOfSamePolarity ;
+  public: bool mPreviousBit ;
+  public: bool mUnstuffingActive ;
+
+//--- CRC and destuffing counters
+  public: U16 mCRC15Accumulator ;
+  public: U32 mCRC17Accumulator ;
+  public: U32 mCRC21Accumulator ;
+  public: U32 mStuffBitCount ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_DECODER_SNAPSHOT_H
@@ -0,0 +1,37 @@
+#ifndef CANFDMOLINARO_EDGE_SOURCE_H
+#define CANFDMOLINARO_EDGE_SOURCE_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Edge stream of one signal of a capture file, read by the command line decoder: the
+//  file is read sequentially, and edges are returned as sample numbers at the sample
+//  rate given when opening it (sample 0 is capture start).
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroEdgeSource {
+  public: virtual ~CANFDMolinaroEdgeSource (void) {}
+
+//--- Signal level at sample 0
+  public: virtual bool initialLevel (void) const = 0 ;
+
+//--- Appends at most inMaxCount next edges to outEdges, in increasing order; returns the
+//    number of appended edges (0 when every edge has been read, or on read error)
+  public: virtual size_t readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) = 0 ;
+
+//--- Capture end, valid when every edge has been read
+  public: virtual U64 endSampleNumber (void) const = 0 ;
+
+//--- Empty if no read error
+  public: virtual const std::string & errorMessage (void) const = 0 ;
+
+  public: virtual U64 fileSize (void) const = 0 ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_EDGE_SOURCE_H
@@ -0,0 +1,123 @@
+#include "CANFDMolinaroErrorInjector.h"
+
+#include <cstdlib>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------
+
+static const char * KIND_NAMES [CANFDMolinaroErrorInjector::INJECTION_KIND_COUNT] = {
+  "", "flip", "stuff", "crc", "form", "glitch", "errorflag", "overload"
+} ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroErrorInjector::CANFDMolinaroErrorInjector (void) :
+mRates (),
+mPositions (),
+mTotalRate (0.0),
+mSeed (0) {
+  for (U32 i=0 ; i<INJECTION_KIND_COUNT ; i++) {
+    mPositions [i] = -1 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroErrorInjector::compile (const std::string & inSource,
+                                          std::string & outErrorMessage) {
+  for (U32 i=0 ; i<INJECTION_KIND_COUNT ; i++) {
+    mRates [i] = 0.0 ;
+    mPositions [i] = -1 ;
+  }
+//--- Split terms
+  bool ok = true ;
+  std::string term ;
+  for (size_t i=0 ; (i <= inSource.length ()) && ok ; i++) {
+    const char c = (i < inSource.length ()) ? inSource [i] : ' ' ;
+    if ((c == ',') || (c == ';') || isspace (c)) {
+      if (term.length () > 0) {
+        ok = compileTerm (term, outErrorMessage) ;
+        term.clear () ;
+      }
+    }else{
+      term += char (tolower (c)) ;
+    }
+  }
+//--- Check total rate
+  mTotalRate = 0.0 ;
+  for (U32 i=0 ; i<INJECTION_KIND_COUNT ; i++) {
+    mTotalRate += mRates [i] ;
+  }
+  if (ok && (mTotalRate > 100.0)) {
+    outErrorMessage = "Error injection rates add up to more than 100 %" ;
+    ok = false ;
+  }
+  if (!ok) {
+    for (U32 i=0 ; i<INJECTION_KIND_COUNT ; i++) {
+      mRates [i] = 0.0 ;
+    }
+    mTotalRate = 0.0 ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroErrorInjector::compileTerm (const std::string & inTerm,
+                                              std::string & outErrorMessage) {
+  const size_t equal = inTerm.find ('=') ;
+  U32 kind = 0 ;
+  if (equal != std::string::npos) {
+    for (U32 i=1 ; (i<INJECTION_KIND_COUNT) && (kind == 0) ; i++) {
+      if (inTerm.compare (0, equal, KIND_NAMES [i]) == 0) {
+        kind = i ;
+      }
+    }
+  }
+  bool ok = kind != 0 ;
+  if (ok) {
+    const char * start = inTerm.c_str () + equal + 1 ;
+    char * end = nullptr ;
+    const double rate = strtod (start, &end) ;
+    ok = (end != start) && (rate >= 0.0) && (rate <= 100.0) ;
+    mRates [kind] = rate ;
+    if (ok && (*end == '@')) {
+      start = end + 1 ;
+      const long position = strtol (start, &end, 10) ;
+      ok = (end != start) && (position >= 0) && (position < 1000) ;
+      mPositions [kind] = S32 (position) ;
+    }
+    ok = ok && (*end == '\0') ;
+  }
+  if (!ok) {
+    outErrorMessage = "Invalid error injection term: \"" + inTerm + "\"" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroErrorInjector::reset (const U32 inSeed) {
+  mSeed = inSeed ^ 0x5EED1234U ;
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroErrorInjector::Injection CANFDMolinaroErrorInjector::nextInjection (void) {
+  Injection injection = { NO_INJECTION, -1, 0 } ;
+  if (mTotalRate > 0.0) {
+    const double draw = double ((pseudoRandomValue () >> 8) % 1000000) / 10000.0 ; // [0, 100)
+    double cumulatedRate = 0.0 ;
+    for (U32 i=1 ; (i<INJECTION_KIND_COUNT) && (injection.mKind == NO_INJECTION) ; i++) {
+      cumulatedRate += mRates [i] ;
+      if (draw < cumulatedRate) {
+        injection.mKind = InjectionKind (i) ;
+        injection.mPosition = mPositions [i] ;
+        injection.mRandom = pseudoRandomValue () >> 8 ;
+      }
+    }
+  }
+  return injection ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+#ifndef CANFDMOLINARO_ERROR_INJECTOR_H
+#define CANFDMOLINARO_ERROR_INJECTOR_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <string>
+
+//----------------------------------------------------------------------------------------
+//  Simulator error injection. The specification is a list of terms, separated by commas
+//  or spaces, each one is kind=rate or kind=rate@position; rate is the percentage of
+//  frames that get this fault (rates add up, at most 100), position is optional:
+//
+//    flip        a bit is inverted (position: frame bit index, stuff bits included)
+//    stuff       a dynamic stuff bit is inverted, giving a stuff error (position: stuff bit rank)
+//    crc         the CRC field is sent with one bit inverted (position: CRC bit, 0 is LSB)
+//    form        a delimiter bit is dominant (position: 0 CRC DEL, 1 ACK DEL, 2-7 EOF)
+//    glitch      a pulse of 1/8 bit of opposite level within a bit (position: bit index)
+//    errorflag   frame is aborted by an active error flag (position: first flag bit)
+//    overload    an overload flag follows the EOF field
+//
+//  For example, "flip=2, crc=1, glitch=0.5@20". Faults are drawn with a generator of their
+//  own, so the generated frames are the same with or without injection.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroErrorInjector {
+  public: CANFDMolinaroErrorInjector (void) ;
+
+  public: typedef enum {
+    NO_INJECTION, BIT_FLIP, STUFF_ERROR, CRC_CORRUPTION, FORM_ERROR, GLITCH, ERROR_FLAG, OVERLOAD_FLAG
+  } InjectionKind ;
+
+  public: static const U32 INJECTION_KIND_COUNT = 8 ;
+
+  public: typedef struct {
+    InjectionKind mKind ;
+    S32 mPosition ; // -1 if random
+    U32 mRandom ; // For choosing a random position
+  } Injection ;
+
+//--- Returns false and sets outErrorMessage on syntax error (no fault is then injected)
+  public: bool compile (const std::string & inSource, std::string & outErrorMessage) ;
+
+  public: inline bool isEmpty (void) const { return mTotalRate == 0.0 ; }
+
+  public: void reset (const U32 inSeed) ;
+
+//--- Fault of next frame (NO_INJECTION kind for an error free frame)
+  public: Injection nextInjection (void) ;
+
+//--- Private methods
+  private: U32 pseudoRandomValue (void) {
+    mSeed = 8253729U * mSeed + 2396403U ;
+    return mSeed ;
+  }
+  private: bool compileTerm (const std::string & inTerm, std::string & outErrorMessage) ;
+
+//--- Private properties
+  private: double mRates [INJECTION_KIND_COUNT] ; // In %
+  private: S32 mPositions [INJECTION_KIND_COUNT] ;
+  private: double mTotalRate ;
+  private: U32 mSeed ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_ERROR_INJECTOR_H
@@ -0,0 +1,1124 @@
+#include "CANFDMolinaroFrameDecoder.h"
+#include "CANFDMolinaroAnalyzerResults.h"
+#include <algorithm>
+
+//----------------------------------------------------------------------------------------
+
+static const uint8_t CANFD_LENGTH [16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64} ;
+
+static const U8 GRAY_CODE_DECODER [8] = {0, 1, 3, 2, 7, 6, 4, 5} ;
+
+//----------------------------------------------------------------------------------------
+//  Dynamic destuffing: a received bit is a frame bit, a stuff bit (after 5 bits of the
+//  same polarity, and of opposite polarity) or a stuff error. The table is indexed by
+//  (run length - 1) * 4 + previous bit * 2 + received bit; it gives the bit kind and the
+//  run length after the bit (6 after a stuff error, error frame decoding counts from it).
+//----------------------------------------------------------------------------------------
+
+typedef enum {FRAME_BIT, STUFF_BIT, STUFF_ERROR} DestuffedBitKind ;
+
+typedef struct {
+  DestuffedBitKind mKind ;
+  U8 mRunLength ;
+} DestuffingStep ;
+
+static const DestuffingStep DESTUFFING_TABLE [5 * 4] = {
+  {FRAME_BIT, 2}, {FRAME_BIT, 1}, {FRAME_BIT, 1}, {FRAME_BIT, 2}, // Run length 1
+  {FRAME_BIT, 3}, {FRAME_BIT, 1}, {FRAME_BIT, 1}, {FRAME_BIT, 3}, // Run length 2
+  {FRAME_BIT, 4}, {FRAME_BIT, 1}, {FRAME_BIT, 1}, {FRAME_BIT, 4}, // Run length 3
+  {FRAME_BIT, 5}, {FRAME_BIT, 1}, {FRAME_BIT, 1}, {FRAME_BIT, 5}, // Run length 4
+  {STUFF_ERROR, 6}, {STUFF_BIT, 1}, {STUFF_BIT, 1}, {STUFF_ERROR, 6} // Run length 5
+} ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroFrameDecoder::CANFDMolinaroFrameDecoder (void) :
+mOutput (nullptr),
+mMarkerOutput (true),
+mSampleRateHz (0),
+mArbitrationBitRate (1),
+mDataBitRate (1),
+mArbitrationSamplePoint (75),
+mDataSamplePoint (75),
+mProtocol (CANFD_ISO_PROTOCOL),
+mEnterDynamicBitInCRCs (&CANFDMolinaroFrameDecoder::enterDynamicBitInCANFDCRCs),
+mSamplesPerArbitrationBit (1),
+mSamplesPerDataBit (1),
+mDataSamplesBeforeSamplePoint (0),
+mDataPhaseSJWSamples (0),
+mStartOfFieldSampleNumber (0),
+mStartOfFrameSampleNumber (0),
+mCurrentSamplesPerBit (1),
+mDataPhase (false),
+mResynchronizingDataPhase (false),
+mFrameFieldEngineState (FrameFieldEngineState::IDLE),
+mFieldBitIndex (0),
+mConsecutiveBitCountOfSamePolarity (0),
+mPreviousBit (true),
+mUnstuffingActive (false),
+mFixedStuffingActive (false),
+mFixedStuffBitCount (0),
+mFrameIndex (0),
+mFieldBits (0),
+mIdentifier (0),
+mStuffBitCount (0),
+mDataCodeLength (0),
+mData (64, 0),
+mCRC15Accumulator (0),
+mCRC15 (0),
+mCRC17Accumulator (0),
+mCRC17 (0),
+mCRC21Accumulator (0),
+mCRC21 (0),
+mSDT (0),
+mSEC (false),
+mVCID (0),
+mAcceptanceField (0),
+mPCRCAccumulator (0),
+mPCRC (0),
+mFCRCAccumulator (0),
+mFCRC (0),
+mFrameFormat (FrameFormat::base),
+mFrameType (FrameType::canData),
+mBRS (false),
+mESI (false),
+mAcked (false),
+mCRCIsValid (false),
+mMarkerTypeForDataAndCRC (AnalyzerResults::Dot),
+mCounters () {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::configure (const CANFDMolinaroAnalyzerSettings & inSettings,
+                                           const U32 inBus,
+                                           const U32 inSampleRateHz) {
+  const BusBitTiming timing = inSettings.busBitTiming (inBus) ;
+  mSampleRateHz = inSampleRateHz ;
+  mArbitrationBitRate = timing.mArbitrationBitRate ;
+  mDataBitRate = timing.mDataBitRate ;
+  mArbitrationSamplePoint = timing.mArbitrationSamplePoint ;
+  mDataSamplePoint = timing.mDataSamplePoint ;
+  mProtocol = inSettings.protocol () ;
+  mEnterDynamicBitInCRCs = (mProtocol == CANXL_PROTOCOL)
+    ? &CANFDMolinaroFrameDecoder::enterDynamicBitInCANXLCRCs
+    : &CANFDMolinaroFrameDecoder::enterDynamicBitInCANFDCRCs ;
+//--- Derived bit timing
+  mSamplesPerArbitrationBit = inSampleRateHz / timing.mArbitrationBitRate ;
+  mSamplesPerDataBit = inSampleRateHz / timing.mDataBitRate ;
+  mDataSamplesBeforeSamplePoint = mSamplesPerDataBit * mDataSamplePoint / 100 ;
+  const U32 dataPhaseSJW = inSettings.dataPhaseSJW () ; // % of data bit
+  mDataPhaseSJWSamples = (dataPhaseSJW == 0) ? 0 : std::max (U32 (1), mSamplesPerDataBit * dataPhaseSJW / 100) ;
+  mCurrentSamplesPerBit = mSamplesPerArbitrationBit ;
+  mCounters.reset () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::reset (const bool inBusLevel) {
+  mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
+  mUnstuffingActive = false ;
+  mFixedStuffingActive = false ;
+  mPreviousBit = inBusLevel ;
+  mCurrentSamplesPerBit = mSamplesPerArbitrationBit ;
+  mDataPhase = false ;
+  mResynchronizingDataPhase = false ;
+  mFrameIndex = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroFrameDecoder::dataLength (void) const {
+  U32 result = 0 ;
+  if (mFrameType == FrameType::canxlData) {
+    result = mDataCodeLength + 1 ;
+  }else if (mFrameType != FrameType::remote) {
+    result = CANFD_LENGTH [mDataCodeLength] ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+//  SNAPSHOTS
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroDecoderSnapshot CANFDMolinaroFrameDecoder::takeSnapshot (const U64 inSampleNumber) const {
+  CANFDMolinaroDecoderSnapshot snapshot ;
+  snapshot.mSampleNumber = inSampleNumber ;
+  snapshot.mFrameIndex = mFrameIndex ;
+  snapshot.mSamplesPerBit = mCurrentSamplesPerBit ;
+  snapshot.mFrameFieldEngineState = U8 (mFrameFieldEngineState) ;
+  snapshot.mFieldBitIndex = U8 (mFieldBitIndex) ;
+  snapshot.mConsecutiveBitCountOfSamePolarity = U8 (mConsecutiveBitCountOfSamePolarity) ;
+  snapshot.mPreviousBit = mPreviousBit ;
+  snapshot.mUnstuffingActive = mUnstuffingActive ;
+  snapshot.mCRC15Accumulator = mCRC15Accumulator ;
+  snapshot.mCRC17Accumulator = mCRC17Accumulator ;
+  snapshot.mCRC21Accumulator = mCRC21Accumulator ;
+  snapshot.mStuffBitCount = mStuffBitCount ;
+  return snapshot ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::restoreSnapshot (const CANFDMolinaroDecoderSnapshot & inSnapshot) {
+  mFrameIndex = inSnapshot.mFrameIndex ;
+  mCurrentSamplesPerBit = inSnapshot.mSamplesPerBit ;
+  mDataPhase = false ; // Snapshots are taken at SOF
+  mResynchronizingDataPhase = false ;
+  mFrameFieldEngineState = FrameFieldEngineState (inSnapshot.mFrameFieldEngineState) ;
+  mFieldBitIndex = inSnapshot.mFieldBitIndex ;
+  mConsecutiveBitCountOfSamePolarity = inSnapshot.mConsecutiveBitCountOfSamePolarity ;
+  mPreviousBit = inSnapshot.mPreviousBit ;
+  mUnstuffingActive = inSnapshot.mUnstuffingActive ;
+  mFixedStuffingActive = false ;
+  mCRC15Accumulator = inSnapshot.mCRC15Accumulator ;
+  mCRC17Accumulator = inSnapshot.mCRC17Accumulator ;
+  mCRC21Accumulator = inSnapshot.mCRC21Accumulator ;
+  mStuffBitCount = inSnapshot.mStuffBitCount ;
+}
+
+//----------------------------------------------------------------------------------------
+//  CAN FRAME DECODER
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBit (const bool inBit, U64 & ioBitCenterSampleNumber) {
+  mCounters.increment (mDataPhase ? CANFDMolinaroDecoderCounters::DATA_BITS : CANFDMolinaroDecoderCounters::ARBITRATION_BITS) ;
+  if (mFixedStuffingActive) { // CAN XL data phase
+    if (mFixedStuffBitCount < 10) {
+      mFixedStuffBitCount += 1 ;
+      decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
+      mPreviousBit = inBit ;
+    }else if (inBit != mPreviousBit) { // Fixed stuff bit - discarded
+      if (mFrameFieldEngineState != FrameFieldEngineState::XL_DATA) {
+        addMark (ioBitCenterSampleNumber, AnalyzerResults::X) ;
+      }
+      mCounters.increment (CANFDMolinaroDecoderCounters::STUFF_BITS) ;
+      mFixedStuffBitCount = 0 ;
+      mPreviousBit = inBit ;
+    }else{ // Stuff Error
+      addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+      enterInErrorMode (ioBitCenterSampleNumber + samplesAfterSamplePoint (), CANFDMolinaroDecoderCounters::STUFF_ERRORS) ;
+    }
+  }else if (!mUnstuffingActive) {
+    decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
+    mPreviousBit = inBit ;
+  }else{ // Dynamic stuffing, run length is 1 ... 5
+    const DestuffingStep step = DESTUFFING_TABLE [
+      (mConsecutiveBitCountOfSamePolarity - 1) * 4 + (U32 (mPreviousBit) << 1) + U32 (inBit)
+    ] ;
+    mConsecutiveBitCountOfSamePolarity = step.mRunLength ;
+    mPreviousBit = inBit ;
+    switch (step.mKind) {
+    case FRAME_BIT :
+      decodeFrameBit (inBit, ioBitCenterSampleNumber) ;
+      enterDynamicBitInCRCs (inBit) ;
+      break ;
+    case STUFF_BIT : // Discarded
+      addMark (ioBitCenterSampleNumber, AnalyzerResults::X);
+      mStuffBitCount += 1 ;
+      mCounters.increment (CANFDMolinaroDecoderCounters::STUFF_BITS) ;
+      enterDynamicBitInCRCs (inBit) ;
+      break ;
+    case STUFF_ERROR :
+      addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorX);
+      enterInErrorMode (ioBitCenterSampleNumber + samplesAfterSamplePoint (), CANFDMolinaroDecoderCounters::STUFF_ERRORS) ;
+      break ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  DATA PHASE RESYNCHRONIZATION
+//  With Data Phase SJW, the data phase is sampled at the data sample point, as a CAN
+//  controller does; only recessive to dominant edges resynchronize, and the phase error
+//  is compensated by at most SJW. So the dominant to recessive edges, that asymmetric
+//  transceiver delays shift, do not move sampling.
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroFrameDecoder::resynchronize (const U64 inEdgeSampleNumber,
+                                              const U64 inNextSampleNumber,
+                                              const bool inDominantEdge) const {
+  U64 result = inEdgeSampleNumber + mCurrentSamplesPerBit / 2 ;
+  if (mResynchronizingDataPhase) {
+    result = inNextSampleNumber ;
+    if (inDominantEdge) {
+      const S64 sjw = S64 (mDataPhaseSJWSamples) ;
+      const S64 phaseError = S64 (inEdgeSampleNumber) - S64 (inNextSampleNumber - mDataSamplesBeforeSamplePoint) ;
+      result = U64 (S64 (inNextSampleNumber) + std::min (sjw, std::max (-sjw, phaseError))) ;
+    }
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+//  BIT RATE SWITCH
+//  At BRS (CANFD) or ADH (CAN XL), the bit has arbitration phase 1 and data phase 2; at
+//  CRC DEL (CANFD) or DAH (CAN XL), the bit has data phase 1 and arbitration phase 2.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::switchToDataBitRate (U64 & ioBitCenterSampleNumber,
+                                                     const AnalyzerResults::MarkerType inMarker) {
+  const U64 samplesForDataBitRate = mSamplesPerDataBit ;
+  const U64 BSRsamplesX100 =
+    mArbitrationSamplePoint * mCurrentSamplesPerBit
+  +
+    (100 - mDataSamplePoint) * samplesForDataBitRate
+  ;
+  const U64 centerBSR = ioBitCenterSampleNumber - mCurrentSamplesPerBit / 2 + BSRsamplesX100 / 200 ;
+  addMark (centerBSR, inMarker) ;
+//--- Adjust for center (or sample point) of next bit
+  ioBitCenterSampleNumber -= mCurrentSamplesPerBit / 2 ; // Returns at the beginning of BRS bit
+  ioBitCenterSampleNumber += BSRsamplesX100 / 100 ; // Advance at the beginning of next bit
+  const U64 nextBitStart = ioBitCenterSampleNumber ;
+//--- Switch to Data Bit Rate
+  mCurrentSamplesPerBit = samplesForDataBitRate ;
+  mDataPhase = true ;
+  mResynchronizingDataPhase = mDataPhaseSJWSamples > 0 ;
+  if (!mResynchronizingDataPhase) {
+    ioBitCenterSampleNumber -= samplesForDataBitRate / 2 ; // Back half of a data bit rate bit
+  }else{
+    ioBitCenterSampleNumber -= samplesForDataBitRate - mDataSamplesBeforeSamplePoint ; // Back a bit, to sample point
+  }
+  mMarkerTypeForDataAndCRC = AnalyzerResults::Square ;
+  mOutput->bitRateSwitch (nextBitStart, true) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::switchToArbitrationBitRate (U64 & ioBitCenterSampleNumber,
+                                                            const AnalyzerResults::MarkerType inMarker) {
+  const U32 samplesPerArbitrationBit = mSamplesPerArbitrationBit ;
+  const U64 CRCDELsamplesX100 =
+    mDataSamplePoint * mCurrentSamplesPerBit
+  +
+    (100 - mArbitrationSamplePoint) * samplesPerArbitrationBit
+  ;
+  const U64 startCRCDEL = ioBitCenterSampleNumber - samplesBeforeSamplePoint () ;
+  const U64 centerCRCDEL = startCRCDEL + CRCDELsamplesX100 / 200 ;
+  addMark (centerCRCDEL, inMarker) ;
+//--- Adjust for center of next bit
+  ioBitCenterSampleNumber = startCRCDEL ; // Returns at the beginning of CRCDEL bit
+  ioBitCenterSampleNumber += CRCDELsamplesX100 / 100 ; // Advance at the beginning of next bit
+  ioBitCenterSampleNumber -= samplesPerArbitrationBit / 2 ; // Back half of a arbitration bit rate bit
+//--- Switch to Arbitration Bit Rate
+  mCurrentSamplesPerBit = samplesPerArbitrationBit ;
+  mDataPhase = false ;
+  mResynchronizingDataPhase = false ;
+  mOutput->bitRateSwitch (ioBitCenterSampleNumber + mCurrentSamplesPerBit / 2, false) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::decodeFrameBit (const bool inBit, U64 & ioBitCenterSampleNumber) {
+  mFieldBits = (mFieldBits << 1) | inBit ;
+  switch (mFrameFieldEngineState) {
+  case FrameFieldEngineState::IDLE :
+    handle_IDLE_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::IDENTIFIER :
+    handle_IDENTIFIER_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CONTROL_EXTENDED :
+    handle_CONTROL_EXTENDED_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CONTROL_BASE :
+    handle_CONTROL_BASE_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CONTROL_AFTER_R0 :
+    handle_CONTROL_AFTER_R0_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::DATA :
+    handle_DATA_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::SBC :
+    handle_SBC_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CRC15 :
+    handle_CRC15_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CRC17 :
+    handle_CRC17_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CRC21 :
+    handle_CRC21_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::CRCDEL :
+    handle_CRCDEL_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::ACK :
+    handle_ACK_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::ENDOFFRAME :
+    handle_ENDOFFRAME_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::INTERMISSION :
+    handle_INTERMISSION_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::DECODER_ERROR :
+    handle_DECODER_ERROR_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_ADS :
+    handle_XL_ADS_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_CONTROL :
+    handle_XL_CONTROL_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_PCRC :
+    handle_XL_PCRC_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_ACCEPTANCE :
+    handle_XL_ACCEPTANCE_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_DATA :
+    handle_XL_DATA_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_FCRC :
+    handle_XL_FCRC_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_FCP :
+    handle_XL_FCP_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  case FrameFieldEngineState::XL_DAS :
+    handle_XL_DAS_state (inBit, ioBitCenterSampleNumber) ;
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_IDLE_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  if (inBit) {
+    mOutput->busIdleBit () ;
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Stop) ;
+  }else{ // SOF
+    mOutput->startOfFrame (*this, inBitCenterSampleNumber - mCurrentSamplesPerBit / 2) ;
+    mFrameIndex += 1 ;
+    mUnstuffingActive = true ;
+    mCRC15Accumulator = 0 ;
+    switch (mProtocol) {
+    case CANFD_NON_ISO_PROTOCOL :
+      mCRC17Accumulator = 0 ;
+      mCRC21Accumulator = 0 ;
+      break ;
+    case CANFD_ISO_PROTOCOL :
+    case CANXL_PROTOCOL :
+      mCRC17Accumulator = 1 << 16 ;
+      mCRC21Accumulator = 1 << 20 ;
+      break ;
+    }
+    mPCRCAccumulator = 0x1FFF ;
+    mFCRCAccumulator = 0xFFFFFFFF ;
+    mConsecutiveBitCountOfSamePolarity = 1 ;
+    mPreviousBit = false ;
+    enterBitInCRC15 (inBit) ;
+    enterDynamicBitInCRCs (inBit) ;
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Start);
+    mFieldBitIndex = 0 ;
+    mIdentifier = 0 ;
+    mStuffBitCount = 0 ;
+    mCRCIsValid = false ;
+    mFrameFieldEngineState = FrameFieldEngineState::IDENTIFIER ;
+    mCurrentSamplesPerBit = mSamplesPerArbitrationBit ;
+    mStartOfFieldSampleNumber = inBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
+    mStartOfFrameSampleNumber = inBitCenterSampleNumber ;
+    mMarkerTypeForDataAndCRC = AnalyzerResults::Dot ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_IDENTIFIER_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex <= 11) { // Standard identifier
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Dot);
+  }else if (mFieldBitIndex == 12) { // RTR or SRR bit
+    mFrameType = inBit ? FrameType::remote : FrameType::canData  ;
+  }else if (mFieldBitIndex == 13) { // IDE bit
+    mIdentifier = U32 (fieldBits (13) >> 2) ; // Standard identifier, RTR or SRR, IDE
+    mFrameFormat = inBit ? FrameFormat::extended : FrameFormat::base ;
+    if (!inBit) { // IDE dominant -> base frame
+    //--- RTR mark
+      addMark (inBitCenterSampleNumber - mCurrentSamplesPerBit,
+               inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
+    //--- IDE Mark
+      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
+    //--- Bubble
+      addBubble (STANDARD_IDENTIFIER_FIELD_RESULT,
+                 mIdentifier,
+                 mFrameType == FrameType::canData, // 0 -> remote, 1 -> data
+                 inBitCenterSampleNumber - mCurrentSamplesPerBit) ;
+      mFieldBitIndex = 0 ;
+      mFrameFieldEngineState = FrameFieldEngineState::CONTROL_BASE ;
+    }else{ // IDE recessive -> extended frame
+    //--- SRR mark
+      addMark (inBitCenterSampleNumber - mCurrentSamplesPerBit, inBit ? AnalyzerResults::One : AnalyzerResults::ErrorSquare) ;
+    //--- IDE Mark
+      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+    }
+  }else if (mFieldBitIndex < 32) { // ID17 ... ID0
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Dot);
+  }else{ // RTR
+    mIdentifier = (mIdentifier << 18) | U32 (fieldBits (19) >> 1) ; // ID17 ... ID0, RTR
+    mFrameType = inBit ? FrameType::remote : FrameType::canData ;
+    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
+  //--- Bubble
+    addBubble (EXTENDED_IDENTIFIER_FIELD_RESULT,
+               mIdentifier,
+               mFrameType == FrameType::canData, // 0 -> remote, 1 -> data
+               inBitCenterSampleNumber) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_EXTENDED ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+
+void CANFDMolinaroFrameDecoder::handle_CONTROL_BASE_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 1) { // FDF bit
+    if (inBit) { // FDF recessive -> CANFD frame
+      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+      mFrameType = FrameType::canfdData ;
+    }else{
+      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
+      mFieldBitIndex = 0 ;
+      mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
+    }
+    mOutput->frameHeaderDecoded (*this, inBit) ;
+  }else if (inBit && (mProtocol == CANXL_PROTOCOL)) { // XLF recessive -> CAN XL frame
+    addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+    mFrameType = FrameType::canxlData ;
+    mUnstuffingActive = false ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_ADS ;
+  }else if (inBit) { // R0 bit recessive -> error
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }else{ // R0 dominant: ok
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Zero) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+
+void CANFDMolinaroFrameDecoder::handle_CONTROL_EXTENDED_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 1) { // FDF bit
+    if (inBit) { // FDF recessive -> CANFD frame
+      addMark (inBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+      mFrameType = FrameType::canfdData ;
+    }else{
+      addMark (inBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
+    }
+    mOutput->frameHeaderDecoded (*this, inBit) ;
+  }else if (inBit) { // R0 bit recessive -> error
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }else{ // R0 dominant: ok
+    addMark (inBitCenterSampleNumber, AnalyzerResults::Zero) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CONTROL_AFTER_R0 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_CONTROL_AFTER_R0_state (const bool inBit,
+                                                           U64 & ioBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  mFieldBitIndex ++ ;
+  if (mFrameType == FrameType::canfdData) {
+    if (mFieldBitIndex == 1) { // BRS
+      mBRS = inBit ;
+      if (inBit) { // Switch to data bit rate
+        switchToDataBitRate (ioBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+      }else{
+        addMark (ioBitCenterSampleNumber, AnalyzerResults::DownArrow) ;
+      }
+    }else if (mFieldBitIndex == 2) { // ESI
+      addMark (ioBitCenterSampleNumber, inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
+      mESI = inBit ;
+    }else{
+      addMark (ioBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+      if (mFieldBitIndex == 6) {
+        mDataCodeLength = fieldBits (4) ;
+        const U32 data2 = U32 (mBRS) | (U32 (mESI) << 1) ;
+        addBubble (CANFD_CONTROL_FIELD_RESULT, mDataCodeLength, data2, ioBitCenterSampleNumber) ;
+        mFieldBitIndex = 0 ;
+        if (mDataCodeLength != 0) {
+          mFrameFieldEngineState = FrameFieldEngineState::DATA ;
+        }else if (mProtocol == CANFD_NON_ISO_PROTOCOL) { // No Data, CANFD non ISO
+          mOutput->framePayloadDecoded (*this) ;
+          mCRC17 = mCRC17Accumulator ;
+          mUnstuffingActive = false ;
+          mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
+        }else{  // No Data, CANFD ISO
+          mOutput->framePayloadDecoded (*this) ;
+          mUnstuffingActive = false ;
+          mFrameFieldEngineState = FrameFieldEngineState::SBC ;
+        }
+      }
+    }
+  }else{ // Base frame
+    addMark (ioBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+    if (mFieldBitIndex == 4) {
+      mDataCodeLength = fieldBits (4) ;
+      addBubble (CAN20B_CONTROL_FIELD_RESULT, mDataCodeLength, 0, ioBitCenterSampleNumber) ;
+      mFieldBitIndex = 0 ;
+      if ((mDataCodeLength > 8) && (mFrameType != FrameType::canfdData)) {
+        mDataCodeLength = 8 ;
+      }
+      mCRC15 = mCRC15Accumulator ;
+      if (mFrameType == FrameType::remote) {
+        mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
+      }else if (mDataCodeLength > 0) {
+        mFrameFieldEngineState = FrameFieldEngineState::DATA ;
+      }else if (mFrameType == FrameType::canData) {
+        mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
+      }
+      if (mFrameFieldEngineState != FrameFieldEngineState::DATA) {
+        mOutput->framePayloadDecoded (*this) ;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+  mFieldBitIndex += 1 ;
+  if ((mFieldBitIndex % 8) == 0) {
+    const U32 dataIndex = (mFieldBitIndex - 1) / 8 ;
+    mData [dataIndex] = U8 (fieldBits (8)) ;
+    addBubble (DATA_FIELD_RESULT, mData [dataIndex], dataIndex, inBitCenterSampleNumber) ;
+  }
+  if (mFieldBitIndex == (8 * CANFD_LENGTH [mDataCodeLength])) {
+    mFieldBitIndex = 0 ;
+    mOutput->framePayloadDecoded (*this) ;
+    if (mFrameType != FrameType::canfdData) {
+      mCRC15 = mCRC15Accumulator ;
+      mFrameFieldEngineState = FrameFieldEngineState::CRC15 ;
+    }else if (mProtocol != CANFD_NON_ISO_PROTOCOL) {
+      mFrameFieldEngineState = FrameFieldEngineState::SBC ;
+      mUnstuffingActive = false ;
+    }else if (mDataCodeLength <= 10) {
+      mCRC17 = mCRC17Accumulator ;
+      mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
+      mUnstuffingActive = false ;
+    }else{
+      mCRC21 = mCRC21Accumulator ;
+      mFrameFieldEngineState = FrameFieldEngineState::CRC21 ;
+      mUnstuffingActive = false ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_CRC15_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInCRC15 (inBit) ;
+  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+  mFieldBitIndex += 1 ;
+  if (mFieldBitIndex == 15) {
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
+    addBubble (CRC15_FIELD_RESULT, mCRC15, mCRC15Accumulator, inBitCenterSampleNumber) ;
+    mCRCIsValid = mCRC15Accumulator == 0 ;
+    if (mCRC15Accumulator != 0) {
+      enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::CRC_ERRORS) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_SBC_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  mFieldBitIndex += 1 ;
+  if (mFieldBitIndex == 1) { // Forced Stuff Bit
+    if (inBit == mPreviousBit) {
+      addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+      enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::STUFF_ERRORS) ;
+    }else{
+      addMark (inBitCenterSampleNumber, AnalyzerResults::X);
+      mCounters.increment (CANFDMolinaroDecoderCounters::STUFF_BITS) ;
+    }
+  }else if (mFieldBitIndex <= 4) {
+    enterBitInCRC17 (inBit) ;
+    enterBitInCRC21 (inBit) ;
+    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+  }else{ // Parity bit
+    enterBitInCRC17 (inBit) ;
+    enterBitInCRC21 (inBit) ;
+    const U32 sbcField = fieldBits (4) ; // Gray coded stuff bit count, parity bit
+    const U8 suffBitCountMod8 = GRAY_CODE_DECODER [sbcField >> 1] ;
+  //--- Check parity
+    bool oneBitCountIsEven = true ;
+    U32 v = sbcField ;
+    while (v > 0) {
+      oneBitCountIsEven ^= (v & 1) != 0 ;
+      v >>= 1 ;
+    }
+    addMark (inBitCenterSampleNumber, oneBitCountIsEven ? AnalyzerResults::Dot : AnalyzerResults::ErrorX) ;
+    const U32 data2 = ((mStuffBitCount % 8) << 1) | !oneBitCountIsEven ;
+    addBubble (SBC_FIELD_RESULT, suffBitCountMod8, data2, inBitCenterSampleNumber) ;
+    mUnstuffingActive = false ;
+    mFieldBitIndex = 0 ;
+    if (mDataCodeLength <= 10) {
+      mCRC17 = mCRC17Accumulator ;
+      mFrameFieldEngineState = FrameFieldEngineState::CRC17 ;
+    }else{
+      mCRC21 = mCRC21Accumulator ;
+      mFrameFieldEngineState = FrameFieldEngineState::CRC21 ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_CRC17_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  if ((mFieldBitIndex % 5) != 0) {
+    enterBitInCRC17 (inBit) ;
+    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+  }else if (inBit == mPreviousBit) {
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::STUFF_ERRORS) ;
+  }else{
+    addMark (inBitCenterSampleNumber, AnalyzerResults::X);
+    mCounters.increment (CANFDMolinaroDecoderCounters::STUFF_BITS) ;
+  }
+  mFieldBitIndex += 1 ;
+  if (mFieldBitIndex == 22) {
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
+    addBubble (CRC17_FIELD_RESULT, mCRC17, mCRC17Accumulator, inBitCenterSampleNumber) ;
+    mCRCIsValid = mCRC17Accumulator == 0 ;
+    if (!mCRCIsValid) {
+      mCounters.increment (CANFDMolinaroDecoderCounters::CRC_ERRORS) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_CRC21_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  if ((mFieldBitIndex % 5) != 0) {
+    enterBitInCRC21 (inBit) ;
+    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC);
+  }else if (inBit == mPreviousBit) {
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::STUFF_ERRORS) ;
+  }else{
+    addMark (inBitCenterSampleNumber, AnalyzerResults::X);
+    mCounters.increment (CANFDMolinaroDecoderCounters::STUFF_BITS) ;
+  }
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 27) {
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::CRCDEL ;
+    addBubble (CRC21_FIELD_RESULT, mCRC21, mCRC21Accumulator, inBitCenterSampleNumber) ;
+    mCRCIsValid = mCRC21Accumulator == 0 ;
+    if (!mCRCIsValid) {
+      mCounters.increment (CANFDMolinaroDecoderCounters::CRC_ERRORS) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_CRCDEL_state (const bool inBit, U64 & ioBitCenterSampleNumber) {
+  mUnstuffingActive = false ;
+  if (inBit) { // Handle Bit Rate Switch: data bit rate -> arbitration bit rate
+    switchToArbitrationBitRate (ioBitCenterSampleNumber, AnalyzerResults::One) ;
+  }else{
+    addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (ioBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }
+  mStartOfFieldSampleNumber = ioBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
+  mFrameFieldEngineState = FrameFieldEngineState::ACK ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_ACK_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 1) { // ACK SLOT
+    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::ErrorSquare : AnalyzerResults::DownArrow);
+    mAcked = inBit ;
+  }else{ // ACK DELIMITER
+    addBubble (ACK_FIELD_RESULT, mAcked, 0, inBitCenterSampleNumber) ;
+    mFrameFieldEngineState = FrameFieldEngineState::ENDOFFRAME ;
+    if (inBit) {
+      addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
+      countReceivedFrame () ;
+      mOutput->frameReceived (*this, inBitCenterSampleNumber + mCurrentSamplesPerBit / 2) ;
+    }else{
+      addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
+      enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::ACK_DELIMITER_ERRORS) ;
+    }
+    mFieldBitIndex = 0 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_ENDOFFRAME_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  if (inBit) {
+    addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
+  }else{
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 7) {
+    addBubble (EOF_FIELD_RESULT, 0, 0, inBitCenterSampleNumber) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::INTERMISSION ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_INTERMISSION_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  if (inBit) {
+    addMark (inBitCenterSampleNumber, AnalyzerResults::One) ;
+  }else{
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 3) {
+    addBubble (INTERMISSION_FIELD_RESULT, 0, 0, inBitCenterSampleNumber) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
+    mOutput->endOfFrame (inBitCenterSampleNumber + mCurrentSamplesPerBit / 2) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_DECODER_ERROR_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  mUnstuffingActive = false ;
+  addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorDot);
+  if (mPreviousBit != inBit) {
+    mConsecutiveBitCountOfSamePolarity = 1 ;
+    mPreviousBit = inBit ;
+  }else if (inBit) {
+    mConsecutiveBitCountOfSamePolarity += 1 ;
+    if (mConsecutiveBitCountOfSamePolarity == 11) {
+      addBubble (CAN_ERROR_RESULT, 0, 0, inBitCenterSampleNumber) ;
+      mFrameFieldEngineState = FrameFieldEngineState::IDLE ;
+      mOutput->endOfFrame (inBitCenterSampleNumber + mCurrentSamplesPerBit / 2) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  CAN XL FRAME FIELDS
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_ADS_state (const bool inBit, U64 & ioBitCenterSampleNumber) {
+  enterBitInPCRC (inBit) ;
+  enterBitInFCRC (inBit) ;
+  mFieldBitIndex ++ ;
+  const bool expectedBit = (mFieldBitIndex >= 2) && (mFieldBitIndex <= 4) ; // resXL, ADH, DH1, DH2, DL1
+  if (inBit != expectedBit) {
+    addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
+    enterInErrorMode (ioBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }else if (mFieldBitIndex == 2) { // ADH: switch to data bit rate
+    switchToDataBitRate (ioBitCenterSampleNumber, AnalyzerResults::UpArrow) ;
+  }else if (mFieldBitIndex < 5) {
+    addMark (ioBitCenterSampleNumber, inBit ? AnalyzerResults::One : AnalyzerResults::Zero) ;
+  }else{ // DL1: fixed stuffing starts with SDT
+    addMark (ioBitCenterSampleNumber, AnalyzerResults::Zero) ;
+    mFixedStuffingActive = true ;
+    mFixedStuffBitCount = 0 ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_CONTROL ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_CONTROL_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInPCRC (inBit) ;
+  enterBitInFCRC (inBit) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex <= 8) { // SDT
+    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+    if (mFieldBitIndex == 8) {
+      mSDT = fieldBits (8) ;
+    }
+  }else if (mFieldBitIndex == 9) { // SEC
+    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::UpArrow : AnalyzerResults::DownArrow) ;
+    mSEC = inBit ;
+  }else if (mFieldBitIndex <= 20) { // DLC
+    addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+    if (mFieldBitIndex == 20) {
+      mDataCodeLength = fieldBits (11) ;
+      addBubble (CANXL_CONTROL_FIELD_RESULT, mDataCodeLength, mSDT | (U32 (mSEC) << 8), inBitCenterSampleNumber) ;
+    }
+  }else{ // SBC
+    if (mFieldBitIndex < 23) {
+      addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+    }else{
+      const U8 stuffBitCountMod8 = GRAY_CODE_DECODER [fieldBits (3)] ;
+      const bool countError = stuffBitCountMod8 != (mStuffBitCount % 8) ;
+      addMark (inBitCenterSampleNumber, countError ? AnalyzerResults::ErrorX : mMarkerTypeForDataAndCRC) ;
+      addBubble (SBC_FIELD_RESULT, stuffBitCountMod8, (mStuffBitCount % 8) << 1, inBitCenterSampleNumber) ; // No parity bit
+      mFieldBitIndex = 0 ;
+      mFrameFieldEngineState = FrameFieldEngineState::XL_PCRC ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_PCRC_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInPCRC (inBit) ;
+  enterBitInFCRC (inBit) ;
+  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 13) {
+    mPCRC = U16 (fieldBits (13)) ;
+    addBubble (PCRC_FIELD_RESULT, mPCRC, mPCRCAccumulator, inBitCenterSampleNumber) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_ACCEPTANCE ;
+    if (mPCRCAccumulator != 0) { // Header is not valid
+      enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::CRC_ERRORS) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_ACCEPTANCE_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInFCRC (inBit) ;
+  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 8) { // VCID
+    mVCID = fieldBits (8) ;
+  }else if (mFieldBitIndex == 40) { // AF
+    mAcceptanceField = fieldBits (32) ;
+    addBubble (CANXL_ACCEPTANCE_FIELD_RESULT, mAcceptanceField, mVCID, inBitCenterSampleNumber) ;
+    if (mData.size () < dataLength ()) {
+      mData.resize (dataLength ()) ;
+    }
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_DATA ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  CAN XL data bits have no marker, and the data field is a single bubble (with the
+//  first 8 bytes): the payload is in the frame table.
+
+void CANFDMolinaroFrameDecoder::handle_XL_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInFCRC (inBit) ;
+  mFieldBitIndex += 1 ;
+  if ((mFieldBitIndex % 8) == 0) {
+    mData [(mFieldBitIndex - 1) / 8] = U8 (fieldBits (8)) ;
+  }
+  const U32 length = dataLength () ;
+  if (U32 (mFieldBitIndex) == (8 * length)) {
+    U64 head = 0 ;
+    for (U32 i=0 ; i<8 ; i++) {
+      head <<= 8 ;
+      head |= (i < length) ? mData [i] : 0 ;
+    }
+    addBubble (CANXL_DATA_FIELD_RESULT, length, head, inBitCenterSampleNumber) ;
+    mOutput->framePayloadDecoded (*this) ;
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_FCRC ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_FCRC_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  enterBitInFCRC (inBit) ;
+  addMark (inBitCenterSampleNumber, mMarkerTypeForDataAndCRC) ;
+  mFieldBitIndex ++ ;
+  if (mFieldBitIndex == 32) {
+    mFCRC = fieldBits (32) ;
+    mFixedStuffingActive = false ; // No stuff bit after last FCRC bit
+    addBubble (FCRC_FIELD_RESULT, mFCRC, mFCRCAccumulator, inBitCenterSampleNumber) ;
+    mCRCIsValid = mFCRCAccumulator == 0 ;
+    if (!mCRCIsValid) {
+      mCounters.increment (CANFDMolinaroDecoderCounters::CRC_ERRORS) ;
+    }
+    mFieldBitIndex = 0 ;
+    mFrameFieldEngineState = FrameFieldEngineState::XL_FCP ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_FCP_state (const bool inBit, const U64 inBitCenterSampleNumber) {
+  mFieldBitIndex ++ ;
+  const bool expectedBit = mFieldBitIndex <= 2 ; // 1100
+  if (inBit != expectedBit) {
+    addMark (inBitCenterSampleNumber, AnalyzerResults::ErrorX) ;
+    enterInErrorMode (inBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }else{
+    addMark (inBitCenterSampleNumber, inBit ? AnalyzerResults::One : AnalyzerResults::Zero) ;
+    if (mFieldBitIndex == 4) {
+      mFieldBitIndex = 0 ;
+      mFrameFieldEngineState = FrameFieldEngineState::XL_DAS ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::handle_XL_DAS_state (const bool inBit, U64 & ioBitCenterSampleNumber) {
+  mFieldBitIndex ++ ;
+  const bool expectedBit = mFieldBitIndex != 3 ; // DAH, AH1, AL1, AH2
+  if (inBit != expectedBit) {
+    addMark (ioBitCenterSampleNumber, AnalyzerResults::ErrorDot) ;
+    enterInErrorMode (ioBitCenterSampleNumber, CANFDMolinaroDecoderCounters::FORM_ERRORS) ;
+  }else if (mFieldBitIndex == 1) { // DAH: switch to arbitration bit rate
+    switchToArbitrationBitRate (ioBitCenterSampleNumber, AnalyzerResults::One) ;
+  }else{
+    addMark (ioBitCenterSampleNumber, inBit ? AnalyzerResults::One : AnalyzerResults::Zero) ;
+    if (mFieldBitIndex == 4) {
+      mStartOfFieldSampleNumber = ioBitCenterSampleNumber + mCurrentSamplesPerBit / 2 ;
+      mFieldBitIndex = 0 ;
+      mFrameFieldEngineState = FrameFieldEngineState::ACK ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBitInCRC15 (const bool inBit) {
+  const bool bit14 = (mCRC15Accumulator & (1 << 14)) != 0 ;
+  const bool crc_nxt = inBit ^ bit14 ;
+  mCRC15Accumulator <<= 1 ;
+  mCRC15Accumulator &= 0x7FFF ;
+  if (crc_nxt) {
+    mCRC15Accumulator ^= 0x4599 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBitInCRC17 (const bool inBit) {
+  const bool bit16 = (mCRC17Accumulator & (1 << 16)) != 0 ;
+  const bool crc_nxt = inBit ^ bit16 ;
+  mCRC17Accumulator <<= 1 ;
+  mCRC17Accumulator &= 0x1FFFF ;
+  if (crc_nxt) {
+    mCRC17Accumulator ^= 0x1685B ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBitInCRC21 (const bool inBit) {
+  const bool bit20 = (mCRC21Accumulator & (1 << 20)) != 0 ;
+  const bool crc_nxt = inBit ^ bit20 ;
+  mCRC21Accumulator <<= 1 ;
+  mCRC21Accumulator &= 0x1FFFFF ;
+  if (crc_nxt) {
+    mCRC21Accumulator ^= 0x102899 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Bits of the dynamically stuffed part of the frame, stuff bits included: with the CAN XL
+//  protocol, the PCRC and FCRC of a possible CAN XL frame are also computed
+
+void CANFDMolinaroFrameDecoder::enterDynamicBitInCANFDCRCs (const bool inBit) {
+  enterBitInCRC17 (inBit) ;
+  enterBitInCRC21 (inBit) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterDynamicBitInCANXLCRCs (const bool inBit) {
+  enterBitInCRC17 (inBit) ;
+  enterBitInCRC21 (inBit) ;
+  enterBitInPCRC (inBit) ;
+  enterBitInFCRC (inBit) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBitInPCRC (const bool inBit) {
+  const bool bit12 = (mPCRCAccumulator & (1 << 12)) != 0 ;
+  const bool crc_nxt = inBit ^ bit12 ;
+  mPCRCAccumulator = U16 (mPCRCAccumulator << 1) ;
+  mPCRCAccumulator &= 0x1FFF ;
+  if (crc_nxt) {
+    mPCRCAccumulator ^= 0x1CC1 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterBitInFCRC (const bool inBit) {
+  const bool bit31 = (mFCRCAccumulator & (1U << 31)) != 0 ;
+  const bool crc_nxt = inBit ^ bit31 ;
+  mFCRCAccumulator <<= 1 ;
+  if (crc_nxt) {
+    mFCRCAccumulator ^= 0xF1922815 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::addBubble (const U8 inBubbleType,
+                                           const U64 inData1,
+                                           const U64 inData2,
+                                           const U64 inBitCenterSampleNumber) {
+  const U64 endSampleNumber = inBitCenterSampleNumber + samplesAfterSamplePoint () ;
+  mOutput->decoderBubble (inBubbleType, inData1, inData2, mStartOfFieldSampleNumber, endSampleNumber) ;
+//--- Prepare for next bubble
+  mStartOfFieldSampleNumber = endSampleNumber ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::countReceivedFrame (void) {
+  switch (mFrameType) {
+  case FrameType::canData :
+    mCounters.increment (CANFDMolinaroDecoderCounters::CAN_DATA_FRAMES) ;
+    break ;
+  case FrameType::remote :
+    mCounters.increment (CANFDMolinaroDecoderCounters::CAN_REMOTE_FRAMES) ;
+    break ;
+  case FrameType::canfdData :
+    mCounters.increment (CANFDMolinaroDecoderCounters::CANFD_FRAMES) ;
+    break ;
+  case FrameType::canxlData :
+    mCounters.increment (CANFDMolinaroDecoderCounters::CANXL_FRAMES) ;
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameDecoder::enterInErrorMode (const U64 inBitCenterSampleNumber,
+                                                  const CANFDMolinaroDecoderCounters::Counter inCause) {
+  mCounters.increment (inCause) ;
+  mOutput->frameError () ;
+  mStartOfFieldSampleNumber = inBitCenterSampleNumber ;
+  mCurrentSamplesPerBit = mSamplesPerArbitrationBit ;
+  mDataPhase = false ;
+  mResynchronizingDataPhase = false ;
+  mFrameFieldEngineState = DECODER_ERROR ;
+  mUnstuffingActive = false ;
+  mFixedStuffingActive = false ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,292 @@
+#ifndef CANFDMOLINARO_FRAME_DECODER_H
+#define CANFDMOLINARO_FRAME_DECODER_H
+
+//----------------------------------------------------------------------------------------
+
+#include <AnalyzerResults.h>
+#include "CANFDMolinaroAnalyzerSettings.h"
+#include "CANFDMolinaroDecoderSnapshot.h"
+#include "CANFDMolinaroDecoderCounters.h"
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroFrameDecoder ;
+
+//----------------------------------------------------------------------------------------
+//  Decoder output: markers and field bubbles, and frame events
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroDecoderOutput {
+  public: virtual ~CANFDMolinaroDecoderOutput (void) {}
+
+  public: virtual void decoderMark (const U64 inSampleNumber,
+                                    const AnalyzerResults::MarkerType inMarker) = 0 ;
+
+  public: virtual void decoderBubble (const U8 inBubbleType,
+                                      const U64 inData1,
+                                      const U64 inData2,
+                                      const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber) = 0 ;
+
+//--- Recessive bit while bus is idle
+  public: virtual void busIdleBit (void) {}
+
+//--- SOF, called before decoder state is changed (inSampleNumber is the SOF edge)
+  public: virtual void startOfFrame (const CANFDMolinaroFrameDecoder & /* inDecoder */,
+                                     const U64 /* inSampleNumber */) {}
+
+//--- Identifier and FDF bit are known
+  public: virtual void frameHeaderDecoded (const CANFDMolinaroFrameDecoder & /* inDecoder */,
+                                           const bool /* inFDF */) {}
+
+//--- Data field is complete (or frame has no data field)
+  public: virtual void framePayloadDecoded (const CANFDMolinaroFrameDecoder & /* inDecoder */) {}
+
+//--- ACK delimiter is recessive
+  public: virtual void frameReceived (const CANFDMolinaroFrameDecoder & /* inDecoder */,
+                                      const U64 /* inEndSampleNumber */) {}
+
+//--- Decoder enters error mode
+  public: virtual void frameError (void) {}
+
+//--- Bit rate switch at BRS or ADH (to data bit rate), at CRC DEL or DAH (to arbitration
+//    bit rate);
+//    inSampleNumber is the start of the next bit
+  public: virtual void bitRateSwitch (const U64 /* inSampleNumber */, const bool /* inDataBitRate */) {}
+
+//--- Bus returns to idle, after intermission or error
+  public: virtual void endOfFrame (const U64 /* inEndSampleNumber */) {}
+} ;
+
+//----------------------------------------------------------------------------------------
+//  CAN / CANFD frame decoder: destuffing, CRC and frame field state machine
+//
+//  With the CAN XL protocol setting, a base frame with FDF and XLF recessive is a CAN XL
+//  frame; it is decoded as:
+//    SOF, ID (11), RRS, IDE, FDF, XLF           dynamic stuffing, arbitration bit rate
+//    resXL, ADH, DH1, DH2, DL1                  bit rate switch in ADH
+//    SDT (8), SEC, DLC (11), SBC (3), PCRC (13),
+//    VCID (8), AF (32), DATA (DLC+1 bytes),
+//    FCRC (32)                                  fixed stuffing, data bit rate
+//    FCP (1100), DAH, AH1, AL1, AH2             bit rate switch in DAH
+//    ACK, EOF, intermission                     as CANFD frames
+//  Fixed stuffing inserts the complement of the previous bit after every 10 bits, from
+//  SDT to the last bit of FCRC (excluded). SBC is the Gray code of the dynamic stuff bit
+//  count modulo 8. PCRC (polynomial 0x1CC1, initial value 0x1FFF) covers SOF to SBC,
+//  FCRC (polynomial 0xF1922815, initial value 0xFFFFFFFF) covers SOF to DATA; fixed stuff
+//  bits are excluded from both, dynamic stuff bits are included.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroFrameDecoder {
+  public: CANFDMolinaroFrameDecoder (void) ;
+
+//--- Bit timing of bus inBus (0 for the Serial channel)
+  public: void configure (const CANFDMolinaroAnalyzerSettings & inSettings,
+                          const U32 inBus,
+                          const U32 inSampleRateHz) ;
+
+  public: void setOutput (CANFDMolinaroDecoderOutput * inOutput) { mOutput = inOutput ; }
+
+//--- Markers are not output when disabled (frame level decoding modes, field replay)
+  public: void setMarkerOutput (const bool inEnabled) { mMarkerOutput = inEnabled ; }
+
+//--- Returns to idle state, inBusLevel is the current bus level
+  public: void reset (const bool inBusLevel) ;
+
+  public: void enterBit (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+
+//--- Sample of the first bit after a bus edge, inNextSampleNumber being the next sample
+//    before the edge: bit center after every edge, or, in data phase with Data Phase SJW,
+//    resynchronization on recessive to dominant edges by at most SJW
+  public: U64 resynchronize (const U64 inEdgeSampleNumber,
+                             const U64 inNextSampleNumber,
+                             const bool inDominantEdge) const ;
+
+//--- Snapshots
+  public: CANFDMolinaroDecoderSnapshot takeSnapshot (const U64 inSampleNumber) const ;
+  public: void restoreSnapshot (const CANFDMolinaroDecoderSnapshot & inSnapshot) ;
+
+//--- Decoder state
+  public: inline bool isIdle (void) const { return mFrameFieldEngineState == FrameFieldEngineState::IDLE ; }
+  public: inline bool isInAckField (void) const { return mFrameFieldEngineState == FrameFieldEngineState::ACK ; }
+  public: inline U32 currentSamplesPerBit (void) const { return mCurrentSamplesPerBit ; }
+  public: inline U64 frameIndex (void) const { return mFrameIndex ; }
+  public: inline U32 samplesPerArbitrationBit (void) const { return mSamplesPerArbitrationBit ; }
+  public: inline U32 sampleRateHz (void) const { return mSampleRateHz ; }
+  public: inline U32 arbitrationBitRate (void) const { return mArbitrationBitRate ; }
+  public: inline U32 dataBitRate (void) const { return mDataBitRate ; }
+
+//--- Performance counters, reset by configure (); readable from any thread. Resumed
+//    decoding restores the counter values of its snapshot
+  public: inline const CANFDMolinaroDecoderCounters & counters (void) const { return mCounters ; }
+  public: inline void setCounter (const CANFDMolinaroDecoderCounters::Counter inCounter, const U64 inValue) {
+    mCounters.set (inCounter, inValue) ;
+  }
+
+//--- Received frame
+  public: inline U64 startOfFrameSampleNumber (void) const { return mStartOfFrameSampleNumber ; }
+  public: inline U32 identifier (void) const { return mIdentifier ; }
+  public: inline bool isExtended (void) const { return mFrameFormat == FrameFormat::extended ; }
+  public: inline bool isCANFD (void) const { return mFrameType == FrameType::canfdData ; }
+  public: inline bool isCANXL (void) const { return mFrameType == FrameType::canxlData ; }
+  public: inline bool isRemote (void) const { return mFrameType == FrameType::remote ; }
+  public: inline bool BRS (void) const { return mBRS ; }
+  public: inline bool ESI (void) const { return mESI ; }
+  public: inline bool ackSlotIsRecessive (void) const { return mAcked ; }
+  public: inline bool crcIsValid (void) const { return mCRCIsValid ; }
+  public: inline U32 dataCodeLength (void) const { return mDataCodeLength ; }
+  public: U32 dataLength (void) const ;
+  public: inline const U8 * data (void) const { return mData.data () ; }
+  public: inline U32 serviceDataUnitType (void) const { return mSDT ; } // CAN XL
+  public: inline bool SEC (void) const { return mSEC ; } // CAN XL
+  public: inline U32 virtualCANNetworkIdentifier (void) const { return mVCID ; } // CAN XL
+  public: inline U32 acceptanceField (void) const { return mAcceptanceField ; } // CAN XL
+
+//--- Configuration
+  private: CANFDMolinaroDecoderOutput * mOutput ;
+  private: bool mMarkerOutput ;
+  private: U32 mSampleRateHz ;
+  private: U32 mArbitrationBitRate ;
+  private: U32 mDataBitRate ;
+  private: U32 mArbitrationSamplePoint ;
+  private: U32 mDataSamplePoint ;
+  private: ProtocolSetting mProtocol ;
+//--- CRC update of dynamically stuffed bits, selected by configure () from the protocol:
+//    the bit loop does not test the protocol
+  private: typedef void (CANFDMolinaroFrameDecoder::* DynamicBitCRCUpdate) (const bool inBit) ;
+  private: DynamicBitCRCUpdate mEnterDynamicBitInCRCs ;
+
+//--- Bit timing derived from configuration, computed once by configure (): the bit
+//    loop does not divide by bit rates
+  private: U32 mSamplesPerArbitrationBit ;
+  private: U32 mSamplesPerDataBit ;
+  private: U32 mDataSamplesBeforeSamplePoint ; // Data Phase SJW: sample point in data bit
+  private: U32 mDataPhaseSJWSamples ; // 0: no data phase resynchronization
+
+//--- Bit timing
+  private: U64 mStartOfFieldSampleNumber ;
+  private: U64 mStartOfFrameSampleNumber ;
+  private: U32 mCurrentSamplesPerBit ;
+  private: bool mDataPhase ; // Bits are at data bit rate
+  private: bool mResynchronizingDataPhase ; // Data phase, with Data Phase SJW
+
+//--- Sample position in current bit: bit center, or data sample point in data phase
+//    with Data Phase SJW
+  private: inline U32 samplesBeforeSamplePoint (void) const {
+    return mResynchronizingDataPhase ? mDataSamplesBeforeSamplePoint : (mCurrentSamplesPerBit / 2) ;
+  }
+  private: inline U32 samplesAfterSamplePoint (void) const {
+    return mResynchronizingDataPhase
+      ? (mSamplesPerDataBit - mDataSamplesBeforeSamplePoint)
+      : (mCurrentSamplesPerBit / 2) ;
+  }
+
+//--- CAN protocol
+  private: typedef enum  {
+    IDLE, IDENTIFIER, CONTROL_BASE, CONTROL_EXTENDED, CONTROL_AFTER_R0, DATA, SBC,
+    CRC15, CRC17, CRC21, CRCDEL, ACK, ENDOFFRAME, INTERMISSION, DECODER_ERROR,
+    XL_ADS, XL_CONTROL, XL_PCRC, XL_ACCEPTANCE, XL_DATA, XL_FCRC, XL_FCP, XL_DAS
+  } FrameFieldEngineState ;
+
+  private: FrameFieldEngineState mFrameFieldEngineState ;
+  private: int mFieldBitIndex ;
+  private: int mConsecutiveBitCountOfSamePolarity ;
+  private: bool mPreviousBit ;
+  private: bool mUnstuffingActive ;
+  private: bool mFixedStuffingActive ; // CAN XL data phase
+  private: U32 mFixedStuffBitCount ; // Bits since last fixed stuff bit
+  private: U64 mFrameIndex ;
+
+//--- Decoded bits (stuff bits excluded), last one in bit 0: a field is extracted from
+//    them when its last bit is decoded
+  private: U64 mFieldBits ;
+  private: inline U32 fieldBits (const U32 inCount) const { // inCount <= 32
+    return U32 (mFieldBits & ((U64 (1) << inCount) - 1)) ;
+  }
+
+//--- Received frame
+  private: uint32_t mIdentifier ;
+  private: U32 mStuffBitCount ;
+  private: U32 mDataCodeLength ;
+  private: std::vector <U8> mData ; // Grows to the largest payload seen
+  private: U16 mCRC15Accumulator ;
+  private: U16 mCRC15 ;
+  private: U32 mCRC17Accumulator ;
+  private: U32 mCRC17 ;
+  private: U32 mCRC21Accumulator ;
+  private: U32 mCRC21 ;
+  private: U32 mSDT ;
+  private: bool mSEC ;
+  private: U32 mVCID ;
+  private: U32 mAcceptanceField ;
+  private: U16 mPCRCAccumulator ;
+  private: U16 mPCRC ;
+  private: U32 mFCRCAccumulator ;
+  private: U32 mFCRC ;
+  private: typedef enum {base, extended} FrameFormat ;
+  private: FrameFormat mFrameFormat ;
+  private: typedef enum {canData, remote, canfdData, canxlData} FrameType ;
+  private: FrameType mFrameType ;
+  private: bool mBRS ;
+  private: bool mESI ;
+  private: bool mAcked ;
+  private: bool mCRCIsValid ;
+  private: AnalyzerResults::MarkerType mMarkerTypeForDataAndCRC ;
+
+//--- Performance counters
+  private: CANFDMolinaroDecoderCounters mCounters ;
+
+//--- Decoder methods
+  private: void decodeFrameBit (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+  private: void enterBitInCRC15 (const bool inBit) ;
+  private: void enterBitInCRC17 (const bool inBit) ;
+  private: void enterBitInCRC21 (const bool inBit) ;
+  private: inline void enterDynamicBitInCRCs (const bool inBit) { (this->*mEnterDynamicBitInCRCs) (inBit) ; }
+  private: void enterDynamicBitInCANFDCRCs (const bool inBit) ;
+  private: void enterDynamicBitInCANXLCRCs (const bool inBit) ;
+  private: void enterBitInPCRC (const bool inBit) ;
+  private: void enterBitInFCRC (const bool inBit) ;
+  private: void switchToDataBitRate (U64 & ioBitCenterSampleNumber, const AnalyzerResults::MarkerType inMarker) ;
+  private: void switchToArbitrationBitRate (U64 & ioBitCenterSampleNumber, const AnalyzerResults::MarkerType inMarker) ;
+  private: inline void addMark (const U64 inBitCenterSampleNumber, const AnalyzerResults::MarkerType inMarker) {
+    if (mMarkerOutput) {
+      mOutput->decoderMark (inBitCenterSampleNumber, inMarker) ;
+    }
+  }
+  private: void addBubble (const U8 inBubbleType,
+                           const U64 inData1,
+                           const U64 inData2,
+                           const U64 inBitCenterSampleNumber) ;
+  private: void countReceivedFrame (void) ;
+  private: void enterInErrorMode (const U64 inBitCenterSampleNumber,
+                                  const CANFDMolinaroDecoderCounters::Counter inCause) ;
+
+  private: void handle_IDLE_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_IDENTIFIER_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CONTROL_BASE_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CONTROL_EXTENDED_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CONTROL_AFTER_R0_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+  private: void handle_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_SBC_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CRC15_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CRC17_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CRC21_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_CRCDEL_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+  private: void handle_ACK_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_ENDOFFRAME_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_INTERMISSION_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_DECODER_ERROR_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_ADS_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+  private: void handle_XL_CONTROL_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_PCRC_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_ACCEPTANCE_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_DATA_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_FCRC_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_FCP_state (const bool inBit, const U64 inBitCenterSampleNumber) ;
+  private: void handle_XL_DAS_state (const bool inBit, U64 & ioBitCenterSampleNumber) ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_FRAME_DECODER_H
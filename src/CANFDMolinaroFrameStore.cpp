@@ -0,0 +1,164 @@
+#include "CANFDMolinaroFrameStore.h"
+
+#include <algorithm>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------
+
+static const uint8_t CANFD_LENGTH [16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64} ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroFrameStore::CANFDMolinaroFrameStore (void) :
+mStartSampleNumbers (),
+mDurations (),
+mIdentifiers (),
+mFlags (),
+mDataCodeLengths (),
+mBuses (),
+mPayloadOffsets (),
+mPayloadArena (),
+mPayloadHashTable (),
+mPayloadHashTableCount (0),
+mPayloadDeduplication (false),
+mMutex () {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameStore::clear (void) {
+  mStartSampleNumbers.clear () ;
+  mDurations.clear () ;
+  mIdentifiers.clear () ;
+  mFlags.clear () ;
+  mDataCodeLengths.clear () ;
+  mBuses.clear () ;
+  mPayloadOffsets.clear () ;
+  mPayloadArena.clear () ;
+  mPayloadHashTable.clear () ;
+  mPayloadHashTableCount = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameStore::setPayloadDeduplication (const bool inEnabled) {
+  mPayloadDeduplication = inEnabled ;
+  if (!inEnabled) {
+    mPayloadHashTable.clear () ;
+    mPayloadHashTableCount = 0 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+static U32 payloadLength (const U8 inFlags, const U16 inDataCodeLength) {
+  U32 length = 0 ;
+  if ((inFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0) {
+    length = 0 ;
+  }else if ((inFlags & CANFDMolinaroFrameStore::CANXL_FLAG) != 0) {
+    length = U32 (inDataCodeLength) + 1 ;
+  }else if ((inFlags & CANFDMolinaroFrameStore::CANFD_FLAG) != 0) {
+    length = CANFD_LENGTH [inDataCodeLength & 15] ;
+  }else{
+    length = std::min (U32 (inDataCodeLength), U32 (8)) ;
+  }
+  return length ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroFrameStore::dataLength (const U32 inIndex) const {
+  return payloadLength (mFlags [inIndex], mDataCodeLengths [inIndex]) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroFrameStore::hashFrame (const U32 inIdentifier,
+                                        const U8 * inData,
+                                        const U32 inLength) const {
+  U32 hash = 2166136261U ; // FNV-1a
+  for (U32 i=0 ; i<4 ; i++) {
+    hash = (hash ^ U8 (inIdentifier >> (8 * i))) * 16777619U ;
+  }
+  hash = (hash ^ U8 (inLength)) * 16777619U ;
+  for (U32 i=0 ; i<inLength ; i++) {
+    hash = (hash ^ inData [i]) * 16777619U ;
+  }
+  return hash ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameStore::rehash (const U32 inSize) {
+  mPayloadHashTable.assign (inSize, 0) ;
+  mPayloadHashTableCount = 0 ;
+  for (U32 frameIndex = 0 ; frameIndex < size () ; frameIndex++) {
+    const U32 length = dataLength (frameIndex) ;
+    if (length > 0) {
+      U32 slot = hashFrame (mIdentifiers [frameIndex], payload (frameIndex), length) & (inSize - 1) ;
+      bool found = false ;
+      while (!found && (mPayloadHashTable [slot] != 0)) {
+        const U32 other = mPayloadHashTable [slot] - 1 ;
+        found = (mIdentifiers [other] == mIdentifiers [frameIndex])
+          && (dataLength (other) == length)
+          && (memcmp (payload (other), payload (frameIndex), length) == 0) ;
+        slot = (slot + 1) & (inSize - 1) ;
+      }
+      if (!found) {
+        mPayloadHashTable [slot] = frameIndex + 1 ;
+        mPayloadHashTableCount += 1 ;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroFrameStore::append (const U64 inStartSampleNumber,
+                                      const U64 inEndSampleNumber,
+                                      const U32 inIdentifier,
+                                      const U8 inFlags,
+                                      const U16 inDataCodeLength,
+                                      const U8 * inData,
+                                      const U8 inBus) {
+  const U32 frameIndex = size () ;
+  const U32 length = payloadLength (inFlags, inDataCodeLength) ;
+//--- Look for an identical payload
+  U32 payloadOffset = U32 (mPayloadArena.size ()) ;
+  bool found = false ;
+  if (mPayloadDeduplication && (length > 0)) {
+    if ((2 * (mPayloadHashTableCount + 1)) > mPayloadHashTable.size ()) {
+      rehash (std::max (U32 (64), U32 (2 * mPayloadHashTable.size ()))) ;
+    }
+    const U32 mask = U32 (mPayloadHashTable.size () - 1) ;
+    U32 slot = hashFrame (inIdentifier, inData, length) & mask ;
+    while (!found && (mPayloadHashTable [slot] != 0)) {
+      const U32 other = mPayloadHashTable [slot] - 1 ;
+      found = (mIdentifiers [other] == inIdentifier)
+        && (dataLength (other) == length)
+        && (memcmp (payload (other), inData, length) == 0) ;
+      if (found) {
+        payloadOffset = mPayloadOffsets [other] ;
+      }else{
+        slot = (slot + 1) & mask ;
+      }
+    }
+    if (!found) {
+      mPayloadHashTable [slot] = frameIndex + 1 ;
+      mPayloadHashTableCount += 1 ;
+    }
+  }
+  if (!found) {
+    mPayloadArena.insert (mPayloadArena.end (), inData, inData + length) ;
+  }
+//--- Append columns
+  mStartSampleNumbers.push_back (inStartSampleNumber) ;
+  mDurations.push_back (U32 (inEndSampleNumber - inStartSampleNumber)) ;
+  mIdentifiers.push_back (inIdentifier) ;
+  mFlags.push_back (inFlags) ;
+  mDataCodeLengths.push_back (inDataCodeLength) ;
+  mBuses.push_back (inBus) ;
+  mPayloadOffsets.push_back (payloadOffset) ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+#ifndef CANFDMOLINARO_FRAME_STORE_H
+#define CANFDMOLINARO_FRAME_STORE_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <mutex>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Store of decoded frames, as a structure of arrays: one column per frame property, and
+//  a single byte arena for payloads. A frame costs 24 bytes (start sample, duration,
+//  identifier, flags, DLC, bus, payload offset), plus 4 to 8 bytes of hash table when payload
+//  deduplication is enabled. With deduplication, a frame whose identifier and payload
+//  are identical to a previous frame shares its payload bytes.
+//
+//  Frames are appended by the decoder thread; readers should lock mutex () while reading.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroFrameStore {
+  public: CANFDMolinaroFrameStore (void) ;
+
+//--- Frame flags
+  public: static const U8 EXTENDED_FLAG  = 1 << 0 ;
+  public: static const U8 CANFD_FLAG     = 1 << 1 ;
+  public: static const U8 BRS_FLAG       = 1 << 2 ;
+  public: static const U8 ESI_FLAG       = 1 << 3 ;
+  public: static const U8 REMOTE_FLAG    = 1 << 4 ;
+  public: static const U8 CRC_ERROR_FLAG = 1 << 5 ;
+  public: static const U8 NAK_FLAG       = 1 << 6 ;
+  public: static const U8 CANXL_FLAG     = 1 << 7 ; // DLC is data length - 1
+
+  public: void clear (void) ;
+
+  public: void setPayloadDeduplication (const bool inEnabled) ;
+
+  public: void append (const U64 inStartSampleNumber,
+                       const U64 inEndSampleNumber,
+                       const U32 inIdentifier,
+                       const U8 inFlags,
+                       const U16 inDataCodeLength,
+                       const U8 * inData,
+                       const U8 inBus) ;
+
+//--- Accessors
+  public: inline U32 size (void) const { return U32 (mStartSampleNumbers.size ()) ; }
+  public: inline U64 startSampleNumber (const U32 inIndex) const { return mStartSampleNumbers [inIndex] ; }
+  public: inline U64 endSampleNumber (const U32 inIndex) const {
+    return mStartSampleNumbers [inIndex] + mDurations [inIndex] ;
+  }
+  public: inline U32 identifier (const U32 inIndex) const { return mIdentifiers [inIndex] ; }
+  public: inline U8 flags (const U32 inIndex) const { return mFlags [inIndex] ; }
+  public: inline U16 dataCodeLength (const U32 inIndex) const { return mDataCodeLengths [inIndex] ; }
+  public: inline U8 bus (const U32 inIndex) const { return mBuses [inIndex] ; }
+  public: U32 dataLength (const U32 inIndex) const ;
+  public: inline const U8 * payload (const U32 inIndex) const { return mPayloadArena.data () + mPayloadOffsets [inIndex] ; }
+
+  public: inline std::mutex & mutex (void) { return mMutex ; }
+
+//--- Private methods
+  private: U32 hashFrame (const U32 inIdentifier, const U8 * inData, const U32 inLength) const ;
+  private: void rehash (const U32 inSize) ;
+
+//--- Columns
+  private: std::vector <U64> mStartSampleNumbers ;
+  private: std::vector <U32> mDurations ; // End sample number - start sample number
+  private: std::vector <U32> mIdentifiers ;
+  private: std::vector <U8> mFlags ;
+  private: std::vector <U16> mDataCodeLengths ;
+  private: std::vector <U8> mBuses ;
+  private: std::vector <U32> mPayloadOffsets ;
+  private: std::vector <U8> mPayloadArena ;
+
+//--- Payload deduplication: open addressing table of frame index + 1 (0 for empty slot)
+  private: std::vector <U32> mPayloadHashTable ;
+  private: U32 mPayloadHashTableCount ;
+  private: bool mPayloadDeduplication ;
+
+  private: std::mutex mMutex ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_FRAME_STORE_H
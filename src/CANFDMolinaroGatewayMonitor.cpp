@@ -0,0 +1,329 @@
+#include "CANFDMolinaroGatewayMonitor.h"
+#include "CANFDMolinaroFrameStore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroGatewayMonitor::CANFDMolinaroGatewayMonitor (void) :
+mRoutes (),
+mWindowMicroseconds (10000),
+mLateMicroseconds (0),
+mSampleRateHz (1),
+mWindowSamples (0),
+mLateSamples (0),
+mPendingFrames (),
+mFirstPendingSequence (0),
+mPendingByKey (),
+mMutex () {
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroGatewayMonitor::compile (const std::string & inSource,
+                                           std::string & outErrorMessage) {
+  mRoutes.clear () ;
+  mWindowMicroseconds = 10000 ;
+  mLateMicroseconds = 0 ;
+//--- Split terms
+  bool ok = true ;
+  std::string term ;
+  for (size_t i=0 ; (i <= inSource.length ()) && ok ; i++) {
+    const char c = (i < inSource.length ()) ? inSource [i] : ' ' ;
+    if ((c == ',') || (c == ';') || isspace (c)) {
+      if (term.length () > 0) {
+        ok = compileTerm (term, outErrorMessage) ;
+        term.clear () ;
+      }
+    }else{
+      term += char (tolower (c)) ;
+    }
+  }
+  if (ok && (mRoutes.size () == 0) && (inSource.find_first_not_of (" \t,;") != std::string::npos)) {
+    outErrorMessage = "Gateway routes: no route" ;
+    ok = false ;
+  }
+  if (!ok) {
+    mRoutes.clear () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroGatewayMonitor::compileTerm (const std::string & inTerm,
+                                               std::string & outErrorMessage) {
+  bool ok = true ;
+  char * end = nullptr ;
+  if ((inTerm.compare (0, 7, "window=") == 0) || (inTerm.compare (0, 5, "late=") == 0)) {
+    const bool window = inTerm [0] == 'w' ;
+    const char * start = inTerm.c_str () + (window ? 7 : 5) ;
+    const unsigned long long value = strtoull (start, &end, 10) ;
+    ok = (end != start) && (*end == '\0') && (value <= 100000000ULL) && (!window || (value > 0)) ;
+    if (window) {
+      mWindowMicroseconds = value ;
+    }else{
+      mLateMicroseconds = value ;
+    }
+  }else{ // src>dst or src>dst:id=id
+    const char * start = inTerm.c_str () ;
+    const unsigned long sourceBus = strtoul (start, &end, 10) ;
+    ok = (end != start) && (*end == '>') && (sourceBus >= 1) && (sourceBus <= 16) ;
+    unsigned long destinationBus = 0 ;
+    if (ok) {
+      start = end + 1 ;
+      destinationBus = strtoul (start, &end, 10) ;
+      ok = (end != start) && (destinationBus >= 1) && (destinationBus <= 16) && (destinationBus != sourceBus) ;
+    }
+    if (ok) {
+      const U32 route = routeIndex (U32 (sourceBus - 1), U32 (destinationBus - 1)) ;
+      if (*end == ':') {
+        start = end + 1 ;
+        const unsigned long sourceIdentifier = strtoul (start, &end, 0) ;
+        ok = (end != start) && (*end == '=') && (sourceIdentifier <= 0x1FFFFFFF) ;
+        if (ok) {
+          start = end + 1 ;
+          const unsigned long destinationIdentifier = strtoul (start, &end, 0) ;
+          ok = (end != start) && (destinationIdentifier <= 0x1FFFFFFF) ;
+          mRoutes [route].mIdentifierMap [U32 (sourceIdentifier)] = U32 (destinationIdentifier) ;
+        }
+      }
+      ok = ok && (*end == '\0') ;
+    }
+  }
+  if (!ok) {
+    outErrorMessage = "Invalid gateway route term: \"" + inTerm + "\"" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroGatewayMonitor::routeIndex (const U32 inSourceBus, const U32 inDestinationBus) {
+  U32 result = 0 ;
+  while ((result < mRoutes.size ())
+      && !((mRoutes [result].mSourceBus == inSourceBus) && (mRoutes [result].mDestinationBus == inDestinationBus))) {
+    result += 1 ;
+  }
+  if (result == mRoutes.size ()) {
+    Route route ;
+    route.mSourceBus = inSourceBus ;
+    route.mDestinationBus = inDestinationBus ;
+    mRoutes.push_back (route) ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroGatewayMonitor::requiredBusCount (void) const {
+  U32 result = 0 ;
+  for (const Route & route : mRoutes) {
+    result = std::max (result, std::max (route.mSourceBus, route.mDestinationBus) + 1) ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+std::string CANFDMolinaroGatewayMonitor::routeName (const U32 inRoute) const {
+  return std::to_string (mRoutes [inRoute].mSourceBus + 1) + ">" + std::to_string (mRoutes [inRoute].mDestinationBus + 1) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroGatewayMonitor::reset (const U32 inSampleRateHz) {
+  mSampleRateHz = inSampleRateHz ;
+  mWindowSamples = mWindowMicroseconds * inSampleRateHz / 1000000 ;
+  mLateSamples = mLateMicroseconds * inSampleRateHz / 1000000 ;
+  for (Route & route : mRoutes) {
+    route.mForwardedCount = 0 ;
+    route.mLateCount = 0 ;
+    route.mUnmatchedCount = 0 ;
+    route.mMinLatency = UINT64_MAX ;
+    route.mMaxLatency = 0 ;
+    route.mLatencySum = 0.0 ;
+    route.mHistogram.assign (HISTOGRAM_SIZE, 0) ;
+  }
+  mPendingFrames.clear () ;
+  mFirstPendingSequence = 0 ;
+  mPendingByKey.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroGatewayMonitor::frameKey (const U32 inRoute,
+                                           const U32 inIdentifier,
+                                           const U8 inFlags,
+                                           const U8 * inData,
+                                           const U32 inDataLength) {
+  U64 hash = 14695981039346656037ULL ; // FNV-1a
+  const U32 header [3] = {
+    inRoute, inIdentifier, U32 (inFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) | (inDataLength << 8)
+  } ;
+  for (U32 i=0 ; i<3 ; i++) {
+    for (U32 j=0 ; j<4 ; j++) {
+      hash = (hash ^ U8 (header [i] >> (8 * j))) * 1099511628211ULL ;
+    }
+  }
+  for (U32 i=0 ; i<inDataLength ; i++) {
+    hash = (hash ^ inData [i]) * 1099511628211ULL ;
+  }
+  return hash ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Log-linear histogram: values below 32 have their own bucket, above each power of two
+//  range is split in 16 buckets.
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroGatewayMonitor::histogramBucket (const U64 inLatency) {
+  U32 result = U32 (inLatency) ;
+  if (inLatency >= 32) {
+    U32 shift = 0 ;
+    while ((inLatency >> shift) >= 32) {
+      shift += 1 ;
+    }
+    result = 16 * shift + U32 (inLatency >> shift) ;
+  }
+  return std::min (result, HISTOGRAM_SIZE - 1) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroGatewayMonitor::histogramBucketValue (const U32 inBucket) {
+  U64 result = inBucket ;
+  if (inBucket >= 32) {
+    const U32 shift = (inBucket - 16) / 16 ;
+    const U64 mantissa = inBucket - 16 * shift ;
+    result = (mantissa << shift) + ((U64 (1) << shift) / 2) ; // Middle of bucket
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroGatewayMonitor::evict (const U64 inSampleNumber, std::vector <Event> & ioEvents) {
+  while ((mPendingFrames.size () > 0) && ((mPendingFrames.front ().mEndSampleNumber + mWindowSamples) < inSampleNumber)) {
+    const PendingFrame & frame = mPendingFrames.front () ;
+    if (!frame.mMatched) {
+      mRoutes [frame.mRoute].mUnmatchedCount += 1 ;
+      const Event event = {
+        EventKind::UNMATCHED_FRAME, frame.mRoute, frame.mIdentifier, frame.mEndSampleNumber, 0
+      } ;
+      ioEvents.push_back (event) ;
+      std::unordered_map <U64, std::deque <U64> >::iterator it = mPendingByKey.find (frame.mKey) ;
+      it->second.pop_front () ; // Oldest pending frame of its key
+      if (it->second.size () == 0) {
+        mPendingByKey.erase (it) ;
+      }
+    }
+    mPendingFrames.pop_front () ;
+    mFirstPendingSequence += 1 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroGatewayMonitor::enterFrame (const U32 inBus,
+                                              const U64 inStartSampleNumber,
+                                              const U64 inEndSampleNumber,
+                                              const U32 inIdentifier,
+                                              const U8 inFlags,
+                                              const U8 * inData,
+                                              const U32 inDataLength,
+                                              std::vector <Event> & ioEvents) {
+  evict (inStartSampleNumber, ioEvents) ;
+  for (U32 routeIdx = 0 ; routeIdx < mRoutes.size () ; routeIdx++) {
+    Route & route = mRoutes [routeIdx] ;
+  //--- Destination frame
+    if (route.mDestinationBus == inBus) {
+      const U64 key = frameKey (routeIdx, inIdentifier, inFlags, inData, inDataLength) ;
+      std::unordered_map <U64, std::deque <U64> >::iterator it = mPendingByKey.find (key) ;
+      if (it != mPendingByKey.end ()) {
+        PendingFrame & source = mPendingFrames [it->second.front () - mFirstPendingSequence] ;
+        if (source.mEndSampleNumber <= inStartSampleNumber) {
+          source.mMatched = true ;
+          it->second.pop_front () ;
+          if (it->second.size () == 0) {
+            mPendingByKey.erase (it) ;
+          }
+          const U64 latency = inStartSampleNumber - source.mEndSampleNumber ;
+          const bool late = (mLateSamples > 0) && (latency > mLateSamples) ;
+          route.mForwardedCount += 1 ;
+          route.mLateCount += late ? 1 : 0 ;
+          route.mMinLatency = std::min (route.mMinLatency, latency) ;
+          route.mMaxLatency = std::max (route.mMaxLatency, latency) ;
+          route.mLatencySum += double (latency) ;
+          route.mHistogram [histogramBucket (latency)] += 1 ;
+          const Event event = {
+            late ? EventKind::LATE_FRAME : EventKind::FORWARDED_FRAME,
+            routeIdx, inIdentifier, source.mEndSampleNumber, latency
+          } ;
+          ioEvents.push_back (event) ;
+        }
+      }
+    }
+  //--- Source frame
+    if (route.mSourceBus == inBus) {
+      U32 identifier = inIdentifier ;
+      bool forwarded = true ;
+      if (route.mIdentifierMap.size () > 0) {
+        const std::map <U32, U32>::const_iterator it = route.mIdentifierMap.find (inIdentifier) ;
+        forwarded = it != route.mIdentifierMap.end () ;
+        identifier = forwarded ? it->second : 0 ;
+      }
+      if (forwarded) {
+        const U64 key = frameKey (routeIdx, identifier, inFlags, inData, inDataLength) ;
+        const PendingFrame frame = { key, inEndSampleNumber, inIdentifier, routeIdx, false } ;
+        mPendingByKey [key].push_back (mFirstPendingSequence + mPendingFrames.size ()) ;
+        mPendingFrames.push_back (frame) ;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroGatewayMonitor::minLatency (const U32 inRoute) const {
+  const Route & route = mRoutes [inRoute] ;
+  return (route.mForwardedCount == 0) ? 0.0 : (double (route.mMinLatency) / double (mSampleRateHz)) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroGatewayMonitor::meanLatency (const U32 inRoute) const {
+  const Route & route = mRoutes [inRoute] ;
+  return (route.mForwardedCount == 0)
+    ? 0.0
+    : (route.mLatencySum / double (route.mForwardedCount) / double (mSampleRateHz)) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroGatewayMonitor::maxLatency (const U32 inRoute) const {
+  return double (mRoutes [inRoute].mMaxLatency) / double (mSampleRateHz) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroGatewayMonitor::percentileLatency (const U32 inRoute, const double inPercentile) const {
+  const Route & route = mRoutes [inRoute] ;
+  double result = 0.0 ;
+  if (route.mForwardedCount > 0) {
+    const U64 rank = std::max (U64 (1), U64 (inPercentile * double (route.mForwardedCount) + 0.999999)) ;
+    U64 cumulated = 0 ;
+    U32 bucket = 0 ;
+    while ((cumulated + route.mHistogram [bucket]) < rank) {
+      cumulated += route.mHistogram [bucket] ;
+      bucket += 1 ;
+    }
+    const U64 value = std::min (route.mMaxLatency, std::max (route.mMinLatency, histogramBucketValue (bucket))) ;
+    result = double (value) / double (mSampleRateHz) ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
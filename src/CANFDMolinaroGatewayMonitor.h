@@ -0,0 +1,134 @@
+#ifndef CANFDMOLINARO_GATEWAY_MONITOR_H
+#define CANFDMOLINARO_GATEWAY_MONITOR_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Gateway latency measurement, between buses of multi-bus decoding. The specification
+//  is a list of terms, separated by commas or spaces:
+//
+//    1>2              frames of bus 1 are forwarded to bus 2, with the same identifier
+//    1>2:0x123=0x456  frame 0x123 of bus 1 is forwarded to bus 2 as 0x456 (once a route
+//                     has an identifier mapping, only mapped identifiers are forwarded)
+//    window=10000     matching window, in µs (default 10000)
+//    late=2000        a forwarded frame whose latency is over this value, in µs, is
+//                     flagged as late (default 0, no late flag)
+//
+//  A source frame is pending until a destination frame with the same (mapped identifier,
+//  payload) hash is seen; latency runs from the end of the source frame (ACK delimiter)
+//  to the SOF of the destination frame. A source frame still pending after the window
+//  is evicted and flagged as unmatched, so memory is bounded by the traffic of a window.
+//  Latency distribution is kept in a log-linear histogram (about 3 % resolution).
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroGatewayMonitor {
+  public: CANFDMolinaroGatewayMonitor (void) ;
+
+//--- Returns false and sets outErrorMessage on syntax error (there is then no route)
+  public: bool compile (const std::string & inSource, std::string & outErrorMessage) ;
+
+  public: inline bool isEmpty (void) const { return mRoutes.size () == 0 ; }
+
+//--- Largest bus index used by a route, plus 1 (0 if no route)
+  public: U32 requiredBusCount (void) const ;
+
+  public: void reset (const U32 inSampleRateHz) ;
+
+//--- Events
+  public: typedef enum {FORWARDED_FRAME, LATE_FRAME, UNMATCHED_FRAME} EventKind ;
+
+  public: typedef struct {
+    EventKind mKind ;
+    U32 mRoute ;
+    U32 mIdentifier ; // Destination frame (forwarded, late), source frame (unmatched)
+    U64 mSourceEndSampleNumber ;
+    U64 mLatency ; // In samples (forwarded, late)
+  } Event ;
+
+//--- Frames should be entered in SOF order, inFlags are CANFDMolinaroFrameStore flags;
+//    events are appended to ioEvents, they all occur at inStartSampleNumber
+  public: void enterFrame (const U32 inBus,
+                           const U64 inStartSampleNumber,
+                           const U64 inEndSampleNumber,
+                           const U32 inIdentifier,
+                           const U8 inFlags,
+                           const U8 * inData,
+                           const U32 inDataLength,
+                           std::vector <Event> & ioEvents) ;
+
+//--- Statistics (lock mutex () while reading); latencies are in seconds
+  public: inline U32 routeCount (void) const { return U32 (mRoutes.size ()) ; }
+  public: std::string routeName (const U32 inRoute) const ;
+  public: inline U64 forwardedCount (const U32 inRoute) const { return mRoutes [inRoute].mForwardedCount ; }
+  public: inline U64 lateCount (const U32 inRoute) const { return mRoutes [inRoute].mLateCount ; }
+  public: inline U64 unmatchedCount (const U32 inRoute) const { return mRoutes [inRoute].mUnmatchedCount ; }
+  public: double minLatency (const U32 inRoute) const ;
+  public: double meanLatency (const U32 inRoute) const ;
+  public: double maxLatency (const U32 inRoute) const ;
+  public: double percentileLatency (const U32 inRoute, const double inPercentile) const ;
+  public: inline size_t pendingCount (void) const { return mPendingFrames.size () ; }
+
+  public: inline std::mutex & mutex (void) { return mMutex ; }
+
+//--- Private types
+  private: static const U32 HISTOGRAM_SIZE = 16 * 62 ;
+
+  private: typedef struct {
+    U32 mSourceBus ;
+    U32 mDestinationBus ;
+    std::map <U32, U32> mIdentifierMap ; // Empty: identifiers are not mapped
+    U64 mForwardedCount ;
+    U64 mLateCount ;
+    U64 mUnmatchedCount ;
+    U64 mMinLatency ;
+    U64 mMaxLatency ;
+    double mLatencySum ;
+    std::vector <U32> mHistogram ;
+  } Route ;
+
+  private: typedef struct {
+    U64 mKey ;
+    U64 mEndSampleNumber ;
+    U32 mIdentifier ;
+    U32 mRoute ;
+    bool mMatched ;
+  } PendingFrame ;
+
+//--- Private methods
+  private: bool compileTerm (const std::string & inTerm, std::string & outErrorMessage) ;
+  private: U32 routeIndex (const U32 inSourceBus, const U32 inDestinationBus) ;
+  private: static U64 frameKey (const U32 inRoute,
+                                const U32 inIdentifier,
+                                const U8 inFlags,
+                                const U8 * inData,
+                                const U32 inDataLength) ;
+  private: static U32 histogramBucket (const U64 inLatency) ;
+  private: static U64 histogramBucketValue (const U32 inBucket) ;
+  private: void evict (const U64 inSampleNumber, std::vector <Event> & ioEvents) ;
+
+//--- Private properties
+  private: std::vector <Route> mRoutes ;
+  private: U64 mWindowMicroseconds ;
+  private: U64 mLateMicroseconds ;
+  private: U32 mSampleRateHz ;
+  private: U64 mWindowSamples ;
+  private: U64 mLateSamples ;
+//--- Pending source frames, in SOF order; mPendingByKey holds the sequence numbers of
+//    the unmatched pending frames of each key, oldest first
+  private: std::deque <PendingFrame> mPendingFrames ;
+  private: U64 mFirstPendingSequence ;
+  private: std::unordered_map <U64, std::deque <U64> > mPendingByKey ;
+  private: std::mutex mMutex ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_GATEWAY_MONITOR_H
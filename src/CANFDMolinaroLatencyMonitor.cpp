@@ -0,0 +1,51 @@
+#include "CANFDMolinaroLatencyMonitor.h"
+
+//----------------------------------------------------------------------------------------
+
+const double CANFDMolinaroLatencyMonitor::LAG_LIMIT = 0.1 ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroLatencyMonitor::CANFDMolinaroLatencyMonitor (void) :
+mAnchorTime (),
+mAnchorSampleNumber (0),
+mSampleRateHz (1),
+mCount (0),
+mLagSum (0.0),
+mMaxLag (0.0),
+mCountOverLimit (0),
+mMutex () {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroLatencyMonitor::start (const U64 inSampleNumber, const U32 inSampleRateHz) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mAnchorTime = std::chrono::steady_clock::now () ;
+  mAnchorSampleNumber = inSampleNumber ;
+  mSampleRateHz = inSampleRateHz ;
+  mCount = 0 ;
+  mLagSum = 0.0 ;
+  mMaxLag = 0.0 ;
+  mCountOverLimit = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroLatencyMonitor::record (const U64 inSampleNumber) {
+  const std::chrono::duration <double> wallClock = std::chrono::steady_clock::now () - mAnchorTime ;
+  const double captureTime = double (inSampleNumber - mAnchorSampleNumber) / double (mSampleRateHz) ;
+  const double lag = wallClock.count () - captureTime ;
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mCount += 1 ;
+  mLagSum += lag ;
+  if (mMaxLag < lag) {
+    mMaxLag = lag ;
+  }
+  if (lag > LAG_LIMIT) {
+    mCountOverLimit += 1 ;
+  }
+  return lag ;
+}
+
+//----------------------------------------------------------------------------------------
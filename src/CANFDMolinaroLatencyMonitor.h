@@ -0,0 +1,49 @@
+#ifndef CANFDMOLINARO_LATENCY_MONITOR_H
+#define CANFDMOLINARO_LATENCY_MONITOR_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <chrono>
+#include <mutex>
+
+//----------------------------------------------------------------------------------------
+//  Decode lag monitor for live decoding: the lag of a commit is the wall-clock time
+//  elapsed since the anchor, minus the capture time elapsed between the anchor sample
+//  and the committed sample. The anchor is the first sample seen by start (), so lags
+//  are relative to the lag of the first processed edge.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroLatencyMonitor {
+  public: CANFDMolinaroLatencyMonitor (void) ;
+
+  public: void start (const U64 inSampleNumber, const U32 inSampleRateHz) ;
+
+//--- Returns the lag of inSampleNumber, in seconds
+  public: double record (const U64 inSampleNumber) ;
+
+//--- Statistics (lock mutex () while reading)
+  public: inline U64 count (void) const { return mCount ; }
+  public: inline double meanLag (void) const { return (mCount == 0) ? 0.0 : (mLagSum / double (mCount)) ; }
+  public: inline double maxLag (void) const { return mMaxLag ; }
+  public: inline U64 countOverLimit (void) const { return mCountOverLimit ; }
+
+  public: inline std::mutex & mutex (void) { return mMutex ; }
+
+//--- Lag limit, in seconds
+  public: static const double LAG_LIMIT ;
+
+//--- Private properties
+  private: std::chrono::steady_clock::time_point mAnchorTime ;
+  private: U64 mAnchorSampleNumber ;
+  private: U32 mSampleRateHz ;
+  private: U64 mCount ;
+  private: double mLagSum ;
+  private: double mMaxLag ;
+  private: U64 mCountOverLimit ;
+  private: std::mutex mMutex ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_LATENCY_MONITOR_H
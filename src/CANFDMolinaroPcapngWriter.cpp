@@ -0,0 +1,174 @@
+#include "CANFDMolinaroPcapngWriter.h"
+#include "CANFDMolinaroFrameStore.h"
+
+//----------------------------------------------------------------------------------------
+
+static const U32 SECTION_HEADER_BLOCK = 0x0A0D0D0A ;
+static const U32 INTERFACE_DESCRIPTION_BLOCK = 1 ;
+static const U32 ENHANCED_PACKET_BLOCK = 6 ;
+static const U16 LINKTYPE_CAN_SOCKETCAN = 227 ;
+
+//--- SocketCAN flags
+static const U32 CAN_EFF_FLAG = 0x80000000 ;
+static const U32 CAN_RTR_FLAG = 0x40000000 ;
+static const U8 CANFD_BRS = 0x01 ;
+static const U8 CANFD_ESI = 0x02 ;
+static const U8 CANFD_FDF = 0x04 ;
+static const U8 CANXL_SEC = 0x01 ;
+static const U8 CANXL_XLF = 0x80 ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroPcapngWriter::CANFDMolinaroPcapngWriter (void) :
+mFile () {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroPcapngWriter::~CANFDMolinaroPcapngWriter (void) {
+  close () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroPcapngWriter::open (const std::string & inFilePath, std::string & outErrorMessage) {
+  close () ;
+  mFile.open (inFilePath, std::ios::out | std::ios::binary | std::ios::trunc) ;
+  const bool ok = mFile.is_open () ;
+  if (!ok) {
+    outErrorMessage = "cannot create '" + inFilePath + "'" ;
+  }else{
+  //--- Section header block, section length unspecified
+    writeU32 (SECTION_HEADER_BLOCK) ;
+    writeU32 (28) ;
+    writeU32 (0x1A2B3C4D) ; // Byte order magic
+    writeU16 (1) ; // Version 1.0
+    writeU16 (0) ;
+    writeU32 (0xFFFFFFFF) ;
+    writeU32 (0xFFFFFFFF) ;
+    writeU32 (28) ;
+  //--- Interface description block, if_tsresol option: nanoseconds
+    writeU32 (INTERFACE_DESCRIPTION_BLOCK) ;
+    writeU32 (32) ;
+    writeU16 (LINKTYPE_CAN_SOCKETCAN) ;
+    writeU16 (0) ;
+    writeU32 (0) ; // No snap length
+    writeU16 (9) ; // if_tsresol
+    writeU16 (1) ;
+    writeU32 (9) ; // 10^-9 s, padded
+    writeU32 (0) ; // opt_endofopt
+    writeU32 (32) ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroPcapngWriter::openForAppend (const std::string & inFilePath, std::string & outErrorMessage) {
+  close () ;
+  mFile.open (inFilePath, std::ios::out | std::ios::binary | std::ios::app) ;
+  const bool ok = mFile.is_open () ;
+  if (!ok) {
+    outErrorMessage = "cannot open '" + inFilePath + "'" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroPcapngWriter::fileSize (void) {
+  mFile.seekp (0, std::ios::end) ; // Also flushes; tellp is not the file size in append mode
+  return U64 (mFile.tellp ()) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroPcapngWriter::close (void) {
+  bool ok = true ;
+  if (mFile.is_open ()) {
+    ok = mFile.good () ;
+    mFile.close () ;
+    ok = ok && !mFile.fail () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPcapngWriter::writeFrame (const CANFDMolinaroBusDecoder::FrameRecord & inFrame,
+                                           const U64 inTimestampNs) {
+  const bool isCANXL = (inFrame.mFlags & CANFDMolinaroFrameStore::CANXL_FLAG) != 0 ;
+  const bool isRemote = (inFrame.mFlags & CANFDMolinaroFrameStore::REMOTE_FLAG) != 0 ;
+  const U32 dataLength = isRemote ? 0 : U32 (inFrame.mData.size ()) ;
+  const U32 headerLength = isCANXL ? 12 : 8 ;
+  const U32 packetLength = headerLength + dataLength ;
+  const U32 paddedLength = (packetLength + 3) & ~U32 (3) ;
+  const U32 blockLength = 32 + paddedLength ;
+//--- Enhanced packet block header
+  writeU32 (ENHANCED_PACKET_BLOCK) ;
+  writeU32 (blockLength) ;
+  writeU32 (0) ; // Interface
+  writeU32 (U32 (inTimestampNs >> 32)) ;
+  writeU32 (U32 (inTimestampNs)) ;
+  writeU32 (packetLength) ;
+  writeU32 (packetLength) ;
+//--- SocketCAN header
+  if (isCANXL) {
+    writeBigEndianU32 ((inFrame.mIdentifier & 0x7FF) | (U32 (inFrame.mVirtualCANNetworkIdentifier) << 16)) ;
+    mFile.put (char (CANXL_XLF | (inFrame.mSEC ? CANXL_SEC : 0))) ;
+    mFile.put (char (inFrame.mServiceDataUnitType)) ;
+    writeU16 (U16 (dataLength)) ;
+    writeU32 (inFrame.mAcceptanceField) ;
+  }else{
+    const bool isCANFD = (inFrame.mFlags & CANFDMolinaroFrameStore::CANFD_FLAG) != 0 ;
+    U32 canID = inFrame.mIdentifier ;
+    canID |= ((inFrame.mFlags & CANFDMolinaroFrameStore::EXTENDED_FLAG) != 0) ? CAN_EFF_FLAG : 0 ;
+    canID |= isRemote ? CAN_RTR_FLAG : 0 ;
+    U8 fdFlags = 0 ;
+    if (isCANFD) {
+      fdFlags |= CANFD_FDF ;
+      fdFlags |= ((inFrame.mFlags & CANFDMolinaroFrameStore::BRS_FLAG) != 0) ? CANFD_BRS : 0 ;
+      fdFlags |= ((inFrame.mFlags & CANFDMolinaroFrameStore::ESI_FLAG) != 0) ? CANFD_ESI : 0 ;
+    }
+    writeBigEndianU32 (canID) ;
+    mFile.put (char (isRemote ? inFrame.mDataCodeLength : dataLength)) ;
+    mFile.put (char (fdFlags)) ;
+    writeU16 (0) ; // Reserved
+  }
+  if (dataLength > 0) {
+    mFile.write (reinterpret_cast <const char *> (inFrame.mData.data ()), std::streamsize (dataLength)) ;
+  }
+  for (U32 i = packetLength ; i < paddedLength ; i++) {
+    mFile.put (0) ;
+  }
+  writeU32 (blockLength) ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Block fields are written little endian, as the byte order magic
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPcapngWriter::writeU16 (const U16 inValue) {
+  mFile.put (char (inValue)) ;
+  mFile.put (char (inValue >> 8)) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPcapngWriter::writeU32 (const U32 inValue) {
+  mFile.put (char (inValue)) ;
+  mFile.put (char (inValue >> 8)) ;
+  mFile.put (char (inValue >> 16)) ;
+  mFile.put (char (inValue >> 24)) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPcapngWriter::writeBigEndianU32 (const U32 inValue) {
+  mFile.put (char (inValue >> 24)) ;
+  mFile.put (char (inValue >> 16)) ;
+  mFile.put (char (inValue >> 8)) ;
+  mFile.put (char (inValue)) ;
+}
+
+//----------------------------------------------------------------------------------------
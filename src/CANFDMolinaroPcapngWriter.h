@@ -0,0 +1,57 @@
+#ifndef CANFDMOLINARO_PCAPNG_WRITER_H
+#define CANFDMOLINARO_PCAPNG_WRITER_H
+
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroBusDecoder.h"
+#include <fstream>
+#include <string>
+
+//----------------------------------------------------------------------------------------
+//  pcapng capture file of decoded frames, one interface of link type
+//  LINKTYPE_CAN_SOCKETCAN (227), with nanosecond timestamps. Packets are SocketCAN
+//  frames: classic CAN and CANFD frames use the can_id / length / FD flags header, CAN XL
+//  frames the priority / XL flags / SDT / length / acceptance field header (CAN ID and
+//  priority fields are big endian, CAN XL length and acceptance field are little endian).
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroPcapngWriter {
+  public: CANFDMolinaroPcapngWriter (void) ;
+  public: ~CANFDMolinaroPcapngWriter (void) ;
+
+//--- Returns false and sets outErrorMessage if the file cannot be created
+  public: bool open (const std::string & inFilePath, std::string & outErrorMessage) ;
+
+//--- Returns false if a write failed (disk full, I/O error)
+  public: bool close (void) ;
+
+//--- Resumed decoding: reopens a file written by open (), frames are appended
+  public: bool openForAppend (const std::string & inFilePath, std::string & outErrorMessage) ;
+
+//--- Written file size (the file is flushed)
+  public: U64 fileSize (void) ;
+
+  public: inline bool isOpen (void) const { return mFile.is_open () ; }
+
+//--- false once a write has failed
+  public: inline bool isGood (void) const { return mFile.good () ; }
+
+  public: void writeFrame (const CANFDMolinaroBusDecoder::FrameRecord & inFrame,
+                           const U64 inTimestampNs) ;
+
+//--- Private methods
+  private: void writeU16 (const U16 inValue) ;
+  private: void writeU32 (const U32 inValue) ;
+  private: void writeBigEndianU32 (const U32 inValue) ;
+
+//--- Private properties
+  private: std::ofstream mFile ;
+
+//--- No copy
+  private: CANFDMolinaroPcapngWriter (const CANFDMolinaroPcapngWriter &) = delete ;
+  private: CANFDMolinaroPcapngWriter & operator = (const CANFDMolinaroPcapngWriter &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_PCAPNG_WRITER_H
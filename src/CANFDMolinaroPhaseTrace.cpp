@@ -0,0 +1,135 @@
+#include "CANFDMolinaroPhaseTrace.h"
+#include <iomanip>
+
+//----------------------------------------------------------------------------------------
+
+static const char * PHASE_NAME [CANFDMolinaroPhaseTrace::PHASE_COUNT] = {
+  "Edge Iteration",
+  "Decode",
+  "AddMarker",
+  "AddFrame",
+  "AddFrameV2",
+  "CommitResults",
+  "ReportProgress"
+} ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroPhaseTrace::CANFDMolinaroPhaseTrace (void) :
+mFile (),
+mOrigin (),
+mBatchStart (),
+mLastSwitch (),
+mCurrentPhase (Phase::EDGE_ITERATION),
+mBatchFrameCount (0),
+mPhaseTime (),
+mPhaseCallCount () {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroPhaseTrace::~CANFDMolinaroPhaseTrace (void) {
+  close () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPhaseTrace::open (const std::string & inFilePath) {
+  close () ;
+#ifdef CANFD_TRACE
+  if (inFilePath.length () > 0) {
+    mFile.open (inFilePath, std::ios::out | std::ios::trunc) ;
+    if (mFile.is_open ()) {
+      mFile << std::fixed << std::setprecision (3) ;
+      mFile << "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CANFD (Molinaro)\"}}" ;
+      mFile << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"WorkerThread\"}}" ;
+      mOrigin = std::chrono::steady_clock::now () ;
+      mBatchStart = mOrigin ;
+      mLastSwitch = mOrigin ;
+      mCurrentPhase = Phase::EDGE_ITERATION ;
+      mBatchFrameCount = 0 ;
+      for (U32 i = 0 ; i < PHASE_COUNT ; i++) {
+        mPhaseTime [i] = std::chrono::steady_clock::duration::zero () ;
+        mPhaseCallCount [i] = 0 ;
+      }
+    }
+  }
+#else
+  (void) inFilePath ;
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPhaseTrace::close (void) {
+  if (mFile.is_open ()) {
+    flush () ;
+    mFile << "\n]\n" ;
+    mFile.close () ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroPhaseTrace::Phase CANFDMolinaroPhaseTrace::enter (const Phase inPhase) {
+  chargeCurrentPhase (std::chrono::steady_clock::now ()) ;
+  const Phase previousPhase = mCurrentPhase ;
+  mCurrentPhase = inPhase ;
+  mPhaseCallCount [inPhase] += 1 ;
+  return previousPhase ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPhaseTrace::leave (const Phase inPreviousPhase) {
+  chargeCurrentPhase (std::chrono::steady_clock::now ()) ;
+  mCurrentPhase = inPreviousPhase ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPhaseTrace::chargeCurrentPhase (const std::chrono::steady_clock::time_point inNow) {
+  mPhaseTime [mCurrentPhase] += inNow - mLastSwitch ;
+  mLastSwitch = inNow ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroPhaseTrace::microseconds (const std::chrono::steady_clock::time_point inTime) const {
+  return std::chrono::duration <double, std::micro> (inTime - mOrigin).count () ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Timestamps and durations are in microseconds since the file was opened.
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroPhaseTrace::writeBatch (void) {
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now () ;
+  chargeCurrentPhase (now) ;
+  const double batchStart = microseconds (mBatchStart) ;
+  mFile << ",\n{\"name\":\"Batch\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+        << ",\"ts\":" << batchStart
+        << ",\"dur\":" << (microseconds (now) - batchStart)
+        << ",\"args\":{\"frames\":" << mBatchFrameCount << "}}" ;
+  double start = batchStart ;
+  for (U32 i = 0 ; i < PHASE_COUNT ; i++) {
+    const double duration = std::chrono::duration <double, std::micro> (mPhaseTime [i]).count () ;
+    if (duration > 0.0) {
+      mFile << ",\n{\"name\":\"" << PHASE_NAME [i] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << start
+            << ",\"dur\":" << duration ;
+      if (mPhaseCallCount [i] > 0) { // Not counted for the base phase
+        mFile << ",\"args\":{\"calls\":" << mPhaseCallCount [i] << "}" ;
+      }
+      mFile << "}" ;
+      start += duration ;
+    }
+    mPhaseTime [i] = std::chrono::steady_clock::duration::zero () ;
+    mPhaseCallCount [i] = 0 ;
+  }
+  mFile.flush () ;
+  mBatchStart = now ;
+  mBatchFrameCount = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+#ifndef CANFDMOLINARO_PHASE_TRACE_H
+#define CANFDMOLINARO_PHASE_TRACE_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+//----------------------------------------------------------------------------------------
+//  Chrome / Perfetto trace-event timeline of WorkerThread phases. Tracing is compiled in
+//  with the CANFD_TRACE CMake option, and enabled by the Trace File setting; otherwise
+//  isEnabled () is constant false, and spans compile to nothing.
+//
+//  Time is attributed to one phase at a time: a span switches the current phase, and
+//  restores the enclosing one when it ends, so SDK calls made while decoding are not
+//  counted as decoding time. Phase times are accumulated and written once per batch of
+//  BATCH_FRAME_COUNT frames (or when decoding catches up with capture data): a "Batch"
+//  complete event, with one child event per phase whose duration is the phase total in
+//  the batch, laid end to end.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroPhaseTrace {
+  public: CANFDMolinaroPhaseTrace (void) ;
+  public: ~CANFDMolinaroPhaseTrace (void) ;
+
+  public: typedef enum {
+    EDGE_ITERATION, // Base phase: reading edges, including waiting for capture data
+    DECODE,
+    ADD_MARKER,
+    ADD_FRAME,
+    ADD_FRAMEV2,
+    COMMIT_RESULTS,
+    REPORT_PROGRESS,
+    PHASE_COUNT
+  } Phase ;
+
+//--- An empty path disables tracing; the file is truncated
+  public: void open (const std::string & inFilePath) ;
+  public: void close (void) ;
+
+#ifdef CANFD_TRACE
+  public: inline bool isEnabled (void) const { return mFile.is_open () ; }
+#else
+  public: inline bool isEnabled (void) const { return false ; }
+#endif
+
+//--- Counts a decoded frame, and writes the batch when it is complete
+  public: inline void frameDone (void) {
+    if (isEnabled ()) {
+      mBatchFrameCount += 1 ;
+      if (mBatchFrameCount >= BATCH_FRAME_COUNT) {
+        writeBatch () ;
+      }
+    }
+  }
+
+//--- Writes the current batch, if not empty
+  public: inline void flush (void) {
+    if (isEnabled () && (mBatchFrameCount > 0)) {
+      writeBatch () ;
+    }
+  }
+
+//--- Phase of a scope
+  public: class Span {
+    public: inline Span (CANFDMolinaroPhaseTrace & inTrace, const Phase inPhase) :
+    mTrace (inTrace),
+    mPreviousPhase (inTrace.isEnabled () ? inTrace.enter (inPhase) : inPhase) {
+    }
+
+    public: inline ~Span (void) {
+      if (mTrace.isEnabled ()) {
+        mTrace.leave (mPreviousPhase) ;
+      }
+    }
+
+    private: CANFDMolinaroPhaseTrace & mTrace ;
+    private: const Phase mPreviousPhase ;
+
+    private: Span (const Span &) = delete ;
+    private: Span & operator = (const Span &) = delete ;
+  } ;
+
+//--- Private methods
+  private: Phase enter (const Phase inPhase) ;
+  private: void leave (const Phase inPreviousPhase) ;
+  private: void chargeCurrentPhase (const std::chrono::steady_clock::time_point inNow) ;
+  private: void writeBatch (void) ;
+  private: double microseconds (const std::chrono::steady_clock::time_point inTime) const ;
+
+//--- Private properties
+  private: static const U32 BATCH_FRAME_COUNT = 256 ;
+  private: std::ofstream mFile ;
+  private: std::chrono::steady_clock::time_point mOrigin ;
+  private: std::chrono::steady_clock::time_point mBatchStart ;
+  private: std::chrono::steady_clock::time_point mLastSwitch ;
+  private: Phase mCurrentPhase ;
+  private: U32 mBatchFrameCount ;
+  private: std::chrono::steady_clock::duration mPhaseTime [PHASE_COUNT] ;
+  private: U64 mPhaseCallCount [PHASE_COUNT] ;
+
+//--- No copy
+  private: CANFDMolinaroPhaseTrace (const CANFDMolinaroPhaseTrace &) = delete ;
+  private: CANFDMolinaroPhaseTrace & operator = (const CANFDMolinaroPhaseTrace &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_PHASE_TRACE_H
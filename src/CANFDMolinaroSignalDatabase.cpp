@@ -0,0 +1,290 @@
+#include "CANFDMolinaroSignalDatabase.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroSignalDatabase::CANFDMolinaroSignalDatabase (void) :
+mSignalPlans (),
+mSignalNames (),
+mSignalUnits (),
+mMessages (),
+mHashTable (),
+mHashShift (32) {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroSignalDatabase::clear (void) {
+  mSignalPlans.clear () ;
+  mSignalNames.clear () ;
+  mSignalUnits.clear () ;
+  mMessages.clear () ;
+  mHashTable.clear () ;
+  mHashShift = 32 ;
+}
+
+//----------------------------------------------------------------------------------------
+//  DBC PARSER
+//----------------------------------------------------------------------------------------
+
+static bool startsWith (const std::string & inLine, const char * inPrefix) {
+  return inLine.compare (0, strlen (inPrefix), inPrefix) == 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSignalDatabase::load (const std::string & inFilePath,
+                                        std::string & outErrorMessage) {
+  clear () ;
+  std::ifstream file (inFilePath) ;
+  bool ok = file.is_open () ;
+  if (!ok) {
+    outErrorMessage = "Cannot read DBC file \"" + inFilePath + "\"" ;
+  }
+//--- Signal value types (SIG_VALTYPE_ may appear after the signal definitions)
+  typedef struct {
+    U32 mKey ;
+    std::string mSignalName ;
+    SignalValueType mValueType ;
+  } ValueTypeDefinition ;
+  std::vector <ValueTypeDefinition> valueTypes ;
+//--- Parse lines
+  std::string line ;
+  U32 lineNumber = 0 ;
+  while (ok && std::getline (file, line)) {
+    lineNumber += 1 ;
+    const size_t first = line.find_first_not_of (" \t") ;
+    if (first != std::string::npos) {
+      line = line.substr (first) ;
+    }
+    if (startsWith (line, "BO_ ")) {
+      unsigned long key = 0 ;
+      char name [256] = "" ;
+      ok = sscanf (line.c_str (), "BO_ %lu %255[^: ]", &key, name) == 2 ;
+      if (ok) {
+        Message message ;
+        message.mKey = U32 (key) ;
+        message.mFirstSignal = U32 (mSignalPlans.size ()) ;
+        message.mSignalCount = 0 ;
+        message.mMultiplexorSignal = -1 ;
+        message.mName = name ;
+        mMessages.push_back (message) ;
+      }
+    }else if (startsWith (line, "SG_ ") && (mMessages.size () > 0)) {
+      std::istringstream header (line.substr (0, line.find (':'))) ;
+      std::string keyword, signalName, multiplexIndicator ;
+      header >> keyword >> signalName >> multiplexIndicator ;
+      const size_t colonPos = line.find (':') ;
+      unsigned startBit = 0 ;
+      unsigned bitLength = 0 ;
+      char byteOrder = '1' ;
+      char valueSign = '+' ;
+      double factor = 1.0 ;
+      double offset = 0.0 ;
+      ok = (colonPos != std::string::npos)
+        && (sscanf (line.c_str () + colonPos + 1, " %u|%u@%c%c (%lf,%lf)",
+                    &startBit, &bitLength, &byteOrder, &valueSign, &factor, &offset) == 6)
+        && (bitLength >= 1) && (bitLength <= 64) ;
+      if (ok) {
+        SignalPlan plan ;
+        plan.mFactor = factor ;
+        plan.mOffset = offset ;
+        plan.mMask = (bitLength == 64) ? ~ U64 (0) : ((U64 (1) << bitLength) - 1) ;
+        plan.mBitLength = U8 (bitLength) ;
+        plan.mBigEndian = byteOrder == '0' ;
+        plan.mSigned = valueSign == '-' ;
+        plan.mValueType = INTEGER_SIGNAL ;
+        if (plan.mBigEndian) { // Motorola: start bit is the MSB, in "sawtooth" numbering
+          const U32 msbLinearIndex = (startBit / 8) * 8 + (7 - startBit % 8) ;
+          const U32 lsbLinearIndex = msbLinearIndex + bitLength - 1 ;
+          plan.mByteOffset = U16 (msbLinearIndex / 8) ;
+          plan.mByteCount = U8 (lsbLinearIndex / 8 - msbLinearIndex / 8 + 1) ;
+          plan.mShift = U8 (7 - lsbLinearIndex % 8) ;
+        }else{ // Intel: start bit is the LSB
+          plan.mByteOffset = U16 (startBit / 8) ;
+          plan.mByteCount = U8 ((startBit % 8 + bitLength + 7) / 8) ;
+          plan.mShift = U8 (startBit % 8) ;
+        }
+        Message & message = mMessages.back () ;
+        if (multiplexIndicator == "M") {
+          plan.mMultiplexValue = MULTIPLEXOR ;
+          message.mMultiplexorSignal = S32 (message.mSignalCount) ;
+        }else if ((multiplexIndicator.length () > 1) && (multiplexIndicator [0] == 'm')) {
+          plan.mMultiplexValue = S32 (strtoul (multiplexIndicator.c_str () + 1, nullptr, 10)) ;
+        }else{
+          plan.mMultiplexValue = NOT_MULTIPLEXED ;
+        }
+        const size_t unitStart = line.find ('"', colonPos) ;
+        const size_t unitEnd = (unitStart == std::string::npos) ? unitStart : line.find ('"', unitStart + 1) ;
+        const std::string unit = (unitEnd == std::string::npos) ? "" : line.substr (unitStart + 1, unitEnd - unitStart - 1) ;
+        mSignalPlans.push_back (plan) ;
+        mSignalNames.push_back (signalName) ;
+        mSignalUnits.push_back (unit) ;
+        message.mSignalCount += 1 ;
+      }
+    }else if (startsWith (line, "SIG_VALTYPE_ ")) {
+      unsigned long key = 0 ;
+      char signalName [256] = "" ;
+      unsigned valueType = 0 ;
+      if (sscanf (line.c_str (), "SIG_VALTYPE_ %lu %255s : %u", &key, signalName, &valueType) == 3) {
+        const ValueTypeDefinition definition = {
+          U32 (key), signalName, (valueType == 1) ? FLOAT_SIGNAL : ((valueType == 2) ? DOUBLE_SIGNAL : INTEGER_SIGNAL)
+        } ;
+        valueTypes.push_back (definition) ;
+      }
+    }
+    if (!ok) {
+      std::stringstream message ;
+      message << "Invalid DBC line " << lineNumber << ": \"" << line << "\"" ;
+      outErrorMessage = message.str () ;
+    }
+  }
+//--- Apply signal value types
+  for (const ValueTypeDefinition & definition : valueTypes) {
+    for (const Message & message : mMessages) {
+      if (message.mKey == definition.mKey) {
+        for (U32 i = message.mFirstSignal ; i < (message.mFirstSignal + message.mSignalCount) ; i++) {
+          if (mSignalNames [i] == definition.mSignalName) {
+            mSignalPlans [i].mValueType = definition.mValueType ;
+          }
+        }
+      }
+    }
+  }
+//---
+  if (ok) {
+    buildHashTable () ;
+  }else{
+    clear () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroSignalDatabase::buildHashTable (void) {
+  U32 size = 16 ;
+  mHashShift = 28 ;
+  while (size < (2 * mMessages.size ())) {
+    size *= 2 ;
+    mHashShift -= 1 ;
+  }
+  mHashTable.assign (size, 0) ;
+  for (U32 i=0 ; i<mMessages.size () ; i++) {
+    U32 slot = hashIndex (mMessages [i].mKey) ;
+    while (mHashTable [slot] != 0) {
+      slot = (slot + 1) & (size - 1) ;
+    }
+    mHashTable [slot] = i + 1 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  SIGNAL EXTRACTION
+//----------------------------------------------------------------------------------------
+
+U64 CANFDMolinaroSignalDatabase::extractRawValue (const SignalPlan & inPlan,
+                                                  const U8 * inData) const {
+  const U8 * p = inData + inPlan.mByteOffset ;
+  const U32 loadedByteCount = (inPlan.mByteCount > 8) ? 8 : inPlan.mByteCount ;
+  U64 window = 0 ;
+  U64 value ;
+  if (inPlan.mBigEndian) {
+    for (U32 i=0 ; i<loadedByteCount ; i++) {
+      window = (window << 8) | p [i] ;
+    }
+    value = window >> inPlan.mShift ;
+    if (inPlan.mByteCount > 8) { // Shift is not 0 in this case
+      value = (window << (8 - inPlan.mShift)) | (p [8] >> inPlan.mShift) ;
+    }
+  }else{
+    for (U32 i=0 ; i<loadedByteCount ; i++) {
+      window |= U64 (p [i]) << (8 * i) ;
+    }
+    value = window >> inPlan.mShift ;
+    if (inPlan.mByteCount > 8) { // Shift is not 0 in this case
+      value |= U64 (p [8]) << (64 - inPlan.mShift) ;
+    }
+  }
+  return value & inPlan.mMask ;
+}
+
+//----------------------------------------------------------------------------------------
+
+double CANFDMolinaroSignalDatabase::physicalValue (const SignalPlan & inPlan,
+                                                   const U64 inRawValue) const {
+  double value ;
+  switch (inPlan.mValueType) {
+  case FLOAT_SIGNAL :
+    { const U32 bits = U32 (inRawValue) ;
+      float f ;
+      memcpy (&f, &bits, sizeof (f)) ;
+      value = f ;
+    }
+    break ;
+  case DOUBLE_SIGNAL :
+    memcpy (&value, &inRawValue, sizeof (value)) ;
+    break ;
+  default :
+    if (inPlan.mSigned && ((inRawValue >> (inPlan.mBitLength - 1)) & 1) != 0) {
+      value = double (S64 (inRawValue | ~inPlan.mMask)) ;
+    }else{
+      value = double (inRawValue) ;
+    }
+    break ;
+  }
+  return value * inPlan.mFactor + inPlan.mOffset ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSignalDatabase::decode (const U32 inIdentifier,
+                                          const bool inExtended,
+                                          const U8 * inData,
+                                          const U32 inLength,
+                                          std::vector <SignalValue> & ioValues,
+                                          std::string & outMessageName) const {
+  ioValues.clear () ;
+  const Message * message = nullptr ;
+  if (mHashTable.size () > 0) {
+    const U32 key = inExtended ? (inIdentifier | (1U << 31)) : inIdentifier ;
+    U32 slot = hashIndex (key) ;
+    while ((message == nullptr) && (mHashTable [slot] != 0)) {
+      const Message & candidate = mMessages [mHashTable [slot] - 1] ;
+      if (candidate.mKey == key) {
+        message = &candidate ;
+      }
+      slot = (slot + 1) & U32 (mHashTable.size () - 1) ;
+    }
+  }
+  if (message != nullptr) {
+    outMessageName = message->mName ;
+  //--- Multiplexor value
+    S32 multiplexValue = -1 ;
+    if (message->mMultiplexorSignal >= 0) {
+      const SignalPlan & plan = mSignalPlans [message->mFirstSignal + U32 (message->mMultiplexorSignal)] ;
+      if ((plan.mByteOffset + plan.mByteCount) <= inLength) {
+        multiplexValue = S32 (extractRawValue (plan, inData)) ;
+      }
+    }
+  //--- Run extraction plans
+    const U32 lastSignal = message->mFirstSignal + message->mSignalCount ;
+    for (U32 i = message->mFirstSignal ; i < lastSignal ; i++) {
+      const SignalPlan & plan = mSignalPlans [i] ;
+      const bool present = ((plan.mByteOffset + plan.mByteCount) <= inLength)
+        && ((plan.mMultiplexValue < 0) || (plan.mMultiplexValue == multiplexValue)) ;
+      if (present) {
+        const SignalValue signalValue = { i, physicalValue (plan, extractRawValue (plan, inData)) } ;
+        ioValues.push_back (signalValue) ;
+      }
+    }
+  }
+  return message != nullptr ;
+}
+
+//----------------------------------------------------------------------------------------
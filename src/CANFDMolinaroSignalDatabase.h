@@ -0,0 +1,101 @@
+#ifndef CANFDMOLINARO_SIGNAL_DATABASE_H
+#define CANFDMOLINARO_SIGNAL_DATABASE_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Signal database, loaded from a DBC file.
+//
+//  Only BO_, SG_ and SIG_VALTYPE_ lines are used. Each signal is compiled into a flat
+//  extraction plan: the payload bytes that contain the signal are loaded at once into a
+//  64-bit word, then a shift and a mask give the raw value (no per-bit loop). Messages are
+//  found by hashing the identifier (bit 31 set for an extended identifier, as in DBC).
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroSignalDatabase {
+  public: CANFDMolinaroSignalDatabase (void) ;
+
+//--- Returns false and sets outErrorMessage if the file cannot be read (database is then empty)
+  public: bool load (const std::string & inFilePath, std::string & outErrorMessage) ;
+
+  public: inline bool isEmpty (void) const { return mMessages.size () == 0 ; }
+
+//--- Decoded signal
+  public: typedef struct {
+    U32 mSignalIndex ;
+    double mValue ;
+  } SignalValue ;
+
+//--- Returns false if the identifier is not in the database. Otherwise, ioValues is set
+//    to the present signals (a signal that does not fit in inLength bytes, or whose
+//    multiplexor value does not match, is absent).
+  public: bool decode (const U32 inIdentifier,
+                       const bool inExtended,
+                       const U8 * inData,
+                       const U32 inLength,
+                       std::vector <SignalValue> & ioValues,
+                       std::string & outMessageName) const ;
+
+  public: inline const std::string & signalName (const U32 inSignalIndex) const {
+    return mSignalNames [inSignalIndex] ;
+  }
+
+  public: inline const std::string & signalUnit (const U32 inSignalIndex) const {
+    return mSignalUnits [inSignalIndex] ;
+  }
+
+//--- Private types
+  private: typedef enum {
+    INTEGER_SIGNAL, FLOAT_SIGNAL, DOUBLE_SIGNAL
+  } SignalValueType ;
+
+  private: static const S32 NOT_MULTIPLEXED = -1 ;
+  private: static const S32 MULTIPLEXOR = -2 ;
+
+  private: typedef struct {
+    double mFactor ;
+    double mOffset ;
+    U64 mMask ;
+    S32 mMultiplexValue ; // NOT_MULTIPLEXED, MULTIPLEXOR, or multiplexor value
+    U16 mByteOffset ; // First payload byte of extraction window
+    U8 mByteCount ; // 1 ... 9
+    U8 mShift ; // Right shift of extraction window
+    U8 mBitLength ;
+    bool mBigEndian ;
+    bool mSigned ;
+    SignalValueType mValueType ;
+  } SignalPlan ;
+
+  private: typedef struct {
+    U32 mKey ; // Identifier, bit 31 set for extended
+    U32 mFirstSignal ;
+    U32 mSignalCount ;
+    S32 mMultiplexorSignal ; // -1 if none
+    std::string mName ;
+  } Message ;
+
+//--- Private methods
+  private: void clear (void) ;
+  private: U64 extractRawValue (const SignalPlan & inPlan, const U8 * inData) const ;
+  private: double physicalValue (const SignalPlan & inPlan, const U64 inRawValue) const ;
+  private: void buildHashTable (void) ;
+  private: inline U32 hashIndex (const U32 inKey) const {
+    return (inKey * 0x9E3779B1U) >> mHashShift ;
+  }
+
+//--- Private properties
+  private: std::vector <SignalPlan> mSignalPlans ;
+  private: std::vector <std::string> mSignalNames ;
+  private: std::vector <std::string> mSignalUnits ;
+  private: std::vector <Message> mMessages ;
+  private: std::vector <U32> mHashTable ; // Message index + 1, 0 for empty slot
+  private: U32 mHashShift ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_SIGNAL_DATABASE_H
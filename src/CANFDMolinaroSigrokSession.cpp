@@ -0,0 +1,424 @@
+#include "CANFDMolinaroSigrokSession.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+//----------------------------------------------------------------------------------------
+//  Little endian fields of zip records
+//----------------------------------------------------------------------------------------
+
+static U32 readU16 (const U8 * inBytes) {
+  return U32 (inBytes [0]) | (U32 (inBytes [1]) << 8) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static U32 readU32 (const U8 * inBytes) {
+  return readU16 (inBytes) | (readU16 (inBytes + 2) << 16) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static const U32 LOCAL_HEADER_SIGNATURE = 0x04034B50 ;
+static const U32 CENTRAL_HEADER_SIGNATURE = 0x02014B50 ;
+static const U32 END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054B50 ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroSigrokSession::CANFDMolinaroSigrokSession (void) :
+mFile (nullptr),
+mFileSize (0),
+mEntries (),
+mChunks (),
+mCaptureSampleRateHz (0),
+mSampleRateRatio (1.0),
+mUnitSize (1),
+mProbeByte (0),
+mProbeBit (0),
+mChunkIndex (0),
+mChunkIsOpen (false),
+mStream (),
+mInputOffset (0),
+mInputRemaining (0),
+mCRC (0),
+mInput (),
+mOutput (),
+mOutputIndex (0),
+mOutputLength (0),
+mCaptureSampleIndex (0),
+mByteInSample (0),
+mLevel (true),
+mInitialLevel (true),
+mErrorMessage () {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroSigrokSession::~CANFDMolinaroSigrokSession (void) {
+  close () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::open (const std::string & inFilePath,
+                                       const std::string & inProbe,
+                                       const U32 inSampleRateHz,
+                                       std::string & outErrorMessage) {
+  close () ;
+  mFile = fopen (inFilePath.c_str (), "rb") ;
+  bool ok = mFile != nullptr ;
+  if (!ok) {
+    outErrorMessage = "cannot open '" + inFilePath + "'" ;
+  }else{
+    ok = readArchiveDirectory (outErrorMessage) ;
+  }
+//--- Metadata
+  if (ok) {
+    std::string metadata ;
+    ok = false ;
+    for (const ArchiveEntry & entry : mEntries) {
+      if (entry.mName == "metadata") {
+        ok = readEntry (entry, metadata) ;
+      }
+    }
+    if (ok) {
+      ok = parseMetadata (metadata, inProbe, outErrorMessage) ;
+    }else{
+      outErrorMessage = "'" + inFilePath + "' is not a sigrok session file" ;
+    }
+  }
+  if (ok) {
+    mSampleRateRatio = double (inSampleRateHz) / double (mCaptureSampleRateHz) ;
+    mInput.resize (INPUT_BUFFER_SIZE) ;
+    mOutput.resize (OUTPUT_BUFFER_SIZE) ;
+  //--- First sample gives the initial level
+    ok = fillOutput () && (mOutputLength > mProbeByte) ;
+    if (ok) {
+      mLevel = ((mOutput [mProbeByte] >> mProbeBit) & 1) != 0 ;
+      mInitialLevel = mLevel ;
+    }else{
+      outErrorMessage = mErrorMessage.empty () ? "no logic data in session file" : mErrorMessage ;
+    }
+  }
+  if (!ok) {
+    close () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroSigrokSession::close (void) {
+  closeChunk () ;
+  if (mFile != nullptr) {
+    fclose (mFile) ;
+    mFile = nullptr ;
+  }
+  mFileSize = 0 ;
+  mEntries.clear () ;
+  mChunks.clear () ;
+  mChunkIndex = 0 ;
+  mOutputIndex = 0 ;
+  mOutputLength = 0 ;
+  mCaptureSampleIndex = 0 ;
+  mByteInSample = 0 ;
+  mErrorMessage.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+//  The end of central directory record is in the last 64 KiB + 22 bytes of the file
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::readArchiveDirectory (std::string & outErrorMessage) {
+  fseeko (mFile, 0, SEEK_END) ;
+  mFileSize = U64 (ftello (mFile)) ;
+  const U64 tailLength = std::min (mFileSize, U64 (65536 + 22)) ;
+  std::vector <U8> tail (size_t (tailLength), 0) ;
+  fseeko (mFile, off_t (mFileSize - tailLength), SEEK_SET) ;
+  bool ok = fread (tail.data (), 1, tail.size (), mFile) == tail.size () ;
+  size_t recordIndex = 0 ;
+  bool found = false ;
+  for (size_t i = tail.size () ; ok && !found && (i >= 22) ; i--) {
+    found = readU32 (tail.data () + i - 22) == END_OF_CENTRAL_DIRECTORY_SIGNATURE ;
+    recordIndex = i - 22 ;
+  }
+  ok = ok && found ;
+  if (!ok) {
+    outErrorMessage = "session file is not a zip archive" ;
+  }
+//--- Central directory
+  if (ok) {
+    const U8 * record = tail.data () + recordIndex ;
+    const U32 entryCount = readU16 (record + 10) ;
+    const U32 directorySize = readU32 (record + 12) ;
+    const U32 directoryOffset = readU32 (record + 16) ;
+    ok = (entryCount != 0xFFFF) && (directoryOffset != 0xFFFFFFFF) ;
+    if (!ok) {
+      outErrorMessage = "ZIP64 session files are not supported" ;
+    }else{
+      std::vector <U8> directory (directorySize) ;
+      fseeko (mFile, off_t (directoryOffset), SEEK_SET) ;
+      ok = fread (directory.data (), 1, directory.size (), mFile) == directory.size () ;
+      size_t idx = 0 ;
+      for (U32 i = 0 ; ok && (i < entryCount) ; i++) {
+        ok = ((idx + 46) <= directory.size ())
+          && (readU32 (directory.data () + idx) == CENTRAL_HEADER_SIGNATURE) ;
+        if (ok) {
+          const U8 * header = directory.data () + idx ;
+          const U32 nameLength = readU16 (header + 28) ;
+          const U32 extraLength = readU16 (header + 30) ;
+          const U32 commentLength = readU16 (header + 32) ;
+          ok = (idx + 46 + nameLength) <= directory.size () ;
+          if (ok) {
+            ArchiveEntry entry ;
+            entry.mMethod = U16 (readU16 (header + 10)) ;
+            entry.mCRC = readU32 (header + 16) ;
+            entry.mCompressedSize = readU32 (header + 20) ;
+            entry.mLocalHeaderOffset = readU32 (header + 42) ;
+            entry.mName.assign (reinterpret_cast <const char *> (header + 46), nameLength) ;
+            mEntries.push_back (entry) ;
+          }
+          idx += 46 + nameLength + extraLength + commentLength ;
+        }
+      }
+      if (!ok) {
+        outErrorMessage = "invalid zip directory in session file" ;
+      }
+    }
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Small entries only (metadata)
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::readEntry (const ArchiveEntry & inEntry, std::string & outContents) {
+  outContents.clear () ;
+  mChunks.assign (1, inEntry) ;
+  mChunkIndex = 0 ;
+  mInput.resize (INPUT_BUFFER_SIZE) ;
+  mOutput.resize (OUTPUT_BUFFER_SIZE) ;
+  while (fillOutput ()) {
+    outContents.append (reinterpret_cast <const char *> (mOutput.data ()), mOutputLength) ;
+    mOutputIndex = mOutputLength ;
+  }
+  mChunks.clear () ;
+  mChunkIndex = 0 ;
+  return mErrorMessage.empty () ;
+}
+
+//----------------------------------------------------------------------------------------
+//  [device 1] section: samplerate=24 MHz, unitsize=1, capturefile=logic-1, probe1=CAN...
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::parseMetadata (const std::string & inMetadata,
+                                                const std::string & inProbe,
+                                                std::string & outErrorMessage) {
+  std::istringstream stream (inMetadata) ;
+  std::string line ;
+  std::string section ;
+  std::string captureFile ;
+  U32 probe = inProbe.empty () ? 1 : 0 ;
+  char * end = nullptr ;
+  const unsigned long probeNumber = strtoul (inProbe.c_str (), &end, 10) ;
+  if (!inProbe.empty () && (*end == '\0')) {
+    probe = U32 (probeNumber) ;
+  }
+  while (std::getline (stream, line)) {
+    if ((line.length () > 0) && (line.back () == '\r')) {
+      line.pop_back () ;
+    }
+    const size_t equal = line.find ('=') ;
+    if ((line.length () > 0) && (line [0] == '[')) {
+      section = line ;
+    }else if ((section == "[device 1]") && (equal != std::string::npos)) {
+      const std::string key = line.substr (0, equal) ;
+      const std::string value = line.substr (equal + 1) ;
+      if (key == "capturefile") {
+        captureFile = value ;
+      }else if (key == "unitsize") {
+        mUnitSize = U32 (strtoul (value.c_str (), nullptr, 10)) ;
+      }else if (key == "samplerate") { // "24 MHz", "500 kHz", "1.5 GHz"
+        char * unit = nullptr ;
+        double rate = strtod (value.c_str (), &unit) ;
+        while (*unit == ' ') {
+          unit += 1 ;
+        }
+        if (unit [0] == 'k') {
+          rate *= 1.0e3 ;
+        }else if (unit [0] == 'M') {
+          rate *= 1.0e6 ;
+        }else if (unit [0] == 'G') {
+          rate *= 1.0e9 ;
+        }
+        mCaptureSampleRateHz = U64 (rate + 0.5) ;
+      }else if ((key.compare (0, 5, "probe") == 0) && (value == inProbe) && (probe == 0)) {
+        probe = U32 (strtoul (key.c_str () + 5, nullptr, 10)) ;
+      }
+    }
+  }
+  bool ok = captureFile.length () > 0 ;
+  if (!ok) {
+    outErrorMessage = "no capture file in session metadata" ;
+  }else if (mCaptureSampleRateHz == 0) {
+    outErrorMessage = "no sample rate in session metadata" ;
+    ok = false ;
+  }else if ((probe == 0) || (mUnitSize == 0) || (probe > (mUnitSize * 8))) {
+    outErrorMessage = "no probe '" + inProbe + "' in session" ;
+    ok = false ;
+  }
+//--- Logic data chunks: "logic-1" or "logic-1-<n>", in chunk number order
+  if (ok) {
+    mProbeByte = (probe - 1) / 8 ;
+    mProbeBit = (probe - 1) % 8 ;
+    std::vector <std::pair <U32, ArchiveEntry> > chunks ;
+    for (const ArchiveEntry & entry : mEntries) {
+      if (entry.mName == captureFile) {
+        chunks.push_back (std::make_pair (U32 (0), entry)) ;
+      }else if (entry.mName.compare (0, captureFile.length () + 1, captureFile + "-") == 0) {
+        const U32 number = U32 (strtoul (entry.mName.c_str () + captureFile.length () + 1, nullptr, 10)) ;
+        chunks.push_back (std::make_pair (number, entry)) ;
+      }
+    }
+    std::sort (chunks.begin (), chunks.end (),
+               [] (const std::pair <U32, ArchiveEntry> & inLeft, const std::pair <U32, ArchiveEntry> & inRight) {
+                 return inLeft.first < inRight.first ;
+               }) ;
+    mChunks.clear () ;
+    for (const auto & chunk : chunks) {
+      mChunks.push_back (chunk.second) ;
+    }
+    mChunkIndex = 0 ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::openChunk (void) {
+  const ArchiveEntry & entry = mChunks [mChunkIndex] ;
+  U8 header [30] ;
+  fseeko (mFile, off_t (entry.mLocalHeaderOffset), SEEK_SET) ;
+  bool ok = (fread (header, 1, 30, mFile) == 30) && (readU32 (header) == LOCAL_HEADER_SIGNATURE) ;
+  ok = ok && ((entry.mMethod == 0) || (entry.mMethod == 8)) ;
+  if (ok) {
+    mInputOffset = entry.mLocalHeaderOffset + 30 + readU16 (header + 26) + readU16 (header + 28) ;
+    mInputRemaining = entry.mCompressedSize ;
+    mCRC = crc32 (0, Z_NULL, 0) ;
+    memset (&mStream, 0, sizeof (mStream)) ;
+    ok = (entry.mMethod == 0) || (inflateInit2 (&mStream, -MAX_WBITS) == Z_OK) ;
+  }
+  if (ok) {
+    mChunkIsOpen = true ;
+  }else{
+    mErrorMessage = "cannot read '" + entry.mName + "' in session file" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroSigrokSession::closeChunk (void) {
+  if (mChunkIsOpen) {
+    if (mChunks [mChunkIndex].mMethod == 8) {
+      inflateEnd (&mStream) ;
+    }
+    mChunkIsOpen = false ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::chunkEnd (void) {
+  const bool ok = mCRC == mChunks [mChunkIndex].mCRC ;
+  if (ok) {
+    closeChunk () ;
+    mChunkIndex += 1 ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Replaces the output buffer contents by the next bytes of capture data
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroSigrokSession::fillOutput (void) {
+  mOutputIndex = 0 ;
+  mOutputLength = 0 ;
+  bool ok = mErrorMessage.empty () ;
+  while (ok && (mOutputLength == 0) && (mChunkIndex < mChunks.size ())) {
+    if (!mChunkIsOpen) {
+      ok = openChunk () ;
+    }
+    if (ok && (mChunks [mChunkIndex].mMethod == 0)) { // Stored
+      const size_t length = size_t (std::min (U64 (mOutput.size ()), mInputRemaining)) ;
+      fseeko (mFile, off_t (mInputOffset), SEEK_SET) ;
+      ok = fread (mOutput.data (), 1, length, mFile) == length ;
+      mOutputLength = length ;
+      mInputOffset += length ;
+      mInputRemaining -= length ;
+      mCRC = crc32 (mCRC, mOutput.data (), uInt (length)) ;
+      if (ok && (mInputRemaining == 0)) {
+        ok = chunkEnd () ;
+      }
+    }else if (ok) { // Deflated
+      if ((mStream.avail_in == 0) && (mInputRemaining > 0)) {
+        const size_t length = size_t (std::min (U64 (mInput.size ()), mInputRemaining)) ;
+        fseeko (mFile, off_t (mInputOffset), SEEK_SET) ;
+        ok = fread (mInput.data (), 1, length, mFile) == length ;
+        mInputOffset += length ;
+        mInputRemaining -= length ;
+        mStream.next_in = mInput.data () ;
+        mStream.avail_in = uInt (length) ;
+      }
+      mStream.next_out = mOutput.data () ;
+      mStream.avail_out = uInt (mOutput.size ()) ;
+      const int result = inflate (&mStream, Z_NO_FLUSH) ;
+      mOutputLength = mOutput.size () - mStream.avail_out ;
+      mCRC = crc32 (mCRC, mOutput.data (), uInt (mOutputLength)) ;
+      if (result == Z_STREAM_END) {
+        ok = chunkEnd () ;
+      }else if ((result != Z_OK) && !((result == Z_BUF_ERROR) && (mInputRemaining > 0))) {
+        ok = false ;
+      }
+    }
+    if (!ok) {
+      mErrorMessage = "cannot read '" + mChunks [mChunkIndex].mName + "' in session file" ;
+    }
+  }
+  return ok && (mOutputLength > 0) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+size_t CANFDMolinaroSigrokSession::readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) {
+  size_t count = 0 ;
+  bool ok = true ;
+  while (ok && (count < inMaxCount)) {
+    if (mOutputIndex == mOutputLength) {
+      ok = fillOutput () ;
+    }
+    const U8 * output = mOutput.data () ;
+    while (ok && (count < inMaxCount) && (mOutputIndex < mOutputLength)) {
+      if (mByteInSample == mProbeByte) {
+        const bool level = ((output [mOutputIndex] >> mProbeBit) & 1) != 0 ;
+        if (level != mLevel) {
+          mLevel = level ;
+          outEdges.push_back (sampleNumber (mCaptureSampleIndex)) ;
+          count += 1 ;
+        }
+      }
+      mOutputIndex += 1 ;
+      mByteInSample += 1 ;
+      if (mByteInSample == mUnitSize) {
+        mByteInSample = 0 ;
+        mCaptureSampleIndex += 1 ;
+      }
+    }
+  }
+  return count ;
+}
+
+//----------------------------------------------------------------------------------------
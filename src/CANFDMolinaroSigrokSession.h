@@ -0,0 +1,100 @@
+#ifndef CANFDMOLINARO_SIGROK_SESSION_H
+#define CANFDMOLINARO_SIGROK_SESSION_H
+
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroEdgeSource.h"
+#include <cstdio>
+#include <zlib.h>
+
+//----------------------------------------------------------------------------------------
+//  Streaming reader of one probe of a sigrok session file (.sr): a zip archive with a
+//  "metadata" INI file (sample rate, unit size, probe names, capture file name), and
+//  logic data chunks "logic-1-1", "logic-1-2"... of unitsize bytes per sample, probe n
+//  being bit n - 1. Chunks are inflated by buffers, in order, and their CRC is checked;
+//  only device 1 is read, and ZIP64 archives are not supported.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroSigrokSession : public CANFDMolinaroEdgeSource {
+  public: CANFDMolinaroSigrokSession (void) ;
+  public: virtual ~CANFDMolinaroSigrokSession (void) ;
+
+//--- inProbe is a probe name, or a probe number (first probe if empty); returns false and
+//    sets outErrorMessage on error
+  public: bool open (const std::string & inFilePath,
+                     const std::string & inProbe,
+                     const U32 inSampleRateHz,
+                     std::string & outErrorMessage) ;
+
+  public: void close (void) ;
+
+  public: inline U64 captureSampleRateHz (void) const { return mCaptureSampleRateHz ; }
+
+//--- Edge source
+  public: virtual bool initialLevel (void) const { return mInitialLevel ; }
+  public: virtual size_t readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) ;
+  public: virtual U64 endSampleNumber (void) const { return sampleNumber (mCaptureSampleIndex) ; }
+  public: virtual const std::string & errorMessage (void) const { return mErrorMessage ; }
+  public: virtual U64 fileSize (void) const { return mFileSize ; }
+
+//--- Private types
+  private: typedef struct {
+    std::string mName ;
+    U16 mMethod ; // 0: stored, 8: deflated
+    U32 mCRC ;
+    U64 mCompressedSize ;
+    U64 mLocalHeaderOffset ;
+  } ArchiveEntry ;
+
+//--- Private methods
+  private: bool readArchiveDirectory (std::string & outErrorMessage) ;
+  private: bool readEntry (const ArchiveEntry & inEntry, std::string & outContents) ;
+  private: bool parseMetadata (const std::string & inMetadata,
+                               const std::string & inProbe,
+                               std::string & outErrorMessage) ;
+  private: bool openChunk (void) ;
+  private: void closeChunk (void) ;
+  private: bool chunkEnd (void) ; // Checks CRC, and closes the chunk
+  private: bool fillOutput (void) ; // Returns false at end of capture data, or on error
+  private: inline U64 sampleNumber (const U64 inCaptureSampleIndex) const {
+    return U64 (double (inCaptureSampleIndex) * mSampleRateRatio + 0.5) ;
+  }
+
+//--- Private properties
+  private: static const size_t INPUT_BUFFER_SIZE = 64 * 1024 ;
+  private: static const size_t OUTPUT_BUFFER_SIZE = 256 * 1024 ;
+  private: FILE * mFile ;
+  private: U64 mFileSize ;
+  private: std::vector <ArchiveEntry> mEntries ;
+  private: std::vector <ArchiveEntry> mChunks ; // Logic data chunks, in order
+  private: U64 mCaptureSampleRateHz ;
+  private: double mSampleRateRatio ; // Decoder samples per capture sample
+  private: U32 mUnitSize ;
+  private: U32 mProbeByte ;
+  private: U32 mProbeBit ;
+//--- Current chunk
+  private: size_t mChunkIndex ;
+  private: bool mChunkIsOpen ;
+  private: z_stream mStream ;
+  private: U64 mInputOffset ; // File offset of next compressed bytes
+  private: U64 mInputRemaining ;
+  private: uLong mCRC ; // Of inflated bytes
+  private: std::vector <U8> mInput ;
+  private: std::vector <U8> mOutput ;
+  private: size_t mOutputIndex ;
+  private: size_t mOutputLength ;
+//--- Current sample
+  private: U64 mCaptureSampleIndex ;
+  private: U32 mByteInSample ;
+  private: bool mLevel ;
+  private: bool mInitialLevel ;
+  private: std::string mErrorMessage ;
+
+//--- No copy
+  private: CANFDMolinaroSigrokSession (const CANFDMolinaroSigrokSession &) = delete ;
+  private: CANFDMolinaroSigrokSession & operator = (const CANFDMolinaroSigrokSession &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_SIGROK_SESSION_H
@@ -1,9 +1,11 @@
 #include "CANFDMolinaroSimulationDataGenerator.h"
 #include "CANFDMolinaroAnalyzerSettings.h"
+#include "CANFDMolinaroStuffingPattern.h"
 
 //----------------------------------------------------------------------------------------
 
 #include <AnalyzerHelpers.h>
+#include <algorithm>
 
 //----------------------------------------------------------------------------------------
 //  CAN 2.0B FRAME GENERATOR
@@ -23,6 +25,9 @@ typedef enum {DOMINANT_BIT, RECESSIVE_BIT} GeneratedBit ;
 
 static const uint32_t CAN_FRAME_MAX_LENGTH = 160 ;
 
+//--- Transceiver loop delay (TXD to RXD) of the simulated node, when TXD is simulated
+static const U64 SIMULATED_LOOP_DELAY_NS = 150 ;
+
 //----------------------------------------------------------------------------------------
 
 class CANFrameBitsGenerator {
@@ -31,11 +36,13 @@ class CANFrameBitsGenerator {
                                   const uint8_t inDataLength,
                                   const uint8_t inData [8],
                                   const FrameType inFrameType,
-                                  const AckSlot inAckSlot) ;
+                                  const AckSlot inAckSlot,
+                                  const uint16_t inCRCErrorMask) ;
 
 //--- Public methods
   public : inline uint32_t frameLength (void) const { return mFrameLength ; }
   public : bool bitAtIndex (const uint32_t inIndex) const ;
+  public : inline uint32_t dynamicStuffingEnd (void) const { return mFrameLength - 13 ; } // CRC DEL index
 
 //--- Private methods (used during frame generation)
   private: void enterBitAppendStuff (const bool inBit) ;
@@ -59,7 +66,8 @@ CANFrameBitsGenerator::CANFrameBitsGenerator (const uint32_t inIdentifier,
                                               const uint8_t inDataLength,
                                               const uint8_t inData [8],
                                               const FrameType inFrameType,
-                                              const AckSlot inAckSlot) :
+                                              const AckSlot inAckSlot,
+                                              const uint16_t inCRCErrorMask) :
 mBits (),
 mFrameLength (0),
 mConsecutiveBitCount (1),
@@ -108,7 +116,7 @@ mCRCAccumulator (0) {
     }
   }
 //--- Enter CRC SEQUENCE
-  const uint16_t frameCRC = mCRCAccumulator ;
+  const uint16_t frameCRC = mCRCAccumulator ^ inCRCErrorMask ;
   for (int idx = 14 ; idx >= 0 ; idx--) {
     const bool bit = (frameCRC & (1 << idx)) != 0 ;
     enterBitAppendStuff (bit) ;
@@ -200,7 +208,8 @@ class CANFDFrameBitsGenerator {
                                     const GeneratedBit inBSR,
                                     const uint8_t inData [64],
                                     const AckSlot inAckSlot,
-                                    const GeneratedBit inESISlot) ;
+                                    const GeneratedBit inESISlot,
+                                    const uint32_t inCRCErrorMask) ;
 
 //--- Public methods
   public: inline uint8_t dataLengthCode (void) const { return mDataLengthCode ; }
@@ -208,6 +217,7 @@ class CANFDFrameBitsGenerator {
   public: inline uint32_t identifier (void) const { return mIdentifier ; }
   public: inline uint32_t frameLength (void) const { return mFrameLength ; }
   public: inline uint32_t stuffBitCount (void) const { return mStuffBitCount ; }
+  public: inline uint32_t dynamicStuffingEnd (void) const { return mDynamicStuffingEnd ; }
   public: inline uint32_t frameCRC (void) const { return mFrameCRC ; }
   public: bool bitAtIndex (const uint32_t inIndex) const ;
   public: bool dataBitRateAtIndex (const uint32_t inIndex) const ;
@@ -231,6 +241,7 @@ class CANFDFrameBitsGenerator {
   private: uint32_t mCRCAccumulator17 ;
   private: uint32_t mCRCAccumulator21 ;
   private: uint8_t mStuffBitCount ;
+  private: uint32_t mDynamicStuffingEnd ; // Index of the first fixed stuffed bit
   private: const uint8_t mDataLengthCode ;
   private: const FrameFormat mFrameFormat ;
   private: const ProtocolSetting mProtocolType ;
@@ -249,7 +260,8 @@ CANFDFrameBitsGenerator::CANFDFrameBitsGenerator (const uint32_t inIdentifier,
                                                   const GeneratedBit inBSR,
                                                   const uint8_t inData [64],
                                                   const AckSlot inAckSlot,
-                                                  const GeneratedBit inESISlot) :
+                                                  const GeneratedBit inESISlot,
+                                                  const uint32_t inCRCErrorMask) :
 mBits (),
 mDataRateBits (),
 mData (),
@@ -259,6 +271,7 @@ mFrameLength (0),
 mCRCAccumulator17 (0),
 mCRCAccumulator21 (0),
 mStuffBitCount (0),
+mDynamicStuffingEnd (0),
 mDataLengthCode (inDataLengthCode),
 mFrameFormat (inFrameFormat),
 mProtocolType (inProtocolType),
@@ -278,6 +291,7 @@ mConsecutiveBitCount (1) {
   case CANFD_NON_ISO_PROTOCOL :
     break ;
   case CANFD_ISO_PROTOCOL :
+  case CANXL_PROTOCOL :
     mCRCAccumulator17 = 1U << 16 ;
     mCRCAccumulator21 = 1U << 20 ;
     break ;
@@ -340,11 +354,14 @@ mConsecutiveBitCount (1) {
       }
     }
   }
+//--- Fixed stuffing from here
+  mDynamicStuffingEnd = mFrameLength ;
 //--- Enter STUFF BIT COUNT
   switch (mProtocolType) {
   case CANFD_NON_ISO_PROTOCOL :
     break ;
   case CANFD_ISO_PROTOCOL :
+  case CANXL_PROTOCOL :
     { enterBitInFrame (!lastBit, dataBitRate) ;
       const uint8_t GRAY_CODE_PARITY [8] = {0, 3, 6, 5, 12, 15, 10, 9} ;
       const uint8_t code = GRAY_CODE_PARITY [mStuffBitCount % 8] ;
@@ -358,7 +375,7 @@ mConsecutiveBitCount (1) {
   }
 //--- Enter CRC SEQUENCE
   enterBitInFrame (!lastBit, dataBitRate) ;
-  const uint32_t frameCRC = (mDataLengthCode > 10) ? mCRCAccumulator21 : mCRCAccumulator17 ;
+  const uint32_t frameCRC = ((mDataLengthCode > 10) ? mCRCAccumulator21 : mCRCAccumulator17) ^ inCRCErrorMask ;
   mFrameCRC = frameCRC ;
   const int crcFirstBitIndex = (mDataLengthCode > 10) ? 20 : 16 ;
   uint32_t bitCount = 0 ;
@@ -481,11 +498,224 @@ uint8_t CANFDFrameBitsGenerator::lengthForCode (const uint8_t inDataLengthCode)
   return LENGTH [inDataLengthCode] ;
 }
 
+//----------------------------------------------------------------------------------------
+//  CAN XL FRAME GENERATOR (see the frame model in CANFDMolinaroFrameDecoder.h)
+//----------------------------------------------------------------------------------------
+
+class CANXLFrameBitsGenerator {
+  public : CANXLFrameBitsGenerator (const uint32_t inIdentifier,
+                                    const uint8_t inSDT,
+                                    const bool inSEC,
+                                    const uint16_t inDataLengthCode,
+                                    const uint8_t inVCID,
+                                    const uint32_t inAcceptanceField,
+                                    const uint8_t * inData,
+                                    const AckSlot inAckSlot,
+                                    const uint32_t inCRCErrorMask) ;
+
+//--- Public methods
+  public: inline uint32_t frameLength (void) const { return uint32_t (mBits.size ()) ; }
+  public: inline bool bitAtIndex (const uint32_t inIndex) const { return mBits [inIndex] ; }
+  public: inline bool dataBitRateAtIndex (const uint32_t inIndex) const { return mDataRateBits [inIndex] ; }
+  public: inline uint32_t dynamicStuffingEnd (void) const { return mDynamicStuffingEnd ; }
+
+//--- Private methods (used during frame generation)
+  private: void enterBitInFrame (const bool inBit, const bool inUseDataBitRate) ;
+
+  private: void enterBitInFrameComputeCRC (const bool inBit, const bool inUseDataBitRate, const bool inPCRC) ;
+
+  private: void enterBitComputeCRCAppendStuff (const bool inBit) ;
+
+  private: void enterBitAppendFixedStuff (const bool inBit, const bool inPCRC, const bool inFCRC) ;
+
+//--- Private properties (a frame has up to about 18,000 bits)
+  private: std::vector <bool> mBits ;
+  private: std::vector <bool> mDataRateBits ;
+  private: uint16_t mPCRCAccumulator ;
+  private: uint32_t mFCRCAccumulator ;
+  private: uint8_t mStuffBitCount ;
+  private: bool mLastBitValue ;
+  private: uint8_t mConsecutiveBitCount ;
+  private: uint8_t mFixedStuffBitCount ;
+  private: uint32_t mDynamicStuffingEnd ; // Index of resXL
+} ;
+
+//----------------------------------------------------------------------------------------
+
+CANXLFrameBitsGenerator::CANXLFrameBitsGenerator (const uint32_t inIdentifier,
+                                                  const uint8_t inSDT,
+                                                  const bool inSEC,
+                                                  const uint16_t inDataLengthCode,
+                                                  const uint8_t inVCID,
+                                                  const uint32_t inAcceptanceField,
+                                                  const uint8_t * inData,
+                                                  const AckSlot inAckSlot,
+                                                  const uint32_t inCRCErrorMask) :
+mBits (),
+mDataRateBits (),
+mPCRCAccumulator (0x1FFF),
+mFCRCAccumulator (0xFFFFFFFF),
+mStuffBitCount (0),
+mLastBitValue (true),
+mConsecutiveBitCount (1),
+mFixedStuffBitCount (0),
+mDynamicStuffingEnd (0) {
+  const uint32_t dataByteCount = uint32_t (inDataLengthCode & 0x7FF) + 1 ;
+  mBits.reserve (8 * dataByteCount + dataByteCount + 200) ;
+  mDataRateBits.reserve (8 * dataByteCount + dataByteCount + 200) ;
+//--- Arbitration field (dynamic stuffing)
+  enterBitComputeCRCAppendStuff (false) ; // SOF
+  for (int idx = 10 ; idx >= 0 ; idx--) { // Identifier
+    enterBitComputeCRCAppendStuff ((inIdentifier & (1U << idx)) != 0) ;
+  }
+  enterBitComputeCRCAppendStuff (false) ; // RRS
+  enterBitComputeCRCAppendStuff (false) ; // IDE
+  enterBitComputeCRCAppendStuff (true) ; // FDF
+  enterBitComputeCRCAppendStuff (true) ; // XLF (never followed by a stuff bit)
+  mDynamicStuffingEnd = uint32_t (mBits.size ()) ;
+//--- resXL, ADS (bit rate switch in ADH)
+  enterBitInFrameComputeCRC (false, false, true) ; // resXL
+  enterBitInFrameComputeCRC (true, true, true) ; // ADH
+  enterBitInFrameComputeCRC (true, true, true) ; // DH1
+  enterBitInFrameComputeCRC (true, true, true) ; // DH2
+  enterBitInFrameComputeCRC (false, true, true) ; // DL1
+//--- Control field (fixed stuffing from here)
+  for (int idx = 7 ; idx >= 0 ; idx--) { // SDT
+    enterBitAppendFixedStuff ((inSDT & (1U << idx)) != 0, true, true) ;
+  }
+  enterBitAppendFixedStuff (inSEC, true, true) ; // SEC
+  for (int idx = 10 ; idx >= 0 ; idx--) { // DLC
+    enterBitAppendFixedStuff ((inDataLengthCode & (1U << idx)) != 0, true, true) ;
+  }
+  const uint8_t sbc = uint8_t ((mStuffBitCount % 8) ^ ((mStuffBitCount % 8) >> 1)) ; // Gray code
+  for (int idx = 2 ; idx >= 0 ; idx--) { // SBC
+    enterBitAppendFixedStuff ((sbc & (1U << idx)) != 0, true, true) ;
+  }
+  const uint16_t pcrc = mPCRCAccumulator ;
+  for (int idx = 12 ; idx >= 0 ; idx--) { // PCRC
+    enterBitAppendFixedStuff ((pcrc & (1U << idx)) != 0, false, true) ;
+  }
+//--- Acceptance field, data field
+  for (int idx = 7 ; idx >= 0 ; idx--) { // VCID
+    enterBitAppendFixedStuff ((inVCID & (1U << idx)) != 0, false, true) ;
+  }
+  for (int idx = 31 ; idx >= 0 ; idx--) { // AF
+    enterBitAppendFixedStuff ((inAcceptanceField & (1U << idx)) != 0, false, true) ;
+  }
+  for (uint32_t dataIdx = 0 ; dataIdx < dataByteCount ; dataIdx ++) {
+    for (int bitIdx = 7 ; bitIdx >= 0 ; bitIdx--) {
+      enterBitAppendFixedStuff ((inData [dataIdx] & (1U << bitIdx)) != 0, false, true) ;
+    }
+  }
+//--- FCRC (no stuff bit after the last bit)
+  const uint32_t fcrc = mFCRCAccumulator ^ inCRCErrorMask ;
+  for (int idx = 31 ; idx >= 0 ; idx--) {
+    enterBitAppendFixedStuff ((fcrc & (1U << idx)) != 0, false, false) ;
+  }
+//--- FCP, DAS (bit rate switch in DAH)
+  enterBitInFrame (true, true) ;
+  enterBitInFrame (true, true) ;
+  enterBitInFrame (false, true) ;
+  enterBitInFrame (false, true) ;
+  enterBitInFrame (true, false) ; // DAH
+  enterBitInFrame (true, false) ; // AH1
+  enterBitInFrame (false, false) ; // AL1
+  enterBitInFrame (true, false) ; // AH2
+//--- Enter ACK, EOF, INTERMISSION
+  enterBitInFrame (inAckSlot == ACK_SLOT_RECESSIVE, false) ;
+  for (uint8_t i=0 ; i<11 ; i++) { // ACK DEL, EOF, INTERMISSION
+    enterBitInFrame (true, false) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANXLFrameBitsGenerator::enterBitInFrame (const bool inBit, const bool inUseDataBitRate) {
+  mBits.push_back (inBit) ;
+  mDataRateBits.push_back (inUseDataBitRate) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANXLFrameBitsGenerator::enterBitInFrameComputeCRC (const bool inBit,
+                                                         const bool inUseDataBitRate,
+                                                         const bool inPCRC) {
+  enterBitInFrame (inBit, inUseDataBitRate) ;
+//--- Enter in PCRC
+  if (inPCRC) {
+    const bool bit12 = (mPCRCAccumulator & (1U << 12)) != 0 ;
+    mPCRCAccumulator = uint16_t ((mPCRCAccumulator << 1) & 0x1FFF) ;
+    if (inBit ^ bit12) {
+      mPCRCAccumulator ^= 0x1CC1 ;
+    }
+  }
+//--- Enter in FCRC
+  const bool bit31 = (mFCRCAccumulator & (1U << 31)) != 0 ;
+  mFCRCAccumulator <<= 1 ;
+  if (inBit ^ bit31) {
+    mFCRCAccumulator ^= 0xF1922815 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANXLFrameBitsGenerator::enterBitComputeCRCAppendStuff (const bool inBit) {
+  enterBitInFrameComputeCRC (inBit, false, true) ;
+//--- Add a stuff bit ?
+  if (mLastBitValue == inBit) {
+    mConsecutiveBitCount += 1 ;
+    if (mConsecutiveBitCount == 5) {
+      mConsecutiveBitCount = 1 ;
+      mStuffBitCount += 1 ;
+      mLastBitValue ^= true ;
+      enterBitInFrameComputeCRC (mLastBitValue, false, true) ;
+    }
+  }else{
+    mLastBitValue = inBit ;
+    mConsecutiveBitCount = 1 ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANXLFrameBitsGenerator::enterBitAppendFixedStuff (const bool inBit, const bool inPCRC, const bool inFCRC) {
+  if (mFixedStuffBitCount == 10) { // Fixed stuff bit, not in CRCs
+    enterBitInFrame (!mBits.back (), true) ;
+    mFixedStuffBitCount = 0 ;
+  }
+  if (inFCRC) {
+    enterBitInFrameComputeCRC (inBit, true, inPCRC) ;
+  }else{
+    enterBitInFrame (inBit, true) ;
+  }
+  mFixedStuffBitCount += 1 ;
+}
+
 //----------------------------------------------------------------------------------------
 //  CANMolinaroSimulationDataGenerator
 //----------------------------------------------------------------------------------------
 
-CANMolinaroSimulationDataGenerator::CANMolinaroSimulationDataGenerator () {
+CANMolinaroSimulationDataGenerator::CANMolinaroSimulationDataGenerator () :
+mBus (0),
+mBitTiming (),
+mRandomSeed (0),
+mFrameBits (),
+mErrorInjector (),
+mFractionalBitTiming (false),
+mClockSeed (0),
+mFrameClockSkew (0.0),
+mSampleFractionX65536 (0),
+mNodeClockSkews (),
+mScheduler (),
+mSchedulerStarted (false),
+mTraceReader (),
+mTraceFrame (),
+mTraceStarted (false),
+mTraceHasFrame (false),
+mTraceStartSampleNumber (0),
+mTraceFirstTimestampNs (0),
+mSerialSimulationData (nullptr),
+mTxdSimulationData (nullptr) {
 }
 
 //----------------------------------------------------------------------------------------
@@ -496,43 +726,65 @@ CANMolinaroSimulationDataGenerator::~CANMolinaroSimulationDataGenerator () {
 //----------------------------------------------------------------------------------------
 
 void CANMolinaroSimulationDataGenerator::Initialize (const U32 simulation_sample_rate,
-                                            CANFDMolinaroAnalyzerSettings * settings) {
+                                            CANFDMolinaroAnalyzerSettings * settings,
+                                            const U32 inBus,
+                                            SimulationChannelDescriptor * inSimulationChannel,
+                                            SimulationChannelDescriptor * inTxdSimulationChannel) {
   mSimulationSampleRateHz = simulation_sample_rate;
   mSettings = settings;
+  mBus = inBus ;
+  mBitTiming = mSettings->busBitTiming (inBus) ;
+  mRandomSeed = mSettings->simulatorRandomSeed () + 7919 * inBus ; // Buses carry distinct traffic
+  mSerialSimulationData = inSimulationChannel ;
+  mTxdSimulationData = inTxdSimulationChannel ;
+  if (mTxdSimulationData != nullptr) { // Bus follows TXD after transceiver loop delay
+    const U64 loopDelay = U64 (simulation_sample_rate) * SIMULATED_LOOP_DELAY_NS / 1000000000 ;
+    mSerialSimulationData->Advance (U32 (std::max (loopDelay, U64 (1)))) ;
+  }
+
+  std::string errorMessage ;
+  mErrorInjector.compile (mSettings->simulatorErrorInjection (), errorMessage) ;
+  mErrorInjector.reset (mRandomSeed) ;
 
-  mSerialSimulationData.SetChannel (mSettings->mInputChannel);
-  mSerialSimulationData.SetSampleRate (simulation_sample_rate) ;
-  mSerialSimulationData.SetInitialBitState (BIT_HIGH) ;
+  mFractionalBitTiming = mSettings->simulatorBitTiming () == FRACTIONAL_BIT_TIMING ;
+  mClockSeed = mRandomSeed ^ 0xC10C5EEDU ;
+  mFrameClockSkew = 0.0 ;
+  mSampleFractionX65536 = 0 ;
+  mNodeClockSkews.clear () ;
 }
 
 //----------------------------------------------------------------------------------------
 
-U32 CANMolinaroSimulationDataGenerator::GenerateSimulationData
+void CANMolinaroSimulationDataGenerator::GenerateSimulationData
                                  (const U64 largest_sample_requested,
-                                  const U32 sample_rate,
-                                  SimulationChannelDescriptor** simulation_channel) {
+                                  const U32 sample_rate) {
   const U64 adjusted_largest_sample_requested = AnalyzerHelpers::AdjustSimulationTargetSample (
     largest_sample_requested,
     sample_rate,
     mSimulationSampleRateHz
   );
 
+  if ((mBus == 0) && (mSettings->simulatorTraceFile ().length () > 0)) { // Trace is replayed on first bus
+    replayTrace (adjusted_largest_sample_requested) ;
+    return ;
+  }else if (mSettings->simulatorBusLoad () > 0) {
+    generateScheduledTraffic (adjusted_largest_sample_requested) ;
+    return ;
+  }
+
  //--- Random Seed
-  mSeed = mSettings->simulatorRandomSeed () ;
+  mSeed = mRandomSeed ;
 
 //--- Let's move forward for 11 recessive bits
-  const U32 samplesPerArbitrationBitRate = mSimulationSampleRateHz / mSettings->arbitrationBitRate () ;
+  const U32 samplesPerArbitrationBitRate = mSimulationSampleRateHz / mBitTiming.mArbitrationBitRate ;
   const bool inverted = mSettings->inverted () ;
-  mSerialSimulationData.TransitionIfNeeded (inverted ? BIT_LOW : BIT_HIGH) ;  // Edge for IDLE
-  mSerialSimulationData.Advance (samplesPerArbitrationBitRate * 11) ;
-  mSerialSimulationData.TransitionIfNeeded (inverted ? BIT_HIGH : BIT_LOW) ;  // Edge for SOF bit
+  transitionIfNeeded (inverted ? BIT_LOW : BIT_HIGH) ;  // Edge for IDLE
+  advance (samplesPerArbitrationBitRate * 11) ;
+  transitionIfNeeded (inverted ? BIT_HIGH : BIT_LOW) ;  // Edge for SOF bit
 
-  while (mSerialSimulationData.GetCurrentSampleNumber() < adjusted_largest_sample_requested) {
+  while (mSerialSimulationData->GetCurrentSampleNumber() < adjusted_largest_sample_requested) {
     createCANFrame (samplesPerArbitrationBitRate, inverted) ;
   }
-
-  *simulation_channel = &mSerialSimulationData;
-  return 1;
 }
 
 //----------------------------------------------------------------------------------------
@@ -540,19 +792,23 @@ U32 CANMolinaroSimulationDataGenerator::GenerateSimulationData
 void CANMolinaroSimulationDataGenerator::createCANFrame
                                                   (const U32 inSamplesPerArbitrationBit,
                                                    const bool inInverted) {
-  const U32 samplesPerDataBit = mSimulationSampleRateHz / mSettings->dataBitRate () ;
+  const U32 samplesPerDataBit = mSimulationSampleRateHz / mBitTiming.mDataBitRate ;
   const SimulatorGeneratedFrameType frameTypes = mSettings->generatedFrameType () ;
 //--- Select Frame type to generate
   bool canFD_frame = false ;
   bool canfd_24_64 = false ;
   bool extended = false ;
   bool remoteFrame = false ;
+  bool canXL_frame = false ;
   switch (frameTypes) {
   case GENERATE_ALL_FRAME_TYPES :
     extended = (pseudoRandomValue () & 1) != 0 ;
     remoteFrame = (pseudoRandomValue () & 1) != 0 ;
     canFD_frame = (pseudoRandomValue () & 1) != 0 ;
     canfd_24_64 = (pseudoRandomValue () & 1) != 0 ;
+    if (canFD_frame && !extended && (mSettings->protocol () == CANXL_PROTOCOL)) {
+      canXL_frame = (pseudoRandomValue () & 1) != 0 ;
+    }
     break ;
   case GENERATE_ONLY_STANDARD_DATA :
     break ;
@@ -582,27 +838,24 @@ void CANMolinaroSimulationDataGenerator::createCANFrame
     canfd_24_64 = true ;
     extended = true ;
     break ;
-  }
-//--- Select ACK SLOT level
-  AckSlot ack = AckSlot::ACK_SLOT_DOMINANT ;
-  switch (mSettings->generatedAckSlot ()) {
-  case GENERATE_BIT_DOMINANT :
-    break ;
-  case GENERATE_BIT_RECESSIVE :
-    ack = AckSlot::ACK_SLOT_RECESSIVE ;
-    break ;
-  case GENERATE_BIT_RANDOMLY :
-    ack = ((pseudoRandomValue () & 1) != 0) ? AckSlot::ACK_SLOT_DOMINANT : AckSlot::ACK_SLOT_RECESSIVE ;
+  case GENERATE_ONLY_CANXL_DATA :
+    canXL_frame = true ;
     break ;
   }
+//--- Select ACK SLOT level
+  const AckSlot ack = generatedAckSlot () ;
+//--- Transmitter clock
+  mFrameClockSkew = randomClockSkew () ;
 //--- Generate CANFD Frame, 0 to 16 bytes
-  if (canFD_frame) {
+  if (canXL_frame) {
+    createCANXL_Frame (inSamplesPerArbitrationBit, samplesPerDataBit, inInverted, ack) ;
+  }else if (canFD_frame) {
     createCANFD_Frame (inSamplesPerArbitrationBit, canfd_24_64, samplesPerDataBit, inInverted, ack, extended) ;
   }else{
     createBaseCANFrame (inSamplesPerArbitrationBit, inInverted, ack, extended, remoteFrame) ;
   }
 //--- We need to end recessive
-  mSerialSimulationData.TransitionIfNeeded (inInverted ? BIT_LOW : BIT_HIGH) ;
+  transitionIfNeeded (inInverted ? BIT_LOW : BIT_HIGH) ;
 }
 
 //----------------------------------------------------------------------------------------
@@ -640,41 +893,124 @@ void CANMolinaroSimulationDataGenerator::createCANFD_Frame
   }
 //---
   uint8_t data [64] ;
-  const FrameFormat format = inExtended ? FrameFormat::extendedFrame : FrameFormat::standardFrame ;
-  const uint32_t identifier = uint32_t (pseudoRandomValue ()) & (inExtended ? 0x1FFFFFFF : 0x7FF) ;
-  const uint8_t dataLengthCode = in_canfd_24_64
+  uint32_t identifier = uint32_t (pseudoRandomValue ()) & (inExtended ? 0x1FFFFFFF : 0x7FF) ;
+  uint8_t dataLengthCode = in_canfd_24_64
     ? (uint8_t (pseudoRandomValue ()) % 5 + 11) // 11, ..., 15
     : (uint8_t (pseudoRandomValue ()) % 11) ;   // 0 ... 105
   for (uint32_t i=0 ; i<CANFDFrameBitsGenerator::lengthForCode (dataLengthCode) ; i++) {
     data [i] = uint8_t (pseudoRandomValue ()) ;
   }
-  const ProtocolSetting protocol = mSettings->protocol () ;
-  const CANFDFrameBitsGenerator frame (identifier, format, protocol, dataLengthCode, bsr, data, inAck, esi) ;
+//--- Stuffing pattern
+  const SimulatorStuffingPattern pattern = mSettings->stuffingPattern () ;
+  if (CANFDMolinaroStuffingPattern::usesLargestLength (pattern)) {
+    dataLengthCode = in_canfd_24_64 ? 15 : 10 ;
+  }
+  const CANFDMolinaroStuffingPattern::FrameLayout layout = {
+    true, inExtended, false, bsr == GeneratedBit::RECESSIVE_BIT, esi == GeneratedBit::RECESSIVE_BIT, dataLengthCode
+  } ;
+  CANFDMolinaroStuffingPattern::craft (pattern, layout, true, identifier, data) ;
 //--- Now, send FD frame
+  sendCANFD_Frame (identifier, inExtended, dataLengthCode, data,
+                   bsr == GeneratedBit::RECESSIVE_BIT, esi == GeneratedBit::RECESSIVE_BIT, inAck,
+                   inSamplesPerArbitrationBit, inSamplesPerDataBit, inInverted, true) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANMolinaroSimulationDataGenerator::sendCANFD_Frame (const U32 inIdentifier,
+                                                         const bool inExtended,
+                                                         const uint8_t inDataLengthCode,
+                                                         const uint8_t * inData,
+                                                         const bool inBRS,
+                                                         const bool inESI,
+                                                         const AckSlot inAck,
+                                                         const U32 inSamplesPerArbitrationBit,
+                                                         const U32 inSamplesPerDataBit,
+                                                         const bool inInverted,
+                                                         const bool inEmit) {
+  const FrameFormat format = inExtended ? FrameFormat::extendedFrame : FrameFormat::standardFrame ;
+  const GeneratedBit bsr = inBRS ? GeneratedBit::RECESSIVE_BIT : GeneratedBit::DOMINANT_BIT ;
+  const GeneratedBit esi = inESI ? GeneratedBit::RECESSIVE_BIT : GeneratedBit::DOMINANT_BIT ;
+  const ProtocolSetting protocol = mSettings->protocol () ;
+  const CANFDMolinaroErrorInjector::Injection injection = inEmit
+    ? mErrorInjector.nextInjection ()
+    : CANFDMolinaroErrorInjector::Injection {CANFDMolinaroErrorInjector::NO_INJECTION, -1, 0} ;
+  const uint32_t crcWidth = (inDataLengthCode > 10) ? 21 : 17 ;
+  const uint32_t crcErrorMask = (injection.mKind == CANFDMolinaroErrorInjector::CRC_CORRUPTION)
+    ? (1U << (((injection.mPosition >= 0) ? U32 (injection.mPosition) : injection.mRandom) % crcWidth))
+    : 0 ;
+  const CANFDFrameBitsGenerator frame (inIdentifier, format, protocol, inDataLengthCode, bsr, inData, inAck, esi, crcErrorMask) ;
+  const U64 arbitrationBitDurationX65536 = bitDurationX65536 (inSamplesPerArbitrationBit, mBitTiming.mArbitrationBitRate) ;
+  const U64 dataBitDurationX65536 = bitDurationX65536 (inSamplesPerDataBit, mBitTiming.mDataBitRate) ;
+  mFrameBits.clear () ;
   bool previousBitHasDataBitRate = false ;
   for (U32 i=0 ; i < frame.frameLength () ; i++) {
-    const bool bit = frame.bitAtIndex (i) ^ inInverted ;
     const bool currentBitHasDataBitRate = frame.dataBitRateAtIndex (i) ;
-    mSerialSimulationData.TransitionIfNeeded (bit ? BIT_HIGH : BIT_LOW) ;
-    if (previousBitHasDataBitRate == currentBitHasDataBitRate) {
-      mSerialSimulationData.Advance (currentBitHasDataBitRate ? inSamplesPerDataBit : inSamplesPerArbitrationBit) ;
-    }else if (currentBitHasDataBitRate && !previousBitHasDataBitRate) { // BSR bit
-      const U64 BSRsamplesX100 =
-        mSettings->arbitrationSamplePoint () * inSamplesPerArbitrationBit
-      +
-        (100 - mSettings->dataSamplePoint ()) * inSamplesPerDataBit
-      ;
-      mSerialSimulationData.Advance (BSRsamplesX100 / 100) ;
-    }else{ // CRCDEL bit
-      const U64 CRCDELsamplesX100 =
-        mSettings->dataSamplePoint () * inSamplesPerDataBit
-      +
-        (100 - mSettings->arbitrationSamplePoint ()) * inSamplesPerArbitrationBit
-      ;
-      mSerialSimulationData.Advance (CRCDELsamplesX100 / 100) ;
-    }
+    const U64 bitDuration = frameBitDurationX65536 (previousBitHasDataBitRate, currentBitHasDataBitRate,
+                                                    arbitrationBitDurationX65536, dataBitDurationX65536) ;
+    const SimulatedBit simulatedBit = { frame.bitAtIndex (i), bitDuration } ;
+    mFrameBits.push_back (simulatedBit) ;
     previousBitHasDataBitRate = currentBitHasDataBitRate ;
   }
+  return emitFrameBits (injection, frame.dynamicStuffingEnd (), arbitrationBitDurationX65536, inInverted, inEmit) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::createCANXL_Frame (const U32 inSamplesPerArbitrationBit,
+                                                            const U32 inSamplesPerDataBit,
+                                                            const bool inInverted,
+                                                            const AckSlot inAck) {
+  const uint32_t identifier = uint32_t (pseudoRandomValue ()) & 0x7FF ;
+  const uint8_t sdt = uint8_t (pseudoRandomValue ()) ;
+  const bool sec = (pseudoRandomValue () & 1) != 0 ;
+  const uint16_t dataLengthCode = uint16_t (pseudoRandomValue () % 2048) ; // 1 ... 2048 bytes
+  const uint8_t vcid = uint8_t (pseudoRandomValue ()) ;
+  const uint32_t acceptanceField = uint32_t (pseudoRandomValue ()) ;
+  std::vector <uint8_t> data (size_t (dataLengthCode) + 1) ;
+  for (uint8_t & byte : data) {
+    byte = uint8_t (pseudoRandomValue ()) ;
+  }
+  sendCANXL_Frame (identifier, sdt, sec, dataLengthCode, vcid, acceptanceField, data.data (), inAck,
+                   inSamplesPerArbitrationBit, inSamplesPerDataBit, inInverted, true) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANMolinaroSimulationDataGenerator::sendCANXL_Frame (const U32 inIdentifier,
+                                                         const uint8_t inSDT,
+                                                         const bool inSEC,
+                                                         const uint16_t inDataLengthCode,
+                                                         const uint8_t inVCID,
+                                                         const U32 inAcceptanceField,
+                                                         const uint8_t * inData,
+                                                         const AckSlot inAck,
+                                                         const U32 inSamplesPerArbitrationBit,
+                                                         const U32 inSamplesPerDataBit,
+                                                         const bool inInverted,
+                                                         const bool inEmit) {
+  const CANFDMolinaroErrorInjector::Injection injection = inEmit
+    ? mErrorInjector.nextInjection ()
+    : CANFDMolinaroErrorInjector::Injection {CANFDMolinaroErrorInjector::NO_INJECTION, -1, 0} ;
+  const uint32_t crcWidth = 32 ; // FCRC
+  const uint32_t crcErrorMask = (injection.mKind == CANFDMolinaroErrorInjector::CRC_CORRUPTION)
+    ? (1U << (((injection.mPosition >= 0) ? U32 (injection.mPosition) : injection.mRandom) % crcWidth))
+    : 0 ;
+  const CANXLFrameBitsGenerator frame (inIdentifier, inSDT, inSEC, inDataLengthCode, inVCID, inAcceptanceField,
+                                       inData, inAck, crcErrorMask) ;
+  const U64 arbitrationBitDurationX65536 = bitDurationX65536 (inSamplesPerArbitrationBit, mBitTiming.mArbitrationBitRate) ;
+  const U64 dataBitDurationX65536 = bitDurationX65536 (inSamplesPerDataBit, mBitTiming.mDataBitRate) ;
+  mFrameBits.clear () ;
+  bool previousBitHasDataBitRate = false ;
+  for (U32 i=0 ; i < frame.frameLength () ; i++) {
+    const bool currentBitHasDataBitRate = frame.dataBitRateAtIndex (i) ;
+    const U64 bitDuration = frameBitDurationX65536 (previousBitHasDataBitRate, currentBitHasDataBitRate,
+                                                    arbitrationBitDurationX65536, dataBitDurationX65536) ;
+    const SimulatedBit simulatedBit = { frame.bitAtIndex (i), bitDuration } ;
+    mFrameBits.push_back (simulatedBit) ;
+    previousBitHasDataBitRate = currentBitHasDataBitRate ;
+  }
+  return emitFrameBits (injection, frame.dynamicStuffingEnd (), arbitrationBitDurationX65536, inInverted, inEmit) ;
 }
 
 //----------------------------------------------------------------------------------------
@@ -685,25 +1021,434 @@ void CANMolinaroSimulationDataGenerator::createBaseCANFrame (const U32 inSamples
                                                              const bool inExtended,
                                                              const bool inRemote) {
 //----
-  uint8_t data [8] ;
-  const FrameFormat format = inExtended ? FrameFormat::extendedFrame : FrameFormat::standardFrame ;
-  const FrameType type = inRemote ? FrameType::remoteFrame : FrameType::dataFrame ;
-  const uint32_t identifier = uint32_t (pseudoRandomValue ()) & (inExtended ? 0x1FFFFFFF : 0x7FF) ;
-  const uint8_t dataLength = uint8_t (pseudoRandomValue ()) % 9 ;
+  uint8_t data [64] ;
+  uint32_t identifier = uint32_t (pseudoRandomValue ()) & (inExtended ? 0x1FFFFFFF : 0x7FF) ;
+  uint8_t dataLength = uint8_t (pseudoRandomValue ()) % 9 ;
   if (! remoteFrame) {
     for (uint32_t i=0 ; i<dataLength ; i++) {
       data [i] = uint8_t (pseudoRandomValue ()) ;
     }
   }
-  const CANFrameBitsGenerator frame (identifier, format, dataLength, data, type, inAck) ;
+//--- Stuffing pattern
+  const SimulatorStuffingPattern pattern = mSettings->stuffingPattern () ;
+  if (CANFDMolinaroStuffingPattern::usesLargestLength (pattern)) {
+    dataLength = 8 ;
+  }
+  const CANFDMolinaroStuffingPattern::FrameLayout layout = {false, inExtended, inRemote, false, false, dataLength} ;
+  CANFDMolinaroStuffingPattern::craft (pattern, layout, true, identifier, data) ;
 //--- Generated bit error index
 //   uint8_t generatedErrorBitIndex = uint8_t (uint32_t (pseudoRandomValue ()) % frame.frameLength ()) ;
   pseudoRandomValue () ; // For compatibility witrh CAN 2.0B generator
 //--- Now, send frame
+  sendBaseCANFrame (identifier, inExtended, inRemote, dataLength, data, inAck,
+                    inSamplesPerArbitrationBit, inInverted, true) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+U64 CANMolinaroSimulationDataGenerator::sendBaseCANFrame (const U32 inIdentifier,
+                                                          const bool inExtended,
+                                                          const bool inRemote,
+                                                          const uint8_t inDataLength,
+                                                          const uint8_t * inData,
+                                                          const AckSlot inAck,
+                                                          const U32 inSamplesPerArbitrationBit,
+                                                          const bool inInverted,
+                                                          const bool inEmit) {
+  const FrameFormat format = inExtended ? FrameFormat::extendedFrame : FrameFormat::standardFrame ;
+  const FrameType type = inRemote ? FrameType::remoteFrame : FrameType::dataFrame ;
+  const CANFDMolinaroErrorInjector::Injection injection = inEmit
+    ? mErrorInjector.nextInjection ()
+    : CANFDMolinaroErrorInjector::Injection {CANFDMolinaroErrorInjector::NO_INJECTION, -1, 0} ;
+  const uint16_t crcErrorMask = (injection.mKind == CANFDMolinaroErrorInjector::CRC_CORRUPTION)
+    ? uint16_t (1U << (((injection.mPosition >= 0) ? U32 (injection.mPosition) : injection.mRandom) % 15))
+    : 0 ;
+  const CANFrameBitsGenerator frame (inIdentifier, format, inDataLength, inData, type, inAck, crcErrorMask) ;
+  const U64 arbitrationBitDurationX65536 = bitDurationX65536 (inSamplesPerArbitrationBit, mBitTiming.mArbitrationBitRate) ;
+  mFrameBits.clear () ;
   for (U32 i=0 ; i < frame.frameLength () ; i++) {
-    const bool bit = frame.bitAtIndex (i) ^ inInverted ;
-    mSerialSimulationData.TransitionIfNeeded (bit ? BIT_HIGH : BIT_LOW) ;
-    mSerialSimulationData.Advance (inSamplesPerArbitrationBit) ;
+    const SimulatedBit simulatedBit = { frame.bitAtIndex (i), arbitrationBitDurationX65536 } ;
+    mFrameBits.push_back (simulatedBit) ;
+  }
+  return emitFrameBits (injection, frame.dynamicStuffingEnd (), arbitrationBitDurationX65536, inInverted, inEmit) ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Frame bits end with CRC DEL, ACK SLOT, ACK DEL, EOF (7 bits) and INTERMISSION (3 bits).
+//  The injected fault is applied to the bit list, then bits are sent. A stuff error is
+//  only injected on a dynamic stuff bit, that is before inDynamicStuffingEnd: the fixed
+//  stuffed fields of CAN FD and CAN XL frames have no run of 5 equal bits to break.
+//----------------------------------------------------------------------------------------
+
+U64 CANMolinaroSimulationDataGenerator::emitFrameBits (const CANFDMolinaroErrorInjector::Injection & inInjection,
+                                                       const U32 inDynamicStuffingEnd,
+                                                       const U64 inArbitrationBitDurationX65536,
+                                                       const bool inInverted,
+                                                       const bool inEmit) {
+  const U32 crcDelimiterIndex = U32 (mFrameBits.size ()) - 13 ;
+  const U32 position = U32 (inInjection.mPosition) ;
+  const bool randomPosition = inInjection.mPosition < 0 ;
+  U32 glitchIndex = UINT32_MAX ;
+  const U32 ackSlotIndex = (inInjection.mKind == CANFDMolinaroErrorInjector::ERROR_FLAG)
+    ? UINT32_MAX
+    : (crcDelimiterIndex + 1) ;
+  switch (inInjection.mKind) {
+  case CANFDMolinaroErrorInjector::NO_INJECTION :
+  case CANFDMolinaroErrorInjector::CRC_CORRUPTION : // Done by frame generator
+    break ;
+  case CANFDMolinaroErrorInjector::BIT_FLIP :
+    { const U32 idx = randomPosition ? (1 + inInjection.mRandom % (crcDelimiterIndex - 1)) : position ;
+      if (idx < mFrameBits.size ()) {
+        mFrameBits [idx].mLevel ^= true ;
+      }
+    }
+    break ;
+  case CANFDMolinaroErrorInjector::STUFF_ERROR :
+    { std::vector <U32> stuffBitIndexes ;
+      U32 count = 1 ;
+      for (U32 i=1 ; (i+1) < inDynamicStuffingEnd ; i++) {
+        count = (mFrameBits [i].mLevel == mFrameBits [i-1].mLevel) ? (count + 1) : 1 ;
+        if (count == 5) {
+          stuffBitIndexes.push_back (i + 1) ;
+          i += 1 ;
+          count = 1 ;
+        }
+      }
+      if (stuffBitIndexes.size () > 0) {
+        const U32 rank = randomPosition
+          ? (inInjection.mRandom % stuffBitIndexes.size ())
+          : std::min (position, U32 (stuffBitIndexes.size () - 1)) ;
+        mFrameBits [stuffBitIndexes [rank]].mLevel ^= true ;
+      }
+    }
+    break ;
+  case CANFDMolinaroErrorInjector::FORM_ERROR : // 0: CRC DEL, 1: ACK DEL, 2-7: EOF
+    { const U32 k = (randomPosition ? inInjection.mRandom : position) % 8 ;
+      mFrameBits [(k == 0) ? crcDelimiterIndex : (crcDelimiterIndex + 1 + k)].mLevel = false ;
+    }
+    break ;
+  case CANFDMolinaroErrorInjector::GLITCH :
+    glitchIndex = randomPosition
+      ? (inInjection.mRandom % (U32 (mFrameBits.size ()) - 3))
+      : std::min (position, U32 (mFrameBits.size ()) - 4) ;
+    break ;
+  case CANFDMolinaroErrorInjector::ERROR_FLAG : // 6 dominant bits, 8 bits delimiter, intermission
+    { const U32 idx = randomPosition
+        ? (1 + inInjection.mRandom % (crcDelimiterIndex - 1))
+        : std::min (std::max (position, U32 (1)), crcDelimiterIndex) ;
+      mFrameBits.resize (idx) ;
+      for (U32 i=0 ; i<17 ; i++) {
+        const SimulatedBit simulatedBit = { i >= 6, inArbitrationBitDurationX65536 } ;
+        mFrameBits.push_back (simulatedBit) ;
+      }
+    }
+    break ;
+  case CANFDMolinaroErrorInjector::OVERLOAD_FLAG : // After EOF: 6 dominant bits, 8 bits delimiter, intermission
+    mFrameBits.resize (mFrameBits.size () - 3) ;
+    for (U32 i=0 ; i<17 ; i++) {
+      const SimulatedBit simulatedBit = { i >= 6, inArbitrationBitDurationX65536 } ;
+      mFrameBits.push_back (simulatedBit) ;
+    }
+    break ;
+  }
+//--- Send bits
+  U64 durationX65536 = 0 ;
+  U64 emittedSampleCount = 0 ;
+  for (U32 i=0 ; i < mFrameBits.size () ; i++) {
+    const SimulatedBit & simulatedBit = mFrameBits [i] ;
+    if (inEmit) {
+      const bool bit = simulatedBit.mLevel ^ inInverted ;
+      transitionIfNeeded (bit ? BIT_HIGH : BIT_LOW) ;
+      if ((mTxdSimulationData != nullptr) && (i == ackSlotIndex)) { // Transmitter sends recessive ACK slot
+        mTxdSimulationData->TransitionIfNeeded (inInverted ? BIT_LOW : BIT_HIGH) ;
+      }
+      const U64 bitSampleCount = simulatedBit.mDurationX65536 >> 16 ;
+      if ((i == glitchIndex) && (bitSampleCount >= 8)) {
+        const U64 glitchStart = (bitSampleCount / 4) << 16 ;
+        const U64 glitchDuration = (bitSampleCount / 8) << 16 ;
+        emittedSampleCount += advanceFractional (glitchStart) ;
+        mSerialSimulationData->TransitionIfNeeded (bit ? BIT_LOW : BIT_HIGH) ; // Glitch is not on TXD
+        emittedSampleCount += advanceFractional (glitchDuration) ;
+        mSerialSimulationData->TransitionIfNeeded (bit ? BIT_HIGH : BIT_LOW) ;
+        emittedSampleCount += advanceFractional (simulatedBit.mDurationX65536 - glitchStart - glitchDuration) ;
+      }else{
+        emittedSampleCount += advanceFractional (simulatedBit.mDurationX65536) ;
+      }
+    }
+    durationX65536 += simulatedBit.mDurationX65536 ;
+  }
+  return inEmit ? emittedSampleCount : (durationX65536 >> 16) ;
+}
+
+//----------------------------------------------------------------------------------------
+//  BIT TIMING
+//----------------------------------------------------------------------------------------
+
+//--- Sub-sample part of the bit time is carried to the next bit
+
+U64 CANMolinaroSimulationDataGenerator::advanceFractional (const U64 inDurationX65536) {
+  const U64 total = mSampleFractionX65536 + inDurationX65536 ;
+  const U32 sampleCount = U32 (total >> 16) ;
+  advance (sampleCount) ;
+  mSampleFractionX65536 = U32 (total & 0xFFFF) ;
+  return sampleCount ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Integer bit timing: inSamplesPerBit, as the legacy simulator. Fractional bit timing:
+//  exact bit time, for the transmitter clock of the current frame (a fast clock, positive
+//  skew, gives a shorter bit).
+
+U64 CANMolinaroSimulationDataGenerator::bitDurationX65536 (const U32 inSamplesPerBit,
+                                                            const U32 inBitRate) const {
+  U64 result = U64 (inSamplesPerBit) << 16 ;
+  if (mFractionalBitTiming) {
+    const double samplesPerBit = double (mSimulationSampleRateHz) / (double (inBitRate) * (1.0 + mFrameClockSkew)) ;
+    result = U64 (samplesPerBit * 65536.0 + 0.5) ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+//  The first data bit rate bit (BRS, ADH) and the first arbitration bit rate bit after the
+//  data phase (CRC DEL, DAH) have both bit rates
+
+U64 CANMolinaroSimulationDataGenerator::frameBitDurationX65536 (const bool inPreviousBitHasDataBitRate,
+                                                                const bool inCurrentBitHasDataBitRate,
+                                                                const U64 inArbitrationBitDurationX65536,
+                                                                const U64 inDataBitDurationX65536) const {
+  U64 bitDuration = 0 ;
+  if (inPreviousBitHasDataBitRate == inCurrentBitHasDataBitRate) {
+    bitDuration = inCurrentBitHasDataBitRate ? inDataBitDurationX65536 : inArbitrationBitDurationX65536 ;
+  }else if (inCurrentBitHasDataBitRate && !inPreviousBitHasDataBitRate) { // BSR bit
+    const U64 BSRsamplesX100 =
+      mBitTiming.mArbitrationSamplePoint * inArbitrationBitDurationX65536
+    +
+      (100 - mBitTiming.mDataSamplePoint) * inDataBitDurationX65536
+    ;
+    bitDuration = BSRsamplesX100 / 100 ;
+  }else{ // CRCDEL bit
+    const U64 CRCDELsamplesX100 =
+      mBitTiming.mDataSamplePoint * inDataBitDurationX65536
+    +
+      (100 - mBitTiming.mArbitrationSamplePoint) * inArbitrationBitDurationX65536
+    ;
+    bitDuration = CRCDELsamplesX100 / 100 ;
+  }
+//--- Integer bit timing: whole samples
+  if (!mFractionalBitTiming) {
+    bitDuration &= ~ U64 (0xFFFF) ;
+  }
+  return bitDuration ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Clock skew, uniform in ± tolerance; with integer bit timing, clocks are nominal
+
+double CANMolinaroSimulationDataGenerator::randomClockSkew (void) {
+  double result = 0.0 ;
+  if (mFractionalBitTiming) {
+    mClockSeed = 8253729U * mClockSeed + 2396403U ;
+    const double uniform = double (mClockSeed >> 8) / double (1U << 24) ; // [0, 1)
+    result = (2.0 * uniform - 1.0) * double (mSettings->simulatorClockTolerance ()) * 1.0e-6 ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+AckSlot CANMolinaroSimulationDataGenerator::generatedAckSlot (void) {
+  AckSlot ack = AckSlot::ACK_SLOT_DOMINANT ;
+  switch (mSettings->generatedAckSlot ()) {
+  case GENERATE_BIT_DOMINANT :
+    break ;
+  case GENERATE_BIT_RECESSIVE :
+    ack = AckSlot::ACK_SLOT_RECESSIVE ;
+    break ;
+  case GENERATE_BIT_RANDOMLY :
+    ack = ((pseudoRandomValue () & 1) != 0) ? AckSlot::ACK_SLOT_DOMINANT : AckSlot::ACK_SLOT_RECESSIVE ;
+    break ;
+  }
+  return ack ;
+}
+
+//----------------------------------------------------------------------------------------
+//  SCHEDULED TRAFFIC
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::generateScheduledTraffic (const U64 inLargestSampleRequested) {
+  const U32 samplesPerArbitrationBit = mSimulationSampleRateHz / mBitTiming.mArbitrationBitRate ;
+  const U32 samplesPerDataBit = mSimulationSampleRateHz / mBitTiming.mDataBitRate ;
+  const bool inverted = mSettings->inverted () ;
+  uint8_t data [64] ;
+  if (!mSchedulerStarted) {
+    mSchedulerStarted = true ;
+    mSeed = mRandomSeed ;
+    mScheduler.build (mSettings->simulatorNodeCount (),
+                      mSettings->generatedFrameType (),
+                      mSettings->generatedBSRSlot (),
+                      mRandomSeed,
+                      mSimulationSampleRateHz) ;
+  //--- Each virtual node has its own clock
+    for (U32 i = 0 ; i < mSettings->simulatorNodeCount () ; i++) {
+      mNodeClockSkews.push_back (randomClockSkew ()) ;
+    }
+  //--- Frame durations, estimated with random data
+    for (U32 i = 0 ; i < mScheduler.messageCount () ; i++) {
+      const CANFDMolinaroTrafficScheduler::Message & message = mScheduler.message (i) ;
+      mFrameClockSkew = mNodeClockSkews [message.mNode] ;
+      for (uint32_t k=0 ; k<64 ; k++) {
+        data [k] = uint8_t (pseudoRandomValue ()) ;
+      }
+      craftPayload (message, false, data) ;
+      const U64 duration = message.mCANFD
+        ? sendCANFD_Frame (message.mIdentifier, message.mExtended, message.mDataLengthCode, data,
+                           message.mBRS, false, AckSlot::ACK_SLOT_DOMINANT,
+                           samplesPerArbitrationBit, samplesPerDataBit, inverted, false)
+        : sendBaseCANFrame (message.mIdentifier, message.mExtended, message.mRemote, message.mDataLengthCode, data,
+                            AckSlot::ACK_SLOT_DOMINANT, samplesPerArbitrationBit, inverted, false) ;
+      mScheduler.setMessageDuration (i, duration) ;
+    }
+  //--- 11 recessive bits
+    transitionIfNeeded (inverted ? BIT_LOW : BIT_HIGH) ;
+    advance (samplesPerArbitrationBit * 11) ;
+    mScheduler.start (mSettings->simulatorBusLoad (), mSerialSimulationData->GetCurrentSampleNumber ()) ;
+  }
+//--- Send frames in arbitration order, bus is idle between them
+  while (mSerialSimulationData->GetCurrentSampleNumber () < inLargestSampleRequested) {
+    U64 startSampleNumber = 0 ;
+    const U32 idx = mScheduler.nextFrame (mSerialSimulationData->GetCurrentSampleNumber (), startSampleNumber) ;
+    if (startSampleNumber > mSerialSimulationData->GetCurrentSampleNumber ()) {
+      advanceIdle (startSampleNumber - mSerialSimulationData->GetCurrentSampleNumber ()) ;
+    }
+    const CANFDMolinaroTrafficScheduler::Message & message = mScheduler.message (idx) ;
+    mFrameClockSkew = mNodeClockSkews [message.mNode] ;
+    const AckSlot ack = generatedAckSlot () ;
+    if (message.mCANFD) {
+      bool esi = false ;
+      switch (mSettings->generatedESISlot ()) {
+      case GENERATE_BIT_DOMINANT :
+        break ;
+      case GENERATE_BIT_RECESSIVE :
+        esi = true ;
+        break ;
+      case GENERATE_BIT_RANDOMLY :
+        esi = (pseudoRandomValue () & 1) == 0 ;
+        break ;
+      }
+      for (uint32_t k=0 ; k<CANFDFrameBitsGenerator::lengthForCode (message.mDataLengthCode) ; k++) {
+        data [k] = uint8_t (pseudoRandomValue ()) ;
+      }
+      craftPayload (message, esi, data) ;
+      sendCANFD_Frame (message.mIdentifier, message.mExtended, message.mDataLengthCode, data,
+                       message.mBRS, esi, ack, samplesPerArbitrationBit, samplesPerDataBit, inverted, true) ;
+    }else{
+      for (uint32_t k=0 ; k<message.mDataLengthCode ; k++) {
+        data [k] = uint8_t (pseudoRandomValue ()) ;
+      }
+      craftPayload (message, false, data) ;
+      sendBaseCANFrame (message.mIdentifier, message.mExtended, message.mRemote, message.mDataLengthCode, data,
+                        ack, samplesPerArbitrationBit, inverted, true) ;
+    }
+  }
+}
+
+//--- Scheduled messages keep their identifier and length, only the payload follows the
+//    stuffing pattern
+
+void CANMolinaroSimulationDataGenerator::craftPayload (const CANFDMolinaroTrafficScheduler::Message & inMessage,
+                                                       const bool inESI,
+                                                       uint8_t ioData [64]) const {
+  const CANFDMolinaroStuffingPattern::FrameLayout layout = {
+    inMessage.mCANFD, inMessage.mExtended, inMessage.mRemote, inMessage.mBRS, inESI, inMessage.mDataLengthCode
+  } ;
+  uint32_t identifier = inMessage.mIdentifier ;
+  CANFDMolinaroStuffingPattern::craft (mSettings->stuffingPattern (), layout, false, identifier, ioData) ;
+}
+
+//----------------------------------------------------------------------------------------
+//  TRACE REPLAY
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::advanceIdle (const U64 inSampleCount) {
+  U64 remaining = inSampleCount ;
+  while (remaining > 0) {
+    const U32 count = (remaining > UINT32_MAX) ? UINT32_MAX : U32 (remaining) ;
+    advance (count) ;
+    remaining -= count ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Frames are read one at a time from the trace file. A frame starts at its timestamp,
+//  relative to the first frame of the trace; if the bus is still busy, it is sent as soon
+//  as the bus becomes idle. After the last frame, the bus stays idle.
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::replayTrace (const U64 inLargestSampleRequested) {
+  const U32 samplesPerArbitrationBit = mSimulationSampleRateHz / mBitTiming.mArbitrationBitRate ;
+  const U32 samplesPerDataBit = mSimulationSampleRateHz / mBitTiming.mDataBitRate ;
+  const bool inverted = mSettings->inverted () ;
+  if (!mTraceStarted) {
+    mTraceStarted = true ;
+    std::string errorMessage ;
+    mTraceHasFrame = mTraceReader.open (mSettings->simulatorTraceFile (), errorMessage)
+      && mTraceReader.next (mTraceFrame) ;
+    mTraceFirstTimestampNs = mTraceFrame.mTimestampNs ;
+  //--- 11 recessive bits
+    transitionIfNeeded (inverted ? BIT_LOW : BIT_HIGH) ;
+    advance (samplesPerArbitrationBit * 11) ;
+    mTraceStartSampleNumber = mSerialSimulationData->GetCurrentSampleNumber () ;
+  }
+  while (mSerialSimulationData->GetCurrentSampleNumber () < inLargestSampleRequested) {
+    const U64 currentSampleNumber = mSerialSimulationData->GetCurrentSampleNumber () ;
+    if (!mTraceHasFrame) {
+      advanceIdle (inLargestSampleRequested - currentSampleNumber) ;
+    }else{
+      const U64 timestampNs = (mTraceFrame.mTimestampNs > mTraceFirstTimestampNs)
+        ? (mTraceFrame.mTimestampNs - mTraceFirstTimestampNs)
+        : 0 ;
+      const U64 startSampleNumber = mTraceStartSampleNumber
+        + U64 (double (timestampNs) * double (mSimulationSampleRateHz) / 1.0e9) ;
+      if (startSampleNumber > currentSampleNumber) {
+        advanceIdle (startSampleNumber - currentSampleNumber) ;
+      }
+      mFrameClockSkew = randomClockSkew () ;
+      if (mTraceFrame.mCANFD) {
+        U8 dataLengthCode = 0 ;
+        while (CANFDFrameBitsGenerator::lengthForCode (dataLengthCode) < mTraceFrame.mLength) {
+          dataLengthCode += 1 ;
+        }
+        sendCANFD_Frame (mTraceFrame.mIdentifier, mTraceFrame.mExtended, dataLengthCode, mTraceFrame.mData,
+                         mTraceFrame.mBRS, mTraceFrame.mESI, AckSlot::ACK_SLOT_DOMINANT,
+                         samplesPerArbitrationBit, samplesPerDataBit, inverted, true) ;
+      }else{
+        sendBaseCANFrame (mTraceFrame.mIdentifier, mTraceFrame.mExtended, mTraceFrame.mRemote,
+                          mTraceFrame.mLength, mTraceFrame.mData, AckSlot::ACK_SLOT_DOMINANT,
+                          samplesPerArbitrationBit, inverted, true) ;
+      }
+      mTraceHasFrame = mTraceReader.next (mTraceFrame) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  TXD
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::transitionIfNeeded (const BitState inBitState) {
+  mSerialSimulationData->TransitionIfNeeded (inBitState) ;
+  if (mTxdSimulationData != nullptr) {
+    mTxdSimulationData->TransitionIfNeeded (inBitState) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANMolinaroSimulationDataGenerator::advance (const U32 inSampleCount) {
+  mSerialSimulationData->Advance (inSampleCount) ;
+  if (mTxdSimulationData != nullptr) {
+    mTxdSimulationData->Advance (inSampleCount) ;
   }
 }
 
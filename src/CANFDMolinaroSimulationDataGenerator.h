@@ -4,14 +4,15 @@
 //----------------------------------------------------------------------------------------
 
 #include <SimulationChannelDescriptor.h>
+#include "CANFDMolinaroTrafficScheduler.h"
+#include "CANFDMolinaroTraceReader.h"
+#include "CANFDMolinaroErrorInjector.h"
+#include "CANFDMolinaroAnalyzerSettings.h"
+#include <vector>
 #include <string>
 
 //----------------------------------------------------------------------------------------
 
-class CANFDMolinaroAnalyzerSettings;
-
-//----------------------------------------------------------------------------------------
-
 typedef enum {ACK_SLOT_DOMINANT, ACK_SLOT_RECESSIVE} AckSlot ;
 
 //----------------------------------------------------------------------------------------
@@ -21,12 +22,21 @@ public:
   CANMolinaroSimulationDataGenerator();
   ~CANMolinaroSimulationDataGenerator();
 
-  void Initialize ( U32 simulation_sample_rate, CANFDMolinaroAnalyzerSettings* settings );
-  U32 GenerateSimulationData( U64 newest_sample_requested, U32 sample_rate, SimulationChannelDescriptor** simulation_channel );
+//--- Frames of bus inBus are generated in inSimulationChannel; if inTxdSimulationChannel
+//    is not null, it gets the TXD of the transmitting node
+  void Initialize ( U32 simulation_sample_rate,
+                    CANFDMolinaroAnalyzerSettings* settings,
+                    const U32 inBus,
+                    SimulationChannelDescriptor * inSimulationChannel,
+                    SimulationChannelDescriptor * inTxdSimulationChannel );
+  void GenerateSimulationData( U64 newest_sample_requested, U32 sample_rate );
 
 protected:
   CANFDMolinaroAnalyzerSettings* mSettings;
   U32 mSimulationSampleRateHz;
+  U32 mBus ;
+  BusBitTiming mBitTiming ;
+  U32 mRandomSeed ;
 
 //---------------- Pseudo Random Generator
 //https://stackoverflow.com/questions/15500621/c-c-algorithm-to-produce-same-pseudo-random-number-sequences-from-same-seed-on
@@ -52,7 +62,102 @@ protected: void createCANFD_Frame (const U32 inSamplesPerArbitrationBit,
                                    const AckSlot inAck,
                                    const bool inExtended) ;
 
-protected: SimulationChannelDescriptor mSerialSimulationData;
+protected: void createCANXL_Frame (const U32 inSamplesPerArbitrationBit,
+                                   const U32 inSamplesPerDataBit,
+                                   const bool inInverted,
+                                   const AckSlot inAck) ;
+
+//--- Send a frame, returns its duration in samples (with inEmit false, nothing is sent)
+protected: U64 sendBaseCANFrame (const U32 inIdentifier,
+                                 const bool inExtended,
+                                 const bool inRemote,
+                                 const uint8_t inDataLength,
+                                 const uint8_t * inData,
+                                 const AckSlot inAck,
+                                 const U32 inSamplesPerArbitrationBit,
+                                 const bool inInverted,
+                                 const bool inEmit) ;
+
+protected: U64 sendCANFD_Frame (const U32 inIdentifier,
+                                const bool inExtended,
+                                const uint8_t inDataLengthCode,
+                                const uint8_t * inData,
+                                const bool inBRS,
+                                const bool inESI,
+                                const AckSlot inAck,
+                                const U32 inSamplesPerArbitrationBit,
+                                const U32 inSamplesPerDataBit,
+                                const bool inInverted,
+                                const bool inEmit) ;
+
+//--- inDataLengthCode is data length - 1 (0 ... 2047)
+protected: U64 sendCANXL_Frame (const U32 inIdentifier,
+                                const uint8_t inSDT,
+                                const bool inSEC,
+                                const uint16_t inDataLengthCode,
+                                const uint8_t inVCID,
+                                const U32 inAcceptanceField,
+                                const uint8_t * inData,
+                                const AckSlot inAck,
+                                const U32 inSamplesPerArbitrationBit,
+                                const U32 inSamplesPerDataBit,
+                                const bool inInverted,
+                                const bool inEmit) ;
+
+protected: AckSlot generatedAckSlot (void) ;
+
+//--- Bits of the frame being sent (level is true for recessive), and error injection
+protected: typedef struct {
+  bool mLevel ;
+  U64 mDurationX65536 ; // In 1/65536 sample
+} SimulatedBit ;
+protected: std::vector <SimulatedBit> mFrameBits ;
+protected: CANFDMolinaroErrorInjector mErrorInjector ;
+protected: U64 emitFrameBits (const CANFDMolinaroErrorInjector::Injection & inInjection,
+                              const U32 inDynamicStuffingEnd,
+                              const U64 inArbitrationBitDurationX65536,
+                              const bool inInverted,
+                              const bool inEmit) ;
+
+//--- Bit timing: integer or fractional samples per bit, transmitter clock skew
+protected: U64 bitDurationX65536 (const U32 inSamplesPerBit, const U32 inBitRate) const ;
+protected: U64 frameBitDurationX65536 (const bool inPreviousBitHasDataBitRate,
+                                      const bool inCurrentBitHasDataBitRate,
+                                      const U64 inArbitrationBitDurationX65536,
+                                      const U64 inDataBitDurationX65536) const ;
+protected: U64 advanceFractional (const U64 inDurationX65536) ;
+protected: double randomClockSkew (void) ;
+protected: bool mFractionalBitTiming ;
+protected: U32 mClockSeed ;
+protected: double mFrameClockSkew ; // Relative, 1e-6 is 1 ppm
+protected: U32 mSampleFractionX65536 ;
+protected: std::vector <double> mNodeClockSkews ;
+
+//--- Traffic scheduler (simulator bus load setting is not 0)
+protected: void generateScheduledTraffic (const U64 inLargestSampleRequested) ;
+protected: void craftPayload (const CANFDMolinaroTrafficScheduler::Message & inMessage,
+                              const bool inESI,
+                              uint8_t ioData [64]) const ;
+protected: CANFDMolinaroTrafficScheduler mScheduler ;
+protected: bool mSchedulerStarted ;
+
+//--- Trace replay (simulator trace file setting is not empty)
+protected: void replayTrace (const U64 inLargestSampleRequested) ;
+protected: CANFDMolinaroTraceReader mTraceReader ;
+protected: CANFDMolinaroTraceReader::TraceFrame mTraceFrame ;
+protected: bool mTraceStarted ;
+protected: bool mTraceHasFrame ;
+protected: U64 mTraceStartSampleNumber ;
+protected: U64 mTraceFirstTimestampNs ;
+
+protected: void advanceIdle (const U64 inSampleCount) ;
+
+protected: SimulationChannelDescriptor * mSerialSimulationData;
+
+//--- TXD: bus level, but recessive ACK slot; the bus is delayed by the loop delay
+protected: SimulationChannelDescriptor * mTxdSimulationData ;
+protected: void transitionIfNeeded (const BitState inBitState) ;
+protected: void advance (const U32 inSampleCount) ;
 
 } ;
 
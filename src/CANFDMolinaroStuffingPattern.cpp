@@ -0,0 +1,227 @@
+#include "CANFDMolinaroStuffingPattern.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------------------------------
+
+static const uint8_t CANFD_LENGTH [16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64} ;
+
+//----------------------------------------------------------------------------------------
+//  Stuffing walker: follows the bit stream as the frame bits generators do (stuff bits
+//  included), and chooses free bits
+//----------------------------------------------------------------------------------------
+
+class StuffingWalker {
+  public: StuffingWalker (const bool inMaximize) :
+  mMaximize (inMaximize),
+  mLastBitValue (true),
+  mConsecutiveBitCount (1),
+  mBitIndex (0),
+  mLastStuffBitIndex (0),
+  mLastRunEndIndex (0),
+  mFreeBitIndex (0),
+  mAlternatingBitCount (0) {
+  }
+
+//--- inStuffAllowed is false for the last data bit of a CANFD frame (fixed stuff bit follows)
+  public: void enterBit (const bool inBit, const bool inStuffAllowed) {
+    mBitIndex += 1 ;
+    if (mLastBitValue == inBit) {
+      mConsecutiveBitCount += 1 ;
+      if (mConsecutiveBitCount == 5) {
+        mLastRunEndIndex = mBitIndex ;
+        if (inStuffAllowed) {
+          mConsecutiveBitCount = 1 ;
+          mLastBitValue ^= true ;
+          mBitIndex += 1 ;
+          mLastStuffBitIndex = mBitIndex ;
+        }
+      }
+    }else{
+      mLastBitValue = inBit ;
+      mConsecutiveBitCount = 1 ;
+    }
+  }
+
+//--- The first mAlternatingBitCount free bits of a field alternate
+  public: bool enterFreeBit (const bool inStuffAllowed) {
+    const bool extendRun = mMaximize && (mFreeBitIndex >= mAlternatingBitCount) ;
+    const bool bit = extendRun ? mLastBitValue : !mLastBitValue ;
+    mFreeBitIndex += 1 ;
+    enterBit (bit, inStuffAllowed) ;
+    return bit ;
+  }
+
+  public: void beginField (const U32 inAlternatingBitCount) {
+    mFreeBitIndex = 0 ;
+    mAlternatingBitCount = inAlternatingBitCount ;
+  }
+
+  public: inline U32 lastStuffBitIndex (void) const { return mLastStuffBitIndex ; }
+  public: inline U32 lastRunEndIndex (void) const { return mLastRunEndIndex ; }
+  public: inline U32 bitIndex (void) const { return mBitIndex ; }
+
+  private: const bool mMaximize ;
+  private: bool mLastBitValue ;
+  private: U32 mConsecutiveBitCount ;
+  private: U32 mBitIndex ;
+  private: U32 mLastStuffBitIndex ;
+  private: U32 mLastRunEndIndex ;
+  private: U32 mFreeBitIndex ;
+  private: U32 mAlternatingBitCount ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+static U32 dataByteCount (const CANFDMolinaroStuffingPattern::FrameLayout & inLayout) {
+  U32 result = 0 ;
+  if (inLayout.mCANFD) {
+    result = CANFD_LENGTH [inLayout.mDataLengthCode & 15] ;
+  }else if (!inLayout.mRemote) {
+    result = (inLayout.mDataLengthCode > 8) ? 8 : inLayout.mDataLengthCode ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Walks the frame up to the end of data field. Identifier bits are free if
+//  inCraftIdentifier is true, payload bits are always free. Returns in outControlStuffIndex
+//  the index of the last stuff bit before BRS (CAN 2.0B: before DLC), and in
+//  outDataEndRunIndex the index of the last run end, if it is the last data bit.
+//----------------------------------------------------------------------------------------
+
+static void walkFrame (const CANFDMolinaroStuffingPattern::FrameLayout & inLayout,
+                       const bool inMaximize,
+                       const bool inCraftIdentifier,
+                       const U32 inIdentifierAlternatingBitCount,
+                       const U32 inDataAlternatingBitCount,
+                       uint32_t & ioIdentifier,
+                       uint8_t ioData [64],
+                       U32 & outControlStuffIndex,
+                       U32 & outDataEndRunIndex) {
+  StuffingWalker walker (inMaximize) ;
+  const U32 byteCount = dataByteCount (inLayout) ;
+  const uint8_t dlc = inLayout.mCANFD
+    ? (inLayout.mDataLengthCode & 15)
+    : ((inLayout.mDataLengthCode > 15) ? 15 : inLayout.mDataLengthCode) ;
+  walker.enterBit (false, true) ; // SOF
+//--- Identifier
+  walker.beginField (inIdentifierAlternatingBitCount) ;
+  const int identifierFirstBit = inLayout.mExtended ? 28 : 10 ;
+  uint32_t identifier = 0 ;
+  for (int idx = identifierFirstBit ; idx >= 0 ; idx--) {
+    bool bit = (ioIdentifier & (1U << idx)) != 0 ;
+    if (inCraftIdentifier) {
+      bit = walker.enterFreeBit (true) ;
+    }else{
+      walker.enterBit (bit, true) ;
+    }
+    identifier |= uint32_t (bit) << idx ;
+    if (inLayout.mExtended && (idx == 18)) {
+      walker.enterBit (true, true) ; // SRR
+      walker.enterBit (true, true) ; // IDE
+    }
+  }
+  ioIdentifier = identifier ;
+//--- Control field
+  if (inLayout.mCANFD) {
+    if (!inLayout.mExtended) {
+      walker.enterBit (false, true) ; // R1
+    }
+    walker.enterBit (false, true) ; // IDE (base) or RRS (extended)
+    walker.enterBit (true, true) ; // FDF
+    walker.enterBit (false, true) ; // R0
+    outControlStuffIndex = walker.lastStuffBitIndex () ;
+    walker.enterBit (inLayout.mBRS, true) ;
+    walker.enterBit (inLayout.mESI, true) ;
+  }else{
+    walker.enterBit (inLayout.mRemote, true) ; // RTR
+    walker.enterBit (false, true) ; // RESERVED 1
+    walker.enterBit (false, true) ; // RESERVED 0
+    outControlStuffIndex = walker.lastStuffBitIndex () ;
+  }
+  for (int idx = 3 ; idx >= 0 ; idx--) { // DLC
+    const bool lastBit = (idx == 0) && (byteCount == 0) ;
+    walker.enterBit ((dlc & (1 << idx)) != 0, !(inLayout.mCANFD && lastBit)) ;
+  }
+//--- Data field
+  walker.beginField (inDataAlternatingBitCount) ;
+  for (U32 dataIdx = 0 ; dataIdx < byteCount ; dataIdx++) {
+    uint8_t byte = 0 ;
+    for (int bitIdx = 7 ; bitIdx >= 0 ; bitIdx--) {
+      const bool lastBit = (dataIdx == (byteCount - 1)) && (bitIdx == 0) ;
+      const bool bit = walker.enterFreeBit (!(inLayout.mCANFD && lastBit)) ;
+      byte |= uint8_t (bit) << bitIdx ;
+    }
+    ioData [dataIdx] = byte ;
+  }
+  const U32 dataEndIndex = walker.bitIndex () - ((walker.lastStuffBitIndex () == walker.bitIndex ()) ? 1 : 0) ;
+  outDataEndRunIndex = (walker.lastRunEndIndex () == dataEndIndex) ? dataEndIndex : 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroStuffingPattern::usesLargestLength (const SimulatorStuffingPattern inPattern) {
+  bool result = false ;
+  switch (inPattern) {
+  case GENERATE_RANDOM_CONTENTS :
+  case GENERATE_ALL_ZERO_PAYLOAD :
+  case GENERATE_ALL_ONE_PAYLOAD :
+    break ;
+  case GENERATE_MAXIMUM_STUFFING :
+  case GENERATE_MINIMUM_STUFFING :
+  case GENERATE_STUFF_BIT_AT_BRS :
+  case GENERATE_STUFF_BIT_AT_DATA_END :
+    result = true ;
+    break ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroStuffingPattern::craft (const SimulatorStuffingPattern inPattern,
+                                          const FrameLayout & inLayout,
+                                          const bool inCraftIdentifier,
+                                          uint32_t & ioIdentifier,
+                                          uint8_t ioData [64]) {
+  U32 controlStuffIndex = 0 ;
+  U32 dataEndRunIndex = 0 ;
+  switch (inPattern) {
+  case GENERATE_RANDOM_CONTENTS :
+    break ;
+  case GENERATE_ALL_ZERO_PAYLOAD :
+    memset (ioData, 0x00, 64) ;
+    break ;
+  case GENERATE_ALL_ONE_PAYLOAD :
+    memset (ioData, 0xFF, 64) ;
+    break ;
+  case GENERATE_MAXIMUM_STUFFING :
+  case GENERATE_MINIMUM_STUFFING :
+    walkFrame (inLayout, inPattern == GENERATE_MAXIMUM_STUFFING, inCraftIdentifier, 0, 0,
+               ioIdentifier, ioData, controlStuffIndex, dataEndRunIndex) ;
+    break ;
+  case GENERATE_STUFF_BIT_AT_BRS :
+  case GENERATE_STUFF_BIT_AT_DATA_END :
+    { const bool atBRS = inPattern == GENERATE_STUFF_BIT_AT_BRS ;
+    //--- Run phase repeats every 4 bits; try the alternating prefix lengths, keep the best
+      U32 bestPhase = 0 ;
+      U32 bestIndex = 0 ;
+      for (U32 phase = 0 ; phase < 8 ; phase++) {
+        uint32_t identifier = ioIdentifier ;
+        walkFrame (inLayout, true, inCraftIdentifier, atBRS ? phase : 0, atBRS ? 0 : phase,
+                   identifier, ioData, controlStuffIndex, dataEndRunIndex) ;
+        const U32 index = atBRS ? controlStuffIndex : dataEndRunIndex ;
+        if (index > bestIndex) {
+          bestIndex = index ;
+          bestPhase = phase ;
+        }
+      }
+      walkFrame (inLayout, true, inCraftIdentifier, atBRS ? bestPhase : 0, atBRS ? 0 : bestPhase,
+                 ioIdentifier, ioData, controlStuffIndex, dataEndRunIndex) ;
+    }
+    break ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
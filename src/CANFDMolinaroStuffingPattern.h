@@ -0,0 +1,46 @@
+#ifndef CANFDMOLINARO_STUFFING_PATTERN_H
+#define CANFDMOLINARO_STUFFING_PATTERN_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include "CANFDMolinaroAnalyzerSettings.h"
+#include <stdint.h>
+
+//----------------------------------------------------------------------------------------
+//  Simulator stuffing patterns: identifier and payload bits are chosen while the frame
+//  is walked with the same stuffing rules as the frame bits generators.
+//  - maximum stuffing: every free bit extends the current run, giving a stuff bit every
+//    4 bits once the first run of 5 bits is reached;
+//  - minimum stuffing: every free bit is the complement of the previous one;
+//  - stuff bit at BRS, stuff bit at data end: maximum stuffing, with the first free bits
+//    of the identifier (or of the payload) alternating, so that the run phase places a
+//    stuff condition as close as possible to the BRS bit (CAN 2.0B: DLC field), or on the
+//    last data bit (CANFD: just before the fixed stuff bit of the stuff count field).
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroStuffingPattern {
+  public: typedef struct {
+    bool mCANFD ;
+    bool mExtended ;
+    bool mRemote ;
+    bool mBRS ;
+    bool mESI ;
+    uint8_t mDataLengthCode ;
+  } FrameLayout ;
+
+//--- True if the pattern sets the largest data length (crafted identifier and payload)
+  public: static bool usesLargestLength (const SimulatorStuffingPattern inPattern) ;
+
+//--- Sets payload (and identifier if inCraftIdentifier is true) according to pattern;
+//    does nothing for GENERATE_RANDOM_CONTENTS
+  public: static void craft (const SimulatorStuffingPattern inPattern,
+                             const FrameLayout & inLayout,
+                             const bool inCraftIdentifier,
+                             uint32_t & ioIdentifier,
+                             uint8_t ioData [64]) ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_STUFFING_PATTERN_H
@@ -0,0 +1,246 @@
+#include "CANFDMolinaroTraceReader.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------------------------------
+
+static const U8 CANFD_LENGTH [16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64} ;
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroTraceReader::CANFDMolinaroTraceReader (void) :
+mFile (),
+mLine () {
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroTraceReader::open (const std::string & inFilePath, std::string & outErrorMessage) {
+  mFile.close () ;
+  mFile.clear () ;
+  mFile.open (inFilePath) ;
+  const bool ok = mFile.is_open () ;
+  if (!ok) {
+    outErrorMessage = "Cannot open trace file '" + inFilePath + "'" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroTraceReader::next (TraceFrame & outFrame) {
+  bool found = false ;
+  while (!found && std::getline (mFile, mLine)) {
+    size_t idx = 0 ;
+    while ((idx < mLine.length ()) && isspace (mLine [idx])) {
+      idx += 1 ;
+    }
+    if (idx == mLine.length ()) { // Empty line
+    }else if (mLine [idx] == '(') {
+      found = parseCandumpLine (mLine.substr (idx), outFrame) ;
+    }else{
+      found = parseCSVLine (mLine.substr (idx), outFrame) ;
+    }
+  }
+  return found ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Parsing helpers: each one advances ioIndex, and returns false on error
+//----------------------------------------------------------------------------------------
+
+static int hexDigit (const char inChar) {
+  int result = -1 ;
+  if ((inChar >= '0') && (inChar <= '9')) {
+    result = inChar - '0' ;
+  }else if ((inChar >= 'a') && (inChar <= 'f')) {
+    result = inChar - 'a' + 10 ;
+  }else if ((inChar >= 'A') && (inChar <= 'F')) {
+    result = inChar - 'A' + 10 ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool parseTimestamp (const std::string & inLine, size_t & ioIndex, U64 & outNanoseconds) {
+  U64 seconds = 0 ;
+  U64 nanoseconds = 0 ;
+  const size_t start = ioIndex ;
+  while ((ioIndex < inLine.length ()) && isdigit (inLine [ioIndex])) {
+    seconds = seconds * 10 + U64 (inLine [ioIndex] - '0') ;
+    ioIndex += 1 ;
+  }
+  bool ok = ioIndex > start ;
+  if (ok && (ioIndex < inLine.length ()) && (inLine [ioIndex] == '.')) {
+    ioIndex += 1 ;
+    U64 scale = 100000000 ;
+    while ((ioIndex < inLine.length ()) && isdigit (inLine [ioIndex])) {
+      nanoseconds += scale * U64 (inLine [ioIndex] - '0') ;
+      scale /= 10 ;
+      ioIndex += 1 ;
+    }
+  }
+  outNanoseconds = seconds * 1000000000 + nanoseconds ;
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool parseIdentifier (const std::string & inLine,
+                             size_t & ioIndex,
+                             U32 & outIdentifier,
+                             bool & outExtended) {
+  if ((inLine.compare (ioIndex, 2, "0x") == 0) || (inLine.compare (ioIndex, 2, "0X") == 0)) {
+    ioIndex += 2 ;
+  }
+  U32 digitCount = 0 ;
+  outIdentifier = 0 ;
+  while ((ioIndex < inLine.length ()) && (hexDigit (inLine [ioIndex]) >= 0)) {
+    outIdentifier = (outIdentifier << 4) | U32 (hexDigit (inLine [ioIndex])) ;
+    digitCount += 1 ;
+    ioIndex += 1 ;
+  }
+  outExtended = (digitCount == 8) || (outIdentifier > 0x7FF) ;
+  return (digitCount > 0) && (digitCount <= 8) && (outIdentifier <= 0x1FFFFFFF) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool parsePayload (const std::string & inLine,
+                          size_t & ioIndex,
+                          const char * inSeparators,
+                          U8 outData [64],
+                          U8 & outLength) {
+  bool ok = true ;
+  outLength = 0 ;
+  while (ok && (ioIndex < inLine.length ())) {
+    const char c = inLine [ioIndex] ;
+    if (strchr (inSeparators, c) != nullptr) {
+      ioIndex += 1 ;
+    }else if ((hexDigit (c) >= 0) && ((ioIndex + 1) < inLine.length ()) && (hexDigit (inLine [ioIndex + 1]) >= 0)) {
+      ok = outLength < 64 ;
+      if (ok) {
+        outData [outLength] = U8 ((hexDigit (c) << 4) | hexDigit (inLine [ioIndex + 1])) ;
+        outLength += 1 ;
+        ioIndex += 2 ;
+      }
+    }else if (isspace (c)) { // End of payload
+      ioIndex = inLine.length () ;
+    }else{
+      ok = false ;
+    }
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+static bool checkLength (CANFDMolinaroTraceReader::TraceFrame & ioFrame) {
+  bool ok = true ;
+  if (ioFrame.mRemote) {
+    ok = !ioFrame.mCANFD && (ioFrame.mLength <= 8) ;
+  }else if (ioFrame.mCANFD) { // Pad payload up to a valid CANFD length
+    U32 code = 0 ;
+    while (CANFD_LENGTH [code] < ioFrame.mLength) {
+      code += 1 ;
+    }
+    while (ioFrame.mLength < CANFD_LENGTH [code]) {
+      ioFrame.mData [ioFrame.mLength] = 0 ;
+      ioFrame.mLength += 1 ;
+    }
+  }else{
+    ok = ioFrame.mLength <= 8 ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  (timestamp) interface frame
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroTraceReader::parseCandumpLine (const std::string & inLine, TraceFrame & outFrame) {
+  outFrame.mRemote = false ;
+  outFrame.mCANFD = false ;
+  outFrame.mBRS = false ;
+  outFrame.mESI = false ;
+  outFrame.mLength = 0 ;
+  size_t idx = 1 ; // After '('
+  bool ok = parseTimestamp (inLine, idx, outFrame.mTimestampNs) ;
+  ok = ok && (idx < inLine.length ()) && (inLine [idx] == ')') ;
+//--- Skip interface name
+  const size_t interfaceStart = ok ? inLine.find_first_not_of (" \t", idx + 1) : std::string::npos ;
+  const size_t interfaceEnd = inLine.find_first_of (" \t", interfaceStart) ;
+  const size_t frameStart = inLine.find_first_not_of (" \t", interfaceEnd) ;
+  ok = ok && (interfaceStart != std::string::npos) && (frameStart != std::string::npos) ;
+  idx = frameStart ;
+//--- Frame
+  ok = ok && parseIdentifier (inLine, idx, outFrame.mIdentifier, outFrame.mExtended) ;
+  ok = ok && (idx < inLine.length ()) && (inLine [idx] == '#') ;
+  idx += 1 ;
+  if (ok && (idx < inLine.length ()) && (inLine [idx] == '#')) { // CANFD
+    idx += 1 ;
+    outFrame.mCANFD = true ;
+    const int flags = (idx < inLine.length ()) ? hexDigit (inLine [idx]) : -1 ;
+    ok = flags >= 0 ;
+    outFrame.mBRS = (flags & 1) != 0 ;
+    outFrame.mESI = (flags & 2) != 0 ;
+    idx += 1 ;
+    ok = ok && parsePayload (inLine, idx, ".", outFrame.mData, outFrame.mLength) ;
+  }else if (ok && (idx < inLine.length ()) && ((inLine [idx] == 'R') || (inLine [idx] == 'r'))) { // Remote
+    idx += 1 ;
+    outFrame.mRemote = true ;
+    if ((idx < inLine.length ()) && isdigit (inLine [idx])) {
+      outFrame.mLength = U8 (inLine [idx] - '0') ;
+    }
+  }else if (ok) {
+    ok = parsePayload (inLine, idx, ".", outFrame.mData, outFrame.mLength) ;
+  }
+  return ok && checkLength (outFrame) ;
+}
+
+//----------------------------------------------------------------------------------------
+//  timestamp,identifier,flags,payload
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroTraceReader::parseCSVLine (const std::string & inLine, TraceFrame & outFrame) {
+  outFrame.mRemote = false ;
+  outFrame.mCANFD = false ;
+  outFrame.mBRS = false ;
+  outFrame.mESI = false ;
+  outFrame.mLength = 0 ;
+  size_t idx = 0 ;
+  bool ok = parseTimestamp (inLine, idx, outFrame.mTimestampNs) ;
+  ok = ok && (idx < inLine.length ()) && (inLine [idx] == ',') ;
+  idx += 1 ;
+  ok = ok && parseIdentifier (inLine, idx, outFrame.mIdentifier, outFrame.mExtended) ;
+  ok = ok && (idx < inLine.length ()) && (inLine [idx] == ',') ;
+  idx += 1 ;
+  while (ok && (idx < inLine.length ()) && (inLine [idx] != ',')) {
+    switch (toupper (inLine [idx])) {
+    case 'X' : outFrame.mExtended = true ; break ;
+    case 'R' : outFrame.mRemote = true ; break ;
+    case 'F' : outFrame.mCANFD = true ; break ;
+    case 'B' : outFrame.mBRS = true ; break ;
+    case 'E' : outFrame.mESI = true ; break ;
+    case ' ' : break ;
+    default : ok = false ; break ;
+    }
+    idx += 1 ;
+  }
+  if (ok && (idx < inLine.length ())) { // Payload, or DLC of a remote frame
+    idx += 1 ;
+    if (outFrame.mRemote) {
+      while ((idx < inLine.length ()) && isdigit (inLine [idx])) {
+        outFrame.mLength = U8 (outFrame.mLength * 10 + (inLine [idx] - '0')) ;
+        idx += 1 ;
+      }
+    }else{
+      ok = parsePayload (inLine, idx, " \t", outFrame.mData, outFrame.mLength) ;
+    }
+  }
+  ok = ok && (outFrame.mCANFD || !(outFrame.mBRS || outFrame.mESI)) ;
+  return ok && checkLength (outFrame) ;
+}
+
+//----------------------------------------------------------------------------------------
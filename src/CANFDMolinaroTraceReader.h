@@ -0,0 +1,58 @@
+#ifndef CANFDMOLINARO_TRACE_READER_H
+#define CANFDMOLINARO_TRACE_READER_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <fstream>
+#include <string>
+
+//----------------------------------------------------------------------------------------
+//  Streaming reader of recorded CAN traces, one frame per line; the file is never loaded
+//  entirely, so memory use does not depend on its size. Accepted line formats:
+//
+//  - candump log format (candump -l):
+//      (1436509052.249713) can0 123#DEADBEEF     classic data frame
+//      (1436509052.249713) can0 12345678#R2      remote frame (extended, DLC 2)
+//      (1436509052.249713) can0 123##1DEADBEEF   CANFD frame, flags nibble (1: BRS, 2: ESI)
+//  - CSV: timestamp (s), identifier (hex), flags, payload (hex, spaces allowed); flags
+//    letters are X (extended), R (remote), F (CANFD), B (BRS), E (ESI).
+//      0.001250,0x18DAF110,XFB,02 10 03
+//
+//  Identifiers greater than 0x7FF, or written with 8 hex digits, are extended. Lines that
+//  cannot be parsed (CSV header, comments, CAN XL frames) are skipped.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroTraceReader {
+  public: CANFDMolinaroTraceReader (void) ;
+
+  public: typedef struct {
+    U64 mTimestampNs ;
+    U32 mIdentifier ;
+    U8 mLength ; // Payload length, DLC for a remote frame
+    bool mExtended ;
+    bool mRemote ;
+    bool mCANFD ;
+    bool mBRS ;
+    bool mESI ;
+    U8 mData [64] ;
+  } TraceFrame ;
+
+//--- Returns false and sets outErrorMessage if the file cannot be opened
+  public: bool open (const std::string & inFilePath, std::string & outErrorMessage) ;
+
+//--- Returns false at end of file; lines that cannot be parsed are skipped
+  public: bool next (TraceFrame & outFrame) ;
+
+//--- Line parsers
+  public: static bool parseCandumpLine (const std::string & inLine, TraceFrame & outFrame) ;
+  public: static bool parseCSVLine (const std::string & inLine, TraceFrame & outFrame) ;
+
+//--- Private properties
+  private: std::ifstream mFile ;
+  private: std::string mLine ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_TRACE_READER_H
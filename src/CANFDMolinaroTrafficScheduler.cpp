@@ -0,0 +1,194 @@
+#include "CANFDMolinaroTrafficScheduler.h"
+
+#include <set>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroTrafficScheduler::CANFDMolinaroTrafficScheduler (void) :
+mMessages (),
+mNextNominalRelease (),
+mWaiting (),
+mReleaseQueue (),
+mReadyQueue (),
+mSeed (0) {
+}
+
+//----------------------------------------------------------------------------------------
+//  Arbitration field as an unsigned key: lower key wins. A base frame compares its 11
+//  bits identifier and RTR with the 11 most significant identifier bits and SRR of an
+//  extended frame; SRR and IDE are recessive in an extended frame.
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroTrafficScheduler::arbitrationKey (const Message & inMessage) {
+  U32 key = 0 ;
+  if (inMessage.mExtended) {
+    key = ((inMessage.mIdentifier >> 18) << 20) | (3U << 18) | (inMessage.mIdentifier & 0x3FFFF) ;
+  }else{
+    key = (inMessage.mIdentifier << 20) | (inMessage.mRemote ? (1U << 19) : 0) ;
+  }
+  return key ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTrafficScheduler::build (const U32 inNodeCount,
+                                           const SimulatorGeneratedFrameType inFrameTypes,
+                                           const SimulatorGeneratedBit inBRS,
+                                           const U32 inSeed,
+                                           const U32 inSampleRateHz) {
+  static const U32 PERIODS_MS [7] = {10, 20, 50, 100, 200, 500, 1000} ;
+  mSeed = inSeed ;
+  mMessages.clear () ;
+  std::set <U32> usedKeys ;
+  for (U32 node = 0 ; node < inNodeCount ; node++) {
+    for (U32 i = 0 ; i < MESSAGES_PER_NODE ; i++) {
+      Message message ;
+      message.mNode = node ;
+      message.mExtended = false ;
+      message.mRemote = false ;
+      message.mCANFD = false ;
+      bool canfd_24_64 = false ;
+      switch (inFrameTypes) {
+      case GENERATE_ALL_FRAME_TYPES :
+        message.mExtended = (pseudoRandomValue () & 1) != 0 ;
+        message.mCANFD = (pseudoRandomValue () & 1) != 0 ;
+        message.mRemote = !message.mCANFD && ((pseudoRandomValue () & 7) == 0) ;
+        canfd_24_64 = (pseudoRandomValue () & 1) != 0 ;
+        break ;
+      case GENERATE_ONLY_STANDARD_DATA :
+        break ;
+      case GENERATE_ONLY_EXTENDED_DATA :
+        message.mExtended = true ;
+        break ;
+      case GENERATE_ONLY_STANDARD_REMOTE :
+        message.mRemote = true ;
+        break ;
+      case GENERATE_ONLY_EXTENDED_REMOTE :
+        message.mExtended = true ;
+        message.mRemote = true ;
+        break ;
+      case GENERATE_ONLY_CANFD_BASE_0_16 :
+        message.mCANFD = true ;
+        break ;
+      case GENERATE_ONLY_CANFD_EXTENDED_0_16 :
+        message.mCANFD = true ;
+        message.mExtended = true ;
+        break ;
+      case GENERATE_ONLY_CANFD_BASE_20_64 :
+      case GENERATE_ONLY_CANXL_DATA : // Scheduled traffic has no CAN XL frame
+        message.mCANFD = true ;
+        canfd_24_64 = true ;
+        break ;
+      case GENERATE_ONLY_CANFD_EXTENDED_20_64 :
+        message.mCANFD = true ;
+        message.mExtended = true ;
+        canfd_24_64 = true ;
+        break ;
+      }
+    //--- Unique arbitration field
+      do{
+        message.mIdentifier = pseudoRandomValue () & (message.mExtended ? 0x1FFFFFFF : 0x7FF) ;
+      }while (usedKeys.count (arbitrationKey (message)) > 0) ;
+      usedKeys.insert (arbitrationKey (message)) ;
+    //---
+      if (!message.mCANFD) {
+        message.mDataLengthCode = U8 (pseudoRandomValue () % 9) ;
+      }else if (canfd_24_64) {
+        message.mDataLengthCode = U8 (pseudoRandomValue () % 5 + 11) ;
+      }else{
+        message.mDataLengthCode = U8 (pseudoRandomValue () % 11) ;
+      }
+      switch (inBRS) {
+      case GENERATE_BIT_DOMINANT :
+        message.mBRS = false ;
+        break ;
+      case GENERATE_BIT_RECESSIVE :
+        message.mBRS = message.mCANFD ;
+        break ;
+      case GENERATE_BIT_RANDOMLY :
+        message.mBRS = message.mCANFD && ((pseudoRandomValue () & 1) != 0) ;
+        break ;
+      }
+      message.mPeriod = U64 (inSampleRateHz) * PERIODS_MS [pseudoRandomValue () % 7] / 1000 ;
+      message.mJitter = message.mPeriod * (pseudoRandomValue () % 11) / 100 ; // 0 % to 10 %
+      message.mSporadic = (pseudoRandomValue () % 4) == 0 ;
+      message.mDuration = 0 ;
+      mMessages.push_back (message) ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTrafficScheduler::start (const U32 inLoadPercent, const U64 inStartSampleNumber) {
+//--- Scale periods
+  double load = 0.0 ;
+  for (const Message & message : mMessages) {
+    load += double (message.mDuration) / double (message.mPeriod) ;
+  }
+  const double scale = load * 100.0 / double (inLoadPercent) ;
+  for (Message & message : mMessages) {
+    message.mPeriod = U64 (double (message.mPeriod) * scale) ;
+    message.mJitter = U64 (double (message.mJitter) * scale) ;
+    if (message.mPeriod <= message.mDuration) {
+      message.mPeriod = message.mDuration + 1 ;
+    }
+  }
+//--- First releases, with a random phase
+  mReleaseQueue = decltype (mReleaseQueue) () ;
+  mReadyQueue = decltype (mReadyQueue) () ;
+  mNextNominalRelease.assign (mMessages.size (), 0) ;
+  mWaiting.assign (mMessages.size (), false) ;
+  for (U32 i = 0 ; i < messageCount () ; i++) {
+    const U64 nominal = inStartSampleNumber + pseudoRandomValue () % mMessages [i].mPeriod ;
+    mNextNominalRelease [i] = nominal ;
+    mReleaseQueue.push (ReleaseEvent (nominal, i)) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTrafficScheduler::scheduleNextRelease (const U32 inIndex,
+                                                         const U64 inReleaseSampleNumber) {
+  const Message & message = mMessages [inIndex] ;
+  U64 release = 0 ;
+  if (message.mSporadic) { // Uniform interval in [period / 2, 3 * period / 2]
+    release = inReleaseSampleNumber + message.mPeriod / 2 + pseudoRandomValue () % (message.mPeriod + 1) ;
+  }else{ // Jitter does not accumulate
+    mNextNominalRelease [inIndex] += message.mPeriod ;
+    release = mNextNominalRelease [inIndex] + pseudoRandomValue () % (message.mJitter + 1) ;
+  }
+  mReleaseQueue.push (ReleaseEvent (release, inIndex)) ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTrafficScheduler::releaseMessagesUntil (const U64 inSampleNumber) {
+  while (!mReleaseQueue.empty () && (mReleaseQueue.top ().first <= inSampleNumber)) {
+    const ReleaseEvent event = mReleaseQueue.top () ;
+    mReleaseQueue.pop () ;
+    if (!mWaiting [event.second]) { // Otherwise, the waiting instance is overwritten
+      mWaiting [event.second] = true ;
+      mReadyQueue.push (ReadyMessage (arbitrationKey (mMessages [event.second]), event.second)) ;
+    }
+    scheduleNextRelease (event.second, event.first) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+U32 CANFDMolinaroTrafficScheduler::nextFrame (const U64 inBusIdleSampleNumber,
+                                              U64 & outStartSampleNumber) {
+  outStartSampleNumber = inBusIdleSampleNumber ;
+  releaseMessagesUntil (outStartSampleNumber) ;
+  if (mReadyQueue.empty ()) { // Bus stays idle until next release
+    outStartSampleNumber = mReleaseQueue.top ().first ;
+    releaseMessagesUntil (outStartSampleNumber) ;
+  }
+  const U32 winner = mReadyQueue.top ().second ;
+  mReadyQueue.pop () ;
+  mWaiting [winner] = false ;
+  return winner ;
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+#ifndef CANFDMOLINARO_TRAFFIC_SCHEDULER_H
+#define CANFDMOLINARO_TRAFFIC_SCHEDULER_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include "CANFDMolinaroAnalyzerSettings.h"
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Simulator traffic scheduler: virtual nodes send periodic and sporadic messages.
+//  Released messages wait in a priority queue ordered by arbitration field; when the bus
+//  becomes idle, the message with the lowest arbitration field wins. When no message is
+//  ready, the bus stays idle until the next release. Message periods are scaled so that
+//  the sum of frame duration / period is the target bus load.
+//
+//  All times are sample numbers.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroTrafficScheduler {
+  public: CANFDMolinaroTrafficScheduler (void) ;
+
+  public: typedef struct {
+    U32 mIdentifier ;
+    U32 mNode ;
+    U64 mPeriod ; // Mean release interval for sporadic messages
+    U64 mJitter ; // Maximum release delay of periodic messages
+    U64 mDuration ; // Frame duration, including EOF and intermission
+    U8 mDataLengthCode ;
+    bool mExtended ;
+    bool mRemote ;
+    bool mCANFD ;
+    bool mBRS ;
+    bool mSporadic ;
+  } Message ;
+
+  public: static const U32 MESSAGES_PER_NODE = 4 ;
+
+//--- Builds the message set, with nominal periods (10 ms to 1 s)
+  public: void build (const U32 inNodeCount,
+                      const SimulatorGeneratedFrameType inFrameTypes,
+                      const SimulatorGeneratedBit inBRS,
+                      const U32 inSeed,
+                      const U32 inSampleRateHz) ;
+
+  public: inline U32 messageCount (void) const { return U32 (mMessages.size ()) ; }
+  public: inline const Message & message (const U32 inIndex) const { return mMessages [inIndex] ; }
+  public: inline void setMessageDuration (const U32 inIndex, const U64 inDuration) {
+    mMessages [inIndex].mDuration = inDuration ;
+  }
+
+//--- Scales periods for inLoadPercent bus load, and schedules first releases
+  public: void start (const U32 inLoadPercent, const U64 inStartSampleNumber) ;
+
+//--- Returns the index of the message that wins arbitration when the bus becomes idle
+//    at inBusIdleSampleNumber; outStartSampleNumber is its SOF (later if bus stays idle)
+  public: U32 nextFrame (const U64 inBusIdleSampleNumber, U64 & outStartSampleNumber) ;
+
+//--- Private methods
+  private: U32 pseudoRandomValue (void) {
+    mSeed = 8253729U * mSeed + 2396403U ;
+    return mSeed ;
+  }
+  private: static U32 arbitrationKey (const Message & inMessage) ;
+  private: void releaseMessagesUntil (const U64 inSampleNumber) ;
+  private: void scheduleNextRelease (const U32 inIndex, const U64 inReleaseSampleNumber) ;
+
+//--- Private properties
+  private: typedef std::pair <U64, U32> ReleaseEvent ; // Release sample number, message index
+  private: typedef std::pair <U32, U32> ReadyMessage ; // Arbitration key, message index
+  private: std::vector <Message> mMessages ;
+  private: std::vector <U64> mNextNominalRelease ;
+  private: std::vector <bool> mWaiting ;
+  private: std::priority_queue <ReleaseEvent, std::vector <ReleaseEvent>, std::greater <ReleaseEvent> > mReleaseQueue ;
+  private: std::priority_queue <ReadyMessage, std::vector <ReadyMessage>, std::greater <ReadyMessage> > mReadyQueue ;
+  private: U32 mSeed ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_TRAFFIC_SCHEDULER_H
@@ -0,0 +1,80 @@
+#include "CANFDMolinaroTransceiverMonitor.h"
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroTransceiverMonitor::CANFDMolinaroTransceiverMonitor (void) :
+mPhase (Phase::RECEIVING),
+mTransmitted (false),
+mArbitrationLost (false),
+mBitError (false),
+mHasLoopDelay (false),
+mLoopDelay (0) {
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTransceiverMonitor::startOfFrame (const bool inTxBit) {
+  mTransmitted = !inTxBit ; // Dominant SOF
+  mPhase = mTransmitted ? Phase::ARBITRATION : Phase::RECEIVING ;
+  mArbitrationLost = false ;
+  mBitError = false ;
+  mHasLoopDelay = false ;
+  mLoopDelay = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTransceiverMonitor::endOfArbitration (void) {
+  if (mPhase == Phase::ARBITRATION) {
+    mPhase = Phase::TRANSMITTING ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTransceiverMonitor::frameError (void) {
+  if (mPhase != Phase::RECEIVING) { // Error and overload flags are not compared
+    mPhase = Phase::STOPPED ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroTransceiverMonitor::BitCheck CANFDMolinaroTransceiverMonitor::checkBit (const bool inRxBit,
+                                                                                     const bool inTxBit,
+                                                                                     const bool inAckField) {
+  BitCheck result = BitCheck::BIT_OK ;
+  switch (mPhase) {
+  case Phase::RECEIVING :
+  case Phase::STOPPED :
+    break ;
+  case Phase::ARBITRATION :
+    if (inTxBit && !inRxBit) {
+      result = BitCheck::ARBITRATION_LOST ;
+      mArbitrationLost = true ;
+      mPhase = Phase::RECEIVING ;
+    }else if (!inTxBit && inRxBit) {
+      result = BitCheck::BIT_ERROR ;
+      mBitError = true ;
+      mPhase = Phase::STOPPED ;
+    }
+    break ;
+  case Phase::TRANSMITTING :
+    if ((inTxBit != inRxBit) && !inAckField) {
+      result = BitCheck::BIT_ERROR ;
+      mBitError = true ;
+      mPhase = Phase::STOPPED ;
+    }
+    break ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroTransceiverMonitor::setLoopDelay (const U64 inSampleCount) {
+  mHasLoopDelay = true ;
+  mLoopDelay = inSampleCount ;
+}
+
+//----------------------------------------------------------------------------------------
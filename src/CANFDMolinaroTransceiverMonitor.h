@@ -0,0 +1,54 @@
+#ifndef CANFDMOLINARO_TRANSCEIVER_MONITOR_H
+#define CANFDMOLINARO_TRANSCEIVER_MONITOR_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+
+//----------------------------------------------------------------------------------------
+//  Local node transmission monitor, from the TXD level at every RXD bit center. The
+//  node transmits a frame when TXD is dominant at SOF; then:
+//    - until FDF, TXD recessive while RXD dominant is an arbitration loss: the node
+//      becomes a receiver for the rest of the frame;
+//    - RXD differing from TXD otherwise is a bit error (except in ACK field, where the
+//      transmitter sends a recessive ACK slot); the frame is not checked further.
+//  Loop delay is the delay from the TXD edge to the RXD edge at FDF / res, that CANFD
+//  transmitter delay compensation depends on.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroTransceiverMonitor {
+  public: CANFDMolinaroTransceiverMonitor (void) ;
+
+//--- Frame events; inTxBit is the (not inverted) TXD level at SOF bit center
+  public: void startOfFrame (const bool inTxBit) ;
+  public: void endOfArbitration (void) ;
+  public: void frameError (void) ;
+
+//--- Checks a bit of the current frame (before the decoder enters it)
+  public: typedef enum {BIT_OK, ARBITRATION_LOST, BIT_ERROR} BitCheck ;
+
+  public: BitCheck checkBit (const bool inRxBit, const bool inTxBit, const bool inAckField) ;
+
+  public: void setLoopDelay (const U64 inSampleCount) ;
+
+//--- Current frame
+  public: inline bool transmitted (void) const { return mTransmitted ; }
+  public: inline bool arbitrationLost (void) const { return mArbitrationLost ; }
+  public: inline bool bitError (void) const { return mBitError ; }
+  public: inline bool isMeasuringLoopDelay (void) const { return mPhase == Phase::TRANSMITTING ; }
+  public: inline bool hasLoopDelay (void) const { return mHasLoopDelay ; }
+  public: inline U64 loopDelay (void) const { return mLoopDelay ; } // In samples
+
+//--- Private properties
+  private: typedef enum {RECEIVING, ARBITRATION, TRANSMITTING, STOPPED} Phase ;
+  private: Phase mPhase ;
+  private: bool mTransmitted ;
+  private: bool mArbitrationLost ;
+  private: bool mBitError ;
+  private: bool mHasLoopDelay ;
+  private: U64 mLoopDelay ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_TRANSCEIVER_MONITOR_H
@@ -0,0 +1,281 @@
+#include "CANFDMolinaroVCDReader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sys/stat.h>
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroVCDReader::CANFDMolinaroVCDReader (void) :
+mFile (nullptr),
+mFileSize (0),
+mBuffer (),
+mBufferIndex (0),
+mBufferLength (0),
+mToken (),
+mIdentifierCode (),
+mSamplesPerTimeUnit (1.0),
+mTime (0),
+mEndSampleNumber (0),
+mLevel (true),
+mInitialLevel (true),
+mErrorMessage () {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroVCDReader::~CANFDMolinaroVCDReader (void) {
+  close () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroVCDReader::open (const std::string & inFilePath,
+                                   const std::string & inSignal,
+                                   const U32 inSampleRateHz,
+                                   std::string & outErrorMessage) {
+  close () ;
+  mFile = fopen (inFilePath.c_str (), "rb") ;
+  bool ok = mFile != nullptr ;
+  if (!ok) {
+    outErrorMessage = "cannot open '" + inFilePath + "'" ;
+  }else{
+    struct stat status ;
+    mFileSize = (stat (inFilePath.c_str (), &status) == 0) ? U64 (status.st_size) : 0 ;
+    mBuffer.resize (BUFFER_SIZE) ;
+    mSamplesPerTimeUnit = 1.0e-9 * double (inSampleRateHz) ;
+    ok = parseHeader (inSignal, outErrorMessage) ;
+  }
+//--- First value of the signal is the initial level
+  int value = -1 ;
+  while (ok && (value < 0) && nextToken ()) {
+    if (mToken [0] == '#') {
+      ok = parseTime () ;
+      outErrorMessage = mErrorMessage ;
+    }else{
+      value = signalValue () ;
+    }
+  }
+  if (ok && (value < 0)) {
+    outErrorMessage = "no value of signal '" + inSignal + "' in VCD file" ;
+    ok = false ;
+  }
+  mLevel = value == 1 ;
+  mInitialLevel = mLevel ;
+  if (!ok) {
+    close () ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroVCDReader::close (void) {
+  if (mFile != nullptr) {
+    fclose (mFile) ;
+    mFile = nullptr ;
+  }
+  mFileSize = 0 ;
+  mBuffer.clear () ;
+  mBuffer.shrink_to_fit () ;
+  mBufferIndex = 0 ;
+  mBufferLength = 0 ;
+  mIdentifierCode.clear () ;
+  mTime = 0 ;
+  mEndSampleNumber = 0 ;
+  mErrorMessage.clear () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroVCDReader::nextToken (void) {
+  mToken.clear () ;
+  bool done = mFile == nullptr ;
+  while (!done) {
+    if (mBufferIndex == mBufferLength) {
+      mBufferLength = fread (mBuffer.data (), 1, mBuffer.size (), mFile) ;
+      mBufferIndex = 0 ;
+      done = mBufferLength == 0 ;
+    }else{
+      const char * buffer = mBuffer.data () ;
+      size_t idx = mBufferIndex ;
+      if (mToken.empty ()) { // Skip white space
+        while ((idx < mBufferLength) && isspace (U8 (buffer [idx]))) {
+          idx += 1 ;
+        }
+      }
+      const size_t start = idx ;
+      while ((idx < mBufferLength) && !isspace (U8 (buffer [idx]))) {
+        idx += 1 ;
+      }
+      mToken.append (buffer + start, idx - start) ;
+      mBufferIndex = idx ;
+      done = (idx < mBufferLength) && !mToken.empty () ;
+    }
+  }
+  return !mToken.empty () ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroVCDReader::skipToEnd (void) {
+  while (nextToken () && (mToken != "$end")) {
+  }
+}
+
+//----------------------------------------------------------------------------------------
+//  Declarations: scopes give hierarchical names, the first matching 1 bit variable is
+//  the decoded signal
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroVCDReader::parseHeader (const std::string & inSignal, std::string & outErrorMessage) {
+  std::vector <std::string> scopes ;
+  bool ok = true ;
+  bool found = false ;
+  bool done = false ;
+  while (ok && !done && nextToken ()) {
+    if (mToken == "$timescale") { // "1ns", or "1 ns"
+      std::string text ;
+      while (nextToken () && (mToken != "$end")) {
+        text += mToken ;
+      }
+      char * unit = nullptr ;
+      const double count = strtod (text.c_str (), &unit) ;
+      const std::string unitName = unit ;
+      double seconds = 0.0 ;
+      if (unitName == "s") {
+        seconds = 1.0 ;
+      }else if (unitName == "ms") {
+        seconds = 1.0e-3 ;
+      }else if (unitName == "us") {
+        seconds = 1.0e-6 ;
+      }else if (unitName == "ns") {
+        seconds = 1.0e-9 ;
+      }else if (unitName == "ps") {
+        seconds = 1.0e-12 ;
+      }else if (unitName == "fs") {
+        seconds = 1.0e-15 ;
+      }
+      ok = (count > 0.0) && (seconds > 0.0) ;
+      if (ok) {
+        mSamplesPerTimeUnit *= count * seconds / 1.0e-9 ;
+      }else{
+        outErrorMessage = "invalid timescale '" + text + "'" ;
+      }
+    }else if (mToken == "$scope") { // $scope module top $end
+      nextToken () ;
+      nextToken () ;
+      scopes.push_back (mToken) ;
+      skipToEnd () ;
+    }else if (mToken == "$upscope") {
+      if (scopes.size () > 0) {
+        scopes.pop_back () ;
+      }
+      skipToEnd () ;
+    }else if (mToken == "$var") { // $var wire 1 ! can_rx $end, or $var wire 1 # rx [0] $end
+      std::vector <std::string> fields ;
+      while (nextToken () && (mToken != "$end")) {
+        fields.push_back (mToken) ;
+      }
+      if (!found && (fields.size () >= 4) && (fields [1] == "1")) {
+        const std::string & reference = fields [3] ;
+        const std::string indexed = (fields.size () >= 5) ? (reference + fields [4]) : reference ;
+        std::string scope ;
+        for (const std::string & name : scopes) {
+          scope += name + "." ;
+        }
+        found = inSignal.empty ()
+          || (inSignal == reference) || (inSignal == indexed)
+          || (inSignal == (scope + reference)) || (inSignal == (scope + indexed)) ;
+        if (found) {
+          mIdentifierCode = fields [2] ;
+        }
+      }
+    }else if (mToken == "$enddefinitions") {
+      skipToEnd () ;
+      done = true ;
+    }else if (mToken [0] == '$') { // $date, $version, $comment
+      skipToEnd () ;
+    }
+  }
+  if (ok && !done) {
+    outErrorMessage = "no $enddefinitions in VCD header" ;
+    ok = false ;
+  }
+  if (ok && !found) {
+    outErrorMessage = "no 1 bit variable '" + inSignal + "' in VCD header" ;
+    ok = false ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+
+bool CANFDMolinaroVCDReader::parseTime (void) {
+  char * end = nullptr ;
+  const unsigned long long time = strtoull (mToken.c_str () + 1, &end, 10) ;
+  const bool ok = (mToken.length () > 1) && (*end == '\0') ;
+  if (ok) {
+    mTime = U64 (time) ;
+    mEndSampleNumber = std::max (mEndSampleNumber, sampleNumber (mTime)) ;
+  }else{
+    mErrorMessage = "invalid VCD timestamp '" + mToken + "'" ;
+  }
+  return ok ;
+}
+
+//----------------------------------------------------------------------------------------
+//  Value changes: scalar "1!", vector "b0101 !", real "r1.5 !", string "sText !".
+//  Simulation commands ($dumpvars, $end...) are ignored, $comment is skipped.
+//----------------------------------------------------------------------------------------
+
+int CANFDMolinaroVCDReader::signalValue (void) {
+  int result = -1 ;
+  switch (mToken [0]) {
+  case '0' : case '1' :
+    if (mToken.compare (1, std::string::npos, mIdentifierCode) == 0) {
+      result = mToken [0] - '0' ;
+    }
+    break ;
+  case 'b' : case 'B' :
+    { const char lastBit = mToken.back () ;
+      nextToken () ;
+      if ((mToken == mIdentifierCode) && ((lastBit == '0') || (lastBit == '1'))) {
+        result = lastBit - '0' ;
+      }
+    }
+    break ;
+  case 'r' : case 'R' : case 's' : case 'S' :
+    nextToken () ;
+    break ;
+  case '$' :
+    if (mToken == "$comment") {
+      skipToEnd () ;
+    }
+    break ;
+  default : // x, z
+    break ;
+  }
+  return result ;
+}
+
+//----------------------------------------------------------------------------------------
+
+size_t CANFDMolinaroVCDReader::readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) {
+  size_t count = 0 ;
+  while ((count < inMaxCount) && mErrorMessage.empty () && nextToken ()) {
+    if (mToken [0] == '#') {
+      parseTime () ;
+    }else{
+      const int value = signalValue () ;
+      if ((value >= 0) && ((value == 1) != mLevel)) {
+        mLevel = value == 1 ;
+        outEdges.push_back (sampleNumber (mTime)) ;
+        count += 1 ;
+      }
+    }
+  }
+  return count ;
+}
+
+//----------------------------------------------------------------------------------------
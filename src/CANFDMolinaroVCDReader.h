@@ -0,0 +1,73 @@
+#ifndef CANFDMOLINARO_VCD_READER_H
+#define CANFDMOLINARO_VCD_READER_H
+
+//----------------------------------------------------------------------------------------
+
+#include "CANFDMolinaroEdgeSource.h"
+#include <cstdio>
+
+//----------------------------------------------------------------------------------------
+//  Streaming reader of one signal of a Value Change Dump file (IEEE 1364). The file is
+//  read by buffers and split into whitespace separated tokens: the header gives the
+//  identifier code of the signal and the timescale, then value changes of the signal
+//  are returned as edges. VCD time 0 is sample 0; the last timestamp is capture end.
+//
+//  The signal is a 1 bit variable, named by its reference ("can_rx"), its reference and
+//  bit index ("rx[0]"), or its hierarchical name ("top.phy.can_rx"); x and z values do
+//  not change the level. Without timescale, the time unit is 1 ns.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroVCDReader : public CANFDMolinaroEdgeSource {
+  public: CANFDMolinaroVCDReader (void) ;
+  public: virtual ~CANFDMolinaroVCDReader (void) ;
+
+//--- Reads the header, up to the first value of the signal (first 1 bit variable if
+//    inSignal is empty); returns false and sets outErrorMessage on error
+  public: bool open (const std::string & inFilePath,
+                     const std::string & inSignal,
+                     const U32 inSampleRateHz,
+                     std::string & outErrorMessage) ;
+
+  public: void close (void) ;
+
+//--- Edge source
+  public: virtual bool initialLevel (void) const { return mInitialLevel ; }
+  public: virtual size_t readEdges (std::vector <U64> & outEdges, const size_t inMaxCount) ;
+  public: virtual U64 endSampleNumber (void) const { return mEndSampleNumber ; }
+  public: virtual const std::string & errorMessage (void) const { return mErrorMessage ; }
+  public: virtual U64 fileSize (void) const { return mFileSize ; }
+
+//--- Private methods
+  private: bool nextToken (void) ; // Sets mToken, returns false at end of file
+  private: void skipToEnd (void) ; // Skips tokens up to $end
+  private: bool parseHeader (const std::string & inSignal, std::string & outErrorMessage) ;
+  private: bool parseTime (void) ; // Current token is #<time>
+  private: int signalValue (void) ; // 0, 1, or -1 (other signal, x, z)
+  private: inline U64 sampleNumber (const U64 inTime) const {
+    return U64 (double (inTime) * mSamplesPerTimeUnit + 0.5) ;
+  }
+
+//--- Private properties
+  private: static const size_t BUFFER_SIZE = 1024 * 1024 ;
+  private: FILE * mFile ;
+  private: U64 mFileSize ;
+  private: std::vector <char> mBuffer ;
+  private: size_t mBufferIndex ;
+  private: size_t mBufferLength ;
+  private: std::string mToken ;
+  private: std::string mIdentifierCode ;
+  private: double mSamplesPerTimeUnit ;
+  private: U64 mTime ;
+  private: U64 mEndSampleNumber ;
+  private: bool mLevel ;
+  private: bool mInitialLevel ;
+  private: std::string mErrorMessage ;
+
+//--- No copy
+  private: CANFDMolinaroVCDReader (const CANFDMolinaroVCDReader &) = delete ;
+  private: CANFDMolinaroVCDReader & operator = (const CANFDMolinaroVCDReader &) = delete ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_VCD_READER_H
@@ -0,0 +1,78 @@
+#include "CANFDMolinaroWorkerPool.h"
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroWorkerPool::CANFDMolinaroWorkerPool (void) :
+mThreads (),
+mMutex (),
+mTaskAvailable (),
+mTasksDone (),
+mTask (nullptr),
+mTaskCount (0),
+mNextTask (0),
+mRunningTaskCount (0),
+mStop (false) {
+}
+
+//----------------------------------------------------------------------------------------
+
+CANFDMolinaroWorkerPool::~CANFDMolinaroWorkerPool (void) {
+  { std::lock_guard <std::mutex> lock (mMutex) ;
+    mStop = true ;
+  }
+  mTaskAvailable.notify_all () ;
+  for (std::thread & thread : mThreads) {
+    thread.join () ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroWorkerPool::run (const U32 inTaskCount,
+                                   const std::function <void (const U32)> & inTask) {
+//--- The calling thread runs tasks too
+  while ((mThreads.size () + 1) < inTaskCount) {
+    mThreads.push_back (std::thread (&CANFDMolinaroWorkerPool::workerLoop, this)) ;
+  }
+  std::unique_lock <std::mutex> lock (mMutex) ;
+  mTask = &inTask ;
+  mTaskCount = inTaskCount ;
+  mNextTask = 0 ;
+  mTaskAvailable.notify_all () ;
+  runTasks (lock) ;
+  mTasksDone.wait (lock, [this] { return mRunningTaskCount == 0 ; }) ;
+  mTask = nullptr ;
+  mTaskCount = 0 ;
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroWorkerPool::runTasks (std::unique_lock <std::mutex> & ioLock) {
+  while ((mTask != nullptr) && (mNextTask < mTaskCount)) {
+    const U32 taskIndex = mNextTask ;
+    const std::function <void (const U32)> & task = *mTask ;
+    mNextTask += 1 ;
+    mRunningTaskCount += 1 ;
+    ioLock.unlock () ;
+    task (taskIndex) ;
+    ioLock.lock () ;
+    mRunningTaskCount -= 1 ;
+    if (mRunningTaskCount == 0) {
+      mTasksDone.notify_all () ;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+
+void CANFDMolinaroWorkerPool::workerLoop (void) {
+  std::unique_lock <std::mutex> lock (mMutex) ;
+  while (!mStop) {
+    runTasks (lock) ;
+    mTaskAvailable.wait (lock, [this] {
+      return mStop || ((mTask != nullptr) && (mNextTask < mTaskCount)) ;
+    }) ;
+  }
+}
+
+//----------------------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+#ifndef CANFDMOLINARO_WORKER_POOL_H
+#define CANFDMOLINARO_WORKER_POOL_H
+
+//----------------------------------------------------------------------------------------
+
+#include <LogicPublicTypes.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------
+//  Small pool of persistent threads: run () executes inTaskCount tasks, on the pool
+//  threads and on the calling thread, and returns when all of them are done. Threads
+//  are started by the first run () that needs them, and stopped by the destructor.
+//----------------------------------------------------------------------------------------
+
+class CANFDMolinaroWorkerPool {
+  public: CANFDMolinaroWorkerPool (void) ;
+
+  public: ~CANFDMolinaroWorkerPool (void) ;
+
+//--- inTask is called with task indexes 0 .. inTaskCount-1
+  public: void run (const U32 inTaskCount, const std::function <void (const U32)> & inTask) ;
+
+  public: inline U32 threadCount (void) const { return U32 (mThreads.size ()) ; }
+
+//--- No copy
+  private: CANFDMolinaroWorkerPool (const CANFDMolinaroWorkerPool &) = delete ;
+  private: CANFDMolinaroWorkerPool & operator = (const CANFDMolinaroWorkerPool &) = delete ;
+
+//--- Private methods
+  private: void workerLoop (void) ;
+  private: void runTasks (std::unique_lock <std::mutex> & ioLock) ;
+
+//--- Private properties
+  private: std::vector <std::thread> mThreads ;
+  private: std::mutex mMutex ;
+  private: std::condition_variable mTaskAvailable ;
+  private: std::condition_variable mTasksDone ;
+  private: const std::function <void (const U32)> * mTask ;
+  private: U32 mTaskCount ;
+  private: U32 mNextTask ;
+  private: U32 mRunningTaskCount ;
+  private: bool mStop ;
+} ;
+
+//----------------------------------------------------------------------------------------
+
+#endif //CANFDMOLINARO_WORKER_POOL_H